@@ -0,0 +1,54 @@
+﻿cbuffer g_view : register(b0)
+{
+    float2 viewScale;
+    float2 viewOffset;
+};
+
+Texture2D g_texture : register(t0);
+SamplerState g_sampler : register(s0);
+
+struct VSInput
+{
+    float2 position : POSITION;
+    float2 scale : SCALE;
+    float rotation : ROTATION;
+    float4 color : COLOR;
+    float4 uvRect : TEXCOORD;
+};
+
+struct PSInput
+{
+    float4 position : SV_POSITION;
+    float4 color : COLOR;
+    float2 texcoord : TEXCOORD;
+};
+
+PSInput VS(VSInput input, uint vertexID : SV_VertexID)
+{
+    PSInput output;
+
+    // 0: top-left, 1: top-right, 2: bottom-left, 3: bottom-right
+    float2 corner = float2(vertexID & 1, vertexID >> 1);
+
+    float2 local = (corner - 0.5f) * input.scale;
+
+    float s, c;
+    sincos(input.rotation, s, c);
+
+    // Rotate clockwise in the pixel coordinate (y-axis downward).
+    float2 rotated = float2(local.x * c - local.y * s, local.x * s + local.y * c);
+
+    output.position = float4((input.position + rotated) * viewScale + viewOffset, 0.0f, 1.0f);
+
+    // The textures are premultiplied, so premultiply the tint as well.
+    output.color = float4(input.color.rgb * input.color.a, input.color.a);
+
+    output.texcoord = lerp(input.uvRect.xy, input.uvRect.zw, corner);
+
+    return output;
+}
+
+float4 PS(PSInput input) : SV_TARGET
+{
+    return g_texture.Sample(g_sampler, input.texcoord) * input.color;
+}
@@ -0,0 +1,104 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::cpp_lang_utils
+{
+    // A drop-in replacement of Function for the event callback members (i.e.
+    // the f_xxx hooks), which are usually empty in most objects.
+    //
+    // std::function takes 32~64 bytes (64 for MSVC x64) even if empty, while
+    // LazyFunction only stores a pointer and allocates the std::function
+    // when a callable is assigned, so an empty hook costs 8 bytes only.
+    //
+    // The usage is the same as std::function:
+    //
+    // obj->f_onXxx = [](...) { ... };  // assign
+    // if (f_onXxx) f_onXxx(this, ...); // check & invoke
+    // obj->f_onXxx = nullptr;          // clear
+
+    template<typename T>
+    struct LazyFunction;
+
+    template<typename R, typename... Args>
+    struct LazyFunction<R(Args...)>
+    {
+        using FunctionType = Function<R(Args...)>;
+
+        LazyFunction() = default;
+
+        LazyFunction(std::nullptr_t) { }
+
+        template<typename F>
+        requires (!std::is_same_v<std::decay_t<F>, LazyFunction> &&
+                  !std::is_same_v<std::decay_t<F>, std::nullptr_t> &&
+                  std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+        LazyFunction(F&& func) { assign(std::forward<F>(func)); }
+
+        LazyFunction(const LazyFunction& rhs)
+        {
+            if (rhs.m_func) m_func = std::make_unique<FunctionType>(*rhs.m_func);
+        }
+        LazyFunction(LazyFunction&& rhs) noexcept = default;
+
+        LazyFunction& operator=(const LazyFunction& rhs)
+        {
+            if (this != &rhs)
+            {
+                if (rhs.m_func)
+                {
+                    m_func = std::make_unique<FunctionType>(*rhs.m_func);
+                }
+                else m_func.reset();
+            }
+            return *this;
+        }
+        LazyFunction& operator=(LazyFunction&& rhs) noexcept = default;
+
+        LazyFunction& operator=(std::nullptr_t)
+        {
+            m_func.reset();
+            return *this;
+        }
+
+        template<typename F>
+        requires (!std::is_same_v<std::decay_t<F>, LazyFunction> &&
+                  !std::is_same_v<std::decay_t<F>, std::nullptr_t> &&
+                  std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+        LazyFunction& operator=(F&& func)
+        {
+            assign(std::forward<F>(func));
+            return *this;
+        }
+
+    private:
+        UniquePtr<FunctionType> m_func = {};
+
+        template<typename F>
+        void assign(F&& func)
+        {
+            FunctionType temp(std::forward<F>(func));
+
+            // An empty std::function (or a null function pointer)
+            // should not allocate anything.
+            if (temp)
+            {
+                m_func = std::make_unique<FunctionType>(std::move(temp));
+            }
+            else m_func.reset();
+        }
+
+    public:
+        explicit operator bool() const { return m_func != nullptr; }
+
+        R operator()(Args... args) const
+        {
+            if (!m_func) throw std::bad_function_call();
+
+            return (*m_func)(std::forward<Args>(args)...);
+        }
+    };
+
+    // Keep the hooks pointer-sized, which is what makes the empty ones cheap.
+    static_assert(sizeof(LazyFunction<void()>) == sizeof(void*));
+}
@@ -0,0 +1,719 @@
+﻿#include "Common/Precompile.h"
+
+#include "Common/ImageUtils/Deflate.h"
+
+namespace d14engine::image_utils
+{
+    namespace
+    {
+        constexpr size_t g_windowSize = 32768;
+
+        constexpr size_t g_minMatch = 3;
+        constexpr size_t g_maxMatch = 258;
+
+        // The tokens of a block before it is written.
+        constexpr size_t g_maxBlockTokens = 16384;
+
+        constexpr size_t g_maxStoredSize = 65535;
+
+        constexpr uint16_t g_lengthBases[29] =
+        {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+        };
+        constexpr uint8_t g_lengthExtraBits[29] =
+        {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+        };
+        constexpr uint16_t g_distanceBases[30] =
+        {
+            1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+        };
+        constexpr uint8_t g_distanceExtraBits[30] =
+        {
+            0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+        };
+        constexpr uint8_t g_codeLengthOrder[19] =
+        {
+            16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+        };
+
+        struct CodeTables
+        {
+            uint8_t lengthCodes[g_maxMatch + 1] = {};
+
+            // [distance - 1] for distance <= 256, otherwise [256 + ((distance - 1) >> 7)]
+            uint8_t distanceCodes[512] = {};
+
+            CodeTables()
+            {
+                for (uint8_t code = 0; code < 29; ++code)
+                {
+                    size_t count = (size_t)1 << g_lengthExtraBits[code];
+                    for (size_t i = 0; i < count && g_lengthBases[code] + i <= g_maxMatch; ++i)
+                    {
+                        lengthCodes[g_lengthBases[code] + i] = code;
+                    }
+                }
+                // 258 has its own code instead of being 227 + 31.
+                lengthCodes[g_maxMatch] = 28;
+
+                for (uint8_t code = 0; code < 30; ++code)
+                {
+                    size_t count = (size_t)1 << g_distanceExtraBits[code];
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        size_t distance = g_distanceBases[code] + i;
+                        if (distance <= 256)
+                        {
+                            distanceCodes[distance - 1] = code;
+                        }
+                        else distanceCodes[256 + ((distance - 1) >> 7)] = code;
+                    }
+                }
+            }
+
+            uint8_t distanceCode(size_t distance) const
+            {
+                return distance <= 256 ? distanceCodes[distance - 1] : distanceCodes[256 + ((distance - 1) >> 7)];
+            }
+        };
+
+        const CodeTables& codeTables()
+        {
+            static const CodeTables tables = {};
+            return tables;
+        }
+
+        struct BitWriter
+        {
+            std::vector<uint8_t>& bytes;
+
+            uint64_t bits = 0;
+            int bitCount = 0;
+
+            // LSB first, where the value must fit in the count of bits.
+            void write(uint32_t value, int count)
+            {
+                bits |= (uint64_t)value << bitCount;
+                bitCount += count;
+
+                while (bitCount >= 8)
+                {
+                    bytes.push_back((uint8_t)bits);
+                    bits >>= 8;
+                    bitCount -= 8;
+                }
+            }
+
+            void alignToByte()
+            {
+                if (bitCount > 0)
+                {
+                    bytes.push_back((uint8_t)bits);
+                    bits = 0;
+                    bitCount = 0;
+                }
+            }
+        };
+
+        // A literal if distance is 0, otherwise a match.
+        struct Token
+        {
+            uint16_t value = 0; // literal byte or match length
+            uint16_t distance = 0;
+        };
+
+        // Builds the code lengths limited to maxLength, where the shorter
+        // codes go to the more frequent symbols.
+        void buildCodeLengths(const uint32_t* freqs, size_t count, int maxLength, uint8_t* lengths)
+        {
+            std::fill(lengths, lengths + count, (uint8_t)0);
+
+            std::vector<uint16_t> symbols = {};
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (freqs[i] > 0) symbols.push_back((uint16_t)i);
+            }
+            if (symbols.empty()) return;
+            if (symbols.size() == 1)
+            {
+                lengths[symbols.front()] = 1;
+                return;
+            }
+            std::stable_sort(symbols.begin(), symbols.end(),
+                [&](uint16_t lhs, uint16_t rhs) { return freqs[lhs] < freqs[rhs]; });
+
+            // The 2-queue construction: the leaves are sorted, and the inner
+            // nodes are created in the increasing order of weights.
+            size_t leafCount = symbols.size();
+            size_t nodeCount = 2 * leafCount - 1;
+
+            std::vector<uint64_t> weights(nodeCount);
+            std::vector<size_t> parents(nodeCount);
+
+            for (size_t i = 0; i < leafCount; ++i) weights[i] = freqs[symbols[i]];
+
+            size_t leaf = 0, inner = leafCount;
+            auto popMin = [&](size_t next)
+            {
+                if (leaf < leafCount && (inner >= next || weights[leaf] <= weights[inner]))
+                {
+                    return leaf++;
+                }
+                return inner++;
+            };
+            for (size_t next = leafCount; next < nodeCount; ++next)
+            {
+                size_t a = popMin(next);
+                size_t b = popMin(next);
+
+                weights[next] = weights[a] + weights[b];
+                parents[a] = parents[b] = next;
+            }
+            std::vector<int> depths(nodeCount);
+            depths[nodeCount - 1] = 0;
+
+            for (size_t i = nodeCount - 1; i-- > 0;)
+            {
+                depths[i] = depths[parents[i]] + 1;
+            }
+            int lengthCounts[64] = {};
+            for (size_t i = 0; i < leafCount; ++i)
+            {
+                ++lengthCounts[std::min(depths[i], maxLength)];
+            }
+            // Limit the lengths by moving the leaves up while keeping the
+            // Kraft sum (see tdefl_huffman_enforce_max_code_size of miniz).
+            uint32_t total = 0;
+            for (int i = maxLength; i > 0; --i)
+            {
+                total += (uint32_t)lengthCounts[i] << (maxLength - i);
+            }
+            while (total != (1u << maxLength))
+            {
+                --lengthCounts[maxLength];
+                for (int i = maxLength - 1; i > 0; --i)
+                {
+                    if (lengthCounts[i] > 0)
+                    {
+                        --lengthCounts[i];
+                        lengthCounts[i + 1] += 2;
+                        break;
+                    }
+                }
+                --total;
+            }
+            // The least frequent symbols take the longest codes.
+            size_t index = 0;
+            for (int i = maxLength; i > 0; --i)
+            {
+                for (int j = 0; j < lengthCounts[i]; ++j)
+                {
+                    lengths[symbols[index++]] = (uint8_t)i;
+                }
+            }
+        }
+
+        // The canonical codes with the bits reversed, since the Huffman codes
+        // are packed from the MSB in the LSB-first stream.
+        void buildCodes(const uint8_t* lengths, size_t count, uint16_t* codes)
+        {
+            uint16_t lengthCounts[16] = {};
+            for (size_t i = 0; i < count; ++i) ++lengthCounts[lengths[i]];
+            lengthCounts[0] = 0;
+
+            uint16_t nextCodes[16] = {};
+            uint16_t code = 0;
+            for (int i = 1; i < 16; ++i)
+            {
+                code = (uint16_t)((code + lengthCounts[i - 1]) << 1);
+                nextCodes[i] = code;
+            }
+            for (size_t i = 0; i < count; ++i)
+            {
+                int length = lengths[i];
+                if (length == 0) continue;
+
+                uint16_t value = nextCodes[length]++, reversed = 0;
+                for (int j = 0; j < length; ++j)
+                {
+                    reversed = (uint16_t)((reversed << 1) | ((value >> j) & 1));
+                }
+                codes[i] = reversed;
+            }
+        }
+
+        // Some decoders reject the trees with a single code, so at least 2
+        // codes are always defined.
+        void ensureTwoCodes(uint32_t* freqs, size_t count)
+        {
+            size_t used = std::count_if(freqs, freqs + count, [](uint32_t f) { return f > 0; });
+
+            for (size_t i = 0; i < count && used < 2; ++i)
+            {
+                if (freqs[i] == 0)
+                {
+                    freqs[i] = 1;
+                    ++used;
+                }
+            }
+        }
+
+        void writeStoredBlocks(BitWriter& writer, const uint8_t* data, size_t size, bool final)
+        {
+            do
+            {
+                size_t chunkSize = std::min(size, g_maxStoredSize);
+                bool last = (chunkSize == size);
+
+                writer.write(final && last ? 1 : 0, 1);
+                writer.write(0, 2); // stored
+                writer.alignToByte();
+
+                writer.write((uint32_t)chunkSize, 16);
+                writer.write((uint32_t)(~chunkSize & 0xffff), 16);
+
+                writer.bytes.insert(writer.bytes.end(), data, data + chunkSize);
+
+                data += chunkSize;
+                size -= chunkSize;
+            }
+            while (size > 0);
+        }
+
+        void writeBlock(
+            BitWriter& writer,
+            const std::vector<Token>& tokens,
+            const uint8_t* raw, size_t rawSize,
+            bool final)
+        {
+            auto& tables = codeTables();
+
+            uint32_t litLenFreqs[286] = {}, distanceFreqs[30] = {};
+            for (auto& token : tokens)
+            {
+                if (token.distance == 0)
+                {
+                    ++litLenFreqs[token.value];
+                }
+                else // match
+                {
+                    ++litLenFreqs[257 + tables.lengthCodes[token.value]];
+                    ++distanceFreqs[tables.distanceCode(token.distance)];
+                }
+            }
+            litLenFreqs[256] = 1; // end of block
+
+            ensureTwoCodes(litLenFreqs, 286);
+            ensureTwoCodes(distanceFreqs, 30);
+
+            uint8_t litLenLengths[286] = {}, distanceLengths[30] = {};
+            buildCodeLengths(litLenFreqs, 286, 15, litLenLengths);
+            buildCodeLengths(distanceFreqs, 30, 15, distanceLengths);
+
+            size_t litLenCount = 286, distanceCount = 30;
+            while (litLenCount > 257 && litLenLengths[litLenCount - 1] == 0) --litLenCount;
+            while (distanceCount > 1 && distanceLengths[distanceCount - 1] == 0) --distanceCount;
+
+            // Run-length encode the code lengths of both trees together.
+            std::vector<uint8_t> lengths(litLenLengths, litLenLengths + litLenCount);
+            lengths.insert(lengths.end(), distanceLengths, distanceLengths + distanceCount);
+
+            struct LengthSymbol { uint8_t symbol = 0, extra = 0; };
+            std::vector<LengthSymbol> lengthSymbols = {};
+
+            uint32_t codeLengthFreqs[19] = {};
+            for (size_t i = 0; i < lengths.size();)
+            {
+                uint8_t length = lengths[i];
+
+                size_t run = 1;
+                while (i + run < lengths.size() && lengths[i + run] == length) ++run;
+
+                size_t consumed = 1;
+                if (length == 0 && run >= 11)
+                {
+                    consumed = std::min(run, (size_t)138);
+                    lengthSymbols.push_back({ 18, (uint8_t)(consumed - 11) });
+                }
+                else if (length == 0 && run >= 3)
+                {
+                    consumed = run;
+                    lengthSymbols.push_back({ 17, (uint8_t)(consumed - 3) });
+                }
+                else if (length != 0 && run >= 4)
+                {
+                    // The length itself and then the repeats.
+                    lengthSymbols.push_back({ length, 0 });
+                    ++codeLengthFreqs[length];
+
+                    consumed = 1 + std::min(run - 1, (size_t)6);
+                    lengthSymbols.push_back({ 16, (uint8_t)(consumed - 1 - 3) });
+                }
+                else lengthSymbols.push_back({ length, 0 });
+
+                ++codeLengthFreqs[lengthSymbols.back().symbol];
+                i += consumed;
+            }
+            uint8_t codeLengthLengths[19] = {};
+            buildCodeLengths(codeLengthFreqs, 19, 7, codeLengthLengths);
+
+            size_t codeLengthCount = 19;
+            while (codeLengthCount > 4 && codeLengthLengths[g_codeLengthOrder[codeLengthCount - 1]] == 0)
+            {
+                --codeLengthCount;
+            }
+            // Fall back to the stored blocks if they are smaller.
+            auto extraBits = [](uint8_t symbol) { return symbol == 16 ? 2 : symbol == 17 ? 3 : symbol == 18 ? 7 : 0; };
+
+            uint64_t dynamicBits = 3 + 5 + 5 + 4 + 3 * codeLengthCount;
+            for (auto& s : lengthSymbols)
+            {
+                dynamicBits += codeLengthLengths[s.symbol] + extraBits(s.symbol);
+            }
+            for (auto& token : tokens)
+            {
+                if (token.distance == 0)
+                {
+                    dynamicBits += litLenLengths[token.value];
+                }
+                else // match
+                {
+                    auto lengthCode = tables.lengthCodes[token.value];
+                    auto distanceCode = tables.distanceCode(token.distance);
+
+                    dynamicBits += litLenLengths[257 + lengthCode] + g_lengthExtraBits[lengthCode];
+                    dynamicBits += distanceLengths[distanceCode] + g_distanceExtraBits[distanceCode];
+                }
+            }
+            dynamicBits += litLenLengths[256];
+
+            uint64_t storedBits = rawSize * 8 + (rawSize / g_maxStoredSize + 1) * (3 + 7 + 32);
+            if (storedBits <= dynamicBits)
+            {
+                writeStoredBlocks(writer, raw, rawSize, final);
+                return;
+            }
+            uint16_t litLenCodes[286] = {}, distanceCodes[30] = {}, codeLengthCodes[19] = {};
+            buildCodes(litLenLengths, 286, litLenCodes);
+            buildCodes(distanceLengths, 30, distanceCodes);
+            buildCodes(codeLengthLengths, 19, codeLengthCodes);
+
+            writer.write(final ? 1 : 0, 1);
+            writer.write(2, 2); // dynamic Huffman
+
+            writer.write((uint32_t)(litLenCount - 257), 5);
+            writer.write((uint32_t)(distanceCount - 1), 5);
+            writer.write((uint32_t)(codeLengthCount - 4), 4);
+
+            for (size_t i = 0; i < codeLengthCount; ++i)
+            {
+                writer.write(codeLengthLengths[g_codeLengthOrder[i]], 3);
+            }
+            for (auto& s : lengthSymbols)
+            {
+                writer.write(codeLengthCodes[s.symbol], codeLengthLengths[s.symbol]);
+                if (auto count = extraBits(s.symbol)) writer.write(s.extra, count);
+            }
+            for (auto& token : tokens)
+            {
+                if (token.distance == 0)
+                {
+                    writer.write(litLenCodes[token.value], litLenLengths[token.value]);
+                }
+                else // match
+                {
+                    auto lengthCode = tables.lengthCodes[token.value];
+                    auto distanceCode = tables.distanceCode(token.distance);
+
+                    writer.write(litLenCodes[257 + lengthCode], litLenLengths[257 + lengthCode]);
+                    writer.write(token.value - g_lengthBases[lengthCode], g_lengthExtraBits[lengthCode]);
+
+                    writer.write(distanceCodes[distanceCode], distanceLengths[distanceCode]);
+                    writer.write(token.distance - g_distanceBases[distanceCode], g_distanceExtraBits[distanceCode]);
+                }
+            }
+            writer.write(litLenCodes[256], litLenLengths[256]);
+        }
+
+        struct LevelParams
+        {
+            size_t maxChain = 0;
+            size_t niceLength = 0;
+            bool lazy = false;
+        };
+        constexpr LevelParams g_levelParams[10] =
+        {
+            { 0, 0, false },
+            { 4, 8, false },
+            { 8, 16, false },
+            { 16, 32, false },
+            { 16, 32, true },
+            { 32, 64, true },
+            { 64, 128, true },
+            { 128, 258, true },
+            { 256, 258, true },
+            { 1024, 258, true }
+        };
+
+        // The hash chains of the last 32 KiB positions (the farther ones can
+        // never be matched), where the chain links are kept in a ring.
+        struct Matcher
+        {
+            constexpr static int g_hashBits = 15;
+
+            const uint8_t* data = nullptr;
+            size_t end = 0;
+
+            LevelParams params = {};
+
+            // -1 for none, which is always out of the window.
+            std::vector<int64_t> heads = std::vector<int64_t>((size_t)1 << g_hashBits, -1);
+            std::vector<int64_t> prevs = std::vector<int64_t>(g_windowSize, -1);
+
+            Matcher(const uint8_t* data, size_t end, const LevelParams& params)
+                : data(data), end(end), params(params) { }
+
+            uint32_t hash(size_t pos) const
+            {
+                uint32_t value = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16);
+                return (value * 2654435761u) >> (32 - g_hashBits);
+            }
+
+            // The position must have g_minMatch bytes before the end.
+            void insert(size_t pos)
+            {
+                auto& head = heads[hash(pos)];
+
+                prevs[pos % g_windowSize] = head;
+                head = (int64_t)pos;
+            }
+
+            // Returns { length, distance } with length 0 if not found, which
+            // must be called before inserting the position.
+            std::pair<size_t, size_t> find(size_t pos) const
+            {
+                size_t maxLength = std::min(g_maxMatch, end - pos);
+                if (maxLength < g_minMatch) return { 0, 0 };
+
+                size_t bestLength = g_minMatch - 1, bestDistance = 0;
+
+                // A link in the window has not been overwritten in the ring
+                // since only the positions before this one are inserted.
+                auto lowest = (int64_t)pos - (int64_t)g_windowSize;
+                auto candidate = heads[hash(pos)];
+
+                for (size_t chain = params.maxChain; candidate >= lowest && candidate >= 0 && chain > 0; --chain)
+                {
+                    auto cand = (size_t)candidate;
+
+                    // Check the byte that would make a longer match first.
+                    if (data[cand + bestLength] == data[pos + bestLength] && data[cand] == data[pos])
+                    {
+                        size_t length = 1;
+                        while (length < maxLength && data[cand + length] == data[pos + length]) ++length;
+
+                        if (length > bestLength)
+                        {
+                            bestLength = length;
+                            bestDistance = pos - cand;
+
+                            if (length >= params.niceLength || length == maxLength) break;
+                        }
+                    }
+                    candidate = prevs[cand % g_windowSize];
+                }
+                if (bestDistance == 0) return { 0, 0 };
+
+                return { bestLength, bestDistance };
+            }
+        };
+    }
+
+    void deflateRange(
+        const uint8_t* data, size_t begin, size_t end,
+        int level, bool final, std::vector<uint8_t>& output)
+    {
+        BitWriter writer = { output };
+
+        level = std::clamp(level, 0, 9);
+
+        // The stored blocks are byte-aligned already.
+        if (level == 0 || begin == end)
+        {
+            writeStoredBlocks(writer, data + begin, end - begin, final);
+            return;
+        }
+        size_t base = begin - std::min(begin, g_windowSize);
+
+        Matcher matcher(data, end, g_levelParams[level]);
+
+        // The dictionary is matched but not emitted.
+        for (size_t pos = base; pos < begin && pos + g_minMatch <= end; ++pos)
+        {
+            matcher.insert(pos);
+        }
+        std::vector<Token> tokens = {};
+        tokens.reserve(g_maxBlockTokens + 1);
+
+        size_t blockBegin = begin;
+        auto flushBlock = [&](size_t pos, bool last)
+        {
+            writeBlock(writer, tokens, data + blockBegin, pos - blockBegin, last);
+
+            tokens.clear();
+            blockBegin = pos;
+        };
+        // Long matches are not inserted at the low levels for speed.
+        size_t maxInsertLength = (level <= 3) ? 32 : g_maxMatch;
+
+        size_t pos = begin;
+        while (pos < end)
+        {
+            bool hashable = (pos + g_minMatch <= end);
+
+            auto [length, distance] = hashable ? matcher.find(pos) : std::pair<size_t, size_t>{ 0, 0 };
+            if (hashable) matcher.insert(pos);
+
+            // Emit a literal instead if the next position has a longer match,
+            // and check again from there.
+            if (matcher.params.lazy && length >= g_minMatch && length < matcher.params.niceLength)
+            {
+                while (pos + 1 + g_minMatch <= end)
+                {
+                    auto [nextLength, nextDistance] = matcher.find(pos + 1);
+                    if (nextLength <= length) break;
+
+                    tokens.push_back({ data[pos], 0 });
+                    ++pos;
+                    matcher.insert(pos);
+
+                    length = nextLength;
+                    distance = nextDistance;
+
+                    if (length >= matcher.params.niceLength) break;
+                }
+            }
+            if (length >= g_minMatch)
+            {
+                tokens.push_back({ (uint16_t)length, (uint16_t)distance });
+
+                if (length <= maxInsertLength)
+                {
+                    for (size_t i = 1; i < length && pos + i + g_minMatch <= end; ++i)
+                    {
+                        matcher.insert(pos + i);
+                    }
+                }
+                pos += length;
+            }
+            else // literal
+            {
+                tokens.push_back({ data[pos], 0 });
+                ++pos;
+            }
+            if (tokens.size() >= g_maxBlockTokens && pos < end) flushBlock(pos, false);
+        }
+        flushBlock(pos, final);
+
+        if (final) writer.alignToByte();
+
+        // Byte-align with an empty stored block, so the next range can be
+        // appended directly.
+        else writeStoredBlocks(writer, nullptr, 0, false);
+    }
+
+    uint32_t adler32(const uint8_t* data, size_t size, uint32_t adler)
+    {
+        constexpr uint32_t base = 65521;
+
+        // The largest n such that 255n(n+1)/2 + (n+1)(base-1) < 2^32.
+        constexpr size_t nmax = 5552;
+
+        uint32_t a = adler & 0xffff, b = adler >> 16;
+        while (size > 0)
+        {
+            size_t count = std::min(size, nmax);
+            size -= count;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                a += data[i];
+                b += a;
+            }
+            data += count;
+
+            a %= base;
+            b %= base;
+        }
+        return a | (b << 16);
+    }
+
+    uint32_t adler32Combine(uint32_t adler1, uint32_t adler2, size_t size2)
+    {
+        constexpr uint32_t base = 65521;
+
+        uint32_t remainder = (uint32_t)(size2 % base);
+
+        uint32_t sum1 = adler1 & 0xffff;
+        uint32_t sum2 = (uint32_t)(((uint64_t)remainder * sum1) % base);
+
+        sum1 += (adler2 & 0xffff) + base - 1;
+        sum2 += (adler1 >> 16) + (adler2 >> 16) + base - remainder;
+
+        if (sum1 >= base) sum1 -= base;
+        if (sum1 >= base) sum1 -= base;
+        if (sum2 >= (base << 1)) sum2 -= (base << 1);
+        if (sum2 >= base) sum2 -= base;
+
+        return sum1 | (sum2 << 16);
+    }
+
+    uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc)
+    {
+        // Slicing-by-8: tables[k][b] is the CRC of the byte b followed by k
+        // zero bytes, so 8 bytes are folded per step.
+        static const auto tables = []
+        {
+            std::array<std::array<uint32_t, 256>, 8> values = {};
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                uint32_t value = i;
+                for (int j = 0; j < 8; ++j)
+                {
+                    value = (value & 1) ? (0xedb88320u ^ (value >> 1)) : (value >> 1);
+                }
+                values[0][i] = value;
+            }
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                for (int k = 1; k < 8; ++k)
+                {
+                    auto prev = values[k - 1][i];
+                    values[k][i] = values[0][prev & 0xff] ^ (prev >> 8);
+                }
+            }
+            return values;
+        }();
+        crc = ~crc;
+        for (; size >= 8; data += 8, size -= 8)
+        {
+            uint32_t lo = crc ^ (data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24));
+            uint32_t hi = data[4] | (data[5] << 8) | (data[6] << 16) | ((uint32_t)data[7] << 24);
+
+            crc = tables[7][lo & 0xff] ^ tables[6][(lo >> 8) & 0xff] ^
+                  tables[5][(lo >> 16) & 0xff] ^ tables[4][lo >> 24] ^
+                  tables[3][hi & 0xff] ^ tables[2][(hi >> 8) & 0xff] ^
+                  tables[1][(hi >> 16) & 0xff] ^ tables[0][hi >> 24];
+        }
+        for (size_t i = 0; i < size; ++i)
+        {
+            crc = tables[0][(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+}
@@ -0,0 +1,29 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::image_utils
+{
+    // A DEFLATE (RFC 1951) compressor that only uses the standard library,
+    // which compresses a range of the data independently so that the ranges
+    // can be compressed in parallel and concatenated into a single stream.
+    //
+    // The 32 KiB before the range are used as the dictionary (i.e. matched
+    // but not emitted), so splitting the data costs almost no compression.
+    // A non-final range ends with an empty stored block (the "sync flush" of
+    // zlib) to be byte-aligned, and the final one sets BFINAL.
+
+    // Appends the compressed [begin, end) of the data to the output, where
+    // the level is 0: stored only, 1: fastest ... 9: smallest.
+    void deflateRange(
+        const uint8_t* data, size_t begin, size_t end,
+        int level, bool final, std::vector<uint8_t>& output);
+
+    uint32_t adler32(const uint8_t* data, size_t size, uint32_t adler = 1);
+
+    // The Adler-32 of the concatenation of 2 parts, where size2 is the
+    // size of the second part.
+    uint32_t adler32Combine(uint32_t adler1, uint32_t adler2, size_t size2);
+
+    uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+}
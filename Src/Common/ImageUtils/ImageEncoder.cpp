@@ -0,0 +1,351 @@
+﻿#include "Common/Precompile.h"
+
+#include "Common/ImageUtils/ImageEncoder.h"
+
+#include "Common/ImageUtils/Deflate.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace d14engine::image_utils
+{
+    namespace
+    {
+        void appendUint32BE(std::vector<uint8_t>& bytes, uint32_t value)
+        {
+            for (int i = 3; i >= 0; --i)
+            {
+                bytes.push_back((uint8_t)(value >> (8 * i)));
+            }
+        }
+
+        // Appends length, type, data and CRC, where the CRC covers the type
+        // and the data.
+        void appendPngChunk(std::vector<uint8_t>& bytes, const char* type, const uint8_t* data, size_t size)
+        {
+            appendUint32BE(bytes, (uint32_t)size);
+
+            size_t typeOffset = bytes.size();
+            bytes.insert(bytes.end(), type, type + 4);
+            if (size > 0) bytes.insert(bytes.end(), data, data + size);
+
+            appendUint32BE(bytes, crc32(bytes.data() + typeOffset, 4 + size));
+        }
+
+        template<typename Task>
+        void parallelFor(size_t count, size_t threadCount, const Task& task)
+        {
+            if (threadCount <= 1 || count <= 1)
+            {
+                for (size_t i = 0; i < count; ++i) task(i);
+                return;
+            }
+            auto chunkSize = (count + threadCount - 1) / threadCount;
+
+            std::vector<std::future<void>> tasks = {};
+            for (size_t offset = 0; offset < count; offset += chunkSize)
+            {
+                auto end = std::min(offset + chunkSize, count);
+
+                tasks.push_back(std::async(std::launch::async, [&, offset, end]
+                {
+                    for (size_t i = offset; i < end; ++i) task(i);
+                }));
+            }
+            for (auto& t : tasks) t.get();
+        }
+
+        // Written with the distances from a, b and c directly (instead of p)
+        // so that the compiler can vectorize it.
+        uint8_t paeth(int a, int b, int c)
+        {
+            int pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2 * c);
+
+            return (uint8_t)((pa <= pb && pa <= pc) ? a : (pb <= pc) ? b : c);
+        }
+
+        // Returns the sum of absolute differences of the filtered bytes.
+        uint64_t applyFilter(int type, const uint8_t* curr, const uint8_t* prev, size_t rowBytes, size_t bpp, uint8_t* dst)
+        {
+            auto filter = [&](auto predict)
+            {
+                // The first pixel has neither left nor upper-left.
+                uint32_t sum = 0;
+                for (size_t i = 0; i < bpp && i < rowBytes; ++i)
+                {
+                    dst[i] = (uint8_t)(curr[i] - predict(0, prev[i], 0));
+                    sum += std::abs((int8_t)dst[i]);
+                }
+                for (size_t i = bpp; i < rowBytes; ++i)
+                {
+                    dst[i] = (uint8_t)(curr[i] - predict(curr[i - bpp], prev[i], prev[i - bpp]));
+                    sum += std::abs((int8_t)dst[i]);
+                }
+                return (uint64_t)sum;
+            };
+            switch (type)
+            {
+            case 1: return filter([](int a, int, int) { return a; }); // Sub
+            case 2: return filter([](int, int b, int) { return b; }); // Up
+            case 3: return filter([](int a, int b, int) { return (a + b) >> 1; }); // Average
+            case 4: return filter([](int a, int b, int c) { return (int)paeth(a, b, c); });
+            default: return filter([](int, int, int) { return 0; }); // None
+            }
+        }
+
+        // Writes the filter type and the filtered bytes of a row, which
+        // picks the filter with the minimum sum of absolute differences
+        // (the heuristic recommended by the PNG spec).  The previous row of
+        // the first row is all zeros.
+        void filterRow(const uint8_t* curr, const uint8_t* prev, size_t rowBytes, size_t bpp, std::span<const int> types, uint8_t* scratch, uint8_t* dst)
+        {
+            if (types.size() == 1)
+            {
+                dst[0] = (uint8_t)types[0];
+                applyFilter(types[0], curr, prev, rowBytes, bpp, dst + 1);
+                return;
+            }
+            uint64_t bestSum = UINT64_MAX;
+
+            for (int type : types)
+            {
+                auto sum = applyFilter(type, curr, prev, rowBytes, bpp, scratch);
+
+                if (sum < bestSum)
+                {
+                    bestSum = sum;
+
+                    dst[0] = (uint8_t)type;
+                    memcpy(dst + 1, scratch, rowBytes);
+                }
+            }
+        }
+    }
+
+    std::vector<uint8_t> encodePng(const ImageView& image, const PngSettings& settings)
+    {
+        int level = std::clamp(settings.level, 0, 9);
+
+        size_t threadCount = settings.threadCount;
+        if (threadCount == 0) threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+        size_t bpp = settings.alpha ? 4 : 3;
+        size_t rowBytes = image.width * bpp;
+        size_t filteredRowBytes = 1 + rowBytes;
+
+        // Trying all the filters takes longer than deflating at the low
+        // levels, so only Paeth is used there (about 10% larger).
+        static const int noneFilter[] = { 0 }, paethFilter[] = { 4 }, allFilters[] = { 0, 1, 2, 3, 4 };
+
+        std::span<const int> filterTypes = allFilters;
+        if (level == 0) filterTypes = noneFilter;
+        else if (level <= 2) filterTypes = paethFilter;
+
+        // Drop the alpha (if needed) and filter the rows.
+        std::vector<uint8_t> filtered(filteredRowBytes * image.height);
+
+        size_t rowGroupSize = 64;
+        size_t rowGroupCount = (image.height + rowGroupSize - 1) / rowGroupSize;
+
+        parallelFor(rowGroupCount, threadCount, [&](size_t group)
+        {
+            std::vector<uint8_t> rows[2] = {}, zeros(rowBytes), scratch(rowBytes);
+            if (!settings.alpha)
+            {
+                rows[0].resize(rowBytes);
+                rows[1].resize(rowBytes);
+            }
+            auto packedRow = [&](size_t y, std::vector<uint8_t>& buffer) -> const uint8_t*
+            {
+                auto src = image.data + y * image.rowPitch;
+                if (settings.alpha) return src;
+
+                for (size_t x = 0; x < image.width; ++x)
+                {
+                    memcpy(buffer.data() + x * 3, src + x * 4, 3);
+                }
+                return buffer.data();
+            };
+            size_t begin = group * rowGroupSize;
+            size_t end = std::min(begin + rowGroupSize, (size_t)image.height);
+
+            // Copy the previous row of the group as well if RGB.
+            const uint8_t* prev = (begin > 0) ? packedRow(begin - 1, rows[(begin - 1) % 2]) : zeros.data();
+            for (size_t y = begin; y < end; ++y)
+            {
+                auto curr = packedRow(y, rows[y % 2]);
+                filterRow(curr, prev, rowBytes, bpp, filterTypes, scratch.data(), filtered.data() + y * filteredRowBytes);
+                prev = curr;
+            }
+        });
+        // Deflate the stripes into the IDAT chunks.
+        size_t stripeCount = std::min(threadCount, std::max(filtered.size() / std::max(settings.minStripeSize, (size_t)1), (size_t)1));
+
+        struct Stripe
+        {
+            size_t begin = 0, end = 0;
+
+            std::vector<uint8_t> chunk = {};
+
+            uint32_t adler = 1;
+        };
+        std::vector<Stripe> stripes(stripeCount);
+
+        parallelFor(stripeCount, threadCount, [&](size_t index)
+        {
+            auto& stripe = stripes[index];
+
+            stripe.begin = filtered.size() * index / stripeCount;
+            stripe.end = filtered.size() * (index + 1) / stripeCount;
+
+            // Deflate into the chunk directly and then fill the length and
+            // the CRC, since the stripes can be large.
+            auto& chunk = stripe.chunk;
+            chunk.reserve((stripe.end - stripe.begin) / (level > 0 ? 2 : 1) + 64);
+
+            appendUint32BE(chunk, 0);
+            chunk.insert(chunk.end(), { 'I', 'D', 'A', 'T' });
+
+            if (index == 0)
+            {
+                // CMF (deflate with 32 KiB window) and FLG (level hint with
+                // the check bits)
+                chunk.push_back(0x78);
+                chunk.push_back(level <= 1 ? 0x01 : level <= 5 ? 0x5e : level == 6 ? 0x9c : 0xda);
+            }
+            bool last = (index == stripeCount - 1);
+            deflateRange(filtered.data(), stripe.begin, stripe.end, level, last, chunk);
+
+            auto dataSize = (uint32_t)(chunk.size() - 8);
+            for (int i = 0; i < 4; ++i) chunk[i] = (uint8_t)(dataSize >> (8 * (3 - i)));
+
+            appendUint32BE(chunk, crc32(chunk.data() + 4, 4 + dataSize));
+
+            stripe.adler = adler32(filtered.data() + stripe.begin, stripe.end - stripe.begin);
+        });
+        std::vector<uint8_t> bytes = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+        std::vector<uint8_t> header = {};
+        appendUint32BE(header, image.width);
+        appendUint32BE(header, image.height);
+        header.push_back(8); // bit depth
+        header.push_back(settings.alpha ? 6 : 2); // RGBA : RGB
+        header.push_back(0); // compression
+        header.push_back(0); // filter
+        header.push_back(0); // interlace
+
+        appendPngChunk(bytes, "IHDR", header.data(), header.size());
+
+        uint32_t adler = 1;
+        size_t totalSize = bytes.size() + 12 + 4 + 12;
+        for (auto& stripe : stripes) totalSize += stripe.chunk.size();
+
+        bytes.reserve(totalSize);
+
+        for (auto& stripe : stripes)
+        {
+            bytes.insert(bytes.end(), stripe.chunk.begin(), stripe.chunk.end());
+
+            adler = adler32Combine(adler, stripe.adler, stripe.end - stripe.begin);
+        }
+        // The zlib trailer takes its own IDAT since it is known only after
+        // all the stripes are done.
+        std::vector<uint8_t> trailer = {};
+        appendUint32BE(trailer, adler);
+
+        appendPngChunk(bytes, "IDAT", trailer.data(), trailer.size());
+        appendPngChunk(bytes, "IEND", nullptr, 0);
+
+        return bytes;
+    }
+
+    std::vector<uint8_t> encodeQoi(const ImageView& image, bool alpha)
+    {
+        std::vector<uint8_t> bytes = { 'q', 'o', 'i', 'f' };
+
+        appendUint32BE(bytes, image.width);
+        appendUint32BE(bytes, image.height);
+        bytes.push_back(alpha ? 4 : 3);
+        bytes.push_back(0); // sRGB with linear alpha
+
+        // The worst case is 1 tag byte and all the channels per pixel.
+        bytes.reserve(bytes.size() + (size_t)image.width * image.height * (alpha ? 5 : 4) + 8);
+
+        struct Pixel
+        {
+            uint8_t r = 0, g = 0, b = 0, a = 255;
+
+            bool operator==(const Pixel&) const = default;
+        };
+        Pixel index[64] = {};
+        std::fill(std::begin(index), std::end(index), Pixel{ 0, 0, 0, 0 });
+
+        Pixel prev = {};
+        size_t run = 0;
+
+        size_t pixelCount = (size_t)image.width * image.height, pixelIndex = 0;
+
+        for (uint32_t y = 0; y < image.height; ++y)
+        {
+            auto src = image.data + y * image.rowPitch;
+            for (uint32_t x = 0; x < image.width; ++x, src += 4, ++pixelIndex)
+            {
+                Pixel curr = { src[0], src[1], src[2], alpha ? src[3] : (uint8_t)255 };
+
+                if (curr == prev)
+                {
+                    if (++run == 62 || pixelIndex == pixelCount - 1)
+                    {
+                        bytes.push_back((uint8_t)(0xc0 | (run - 1))); // QOI_OP_RUN
+                        run = 0;
+                    }
+                    continue;
+                }
+                if (run > 0)
+                {
+                    bytes.push_back((uint8_t)(0xc0 | (run - 1))); // QOI_OP_RUN
+                    run = 0;
+                }
+                auto hash = (curr.r * 3 + curr.g * 5 + curr.b * 7 + curr.a * 11) % 64;
+
+                if (index[hash] == curr)
+                {
+                    bytes.push_back((uint8_t)hash); // QOI_OP_INDEX
+                }
+                else // new color
+                {
+                    index[hash] = curr;
+
+                    if (curr.a == prev.a)
+                    {
+                        int dr = (int8_t)(uint8_t)(curr.r - prev.r);
+                        int dg = (int8_t)(uint8_t)(curr.g - prev.g);
+                        int db = (int8_t)(uint8_t)(curr.b - prev.b);
+
+                        int drdg = dr - dg, dbdg = db - dg;
+
+                        if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+                        {
+                            bytes.push_back((uint8_t)(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2))); // QOI_OP_DIFF
+                        }
+                        else if (dg >= -32 && dg <= 31 && drdg >= -8 && drdg <= 7 && dbdg >= -8 && dbdg <= 7)
+                        {
+                            bytes.push_back((uint8_t)(0x80 | (dg + 32))); // QOI_OP_LUMA
+                            bytes.push_back((uint8_t)(((drdg + 8) << 4) | (dbdg + 8)));
+                        }
+                        else // QOI_OP_RGB
+                        {
+                            bytes.insert(bytes.end(), { 0xfe, curr.r, curr.g, curr.b });
+                        }
+                    }
+                    else bytes.insert(bytes.end(), { 0xff, curr.r, curr.g, curr.b, curr.a }); // QOI_OP_RGBA
+                }
+                prev = curr;
+            }
+        }
+        bytes.insert(bytes.end(), { 0, 0, 0, 0, 0, 0, 0, 1 }); // end marker
+
+        return bytes;
+    }
+}
@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::image_utils
+{
+    // RGBA8 pixels where each row takes rowPitch bytes, e.g. a mapped
+    // readback buffer or a mapped CPU-readable bitmap.
+    struct ImageView
+    {
+        const uint8_t* data = nullptr;
+
+        uint32_t width = 0, height = 0;
+
+        size_t rowPitch = 0;
+    };
+
+    struct PngSettings
+    {
+        // 0: uncompressed (stored, no filtering), 1: fastest ... 9: smallest
+        int level = 6;
+
+        // RGBA if true, otherwise RGB with the alpha dropped.
+        bool alpha = true;
+
+        // 0 for std::thread::hardware_concurrency.
+        size_t threadCount = 0;
+
+        // The filtered data is not split into the stripes smaller than this.
+        size_t minStripeSize = 256 * 1024;
+    };
+
+    // Encodes a PNG without any platform codec.  The rows are filtered in
+    // parallel, and then the filtered data is split into the stripes that
+    // are deflated in parallel (each with the 32 KiB before it as the
+    // dictionary) and written as one IDAT per stripe, so the output is an
+    // ordinary zlib stream that any decoder accepts.
+    std::vector<uint8_t> encodePng(const ImageView& image, const PngSettings& settings = {});
+
+    // Encodes a QOI (https://qoiformat.org), which is several times faster
+    // than PNG at a somewhat larger size, e.g. for recording the frames.
+    std::vector<uint8_t> encodeQoi(const ImageView& image, bool alpha = true);
+}
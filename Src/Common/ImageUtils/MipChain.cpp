@@ -0,0 +1,527 @@
+﻿#include "Common/Precompile.h"
+
+#include "Common/ImageUtils/MipChain.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define _D14_MIPCHAIN_SSE2 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define _D14_MIPCHAIN_AVX2 1
+#define _D14_TARGET_AVX2
+#include <intrin.h>
+#elif defined(__GNUC__) || defined(__clang__)
+#define _D14_MIPCHAIN_AVX2 1
+#define _D14_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace d14engine::image_utils
+{
+    namespace
+    {
+        // Each output pixel x is filtered from the input pixels 2x-3 ... 2x+4,
+        // i.e. the taps are at -3.5 ... +3.5 from the output center.
+        constexpr int g_kaiserTapCount = 8;
+
+        constexpr double g_kaiserBeta = 4.0;
+
+        // The zeroth-order modified Bessel function of the first kind.
+        double besselI0(double x)
+        {
+            double sum = 1.0, term = 1.0;
+            for (int k = 1; k < 32; ++k)
+            {
+                double t = x / (2.0 * k);
+                term *= t * t;
+                sum += term;
+            }
+            return sum;
+        }
+
+        const std::array<float, g_kaiserTapCount>& kaiserWeights()
+        {
+            static const auto weights = []
+            {
+                constexpr double pi = 3.14159265358979323846;
+
+                std::array<double, g_kaiserTapCount> values = {};
+                double sum = 0.0;
+
+                for (int k = 0; k < g_kaiserTapCount; ++k)
+                {
+                    // The lowpass for the halved rate is sinc(d / 2).
+                    double d = k - 3.5;
+                    double sinc = std::sin(pi * d * 0.5) / (pi * d * 0.5);
+
+                    double t = d / 4.0;
+                    double window = besselI0(g_kaiserBeta * std::sqrt(1.0 - t * t)) / besselI0(g_kaiserBeta);
+
+                    sum += (values[k] = sinc * window);
+                }
+                std::array<float, g_kaiserTapCount> result = {};
+                for (int k = 0; k < g_kaiserTapCount; ++k)
+                {
+                    result[k] = (float)(values[k] / sum);
+                }
+                return result;
+            }();
+            return weights;
+        }
+
+        //------------------------------------------------------------------
+        // Box
+        //------------------------------------------------------------------
+
+        void boxRowScalar(
+            const uint8_t* row0, const uint8_t* row1,
+            uint32_t srcWidth, uint8_t* dst, uint32_t begin, uint32_t end)
+        {
+            for (uint32_t x = begin; x < end; ++x)
+            {
+                size_t x0 = 8 * (size_t)x;
+                size_t x1 = 4 * (size_t)std::min(2 * x + 1, srcWidth - 1);
+
+                for (int c = 0; c < 4; ++c)
+                {
+                    dst[4 * x + c] = (uint8_t)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+                }
+            }
+        }
+
+#ifdef _D14_MIPCHAIN_SSE2
+        // Returns the next pixel to process, where the output pixels before
+        // end must have both of their input columns.
+        uint32_t boxRowSSE2(
+            const uint8_t* row0, const uint8_t* row1,
+            uint8_t* dst, uint32_t begin, uint32_t end)
+        {
+            auto zero = _mm_setzero_si128();
+            auto bias = _mm_set1_epi16(2);
+
+            uint32_t x = begin;
+            for (; x + 4 <= end; x += 4)
+            {
+                auto a0 = _mm_loadu_si128((const __m128i*)(row0 + 8 * (size_t)x));
+                auto a1 = _mm_loadu_si128((const __m128i*)(row0 + 8 * (size_t)x + 16));
+                auto b0 = _mm_loadu_si128((const __m128i*)(row1 + 8 * (size_t)x));
+                auto b1 = _mm_loadu_si128((const __m128i*)(row1 + 8 * (size_t)x + 16));
+
+                // The vertical sums of the input pixels 0 ... 7 (2 per register).
+                auto s01 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+                auto s23 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+                auto s45 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+                auto s67 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+                // The horizontal sums of the output pixels 0 ... 3.
+                auto q01 = _mm_add_epi16(_mm_unpacklo_epi64(s01, s23), _mm_unpackhi_epi64(s01, s23));
+                auto q23 = _mm_add_epi16(_mm_unpacklo_epi64(s45, s67), _mm_unpackhi_epi64(s45, s67));
+
+                q01 = _mm_srli_epi16(_mm_add_epi16(q01, bias), 2);
+                q23 = _mm_srli_epi16(_mm_add_epi16(q23, bias), 2);
+
+                _mm_storeu_si128((__m128i*)(dst + 4 * (size_t)x), _mm_packus_epi16(q01, q23));
+            }
+            return x;
+        }
+#endif
+
+#ifdef _D14_MIPCHAIN_AVX2
+        // Unpacking works in each 128-bit lane, so the vertical sums of the
+        // 8 input pixels are (0, 1) (4, 5) and (2, 3) (6, 7), and the output
+        // pixels are (0, 1) (2, 3).
+        _D14_TARGET_AVX2 __m256i boxPixelsAVX2(__m256i a, __m256i b)
+        {
+            auto zero = _mm256_setzero_si256();
+
+            auto lo = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero));
+            auto hi = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero));
+
+            auto q = _mm256_add_epi16(_mm256_unpacklo_epi64(lo, hi), _mm256_unpackhi_epi64(lo, hi));
+
+            return _mm256_srli_epi16(_mm256_add_epi16(q, _mm256_set1_epi16(2)), 2);
+        }
+
+        _D14_TARGET_AVX2 uint32_t boxRowAVX2(
+            const uint8_t* row0, const uint8_t* row1,
+            uint8_t* dst, uint32_t begin, uint32_t end)
+        {
+            uint32_t x = begin;
+            for (; x + 8 <= end; x += 8)
+            {
+                auto a0 = _mm256_loadu_si256((const __m256i*)(row0 + 8 * (size_t)x));
+                auto a1 = _mm256_loadu_si256((const __m256i*)(row0 + 8 * (size_t)x + 32));
+                auto b0 = _mm256_loadu_si256((const __m256i*)(row1 + 8 * (size_t)x));
+                auto b1 = _mm256_loadu_si256((const __m256i*)(row1 + 8 * (size_t)x + 32));
+
+                // The 64-bit pairs are (0, 1) (4, 5) (2, 3) (6, 7) after packing.
+                auto packed = _mm256_packus_epi16(boxPixelsAVX2(a0, b0), boxPixelsAVX2(a1, b1));
+
+                _mm256_storeu_si256((__m256i*)(dst + 4 * (size_t)x),
+                    _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+            }
+            return x;
+        }
+#endif
+
+        void boxRow(
+            const uint8_t* row0, const uint8_t* row1,
+            uint32_t srcWidth, uint32_t dstWidth, uint8_t* dst, SimdLevel simd)
+        {
+            uint32_t x = 0;
+
+            // The last output pixel of an odd width repeats the edge.
+            [[maybe_unused]] uint32_t fullCount = srcWidth / 2;
+
+#ifdef _D14_MIPCHAIN_AVX2
+            if (simd >= SimdLevel::AVX2) x = boxRowAVX2(row0, row1, dst, x, fullCount);
+#endif
+#ifdef _D14_MIPCHAIN_SSE2
+            if (simd >= SimdLevel::SSE2) x = boxRowSSE2(row0, row1, dst, x, fullCount);
+#endif
+            boxRowScalar(row0, row1, srcWidth, dst, x, dstWidth);
+        }
+
+        //------------------------------------------------------------------
+        // Kaiser
+        //------------------------------------------------------------------
+
+        // The taps are summed in the same order in all the kernels, so the
+        // results are the same regardless of the SIMD level.
+
+        void kaiserRowScalar(
+            const uint8_t* src, uint32_t srcWidth,
+            float* dst, uint32_t begin, uint32_t end)
+        {
+            auto& weights = kaiserWeights();
+
+            for (uint32_t x = begin; x < end; ++x)
+            {
+                float sums[4] = {};
+                for (int k = 0; k < g_kaiserTapCount; ++k)
+                {
+                    auto sx = std::clamp((int64_t)2 * x - 3 + k, (int64_t)0, (int64_t)srcWidth - 1);
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        sums[c] = sums[c] + weights[k] * (float)src[4 * sx + c];
+                    }
+                }
+                for (int c = 0; c < 4; ++c) dst[4 * x + c] = sums[c];
+            }
+        }
+
+        // Clamps and rounds the sums, where the colors are also clamped to
+        // the alpha so that the ringing never makes an invalid premultiplied
+        // pixel.
+        void storePixelScalar(const float* sums, uint8_t* dst)
+        {
+            float alpha = std::min(std::max(sums[3], 0.0f), 255.0f);
+            for (int c = 0; c < 3; ++c)
+            {
+                float value = std::min(std::max(sums[c], 0.0f), 255.0f);
+                dst[c] = (uint8_t)std::lrintf(std::min(value, alpha));
+            }
+            dst[3] = (uint8_t)std::lrintf(alpha);
+        }
+
+        void kaiserColumnScalar(
+            const float* const* rows, uint8_t* dst, uint32_t begin, uint32_t end)
+        {
+            auto& weights = kaiserWeights();
+
+            for (uint32_t x = begin; x < end; ++x)
+            {
+                float sums[4] = {};
+                for (int c = 0; c < 4; ++c)
+                {
+                    for (int k = 0; k < g_kaiserTapCount; ++k)
+                    {
+                        sums[c] = sums[c] + weights[k] * rows[k][4 * x + c];
+                    }
+                }
+                storePixelScalar(sums, dst + 4 * x);
+            }
+        }
+
+#ifdef _D14_MIPCHAIN_SSE2
+        __m128 loadPixelSSE2(const uint8_t* src)
+        {
+            auto zero = _mm_setzero_si128();
+            auto pixel = _mm_loadu_si32(src);
+            pixel = _mm_unpacklo_epi16(_mm_unpacklo_epi8(pixel, zero), zero);
+            return _mm_cvtepi32_ps(pixel);
+        }
+
+        uint32_t kaiserRowSSE2(const uint8_t* src, float* dst, uint32_t begin, uint32_t end)
+        {
+            auto& weights = kaiserWeights();
+
+            for (uint32_t x = begin; x < end; ++x)
+            {
+                auto p = src + 4 * (2 * (size_t)x - 3);
+
+                auto sums = _mm_setzero_ps();
+                for (int k = 0; k < g_kaiserTapCount; ++k)
+                {
+                    sums = _mm_add_ps(sums, _mm_mul_ps(_mm_set1_ps(weights[k]), loadPixelSSE2(p + 4 * k)));
+                }
+                _mm_storeu_ps(dst + 4 * (size_t)x, sums);
+            }
+            return end;
+        }
+
+        // The clamped pixel (1 per 128 bits) before rounding.
+        __m128 clampPixelSSE2(__m128 sums)
+        {
+            sums = _mm_min_ps(_mm_max_ps(sums, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+            return _mm_min_ps(sums, _mm_shuffle_ps(sums, sums, _MM_SHUFFLE(3, 3, 3, 3)));
+        }
+
+        uint32_t kaiserColumnSSE2(const float* const* rows, uint8_t* dst, uint32_t begin, uint32_t end)
+        {
+            auto& weights = kaiserWeights();
+
+            auto pixel = [&](size_t x)
+            {
+                auto sums = _mm_setzero_ps();
+                for (int k = 0; k < g_kaiserTapCount; ++k)
+                {
+                    sums = _mm_add_ps(sums, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(rows[k] + 4 * x)));
+                }
+                return _mm_cvtps_epi32(clampPixelSSE2(sums));
+            };
+            uint32_t x = begin;
+            for (; x + 4 <= end; x += 4)
+            {
+                auto p01 = _mm_packs_epi32(pixel(x + 0), pixel(x + 1));
+                auto p23 = _mm_packs_epi32(pixel(x + 2), pixel(x + 3));
+
+                _mm_storeu_si128((__m128i*)(dst + 4 * (size_t)x), _mm_packus_epi16(p01, p23));
+            }
+            return x;
+        }
+#endif
+
+#ifdef _D14_MIPCHAIN_AVX2
+        // Two output pixels at once, each in a 128-bit lane.
+        _D14_TARGET_AVX2 uint32_t kaiserRowAVX2(const uint8_t* src, float* dst, uint32_t begin, uint32_t end)
+        {
+            auto& weights = kaiserWeights();
+
+            uint32_t x = begin;
+            for (; x + 2 <= end; x += 2)
+            {
+                auto p = src + 4 * (2 * (size_t)x - 3);
+
+                auto sums = _mm256_setzero_ps();
+                for (int k = 0; k < g_kaiserTapCount; ++k)
+                {
+                    // The k-th tap of x is 2 pixels before that of x + 1.
+                    auto pair = _mm_unpacklo_epi32(
+                        _mm_loadu_si32(p + 4 * k),
+                        _mm_loadu_si32(p + 4 * k + 8));
+
+                    auto pixels = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(pair));
+
+                    sums = _mm256_add_ps(sums, _mm256_mul_ps(_mm256_set1_ps(weights[k]), pixels));
+                }
+                _mm256_storeu_ps(dst + 4 * (size_t)x, sums);
+            }
+            return x;
+        }
+
+        // Two output pixels, each in a 128-bit lane.
+        _D14_TARGET_AVX2 __m256i kaiserPixelsAVX2(const float* const* rows, size_t x)
+        {
+            auto& weights = kaiserWeights();
+
+            auto sums = _mm256_setzero_ps();
+            for (int k = 0; k < g_kaiserTapCount; ++k)
+            {
+                sums = _mm256_add_ps(sums, _mm256_mul_ps(_mm256_set1_ps(weights[k]), _mm256_loadu_ps(rows[k] + 4 * x)));
+            }
+            sums = _mm256_min_ps(_mm256_max_ps(sums, _mm256_setzero_ps()), _mm256_set1_ps(255.0f));
+            sums = _mm256_min_ps(sums, _mm256_shuffle_ps(sums, sums, _MM_SHUFFLE(3, 3, 3, 3)));
+
+            return _mm256_cvtps_epi32(sums);
+        }
+
+        _D14_TARGET_AVX2 uint32_t kaiserColumnAVX2(const float* const* rows, uint8_t* dst, uint32_t begin, uint32_t end)
+        {
+            // The 32-bit pixels are 0 2 4 6 1 3 5 7 after packing in the lanes.
+            auto order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+            uint32_t x = begin;
+            for (; x + 8 <= end; x += 8)
+            {
+                auto p0 = _mm256_packs_epi32(kaiserPixelsAVX2(rows, x + 0), kaiserPixelsAVX2(rows, x + 2));
+                auto p1 = _mm256_packs_epi32(kaiserPixelsAVX2(rows, x + 4), kaiserPixelsAVX2(rows, x + 6));
+
+                _mm256_storeu_si256((__m256i*)(dst + 4 * (size_t)x),
+                    _mm256_permutevar8x32_epi32(_mm256_packus_epi16(p0, p1), order));
+            }
+            return x;
+        }
+#endif
+
+        void kaiserRow(
+            const uint8_t* src, uint32_t srcWidth,
+            uint32_t dstWidth, float* dst, SimdLevel simd)
+        {
+            // The output pixels whose taps are all inside the row, i.e.
+            // 2x - 3 >= 0 and 2x + 4 <= srcWidth - 1.
+            uint32_t innerBegin = std::min(2u, dstWidth);
+            uint32_t innerEnd = srcWidth >= 5 ? std::min((srcWidth - 5) / 2 + 1, dstWidth) : 0;
+
+            innerEnd = std::max(innerEnd, innerBegin);
+
+            kaiserRowScalar(src, srcWidth, dst, 0, innerBegin);
+
+            uint32_t x = innerBegin;
+#ifdef _D14_MIPCHAIN_AVX2
+            if (simd >= SimdLevel::AVX2) x = kaiserRowAVX2(src, dst, x, innerEnd);
+#endif
+#ifdef _D14_MIPCHAIN_SSE2
+            if (simd >= SimdLevel::SSE2) x = kaiserRowSSE2(src, dst, x, innerEnd);
+#endif
+            kaiserRowScalar(src, srcWidth, dst, x, dstWidth);
+        }
+
+        void kaiserColumn(
+            const float* const* rows,
+            uint32_t dstWidth, uint8_t* dst, SimdLevel simd)
+        {
+            uint32_t x = 0;
+#ifdef _D14_MIPCHAIN_AVX2
+            if (simd >= SimdLevel::AVX2) x = kaiserColumnAVX2(rows, dst, x, dstWidth);
+#endif
+#ifdef _D14_MIPCHAIN_SSE2
+            if (simd >= SimdLevel::SSE2) x = kaiserColumnSSE2(rows, dst, x, dstWidth);
+#endif
+            kaiserColumnScalar(rows, dst, x, dstWidth);
+        }
+
+        void downsampleBox(const ImageView& image, Image& result, SimdLevel simd)
+        {
+            for (uint32_t y = 0; y < result.height; ++y)
+            {
+                auto row0 = image.data + 2 * (size_t)y * image.rowPitch;
+                auto row1 = image.data + std::min(2 * y + 1, image.height - 1) * image.rowPitch;
+
+                auto dst = result.pixels.data() + 4 * (size_t)y * result.width;
+
+                boxRow(row0, row1, image.width, result.width, dst, simd);
+            }
+        }
+
+        void downsampleKaiser(const ImageView& image, Image& result, SimdLevel simd)
+        {
+            // The horizontally filtered rows, where the source row y is kept
+            // in the slot y % 8.  The 8 rows of an output row are consecutive
+            // before clamping, so the clamped ones never share a slot.
+            size_t rowSize = 4 * (size_t)result.width;
+
+            std::vector<float> ring(g_kaiserTapCount * rowSize);
+            std::array<int64_t, g_kaiserTapCount> ringRows = {};
+            ringRows.fill(-1);
+
+            auto row = [&](int64_t y) -> const float*
+            {
+                y = std::clamp(y, (int64_t)0, (int64_t)image.height - 1);
+
+                auto slot = (size_t)(y % g_kaiserTapCount);
+                auto dst = ring.data() + slot * rowSize;
+
+                if (ringRows[slot] != y)
+                {
+                    kaiserRow(image.data + y * image.rowPitch, image.width, result.width, dst, simd);
+                    ringRows[slot] = y;
+                }
+                return dst;
+            };
+            for (uint32_t y = 0; y < result.height; ++y)
+            {
+                const float* rows[g_kaiserTapCount] = {};
+                for (int k = 0; k < g_kaiserTapCount; ++k)
+                {
+                    rows[k] = row((int64_t)2 * y - 3 + k);
+                }
+                auto dst = result.pixels.data() + 4 * (size_t)y * result.width;
+
+                kaiserColumn(rows, result.width, dst, simd);
+            }
+        }
+    }
+
+    SimdLevel supportedSimdLevel()
+    {
+#if defined(_D14_MIPCHAIN_AVX2)
+        static const SimdLevel level = []
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            int info[4] = {};
+            __cpuid(info, 0);
+            if (info[0] < 7) return SimdLevel::SSE2;
+
+            // AVX2 also needs the OS to save the YMM registers.
+            __cpuid(info, 1);
+            bool osxsave = (info[2] & (1 << 27)) != 0;
+            bool avx = (info[2] & (1 << 28)) != 0;
+            if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return SimdLevel::SSE2;
+
+            __cpuidex(info, 7, 0);
+            bool avx2 = (info[1] & (1 << 5)) != 0;
+#else
+            bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+            return avx2 ? SimdLevel::AVX2 : SimdLevel::SSE2;
+        }();
+        return level;
+#elif defined(_D14_MIPCHAIN_SSE2)
+        return SimdLevel::SSE2;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }
+
+    ImageView Image::view() const
+    {
+        return { pixels.data(), width, height, 4 * (size_t)width };
+    }
+
+    Image downsample(const ImageView& image, MipFilter filter, SimdLevel simd)
+    {
+        Image result = {};
+        if (image.width == 0 || image.height == 0) return result;
+
+        result.width = (image.width + 1) / 2;
+        result.height = (image.height + 1) / 2;
+        result.pixels.resize(4 * (size_t)result.width * result.height);
+
+        simd = std::min(simd, supportedSimdLevel());
+
+        if (filter == MipFilter::Kaiser)
+        {
+            downsampleKaiser(image, result, simd);
+        }
+        else downsampleBox(image, result, simd);
+
+        return result;
+    }
+
+    std::vector<Image> generateMipChain(const ImageView& image, MipFilter filter, uint32_t minSize, SimdLevel simd)
+    {
+        std::vector<Image> levels = {};
+
+        minSize = std::max(minSize, 1u);
+
+        auto source = image;
+        while (source.width > minSize || source.height > minSize)
+        {
+            levels.push_back(downsample(source, filter, simd));
+            source = levels.back().view();
+        }
+        return levels;
+    }
+}
@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include "Common/ImageUtils/ImageEncoder.h"
+
+namespace d14engine::image_utils
+{
+    enum class MipFilter
+    {
+        // The 2x2 average, which is exact and the fastest.
+        Box,
+        // The 8x8 Kaiser-windowed sinc, which is sharper than Box for the
+        // detailed images (e.g. photos) but rings a little at hard edges.
+        Kaiser
+    };
+
+    enum class SimdLevel { Scalar, SSE2, AVX2 };
+
+    // The best level supported by both the build and the CPU.
+    SimdLevel supportedSimdLevel();
+
+    // RGBA8 pixels owned by the image, where each row takes 4 * width bytes.
+    struct Image
+    {
+        uint32_t width = 0, height = 0;
+
+        std::vector<uint8_t> pixels = {};
+
+        ImageView view() const;
+    };
+
+    // Halves the image (rounded up, with the edge pixels repeated for the
+    // odd sizes).  The pixels must be premultiplied, where filtering is
+    // alpha-correct as is, and the Kaiser results are clamped so that the
+    // colors never exceed the alpha.
+    //
+    // The requested SIMD level is lowered to the supported one, and the
+    // results are the same at all levels.
+    Image downsample(
+        const ImageView& image,
+        MipFilter filter = MipFilter::Box,
+        SimdLevel simd = SimdLevel::AVX2);
+
+    // Returns the levels from 1 (half of the image) on, until both sizes are
+    // not greater than minSize.
+    std::vector<Image> generateMipChain(
+        const ImageView& image,
+        MipFilter filter = MipFilter::Box,
+        uint32_t minSize = 1,
+        SimdLevel simd = SimdLevel::AVX2);
+}
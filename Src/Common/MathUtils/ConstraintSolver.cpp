@@ -0,0 +1,602 @@
+﻿#include "Common/Precompile.h"
+
+#include "Common/MathUtils/ConstraintSolver.h"
+
+#include <cmath>
+
+namespace d14engine::math_utils
+{
+    static bool nearZero(double value)
+    {
+        return std::abs(value) < 1.0e-8;
+    }
+
+    double ConstraintSolver::Strength::make(double strong, double medium, double weak, double weight)
+    {
+        return std::clamp(strong * weight, 0.0, 1000.0) * 1000000.0 +
+               std::clamp(medium * weight, 0.0, 1000.0) * 1000.0 +
+               std::clamp(weak * weight, 0.0, 1000.0);
+    }
+
+    double ConstraintSolver::Row::add(double value)
+    {
+        return constant += value;
+    }
+
+    void ConstraintSolver::Row::insert(const Symbol& symbol, double coefficient)
+    {
+        auto& cell = cells[symbol];
+        if (nearZero(cell += coefficient)) cells.erase(symbol);
+    }
+
+    void ConstraintSolver::Row::insert(const Row& other, double coefficient)
+    {
+        constant += other.constant * coefficient;
+
+        for (auto& [symbol, value] : other.cells)
+        {
+            insert(symbol, value * coefficient);
+        }
+    }
+
+    void ConstraintSolver::Row::remove(const Symbol& symbol)
+    {
+        cells.erase(symbol);
+    }
+
+    void ConstraintSolver::Row::reverseSign()
+    {
+        constant = -constant;
+
+        for (auto& cell : cells) cell.second = -cell.second;
+    }
+
+    void ConstraintSolver::Row::solveFor(const Symbol& symbol)
+    {
+        auto cellItor = cells.find(symbol);
+
+        double coefficient = -1.0 / cellItor->second;
+        cells.erase(cellItor);
+
+        constant *= coefficient;
+        for (auto& cell : cells) cell.second *= coefficient;
+    }
+
+    void ConstraintSolver::Row::solveFor(const Symbol& lhs, const Symbol& rhs)
+    {
+        insert(lhs, -1.0);
+        solveFor(rhs);
+    }
+
+    double ConstraintSolver::Row::coefficientFor(const Symbol& symbol) const
+    {
+        auto cellItor = cells.find(symbol);
+        return cellItor != cells.end() ? cellItor->second : 0.0;
+    }
+
+    void ConstraintSolver::Row::substitute(const Symbol& symbol, const Row& row)
+    {
+        auto cellItor = cells.find(symbol);
+        if (cellItor != cells.end())
+        {
+            double coefficient = cellItor->second;
+            cells.erase(cellItor);
+
+            insert(row, coefficient);
+        }
+    }
+
+    ConstraintSolver::Symbol ConstraintSolver::makeSymbol(SymbolType type)
+    {
+        return { type, m_nextSymbolID++ };
+    }
+
+    ConstraintSolver::Row ConstraintSolver::createRow(const ConstraintInfo& info, Tag& tag)
+    {
+        Row row = {};
+        row.constant = info.expression.constant;
+
+        // Substitute the basic variables with their rows.
+        for (auto& term : info.expression.terms)
+        {
+            if (nearZero(term.coefficient)) continue;
+
+            auto& symbol = m_variables[term.variable].symbol;
+
+            auto rowItor = m_rows.find(symbol);
+            if (rowItor != m_rows.end())
+            {
+                row.insert(rowItor->second, term.coefficient);
+            }
+            else row.insert(symbol, term.coefficient);
+        }
+        bool isRequired = info.strength >= Strength::Required;
+
+        if (info.relation != Relation::Equal)
+        {
+            double coefficient = info.relation == Relation::LessEqual ? 1.0 : -1.0;
+
+            tag.marker = makeSymbol(SymbolType::Slack);
+            row.insert(tag.marker, coefficient);
+
+            if (!isRequired)
+            {
+                tag.other = makeSymbol(SymbolType::Error);
+                row.insert(tag.other, -coefficient);
+
+                m_objective.insert(tag.other, info.strength);
+            }
+        }
+        else if (!isRequired)
+        {
+            tag.marker = makeSymbol(SymbolType::Error);
+            tag.other = makeSymbol(SymbolType::Error);
+
+            row.insert(tag.marker, -1.0);
+            row.insert(tag.other, 1.0);
+
+            m_objective.insert(tag.marker, info.strength);
+            m_objective.insert(tag.other, info.strength);
+        }
+        else // required equality
+        {
+            tag.marker = makeSymbol(SymbolType::Dummy);
+            row.insert(tag.marker);
+        }
+        if (row.constant < 0.0) row.reverseSign();
+
+        return row;
+    }
+
+    ConstraintSolver::Symbol ConstraintSolver::chooseSubject(const Row& row, const Tag& tag) const
+    {
+        for (auto& cell : row.cells)
+        {
+            if (cell.first.type == SymbolType::External) return cell.first;
+        }
+        for (auto& symbol : { tag.marker, tag.other })
+        {
+            if (symbol.type == SymbolType::Slack || symbol.type == SymbolType::Error)
+            {
+                if (row.coefficientFor(symbol) < 0.0) return symbol;
+            }
+        }
+        return {};
+    }
+
+    bool ConstraintSolver::addWithArtificialVariable(const Row& row)
+    {
+        // Minimize the artificial variable, and the row is satisfiable only
+        // if it can reach 0.
+        auto artificial = makeSymbol(SymbolType::Slack);
+        m_rows[artificial] = row;
+        m_artificial = std::make_unique<Row>(row);
+
+        optimize(*m_artificial);
+        bool success = nearZero(m_artificial->constant);
+        m_artificial.reset();
+
+        // Pivot the artificial variable out of the basis if it is basic.
+        auto rowItor = m_rows.find(artificial);
+        if (rowItor != m_rows.end())
+        {
+            if (rowItor->second.cells.empty())
+            {
+                m_rows.erase(rowItor);
+                return success;
+            }
+            Symbol entering = {};
+            for (auto& cell : rowItor->second.cells)
+            {
+                if (cell.first.type == SymbolType::Slack || cell.first.type == SymbolType::Error)
+                {
+                    entering = cell.first;
+                    break;
+                }
+            }
+            if (!entering.isValid())
+            {
+                m_rows.erase(rowItor);
+                return false;
+            }
+            pivot(rowItor, entering);
+        }
+        for (auto& item : m_rows) item.second.remove(artificial);
+
+        m_objective.remove(artificial);
+
+        return success;
+    }
+
+    void ConstraintSolver::substitute(const Symbol& symbol, const Row& row)
+    {
+        for (auto& [basic, basicRow] : m_rows)
+        {
+            basicRow.substitute(symbol, row);
+
+            if (basic.type != SymbolType::External && basicRow.constant < 0.0)
+            {
+                m_infeasibleRows.push_back(basic);
+            }
+        }
+        m_objective.substitute(symbol, row);
+
+        if (m_artificial) m_artificial->substitute(symbol, row);
+    }
+
+    void ConstraintSolver::pivot(std::map<Symbol, Row>::iterator leaving, const Symbol& entering)
+    {
+        ++m_pivotCount;
+
+        auto leavingSymbol = leaving->first;
+        auto row = std::move(leaving->second);
+        m_rows.erase(leaving);
+
+        row.solveFor(leavingSymbol, entering);
+        substitute(entering, row);
+
+        m_rows[entering] = std::move(row);
+    }
+
+    bool ConstraintSolver::optimize(Row& objective)
+    {
+        while (true)
+        {
+            auto entering = enteringSymbol(objective);
+            if (!entering.isValid()) return true;
+
+            auto leaving = leavingRow(entering);
+            if (leaving == m_rows.end()) return false;
+
+            pivot(leaving, entering);
+        }
+    }
+
+    bool ConstraintSolver::dualOptimize()
+    {
+        while (!m_infeasibleRows.empty())
+        {
+            auto leaving = m_infeasibleRows.back();
+            m_infeasibleRows.pop_back();
+
+            auto rowItor = m_rows.find(leaving);
+            if (rowItor != m_rows.end() &&
+                !nearZero(rowItor->second.constant) && rowItor->second.constant < 0.0)
+            {
+                auto entering = dualEnteringSymbol(rowItor->second);
+                if (!entering.isValid())
+                {
+                    m_infeasibleRows.clear();
+                    return false;
+                }
+                pivot(rowItor, entering);
+            }
+        }
+        return true;
+    }
+
+    ConstraintSolver::Symbol ConstraintSolver::enteringSymbol(const Row& objective) const
+    {
+        for (auto& cell : objective.cells)
+        {
+            if (cell.first.type != SymbolType::Dummy && cell.second < 0.0) return cell.first;
+        }
+        return {};
+    }
+
+    ConstraintSolver::Symbol ConstraintSolver::dualEnteringSymbol(const Row& row) const
+    {
+        Symbol entering = {};
+        double ratio = std::numeric_limits<double>::max();
+
+        for (auto& cell : row.cells)
+        {
+            if (cell.second > 0.0 && cell.first.type != SymbolType::Dummy)
+            {
+                double cellRatio = m_objective.coefficientFor(cell.first) / cell.second;
+                if (cellRatio < ratio)
+                {
+                    ratio = cellRatio;
+                    entering = cell.first;
+                }
+            }
+        }
+        return entering;
+    }
+
+    std::map<ConstraintSolver::Symbol, ConstraintSolver::Row>::iterator
+        ConstraintSolver::leavingRow(const Symbol& entering)
+    {
+        auto found = m_rows.end();
+        double ratio = std::numeric_limits<double>::max();
+
+        for (auto rowItor = m_rows.begin(); rowItor != m_rows.end(); ++rowItor)
+        {
+            if (rowItor->first.type == SymbolType::External) continue;
+
+            double coefficient = rowItor->second.coefficientFor(entering);
+            if (coefficient < 0.0)
+            {
+                double rowRatio = -rowItor->second.constant / coefficient;
+                if (rowRatio < ratio)
+                {
+                    ratio = rowRatio;
+                    found = rowItor;
+                }
+            }
+        }
+        return found;
+    }
+
+    std::map<ConstraintSolver::Symbol, ConstraintSolver::Row>::iterator
+        ConstraintSolver::markerLeavingRow(const Symbol& marker)
+    {
+        double ratio1 = std::numeric_limits<double>::max();
+        double ratio2 = std::numeric_limits<double>::max();
+
+        auto first = m_rows.end(), second = m_rows.end(), third = m_rows.end();
+
+        for (auto rowItor = m_rows.begin(); rowItor != m_rows.end(); ++rowItor)
+        {
+            double coefficient = rowItor->second.coefficientFor(marker);
+            if (coefficient == 0.0) continue;
+
+            if (rowItor->first.type == SymbolType::External)
+            {
+                third = rowItor;
+            }
+            else if (coefficient < 0.0)
+            {
+                double rowRatio = -rowItor->second.constant / coefficient;
+                if (rowRatio < ratio1)
+                {
+                    ratio1 = rowRatio;
+                    first = rowItor;
+                }
+            }
+            else // positive coefficient
+            {
+                double rowRatio = rowItor->second.constant / coefficient;
+                if (rowRatio < ratio2)
+                {
+                    ratio2 = rowRatio;
+                    second = rowItor;
+                }
+            }
+        }
+        if (first != m_rows.end()) return first;
+        if (second != m_rows.end()) return second;
+        return third;
+    }
+
+    void ConstraintSolver::removeConstraintEffects(const ConstraintInfo& info)
+    {
+        if (info.tag.marker.type == SymbolType::Error)
+        {
+            removeMarkerEffects(info.tag.marker, info.strength);
+        }
+        if (info.tag.other.type == SymbolType::Error)
+        {
+            removeMarkerEffects(info.tag.other, info.strength);
+        }
+    }
+
+    void ConstraintSolver::removeMarkerEffects(const Symbol& marker, double strength)
+    {
+        auto rowItor = m_rows.find(marker);
+        if (rowItor != m_rows.end())
+        {
+            m_objective.insert(rowItor->second, -strength);
+        }
+        else m_objective.insert(marker, -strength);
+    }
+
+    ConstraintSolver::Variable ConstraintSolver::addVariable()
+    {
+        m_variables.push_back({ makeSymbol(SymbolType::External), 0.0 });
+
+        return m_variables.size() - 1;
+    }
+
+    size_t ConstraintSolver::variableCount() const
+    {
+        return m_variables.size();
+    }
+
+    Optional<ConstraintSolver::ConstraintID> ConstraintSolver::addConstraint(
+        const Expression& expression, Relation relation, double strength)
+    {
+        for (auto& term : expression.terms)
+        {
+            if (term.variable >= m_variables.size()) return std::nullopt;
+        }
+        ConstraintInfo info = {};
+        info.expression = expression;
+        info.relation = relation;
+        info.strength = std::clamp(strength, 0.0, Strength::Required);
+
+        auto row = createRow(info, info.tag);
+        auto subject = chooseSubject(row, info.tag);
+
+        bool allDummies = std::all_of(row.cells.begin(), row.cells.end(),
+            [](auto& cell) { return cell.first.type == SymbolType::Dummy; });
+
+        if (!subject.isValid() && allDummies)
+        {
+            // The constraint is redundant if the constant is 0, otherwise
+            // it conflicts with the existing required ones.
+            if (!nearZero(row.constant)) return std::nullopt;
+
+            subject = info.tag.marker;
+        }
+        if (!subject.isValid())
+        {
+            // Only the required constraints can fail, which introduce no
+            // error terms, but the tableau is pivoted to find that out.
+            auto rows = m_rows;
+            auto objective = m_objective;
+
+            if (!addWithArtificialVariable(row))
+            {
+                m_rows = std::move(rows);
+                m_objective = std::move(objective);
+
+                m_infeasibleRows.clear();
+                return std::nullopt;
+            }
+        }
+        else // pivot the subject into the basis directly
+        {
+            row.solveFor(subject);
+            substitute(subject, row);
+
+            m_rows[subject] = std::move(row);
+        }
+        auto constraint = m_nextConstraintID++;
+        m_constraints[constraint] = std::move(info);
+
+        optimize(m_objective);
+
+        return constraint;
+    }
+
+    bool ConstraintSolver::removeConstraint(ConstraintID constraint)
+    {
+        auto infoItor = m_constraints.find(constraint);
+        if (infoItor == m_constraints.end()) return false;
+
+        auto info = std::move(infoItor->second);
+        m_constraints.erase(infoItor);
+
+        std::erase_if(m_edits, [&](auto& item) { return item.second.constraint == constraint; });
+
+        removeConstraintEffects(info);
+
+        // Remove the row of the marker if it is basic, otherwise pivot it
+        // into the basis first.
+        auto rowItor = m_rows.find(info.tag.marker);
+        if (rowItor != m_rows.end())
+        {
+            m_rows.erase(rowItor);
+        }
+        else
+        {
+            rowItor = markerLeavingRow(info.tag.marker);
+            if (rowItor != m_rows.end())
+            {
+                auto leaving = rowItor->first;
+                auto row = std::move(rowItor->second);
+                m_rows.erase(rowItor);
+
+                ++m_pivotCount;
+                row.solveFor(leaving, info.tag.marker);
+                substitute(info.tag.marker, row);
+            }
+        }
+        optimize(m_objective);
+
+        return true;
+    }
+
+    bool ConstraintSolver::hasConstraint(ConstraintID constraint) const
+    {
+        return m_constraints.contains(constraint);
+    }
+
+    bool ConstraintSolver::addEditVariable(Variable variable, double strength)
+    {
+        if (variable >= m_variables.size() || m_edits.contains(variable)) return false;
+
+        strength = std::clamp(strength, 0.0, Strength::Required);
+        if (strength >= Strength::Required) return false;
+
+        auto constraint = addConstraint({ { { variable, 1.0 } }, 0.0 }, Relation::Equal, strength);
+        if (!constraint.has_value()) return false;
+
+        m_edits[variable] = { constraint.value(), 0.0 };
+
+        return true;
+    }
+
+    bool ConstraintSolver::removeEditVariable(Variable variable)
+    {
+        auto editItor = m_edits.find(variable);
+        if (editItor == m_edits.end()) return false;
+
+        // The edit is erased along with its constraint.
+        return removeConstraint(editItor->second.constraint);
+    }
+
+    bool ConstraintSolver::hasEditVariable(Variable variable) const
+    {
+        return m_edits.contains(variable);
+    }
+
+    bool ConstraintSolver::suggestValue(Variable variable, double value)
+    {
+        auto editItor = m_edits.find(variable);
+        if (editItor == m_edits.end()) return false;
+
+        auto& edit = editItor->second;
+        auto& tag = m_constraints.at(edit.constraint).tag;
+
+        double delta = value - edit.constant;
+        edit.constant = value;
+
+        // The marker/other error is basic: only its own row changes.
+        auto rowItor = m_rows.find(tag.marker);
+        if (rowItor != m_rows.end())
+        {
+            if (rowItor->second.add(-delta) < 0.0) m_infeasibleRows.push_back(tag.marker);
+        }
+        else if ((rowItor = m_rows.find(tag.other)) != m_rows.end())
+        {
+            if (rowItor->second.add(delta) < 0.0) m_infeasibleRows.push_back(tag.other);
+        }
+        else // the marker is parametric: update the rows that contain it
+        {
+            for (auto& [basic, row] : m_rows)
+            {
+                double coefficient = row.coefficientFor(tag.marker);
+                if (coefficient != 0.0 && row.add(delta * coefficient) < 0.0 &&
+                    basic.type != SymbolType::External)
+                {
+                    m_infeasibleRows.push_back(basic);
+                }
+            }
+        }
+        dualOptimize();
+
+        return true;
+    }
+
+    const std::vector<ConstraintSolver::Variable>& ConstraintSolver::updateVariables()
+    {
+        m_changedVariables.clear();
+
+        for (Variable variable = 0; variable < m_variables.size(); ++variable)
+        {
+            auto& info = m_variables[variable];
+
+            auto rowItor = m_rows.find(info.symbol);
+            double value = rowItor != m_rows.end() ? rowItor->second.constant : 0.0;
+
+            if (value != info.value)
+            {
+                info.value = value;
+                m_changedVariables.push_back(variable);
+            }
+        }
+        return m_changedVariables;
+    }
+
+    double ConstraintSolver::value(Variable variable) const
+    {
+        return m_variables.at(variable).value;
+    }
+
+    size_t ConstraintSolver::pivotCount() const
+    {
+        return m_pivotCount;
+    }
+}
@@ -0,0 +1,210 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::math_utils
+{
+    // An incremental solver of the linear equality/inequality constraints
+    // with priorities (the Cassowary algorithm, see "The Cassowary Linear
+    // Arithmetic Constraint Solving Algorithm" by Badros, Borning and
+    // Stuckey), which does no graphics/UI work so it can be used and tested
+    // anywhere.
+    //
+    // The required constraints must be satisfied, while the others are
+    // satisfied as much as possible in the order of their strengths.  The
+    // tableau is kept between the calls, so adding/removing a constraint
+    // only pivots the affected rows, and suggesting the value of an edit
+    // variable (e.g. dragging an edge) only runs the dual simplex on the
+    // rows that become infeasible.
+    //
+    // The results only depend on the call sequence, i.e. the same sequence
+    // always produces the same values.
+
+    struct ConstraintSolver
+    {
+        using Variable = size_t;
+        using ConstraintID = size_t;
+
+        struct Strength
+        {
+            // Combines 3 levels into a single strength, where each level is
+            // clamped to [0, 1000] so a stronger level always wins.
+            static double make(double strong, double medium, double weak, double weight = 1.0);
+
+            // make(1000, 1000, 1000), make(1, 0, 0), make(0, 1, 0) and make(0, 0, 1)
+            static constexpr double Required = 1001001000.0;
+            static constexpr double Strong = 1000000.0;
+            static constexpr double Medium = 1000.0;
+            static constexpr double Weak = 1.0;
+        };
+
+        enum class Relation { LessEqual, Equal, GreaterEqual };
+
+        struct Term
+        {
+            Variable variable = 0;
+            double coefficient = 1.0;
+        };
+
+        // sum(coefficient * variable) + constant
+        struct Expression
+        {
+            std::vector<Term> terms = {};
+            double constant = 0.0;
+        };
+
+    protected:
+        enum class SymbolType { Invalid, External, Slack, Error, Dummy };
+
+        struct Symbol
+        {
+            SymbolType type = SymbolType::Invalid;
+
+            // Unique among the symbols except the invalid one (0).
+            uint64_t id = 0;
+
+            bool isValid() const { return type != SymbolType::Invalid; }
+
+            bool operator<(const Symbol& rhs) const { return id < rhs.id; }
+            bool operator==(const Symbol& rhs) const { return id == rhs.id; }
+        };
+
+        struct Row
+        {
+            std::map<Symbol, double> cells = {};
+            double constant = 0.0;
+
+            double add(double value);
+
+            void insert(const Symbol& symbol, double coefficient = 1.0);
+            void insert(const Row& other, double coefficient = 1.0);
+
+            void remove(const Symbol& symbol);
+
+            void reverseSign();
+
+            // Solves the row (which equals 0) for the symbol, i.e. turns it
+            // into "symbol = the other cells + constant" without the symbol.
+            void solveFor(const Symbol& symbol);
+
+            // Solves "lhs = row" for rhs.
+            void solveFor(const Symbol& lhs, const Symbol& rhs);
+
+            double coefficientFor(const Symbol& symbol) const;
+
+            // Replaces the symbol with the row.
+            void substitute(const Symbol& symbol, const Row& row);
+        };
+
+        // Which symbols are introduced by a constraint, so the effects can be
+        // removed along with the constraint.
+        struct Tag
+        {
+            Symbol marker = {}, other = {};
+        };
+
+        struct ConstraintInfo
+        {
+            Expression expression = {};
+            Relation relation = Relation::Equal;
+            double strength = 0.0;
+
+            Tag tag = {};
+        };
+
+        struct EditInfo
+        {
+            ConstraintID constraint = 0;
+            double constant = 0.0;
+        };
+
+        uint64_t m_nextSymbolID = 1;
+
+        Symbol makeSymbol(SymbolType type);
+
+        struct VariableInfo
+        {
+            Symbol symbol = {};
+            double value = 0.0;
+        };
+        std::vector<VariableInfo> m_variables = {};
+
+        ConstraintID m_nextConstraintID = 0;
+        std::map<ConstraintID, ConstraintInfo> m_constraints = {};
+
+        std::map<Variable, EditInfo> m_edits = {};
+
+        std::map<Symbol, Row> m_rows = {};
+
+        Row m_objective = {};
+        UniquePtr<Row> m_artificial = {};
+
+        std::vector<Symbol> m_infeasibleRows = {};
+
+        std::vector<Variable> m_changedVariables = {};
+
+        size_t m_pivotCount = 0;
+
+        Row createRow(const ConstraintInfo& info, Tag& tag);
+
+        Symbol chooseSubject(const Row& row, const Tag& tag) const;
+
+        bool addWithArtificialVariable(const Row& row);
+
+        void substitute(const Symbol& symbol, const Row& row);
+
+        // Returns false if the objective is unbounded, which never happens
+        // for the objectives built by the solver itself.
+        bool optimize(Row& objective);
+
+        bool dualOptimize();
+
+        Symbol enteringSymbol(const Row& objective) const;
+        Symbol dualEnteringSymbol(const Row& row) const;
+
+        std::map<Symbol, Row>::iterator leavingRow(const Symbol& entering);
+        std::map<Symbol, Row>::iterator markerLeavingRow(const Symbol& marker);
+
+        void removeConstraintEffects(const ConstraintInfo& info);
+        void removeMarkerEffects(const Symbol& marker, double strength);
+
+        // Pivots the symbol into a basic row.
+        void pivot(std::map<Symbol, Row>::iterator leaving, const Symbol& entering);
+
+    public:
+        Variable addVariable();
+
+        size_t variableCount() const;
+
+        // Returns std::nullopt if the constraint is required and conflicts
+        // with the other required ones, i.e. "expression relation 0" can
+        // not be satisfied.  The strength is clamped to Strength::Required.
+        Optional<ConstraintID> addConstraint(
+            const Expression& expression, Relation relation,
+            double strength = Strength::Required);
+
+        bool removeConstraint(ConstraintID constraint);
+
+        bool hasConstraint(ConstraintID constraint) const;
+
+        // An edit variable is pulled to the suggested value with the
+        // strength, which must be weaker than Strength::Required.
+        bool addEditVariable(Variable variable, double strength);
+
+        bool removeEditVariable(Variable variable);
+
+        bool hasEditVariable(Variable variable) const;
+
+        // Returns false if the variable is not an edit variable.
+        bool suggestValue(Variable variable, double value);
+
+        // Copies the solution to the variables and returns the ones whose
+        // values changed since the last update (in ascending order).
+        const std::vector<Variable>& updateVariables();
+
+        double value(Variable variable) const;
+
+        // The number of pivots since constructed, for the benchmarks.
+        size_t pivotCount() const;
+    };
+}
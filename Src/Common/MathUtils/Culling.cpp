@@ -0,0 +1,152 @@
+﻿#include "Common/Precompile.h"
+
+#include "Common/MathUtils/Culling.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define _D14_CULLING_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace d14engine::math_utils
+{
+    size_t AABBArray::size() const
+    {
+        return minX.size();
+    }
+
+    void AABBArray::reserve(size_t count)
+    {
+        minX.reserve(count);
+        minY.reserve(count);
+        minZ.reserve(count);
+        maxX.reserve(count);
+        maxY.reserve(count);
+        maxZ.reserve(count);
+    }
+
+    void AABBArray::push(const AABB& box)
+    {
+        minX.push_back(box.minX);
+        minY.push_back(box.minY);
+        minZ.push_back(box.minZ);
+        maxX.push_back(box.maxX);
+        maxY.push_back(box.maxY);
+        maxZ.push_back(box.maxZ);
+    }
+
+    void AABBArray::clear()
+    {
+        minX.clear();
+        minY.clear();
+        minZ.clear();
+        maxX.clear();
+        maxY.clear();
+        maxZ.clear();
+    }
+
+    Frustum Frustum::fromViewProj(const float(&m)[4][4])
+    {
+        // Gribb & Hartmann: clip = v * M, so the planes are
+        // the combinations of the columns of the matrix.
+        auto column = [&](int j)
+        {
+            return std::array<float, 4>{ m[0][j], m[1][j], m[2][j], m[3][j] };
+        };
+        auto c0 = column(0), c1 = column(1), c2 = column(2), c3 = column(3);
+
+        auto add = [](const std::array<float, 4>& a, const std::array<float, 4>& b)
+        {
+            return std::array<float, 4>{ a[0] + b[0], a[1] + b[1], a[2] + b[2], a[3] + b[3] };
+        };
+        auto sub = [](const std::array<float, 4>& a, const std::array<float, 4>& b)
+        {
+            return std::array<float, 4>{ a[0] - b[0], a[1] - b[1], a[2] - b[2], a[3] - b[3] };
+        };
+        Frustum frustum = {};
+
+        frustum.planes[Left] = add(c3, c0);   // -w <= x
+        frustum.planes[Right] = sub(c3, c0);  // x <= w
+        frustum.planes[Bottom] = add(c3, c1); // -w <= y
+        frustum.planes[Top] = sub(c3, c1);    // y <= w
+        frustum.planes[Near] = c2;            // 0 <= z
+        frustum.planes[Far] = sub(c3, c2);    // z <= w
+
+        return frustum;
+    }
+
+    bool intersects(const Frustum& frustum, const AABB& box)
+    {
+        for (auto& p : frustum.planes)
+        {
+            // Test the corner that is the farthest along the plane normal
+            // (a.k.a the positive vertex); the box is outside if even this
+            // corner is on the negative side.
+            float x = p[0] >= 0.0f ? box.maxX : box.minX;
+            float y = p[1] >= 0.0f ? box.maxY : box.minY;
+            float z = p[2] >= 0.0f ? box.maxZ : box.minZ;
+
+            if (p[0] * x + p[1] * y + p[2] * z + p[3] < 0.0f) return false;
+        }
+        return true;
+    }
+
+    void cullAABBs(
+        const Frustum& frustum,
+        const AABBArray& boxes,
+        size_t offset,
+        size_t count,
+        uint8_t* results)
+    {
+        size_t i = offset, end = offset + count;
+
+#ifdef _D14_CULLING_SSE2
+        // The positive vertex only depends on the signs of the plane, so
+        // the selection is done once per plane instead of once per box.
+        const float* px[Frustum::Count] = {};
+        const float* py[Frustum::Count] = {};
+        const float* pz[Frustum::Count] = {};
+
+        for (int k = 0; k < Frustum::Count; ++k)
+        {
+            auto& p = frustum.planes[k];
+
+            px[k] = p[0] >= 0.0f ? boxes.maxX.data() : boxes.minX.data();
+            py[k] = p[1] >= 0.0f ? boxes.maxY.data() : boxes.minY.data();
+            pz[k] = p[2] >= 0.0f ? boxes.maxZ.data() : boxes.minZ.data();
+        }
+        auto zero = _mm_setzero_ps();
+
+        for (; i + 4 <= end; i += 4)
+        {
+            auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+            for (int k = 0; k < Frustum::Count; ++k)
+            {
+                auto& p = frustum.planes[k];
+
+                auto dist = _mm_set1_ps(p[3]);
+                dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(p[0]), _mm_loadu_ps(px[k] + i)));
+                dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(p[1]), _mm_loadu_ps(py[k] + i)));
+                dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(p[2]), _mm_loadu_ps(pz[k] + i)));
+
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, zero));
+            }
+            int mask = _mm_movemask_ps(inside);
+
+            results[i + 0] = (uint8_t)((mask >> 0) & 1);
+            results[i + 1] = (uint8_t)((mask >> 1) & 1);
+            results[i + 2] = (uint8_t)((mask >> 2) & 1);
+            results[i + 3] = (uint8_t)((mask >> 3) & 1);
+        }
+#endif
+        for (; i < end; ++i)
+        {
+            AABB box =
+            {
+                boxes.minX[i], boxes.minY[i], boxes.minZ[i],
+                boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i]
+            };
+            results[i] = intersects(frustum, box) ? 1 : 0;
+        }
+    }
+}
@@ -0,0 +1,56 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::math_utils
+{
+    // Axis-aligned bounding box in world space.
+    struct AABB
+    {
+        float minX = 0.0f, minY = 0.0f, minZ = 0.0f;
+        float maxX = 0.0f, maxY = 0.0f, maxZ = 0.0f;
+    };
+
+    // Stores the boxes in the structure-of-arrays layout,
+    // so that 4 boxes can be tested with one SIMD instruction.
+    struct AABBArray
+    {
+        std::vector<float> minX = {}, minY = {}, minZ = {};
+        std::vector<float> maxX = {}, maxY = {}, maxZ = {};
+
+        size_t size() const;
+
+        void reserve(size_t count);
+
+        void push(const AABB& box);
+
+        void clear();
+    };
+
+    // The plane (a, b, c, d) keeps the points with ax + by + cz + d >= 0,
+    // i.e. the normals point to the inside of the frustum.
+    struct Frustum
+    {
+        enum PlaneIndex { Left, Right, Bottom, Top, Near, Far, Count };
+
+        std::array<std::array<float, 4>, Count> planes = {};
+
+        // Extracts the planes from the view-projection matrix, which uses
+        // the DirectX conventions (row vectors, z in [0, 1] in clip space).
+        static Frustum fromViewProj(const float(&m)[4][4]);
+    };
+
+    // Conservative: the boxes that straddle the corner of the frustum may
+    // be reported as intersecting, which is fine for the culling.
+    bool intersects(const Frustum& frustum, const AABB& box);
+
+    // Writes 1 to results[i] if box[i] intersects with the frustum, else 0.
+    // Only the range [offset, offset + count) is processed, so it is safe to
+    // split a large array into several chunks and test them in parallel.
+    void cullAABBs(
+        const Frustum& frustum,
+        const AABBArray& boxes,
+        size_t offset,
+        size_t count,
+        uint8_t* results);
+}
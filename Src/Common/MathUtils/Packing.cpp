@@ -0,0 +1,357 @@
+﻿#include "Common/Precompile.h"
+
+#include "Common/MathUtils/Packing.h"
+
+#include <climits>
+
+namespace d14engine::math_utils
+{
+    RectPacker::RectPacker(int binWidth, int binHeight, int padding, bool allowRotation)
+        :
+        m_binWidth(binWidth),
+        m_binHeight(binHeight),
+        m_padding(std::max(padding, 0)),
+        m_allowRotation(allowRotation) { }
+
+    int RectPacker::binWidth() const
+    {
+        return m_binWidth;
+    }
+
+    int RectPacker::binHeight() const
+    {
+        return m_binHeight;
+    }
+
+    int RectPacker::padding() const
+    {
+        return m_padding;
+    }
+
+    bool RectPacker::allowRotation() const
+    {
+        return m_allowRotation;
+    }
+
+    void RectPacker::clear()
+    {
+        m_usedArea = 0;
+    }
+
+    float RectPacker::occupancy() const
+    {
+        auto binArea = (long long)m_binWidth * m_binHeight;
+        return binArea > 0 ? (float)((double)m_usedArea / binArea) : 0.0f;
+    }
+
+    ShelfPacker::ShelfPacker(int binWidth, int binHeight, int padding)
+        :
+        RectPacker(binWidth, binHeight, padding, false) { }
+
+    Optional<PackedRect> ShelfPacker::insert(int width, int height)
+    {
+        if (width <= 0 || height <= 0) return std::nullopt;
+
+        // The footprint includes the padding on the right and bottom, and the
+        // padding on the left and top is reserved by the bin origin offset.
+        int footWidth = width + m_padding;
+        int footHeight = height + m_padding;
+
+        // Pick the shelf that wastes the least height (best-height-fit).
+        Shelf* target = nullptr;
+        for (auto& shelf : m_shelves)
+        {
+            if (footHeight <= shelf.height &&
+                shelf.cursorX + footWidth <= m_binWidth)
+            {
+                if (target == nullptr || shelf.height < target->height)
+                {
+                    target = &shelf;
+                }
+            }
+        }
+        if (target == nullptr)
+        {
+            int nextY = m_padding;
+            if (!m_shelves.empty())
+            {
+                auto& last = m_shelves.back();
+                nextY = last.y + last.height;
+            }
+            if (m_padding + footWidth > m_binWidth ||
+                nextY + footHeight > m_binHeight)
+            {
+                return std::nullopt;
+            }
+            target = &m_shelves.emplace_back(Shelf{ nextY, footHeight, m_padding });
+        }
+        PackedRect rect = { target->cursorX, target->y, width, height };
+
+        target->cursorX += footWidth;
+        m_usedArea += (long long)width * height;
+
+        return rect;
+    }
+
+    void ShelfPacker::clear()
+    {
+        RectPacker::clear();
+
+        m_shelves.clear();
+    }
+
+    SkylinePacker::SkylinePacker(int binWidth, int binHeight, int padding, bool allowRotation)
+        :
+        RectPacker(binWidth, binHeight, padding, allowRotation)
+    {
+        clear();
+    }
+
+    Optional<int> SkylinePacker::fitSkyline(size_t index, int width, int height) const
+    {
+        int x = m_skyline[index].x;
+        if (x + width > m_binWidth) return std::nullopt;
+
+        // The rectangle rests on the highest node it spans.
+        int y = m_skyline[index].y, widthLeft = width;
+        while (widthLeft > 0)
+        {
+            if (index >= m_skyline.size()) return std::nullopt;
+
+            y = std::max(y, m_skyline[index].y);
+            if (y + height > m_binHeight) return std::nullopt;
+
+            widthLeft -= m_skyline[index].width;
+            ++index;
+        }
+        return y;
+    }
+
+    Optional<PackedRect> SkylinePacker::insert(int width, int height)
+    {
+        if (width <= 0 || height <= 0) return std::nullopt;
+
+        struct Candidate
+        {
+            size_t index = 0;
+            int x = 0, y = 0;
+            int footWidth = 0, footHeight = 0;
+            bool rotated = false;
+        };
+        Optional<Candidate> best = {};
+        int bestTop = INT_MAX, bestNodeWidth = INT_MAX;
+
+        auto tryPlace = [&](int footWidth, int footHeight, bool rotated)
+        {
+            for (size_t i = 0; i < m_skyline.size(); ++i)
+            {
+                auto y = fitSkyline(i, footWidth, footHeight);
+                if (!y.has_value()) continue;
+
+                // bottom-left rule: the lowest top edge wins, and then the
+                // narrowest node to keep the wide nodes for the wide ones.
+                int top = y.value() + footHeight;
+                int nodeWidth = m_skyline[i].width;
+
+                if (top < bestTop || (top == bestTop && nodeWidth < bestNodeWidth))
+                {
+                    bestTop = top;
+                    bestNodeWidth = nodeWidth;
+                    best = Candidate{ i, m_skyline[i].x, y.value(), footWidth, footHeight, rotated };
+                }
+            }
+        };
+        tryPlace(width + m_padding, height + m_padding, false);
+
+        if (m_allowRotation && width != height)
+        {
+            tryPlace(height + m_padding, width + m_padding, true);
+        }
+        if (!best.has_value()) return std::nullopt;
+
+        auto& c = best.value();
+
+        // Raise the skyline over the placed rectangle.
+        m_skyline.insert(m_skyline.begin() + c.index, Node{ c.x, c.y + c.footHeight, c.footWidth });
+
+        for (size_t i = c.index + 1; i < m_skyline.size();)
+        {
+            auto& prev = m_skyline[i - 1];
+            auto& node = m_skyline[i];
+
+            int shrink = prev.x + prev.width - node.x;
+            if (shrink <= 0) break;
+
+            if (shrink < node.width)
+            {
+                node.x += shrink;
+                node.width -= shrink;
+                break;
+            }
+            m_skyline.erase(m_skyline.begin() + i);
+        }
+        for (size_t i = 1; i < m_skyline.size();)
+        {
+            if (m_skyline[i - 1].y == m_skyline[i].y)
+            {
+                m_skyline[i - 1].width += m_skyline[i].width;
+                m_skyline.erase(m_skyline.begin() + i);
+            }
+            else ++i;
+        }
+        m_usedArea += (long long)width * height;
+
+        return PackedRect
+        {
+            c.x, c.y,
+            c.footWidth - m_padding, c.footHeight - m_padding,
+            c.rotated
+        };
+    }
+
+    void SkylinePacker::clear()
+    {
+        RectPacker::clear();
+
+        m_skyline.clear();
+        if (m_binWidth > m_padding)
+        {
+            m_skyline.push_back({ m_padding, m_padding, m_binWidth - m_padding });
+        }
+    }
+
+    MaxRectsPacker::MaxRectsPacker(int binWidth, int binHeight, int padding, bool allowRotation)
+        :
+        RectPacker(binWidth, binHeight, padding, allowRotation)
+    {
+        clear();
+    }
+
+    void MaxRectsPacker::splitFreeRects(const FreeRect& used)
+    {
+        std::vector<FreeRect> splitRects = {};
+
+        for (size_t i = 0; i < m_freeRects.size();)
+        {
+            auto f = m_freeRects[i];
+
+            if (used.x >= f.x + f.width || used.x + used.width <= f.x ||
+                used.y >= f.y + f.height || used.y + used.height <= f.y)
+            {
+                ++i;
+                continue;
+            }
+            // Keep the maximal parts on the 4 sides of the used rectangle.
+            if (used.x > f.x)
+            {
+                splitRects.push_back({ f.x, f.y, used.x - f.x, f.height });
+            }
+            if (used.x + used.width < f.x + f.width)
+            {
+                int x = used.x + used.width;
+                splitRects.push_back({ x, f.y, f.x + f.width - x, f.height });
+            }
+            if (used.y > f.y)
+            {
+                splitRects.push_back({ f.x, f.y, f.width, used.y - f.y });
+            }
+            if (used.y + used.height < f.y + f.height)
+            {
+                int y = used.y + used.height;
+                splitRects.push_back({ f.x, y, f.width, f.y + f.height - y });
+            }
+            m_freeRects.erase(m_freeRects.begin() + i);
+        }
+        m_freeRects.insert(m_freeRects.end(), splitRects.begin(), splitRects.end());
+    }
+
+    void MaxRectsPacker::pruneFreeRects()
+    {
+        auto contains = [](const FreeRect& a, const FreeRect& b)
+        {
+            return b.x >= a.x && b.y >= a.y &&
+                   b.x + b.width <= a.x + a.width &&
+                   b.y + b.height <= a.y + a.height;
+        };
+        for (size_t i = 0; i < m_freeRects.size(); ++i)
+        {
+            for (size_t j = i + 1; j < m_freeRects.size();)
+            {
+                if (contains(m_freeRects[i], m_freeRects[j]))
+                {
+                    m_freeRects.erase(m_freeRects.begin() + j);
+                }
+                else if (contains(m_freeRects[j], m_freeRects[i]))
+                {
+                    m_freeRects.erase(m_freeRects.begin() + i);
+                    --i;
+                    break;
+                }
+                else ++j;
+            }
+        }
+    }
+
+    Optional<PackedRect> MaxRectsPacker::insert(int width, int height)
+    {
+        if (width <= 0 || height <= 0) return std::nullopt;
+
+        Optional<FreeRect> best = {};
+        bool bestRotated = false;
+        int bestShortSide = INT_MAX, bestLongSide = INT_MAX;
+
+        auto tryPlace = [&](int footWidth, int footHeight, bool rotated)
+        {
+            for (auto& f : m_freeRects)
+            {
+                if (footWidth > f.width || footHeight > f.height) continue;
+
+                int leftoverHorz = f.width - footWidth;
+                int leftoverVert = f.height - footHeight;
+
+                int shortSide = std::min(leftoverHorz, leftoverVert);
+                int longSide = std::max(leftoverHorz, leftoverVert);
+
+                if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+                {
+                    bestShortSide = shortSide;
+                    bestLongSide = longSide;
+                    best = FreeRect{ f.x, f.y, footWidth, footHeight };
+                    bestRotated = rotated;
+                }
+            }
+        };
+        tryPlace(width + m_padding, height + m_padding, false);
+
+        if (m_allowRotation && width != height)
+        {
+            tryPlace(height + m_padding, width + m_padding, true);
+        }
+        if (!best.has_value()) return std::nullopt;
+
+        auto& used = best.value();
+
+        splitFreeRects(used);
+        pruneFreeRects();
+
+        m_usedArea += (long long)width * height;
+
+        return PackedRect
+        {
+            used.x, used.y,
+            used.width - m_padding, used.height - m_padding,
+            bestRotated
+        };
+    }
+
+    void MaxRectsPacker::clear()
+    {
+        RectPacker::clear();
+
+        m_freeRects.clear();
+        if (m_binWidth > m_padding && m_binHeight > m_padding)
+        {
+            m_freeRects.push_back({ m_padding, m_padding, m_binWidth - m_padding, m_binHeight - m_padding });
+        }
+    }
+}
@@ -0,0 +1,128 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::math_utils
+{
+    // The packers only do the bookkeeping of the rectangle placements (i.e.
+    // no graphics API involved), so the same logic can be shared by all the
+    // atlas-like components (text atlas, icon atlas etc.).
+
+    struct PackedRect
+    {
+        int x = 0, y = 0;
+        int width = 0, height = 0; // after rotation
+
+        // Whether the rectangle is rotated by 90 degrees clockwise.
+        bool rotated = false;
+    };
+
+    struct RectPacker
+    {
+        RectPacker(int binWidth, int binHeight, int padding, bool allowRotation);
+
+        virtual ~RectPacker() = default;
+
+    protected:
+        int m_binWidth = 0, m_binHeight = 0;
+
+        // Reserved between the adjacent rectangles and around the bin border.
+        int m_padding = 0;
+
+        bool m_allowRotation = false;
+
+        long long m_usedArea = 0;
+
+    public:
+        int binWidth() const;
+        int binHeight() const;
+        int padding() const;
+
+        bool allowRotation() const;
+
+        // Returns std::nullopt if there is no enough space left in the bin.
+        // The results only depend on the insertion sequence, i.e. the same
+        // sequence always produces the same placements.
+        virtual Optional<PackedRect> insert(int width, int height) = 0;
+
+        virtual void clear();
+
+        // Ratio of the inserted area to the bin area.
+        float occupancy() const;
+    };
+
+    // Places the rectangles row by row, and a new shelf is opened at the
+    // bottom if none of the existing shelves can hold the incoming one.
+    //
+    // This works best for the items with similar heights (e.g. text lines),
+    // and the insertion is almost free compared with the other heuristics.
+
+    struct ShelfPacker : RectPacker
+    {
+        ShelfPacker(int binWidth = 0, int binHeight = 0, int padding = 0);
+
+    protected:
+        struct Shelf
+        {
+            int y = 0, height = 0;
+            int cursorX = 0; // where to place the next rectangle
+        };
+        std::vector<Shelf> m_shelves = {};
+
+    public:
+        Optional<PackedRect> insert(int width, int height) override;
+
+        void clear() override;
+    };
+
+    // Tracks the top edge of the placed rectangles as a polyline, and puts
+    // the incoming one at the lowest position (bottom-left rule).
+    //
+    // Good for the online packing of the mixed sizes with a small overhead.
+
+    struct SkylinePacker : RectPacker
+    {
+        SkylinePacker(int binWidth = 0, int binHeight = 0, int padding = 0, bool allowRotation = false);
+
+    protected:
+        struct Node
+        {
+            int x = 0, y = 0, width = 0;
+        };
+        std::vector<Node> m_skyline = {};
+
+        // Returns the y where the rectangle can be placed at the node.
+        Optional<int> fitSkyline(size_t index, int width, int height) const;
+
+    public:
+        Optional<PackedRect> insert(int width, int height) override;
+
+        void clear() override;
+    };
+
+    // Keeps all the maximal free rectangles and picks the one that leaves
+    // the shortest side after placing (best-short-side-fit).
+    //
+    // This achieves the highest occupancy of the three, which makes it the
+    // choice for baking the static images (icons, cursors, sprites etc.).
+
+    struct MaxRectsPacker : RectPacker
+    {
+        MaxRectsPacker(int binWidth = 0, int binHeight = 0, int padding = 0, bool allowRotation = false);
+
+    protected:
+        struct FreeRect
+        {
+            int x = 0, y = 0, width = 0, height = 0;
+        };
+        std::vector<FreeRect> m_freeRects = {};
+
+        void splitFreeRects(const FreeRect& used);
+        void pruneFreeRects();
+
+    public:
+        Optional<PackedRect> insert(int width, int height) override;
+
+        void clear() override;
+    };
+}
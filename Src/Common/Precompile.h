@@ -3,8 +3,10 @@
 // Standard Library
 #include <algorithm>
 #include <array>
+#include <deque>
 #include <exception>
 #include <functional>
+#include <future>
 #include <iomanip>
 #include <iterator>
 #include <list>
@@ -12,9 +14,11 @@
 #include <memory>
 #include <optional>
 #include <set>
+#include <span>
 #include <sstream>
 #include <string_view>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <variant>
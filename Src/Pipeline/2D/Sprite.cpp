@@ -5,22 +5,284 @@
 #include "Pipeline/2D/Sprite.h"
 
 #include "Renderer/GraphUtils/Bitmap.h"
+#include "Renderer/GraphUtils/ParamHelper.h"
+#include "Renderer/GraphUtils/PSO.h"
+#include "Renderer/GraphUtils/Shader.h"
+#include "Renderer/GraphUtils/StaticSampler.h"
+#include "Renderer/Renderer.h"
+#include "Renderer/UploadRingBuffer.h"
 
 using namespace d14engine::renderer;
 
 namespace d14engine::pipeline
 {
-    Sprite::Sprite(WstrParam imagePath)
+    Sprite::Sprite(Renderer* rndr, UINT maxTextureCount)
+        :
+        m_maxTextureCount(maxTextureCount)
     {
+        auto device = rndr->d3d12Device();
+
+        // Create descriptor heap.
+        D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+        heapDesc.NumDescriptors = maxTextureCount;
+        heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+        heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+
+        THROW_IF_FAILED(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_srvHeap)));
+
+        m_srvDescSize = rndr->d3d12DeviceInfo().property.descHandleIncrementSize.CBV_SRV_UAV;
+
+        // Create root signature.
+        CD3DX12_ROOT_PARAMETER1 rootParams[2] = {};
+
+        // view data
+        rootParams[0].InitAsConstants(sizeof(ViewData) / sizeof(float), 0);
+        rootParams[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_VERTEX;
+
+        // batch texture
+        CD3DX12_DESCRIPTOR_RANGE1 descRange(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
+        rootParams[1].InitAsDescriptorTable(1, &descRange, D3D12_SHADER_VISIBILITY_PIXEL);
+
+        D3D12_ROOT_SIGNATURE_FLAGS rootSigFlags =
+        (
+            D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT |
+            D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS |
+            D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS |
+            D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS
+        );
+        CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC rootSigDesc = {};
+        rootSigDesc.Init_1_1(NUM_ARR_ARGS(rootParams), 1, &graph_utils::static_sampler::linearClamp(0), rootSigFlags);
+
+        auto& maxVersion = rndr->d3d12DeviceInfo().feature.rootSignature.HighestVersion;
+
+        ComPtr<ID3DBlob> rootSigBlob;
+        THROW_IF_ERROR(D3DX12SerializeVersionedRootSignature(&rootSigDesc, maxVersion, &rootSigBlob, &error));
+        THROW_IF_FAILED(device->CreateRootSignature(0, BLB_PSZ_ARGS(rootSigBlob), IID_PPV_ARGS(&m_rootSignature)));
+
+        // Create pipeline state.
+        auto shaderFileName = rndr->createInfo.binaryPath + L"Shaders/Sprite.hlsl";
+
+        auto vertexShader = graph_utils::shader::compile(shaderFileName, L"VS", L"vs_6_0");
+        auto pixelShader = graph_utils::shader::compile(shaderFileName, L"PS", L"ps_6_0");
+
+        // The quad corners are generated from SV_VertexID,
+        // so there is only the per-instance data in the input layout.
+        D3D12_INPUT_ELEMENT_DESC inputElemDescs[] =
+        {
+            {
+                /* SemanticName         */ "POSITION",
+                /* SemanticIndex        */ 0,
+                /* Format               */ DXGI_FORMAT_R32G32_FLOAT,
+                /* InputSlot            */ 0,
+                /* AlignedByteOffset    */ offsetof(SpriteInstance, position),
+                /* InputSlotClass       */ D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA,
+                /* InstanceDataStepRate */ 1
+            },
+            {
+                /* SemanticName         */ "SCALE",
+                /* SemanticIndex        */ 0,
+                /* Format               */ DXGI_FORMAT_R32G32_FLOAT,
+                /* InputSlot            */ 0,
+                /* AlignedByteOffset    */ offsetof(SpriteInstance, scale),
+                /* InputSlotClass       */ D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA,
+                /* InstanceDataStepRate */ 1
+            },
+            {
+                /* SemanticName         */ "ROTATION",
+                /* SemanticIndex        */ 0,
+                /* Format               */ DXGI_FORMAT_R32_FLOAT,
+                /* InputSlot            */ 0,
+                /* AlignedByteOffset    */ offsetof(SpriteInstance, rotation),
+                /* InputSlotClass       */ D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA,
+                /* InstanceDataStepRate */ 1
+            },
+            {
+                /* SemanticName         */ "COLOR",
+                /* SemanticIndex        */ 0,
+                /* Format               */ DXGI_FORMAT_R8G8B8A8_UNORM,
+                /* InputSlot            */ 0,
+                /* AlignedByteOffset    */ offsetof(SpriteInstance, tint),
+                /* InputSlotClass       */ D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA,
+                /* InstanceDataStepRate */ 1
+            },
+            {
+                /* SemanticName         */ "TEXCOORD",
+                /* SemanticIndex        */ 0,
+                /* Format               */ DXGI_FORMAT_R32G32B32A32_FLOAT,
+                /* InputSlot            */ 0,
+                /* AlignedByteOffset    */ offsetof(SpriteInstance, uvRect),
+                /* InputSlotClass       */ D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA,
+                /* InstanceDataStepRate */ 1
+            }
+        };
+        auto psoDesc = graph_utils::graphicsPipelineStateDescTemplate();
+
+        psoDesc.pRootSignature = m_rootSignature.Get();
+        psoDesc.VS = { BLB_PSZ_ARGS(vertexShader) };
+        psoDesc.PS = { BLB_PSZ_ARGS(pixelShader) };
+        psoDesc.InputLayout = { ARR_NUM_ARGS(inputElemDescs) };
+        psoDesc.DepthStencilState.DepthEnable = FALSE;
+
+        // The sprites may be mirrored with the negative scales.
+        psoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+
+        // premultiplied alpha blending
+        auto& blend = psoDesc.BlendState.RenderTarget[0];
+        blend.BlendEnable = TRUE;
+        blend.SrcBlend = D3D12_BLEND_ONE;
+        blend.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+        blend.BlendOp = D3D12_BLEND_OP_ADD;
+        blend.SrcBlendAlpha = D3D12_BLEND_ONE;
+        blend.DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
+        blend.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+
+        THROW_IF_FAILED(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState)));
+
+        psoDesc.SampleDesc.Count = 4;
+        auto level = rndr->d3d12DeviceInfo().feature.queryMsaaQualityLevel(4);
+        if (level.has_value()) psoDesc.SampleDesc.Quality = level.value();
+
+        THROW_IF_FAILED(device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineStateMsaa)));
+    }
+
+    uint16_t Sprite::loadTexture(Renderer* rndr, WstrParam imagePath)
+    {
+        if (m_textures.size() >= m_maxTextureCount)
+        {
+            THROW_ERROR(L"The sprite texture count exceeds the limit.");
+        }
         auto source = graph_utils::bitmap::load(imagePath);
-        auto data = graph_utils::bitmap::map(source.Get());
+        auto lock = graph_utils::bitmap::map(source.Get());
+
+        Texture texture = {};
+        THROW_IF_FAILED(lock->GetSize(&texture.width, &texture.height));
+
+        UINT stride = 0, byteSize = 0;
+        BYTE* data = nullptr;
+        THROW_IF_FAILED(lock->GetStride(&stride));
+        THROW_IF_FAILED(lock->GetDataPointer(&byteSize, &data));
+
+        auto device = rndr->d3d12Device();
+
+        auto texDesc = CD3DX12_RESOURCE_DESC::Tex2D(
+            DXGI_FORMAT_R8G8B8A8_UNORM, texture.width, texture.height, 1, 1);
+
+        THROW_IF_FAILED(device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+            D3D12_HEAP_FLAG_NONE,
+            &texDesc,
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            nullptr,
+            IID_PPV_ARGS(&texture.resource)));
+
+        ComPtr<ID3D12Resource> intermediate;
+        THROW_IF_FAILED(device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(GetRequiredIntermediateSize(texture.resource.Get(), 0, 1)),
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            nullptr,
+            IID_PPV_ARGS(&intermediate)));
+
+        rndr->beginGpuCommand();
+
+        D3D12_SUBRESOURCE_DATA subresData = {};
+        subresData.pData = data;
+        subresData.RowPitch = stride;
+        subresData.SlicePitch = (LONG_PTR)stride * texture.height;
+
+        UpdateSubresources(rndr->cmdList(), texture.resource.Get(), intermediate.Get(), 0, 0, 1, &subresData);
+
+        auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(
+            texture.resource.Get(),
+            D3D12_RESOURCE_STATE_COPY_DEST,
+            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+        rndr->cmdList()->ResourceBarrier(1, &barrier);
+
+        // The intermediate buffer can be released safely
+        // since the command queue is flushed when ends.
+        rndr->endGpuCommand();
+
+        auto index = (UINT)m_textures.size();
+
+        CD3DX12_CPU_DESCRIPTOR_HANDLE srvHandle(
+            m_srvHeap->GetCPUDescriptorHandleForHeapStart(), index, m_srvDescSize);
+
+        device->CreateShaderResourceView(texture.resource.Get(), nullptr, srvHandle);
+
+        m_textures.push_back(std::move(texture));
+        return (uint16_t)index;
     }
 
-    void Sprite::onRendererUpdateObjectHelper(Renderer* rndr)
+    size_t Sprite::textureCount() const
     {
+        return m_textures.size();
+    }
+
+    void Sprite::onViewResize(UINT viewWidth, UINT viewHeight)
+    {
+        m_viewport.TopLeftX = 0.0f;
+        m_viewport.TopLeftY = 0.0f;
+        m_viewport.Width = (float)viewWidth;
+        m_viewport.Height = (float)viewHeight;
+        m_viewport.MinDepth = 0.0f;
+        m_viewport.MaxDepth = 1.0f;
+
+        m_scissors = { 0, 0, (LONG)viewWidth, (LONG)viewHeight };
+
+        // pixel (0, 0) ---> NDC (-1, +1)
+        // pixel (w, h) ---> NDC (+1, -1)
+        m_viewData.scale[0] = viewWidth > 0 ? +2.0f / viewWidth : 0.0f;
+        m_viewData.scale[1] = viewHeight > 0 ? -2.0f / viewHeight : 0.0f;
+        m_viewData.offset[0] = -1.0f;
+        m_viewData.offset[1] = +1.0f;
+
+        batcher.viewRect = { 0.0f, 0.0f, (float)viewWidth, (float)viewHeight };
     }
 
     void Sprite::onRendererDrawD3d12ObjectHelper(Renderer* rndr)
     {
+        auto instanceCount = batcher.prepare(sprites);
+        if (instanceCount == 0) return;
+
+        // The instances only live in the current render pass.
+        auto chunk = rndr->uploadRing()->allocate(instanceCount * sizeof(SpriteInstance));
+
+        batcher.pack(sprites, (SpriteInstance*)chunk.mapped);
+
+        auto cmdList = rndr->cmdList();
+
+        cmdList->RSSetViewports(1, &m_viewport);
+        cmdList->RSSetScissorRects(1, &m_scissors);
+
+        cmdList->SetGraphicsRootSignature(m_rootSignature.Get());
+        cmdList->SetPipelineState(msaaEnabled ? m_pipelineStateMsaa.Get() : m_pipelineState.Get());
+
+        ID3D12DescriptorHeap* ppHeaps[] = { m_srvHeap.Get() };
+        cmdList->SetDescriptorHeaps(NUM_ARR_ARGS(ppHeaps));
+
+        cmdList->SetGraphicsRoot32BitConstants(0, sizeof(ViewData) / sizeof(float), &m_viewData, 0);
+
+        D3D12_VERTEX_BUFFER_VIEW instanceBufferView = {};
+        instanceBufferView.BufferLocation = chunk.gpuAddress;
+        instanceBufferView.SizeInBytes = (UINT)(instanceCount * sizeof(SpriteInstance));
+        instanceBufferView.StrideInBytes = sizeof(SpriteInstance);
+
+        // Use "TRIANGLESTRIP" since each quad only has 4 corners.
+        cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        cmdList->IASetVertexBuffers(0, 1, &instanceBufferView);
+
+        for (auto& batch : batcher.batches())
+        {
+            if (batch.texture >= m_textures.size()) continue;
+
+            CD3DX12_GPU_DESCRIPTOR_HANDLE srvHandle(
+                m_srvHeap->GetGPUDescriptorHandleForHeapStart(), batch.texture, m_srvDescSize);
+
+            cmdList->SetGraphicsRootDescriptorTable(1, srvHandle);
+
+            cmdList->DrawInstanced(4, batch.instanceCount, 0, batch.instanceOffset);
+        }
     }
 }
@@ -2,15 +2,76 @@
 
 #include "Common/Precompile.h"
 
+#include "Pipeline/2D/SpriteBatch.h"
+
 #include "Renderer/Interfaces/DrawObject.h"
+#include "Renderer/Interfaces/ICamera.h"
 
 namespace d14engine::pipeline
 {
+    // Draws all the sprites in the list with the instancing, i.e. one draw
+    // call for each (layer, texture) batch.  The sprites are placed in the
+    // pixel coordinate of the view, where (0, 0) is the top-left corner.
     struct Sprite : renderer::DrawObject
     {
-        explicit Sprite(WstrParam imagePath);
+        Sprite(renderer::Renderer* rndr, UINT maxTextureCount = 16);
+
+        // prevent std::unique_ptr from generating default deleter
+        virtual ~Sprite() = default;
+
+    public:
+        SpriteList sprites = {};
+
+        SpriteBatcher batcher = {};
+
+        // The PSO must match the sample count of the render target.
+        bool msaaEnabled = false;
+
+    protected:
+        UINT m_maxTextureCount = 0;
+
+        struct Texture
+        {
+            ComPtr<ID3D12Resource> resource = {};
+            UINT width = 0, height = 0;
+        };
+        std::vector<Texture> m_textures = {};
+
+        ComPtr<ID3D12DescriptorHeap> m_srvHeap = {};
+        UINT m_srvDescSize = 0;
+
+    public:
+        // Returns the texture index that can be used in SpriteList::Desc.
+        // The image is expected to be non-premultiplied and will be loaded
+        // as premultiplied to blend correctly with the tint.
+        uint16_t loadTexture(renderer::Renderer* rndr, WstrParam imagePath);
+
+        size_t textureCount() const;
+
+    protected:
+        renderer::ICamera::Viewport m_viewport = {};
+        renderer::ICamera::Scissors m_scissors = {};
+
+        // Root constants that convert the pixel positions to the NDC.
+        struct ViewData
+        {
+            float scale[2] = {};
+            float offset[2] = {};
+        }
+        m_viewData = {};
+
+    public:
+        // The culling rectangle of the batcher is updated as well.
+        void onViewResize(UINT viewWidth, UINT viewHeight);
+
+    protected:
+        ComPtr<ID3D12RootSignature> m_rootSignature = {};
+
+        ComPtr<ID3D12PipelineState> m_pipelineState = {};
+        ComPtr<ID3D12PipelineState> m_pipelineStateMsaa = {};
 
-        void onRendererUpdateObjectHelper(renderer::Renderer* rndr) override;
+    protected:
+        // DrawObject
         void onRendererDrawD3d12ObjectHelper(renderer::Renderer* rndr) override;
     };
 }
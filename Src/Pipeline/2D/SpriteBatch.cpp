@@ -0,0 +1,188 @@
+﻿#include "Common/Precompile.h"
+
+#include "Pipeline/2D/SpriteBatch.h"
+
+#include <cmath>
+
+namespace d14engine::pipeline
+{
+    size_t SpriteList::size() const
+    {
+        return positionX.size();
+    }
+
+    void SpriteList::reserve(size_t count)
+    {
+        positionX.reserve(count);
+        positionY.reserve(count);
+        scaleX.reserve(count);
+        scaleY.reserve(count);
+        rotation.reserve(count);
+        uvRect.reserve(count);
+        tint.reserve(count);
+        layer.reserve(count);
+        texture.reserve(count);
+    }
+
+    size_t SpriteList::push(const Desc& desc)
+    {
+        positionX.push_back(desc.x);
+        positionY.push_back(desc.y);
+        scaleX.push_back(desc.scaleX);
+        scaleY.push_back(desc.scaleY);
+        rotation.push_back(desc.rotation);
+        uvRect.push_back(desc.uvRect);
+        tint.push_back(desc.tint);
+        layer.push_back(desc.layer);
+        texture.push_back(desc.texture);
+
+        return size() - 1;
+    }
+
+    void SpriteList::erase(size_t index)
+    {
+        if (index >= size()) return;
+
+        auto swapAndPop = [&](auto& array)
+        {
+            array[index] = array.back();
+            array.pop_back();
+        };
+        swapAndPop(positionX);
+        swapAndPop(positionY);
+        swapAndPop(scaleX);
+        swapAndPop(scaleY);
+        swapAndPop(rotation);
+        swapAndPop(uvRect);
+        swapAndPop(tint);
+        swapAndPop(layer);
+        swapAndPop(texture);
+    }
+
+    void SpriteList::clear()
+    {
+        positionX.clear();
+        positionY.clear();
+        scaleX.clear();
+        scaleY.clear();
+        rotation.clear();
+        uvRect.clear();
+        tint.clear();
+        layer.clear();
+        texture.clear();
+    }
+
+    void SpriteBatcher::radixSort()
+    {
+        auto count = m_keys.size();
+
+        m_keysTemp.resize(count);
+        m_indicesTemp.resize(count);
+
+        for (uint32_t shift = 0; shift < 32; shift += 8)
+        {
+            size_t histogram[256] = {};
+            for (auto key : m_keys)
+            {
+                ++histogram[(key >> shift) & 0xff];
+            }
+            // Skip the pass if all the keys share the same digit, which is
+            // common since there are usually only a few layers and textures.
+            if (histogram[(m_keys.front() >> shift) & 0xff] == count) continue;
+
+            size_t offset = 0;
+            for (auto& bucket : histogram)
+            {
+                auto bucketSize = bucket;
+                bucket = offset;
+                offset += bucketSize;
+            }
+            for (size_t i = 0; i < count; ++i)
+            {
+                auto dst = histogram[(m_keys[i] >> shift) & 0xff]++;
+
+                m_keysTemp[dst] = m_keys[i];
+                m_indicesTemp[dst] = m_indices[i];
+            }
+            m_keys.swap(m_keysTemp);
+            m_indices.swap(m_indicesTemp);
+        }
+    }
+
+    size_t SpriteBatcher::prepare(const SpriteList& sprites)
+    {
+        m_keys.clear();
+        m_indices.clear();
+
+        auto count = sprites.size();
+
+        m_keys.reserve(count);
+        m_indices.reserve(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (viewRect.has_value())
+            {
+                // Use the bounding circle to ignore the rotation.
+                auto& rect = viewRect.value();
+
+                auto sx = sprites.scaleX[i], sy = sprites.scaleY[i];
+                auto radius = 0.5f * std::sqrt(sx * sx + sy * sy);
+
+                auto x = sprites.positionX[i], y = sprites.positionY[i];
+
+                if (x + radius < rect.left || x - radius > rect.right ||
+                    y + radius < rect.top || y - radius > rect.bottom) continue;
+            }
+            m_keys.push_back((uint32_t)sprites.layer[i] << 16 | sprites.texture[i]);
+            m_indices.push_back((uint32_t)i);
+        }
+        if (!m_keys.empty()) radixSort();
+
+        return m_keys.size();
+    }
+
+    size_t SpriteBatcher::visibleCount() const
+    {
+        return m_keys.size();
+    }
+
+    void SpriteBatcher::pack(const SpriteList& sprites, SpriteInstance* dst)
+    {
+        m_batches.clear();
+
+        for (size_t i = 0; i < m_keys.size(); ++i)
+        {
+            auto index = m_indices[i];
+
+            auto& instance = dst[i];
+
+            instance.position[0] = sprites.positionX[index];
+            instance.position[1] = sprites.positionY[index];
+            instance.scale[0] = sprites.scaleX[index];
+            instance.scale[1] = sprites.scaleY[index];
+            instance.rotation = sprites.rotation[index];
+            instance.tint = sprites.tint[index];
+
+            auto& uvRect = sprites.uvRect[index];
+            std::copy(uvRect.begin(), uvRect.end(), instance.uvRect);
+
+            if (i == 0 || m_keys[i] != m_keys[i - 1])
+            {
+                SpriteDrawBatch batch = {};
+
+                batch.texture = (uint16_t)(m_keys[i] & 0xffff);
+                batch.layer = (uint16_t)(m_keys[i] >> 16);
+                batch.instanceOffset = (uint32_t)i;
+
+                m_batches.push_back(batch);
+            }
+            ++m_batches.back().instanceCount;
+        }
+    }
+
+    const std::vector<SpriteDrawBatch>& SpriteBatcher::batches() const
+    {
+        return m_batches;
+    }
+}
@@ -0,0 +1,112 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::pipeline
+{
+    // The CPU side of the sprite pipeline (storage, culling, sorting and
+    // instance packing) lives here and only uses the standard library, so
+    // it can be profiled without a graphics device.
+
+    // Stores the sprites in the structure-of-arrays layout, which keeps the
+    // culling pass (only touches the positions and scales) cache friendly.
+    struct SpriteList
+    {
+        struct Desc
+        {
+            float x = 0.0f, y = 0.0f; // center, in pixels
+            float scaleX = 1.0f, scaleY = 1.0f; // size, in pixels
+            float rotation = 0.0f; // clockwise, in radians
+
+            std::array<float, 4> uvRect = { 0.0f, 0.0f, 1.0f, 1.0f }; // left, top, right, bottom
+
+            uint32_t tint = 0xffffffff; // R8G8B8A8, R at the lowest byte
+
+            // Larger layers are drawn later, i.e. on the top.
+            uint16_t layer = 0;
+
+            uint16_t texture = 0;
+        };
+
+        std::vector<float> positionX = {}, positionY = {};
+        std::vector<float> scaleX = {}, scaleY = {};
+        std::vector<float> rotation = {};
+
+        std::vector<std::array<float, 4>> uvRect = {};
+
+        std::vector<uint32_t> tint = {};
+
+        std::vector<uint16_t> layer = {};
+        std::vector<uint16_t> texture = {};
+
+        size_t size() const;
+
+        void reserve(size_t count);
+
+        // Returns the index of the new sprite.
+        size_t push(const Desc& desc);
+
+        // The last sprite is moved to the erased position (swap-and-pop),
+        // so the indices of the other sprites are kept unchanged.
+        void erase(size_t index);
+
+        void clear();
+    };
+
+    // Matches the per-instance input layout of Sprite.hlsl.
+    struct SpriteInstance
+    {
+        float position[2] = {};
+        float scale[2] = {};
+        float rotation = 0.0f;
+        uint32_t tint = 0;
+        float uvRect[4] = {};
+    };
+
+    // The instances in [instanceOffset, instanceOffset + instanceCount)
+    // share the same texture, so they can be drawn with one instanced call.
+    struct SpriteDrawBatch
+    {
+        uint16_t texture = 0;
+        uint16_t layer = 0;
+
+        uint32_t instanceOffset = 0;
+        uint32_t instanceCount = 0;
+    };
+
+    struct SpriteBatcher
+    {
+        // The sprites that do not intersect with this rectangle are culled.
+        struct ViewRect
+        {
+            float left = 0.0f, top = 0.0f;
+            float right = 0.0f, bottom = 0.0f;
+        };
+        Optional<ViewRect> viewRect = std::nullopt;
+
+    protected:
+        // The sort key is (layer << 16 | texture), so the layers keep the
+        // painter's order while the textures are grouped inside each layer.
+        std::vector<uint32_t> m_keys = {}, m_keysTemp = {};
+        std::vector<uint32_t> m_indices = {}, m_indicesTemp = {};
+
+        std::vector<SpriteDrawBatch> m_batches = {};
+
+        // LSD radix sort with 8-bit digits, which is stable so the sprites
+        // with the same key are drawn in the pushed order.
+        void radixSort();
+
+    public:
+        // Culls and sorts the sprites; returns the visible sprite count,
+        // i.e. how many instances must be reserved for the packing.
+        size_t prepare(const SpriteList& sprites);
+
+        size_t visibleCount() const;
+
+        // Writes the visible sprites into the destination (e.g. a mapped
+        // upload buffer) in the sorted order and generates the batches.
+        void pack(const SpriteList& sprites, SpriteInstance* dst);
+
+        const std::vector<SpriteDrawBatch>& batches() const;
+    };
+}
@@ -2,19 +2,11 @@
 
 #include "Renderer/Camera.h"
 
-#include "Renderer/GpuBuffer.h"
 #include "Renderer/Renderer.h"
+#include "Renderer/UploadRingBuffer.h"
 
 namespace d14engine::renderer
 {
-    Camera::Camera(ID3D12Device* device)
-    {
-        for (auto& buffer : m_buffers)
-        {
-            buffer = std::make_unique<ConstantBuffer>(device, 1, sizeof(m_data));
-        }
-    }
-
     Camera::Viewport Camera::viewport() const
     {
         return m_viewport;
@@ -45,13 +37,17 @@ namespace d14engine::renderer
         updateProjMatrix();
     }
 
+    math_utils::Frustum Camera::frustum() const
+    {
+        XMFLOAT4X4 viewProj = {};
+        XMStoreFloat4x4(&viewProj, XMMatrixMultiply(viewMatrix(), projMatrix()));
+
+        return math_utils::Frustum::fromViewProj(viewProj.m);
+    }
+
     void Camera::onRendererUpdateObjectHelper(Renderer* rndr)
     {
-        if (dirtyFrameCount > 0)
-        {
-            --dirtyFrameCount;
-            m_buffers.at(rndr->currFrameIndex())->copyData(0, &m_data, sizeof(m_data));
-        }
+        if (dirtyFrameCount > 0) --dirtyFrameCount;
     }
 
     void Camera::onRendererDrawD3d12ObjectHelper(Renderer* rndr)
@@ -59,10 +55,10 @@ namespace d14engine::renderer
         rndr->cmdList()->RSSetViewports(1, &m_viewport);
         rndr->cmdList()->RSSetScissorRects(1, &m_scissors);
 
-        auto buffer = m_buffers.at(rndr->currFrameIndex())->resource();
+        auto chunk = rndr->uploadRing()->allocate(sizeof(m_data));
+        memcpy(chunk.mapped, &m_data, sizeof(m_data));
 
-        rndr->cmdList()->SetGraphicsRootConstantBufferView(
-            rootParamIndex, buffer->GetGPUVirtualAddress());
+        rndr->cmdList()->SetGraphicsRootConstantBufferView(rootParamIndex, chunk.gpuAddress);
     }
 
     float Camera::getAspectRatio() const
@@ -97,9 +93,4 @@ namespace d14engine::renderer
     {
         XMStoreFloat4x4(&m_data.projMatrix, XMMatrixPerspectiveFovLH(fovAngleY, getAspectRatio(), nearZ, farZ));
     }
-
-    const Camera::BufferArray& Camera::buffers() const
-    {
-        return m_buffers;
-    }
 }
@@ -10,12 +10,11 @@
 
 namespace d14engine::renderer
 {
-    struct ConstantBuffer;
     struct Renderer;
 
     struct Camera : ICamera, DrawObject
     {
-        explicit Camera(ID3D12Device* device);
+        Camera() = default;
 
         // prevent std::unique_ptr from generating default deleter
         virtual ~Camera() = default;
@@ -26,8 +25,13 @@ namespace d14engine::renderer
 
         void onViewResize(UINT viewWidth, UINT viewHeight) override;
 
+        math_utils::Frustum frustum() const override;
+
         void onRendererUpdateObjectHelper(Renderer* rndr) override;
 
+        // The data is copied to a chunk of the renderer's upload ring in
+        // each render pass, which is much cheaper than keeping a constant
+        // buffer for each frame resource.
         void onRendererDrawD3d12ObjectHelper(Renderer* rndr) override;
 
     public:
@@ -68,15 +72,8 @@ namespace d14engine::renderer
     public:
         UINT rootParamIndex = 0;
 
-        // Indicates how many buffers need to be updated in the subsequent render passes.
+        // Counts down in the subsequent render passes after the camera is
+        // changed, which can be used to observe the changes.
         UINT dirtyFrameCount = FrameResource::g_bufferCount;
-
-    protected:
-        using BufferArray = FrameResource::Array<UniquePtr<ConstantBuffer>>;
-
-        BufferArray m_buffers = {};
-
-    public:
-        const BufferArray& buffers() const;
     };
 }
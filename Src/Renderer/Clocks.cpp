@@ -0,0 +1,70 @@
+﻿#include "Common/Precompile.h"
+
+#include "Renderer/Clocks.h"
+
+namespace d14engine::renderer
+{
+    RealClock::RealClock() : m_origin(std::chrono::steady_clock::now()) { }
+
+    double RealClock::nowSecs()
+    {
+        using namespace std::chrono;
+        return duration<double>(steady_clock::now() - m_origin).count();
+    }
+
+    ManualClock::ManualClock(double secs) : m_secs(secs) { }
+
+    double ManualClock::nowSecs()
+    {
+        return m_secs;
+    }
+
+    void ManualClock::setSecs(double value)
+    {
+        m_secs = value;
+    }
+
+    void ManualClock::advance(double deltaSecs)
+    {
+        m_secs += deltaSecs;
+    }
+
+    ScaledClock::ScaledClock(ShrdPtrParam<IClock> source, double scale)
+        : m_source(source), m_scale(scale)
+    {
+        m_baseSourceSecs = m_source->nowSecs();
+    }
+
+    double ScaledClock::nowSecs()
+    {
+        return m_baseScaledSecs + (m_source->nowSecs() - m_baseSourceSecs) * m_scale;
+    }
+
+    double ScaledClock::scale() const
+    {
+        return m_scale;
+    }
+
+    void ScaledClock::setScale(double value)
+    {
+        // Read the source once since some clocks advance on each read.
+        double sourceSecs = m_source->nowSecs();
+
+        m_baseScaledSecs += (sourceSecs - m_baseSourceSecs) * m_scale;
+        m_baseSourceSecs = sourceSecs;
+
+        m_scale = value;
+    }
+
+    FixedStepClock::FixedStepClock(double stepSecs) : m_stepSecs(stepSecs) { }
+
+    double FixedStepClock::nowSecs()
+    {
+        return (m_stepCount++) * m_stepSecs;
+    }
+
+    double FixedStepClock::stepSecs() const
+    {
+        return m_stepSecs;
+    }
+}
@@ -0,0 +1,79 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include "Renderer/Interfaces/IClock.h"
+
+#include <chrono>
+
+namespace d14engine::renderer
+{
+    // Reads the system steady clock, which is the default of TickTimer.
+    struct RealClock : IClock
+    {
+        RealClock();
+
+    private:
+        std::chrono::steady_clock::time_point m_origin = {};
+
+    public:
+        double nowSecs() override;
+    };
+
+    // Only advances when told to, e.g. stepping the frames in the tests.
+    struct ManualClock : IClock
+    {
+        explicit ManualClock(double secs = 0.0);
+
+    private:
+        double m_secs = 0.0;
+
+    public:
+        double nowSecs() override;
+
+        void setSecs(double value);
+        void advance(double deltaSecs);
+    };
+
+    // Speeds up or slows down the source clock (0 freezes it), which must not
+    // be null.  Changing the scale never makes the time jump since the time
+    // until then is kept.
+    struct ScaledClock : IClock
+    {
+        explicit ScaledClock(ShrdPtrParam<IClock> source, double scale = 1.0);
+
+    private:
+        SharedPtr<IClock> m_source = {};
+
+        double m_scale = 1.0;
+
+        double m_baseSourceSecs = 0.0;
+        double m_baseScaledSecs = 0.0;
+
+    public:
+        double nowSecs() override;
+
+        double scale() const;
+        void setScale(double value);
+    };
+
+    // Advances by the step after each read, so every frame of TickTimer lasts
+    // exactly one step however long it actually takes, which lets the tests
+    // and benchmarks run the animations as fast as possible.
+    struct FixedStepClock : IClock
+    {
+        explicit FixedStepClock(double stepSecs = 1.0 / 60.0);
+
+    private:
+        double m_stepSecs = 0.0;
+
+        // Counts the steps instead of accumulating the seconds to avoid the
+        // rounding errors piling up in a long simulation.
+        uint64_t m_stepCount = 0;
+
+    public:
+        double nowSecs() override;
+
+        double stepSecs() const;
+    };
+}
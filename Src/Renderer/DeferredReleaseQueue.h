@@ -0,0 +1,97 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::renderer
+{
+    // Keeps the replaced resources alive until the GPU has finished all the
+    // frames that may still use them, so that replacing a resource does not
+    // have to wait for the GPU.  Only the standard library is used (with
+    // the fence values passed in), so it can be tested without a device.
+    //
+    // Works in the same way as RingAllocator: finishFrame tags the objects
+    // pushed since the last call with the fence value of the frame, and
+    // retire releases the frames whose fences have completed.  The objects
+    // pushed after the last finishFrame are never released by retire.
+    template<typename T>
+    struct DeferredReleaseQueue
+    {
+    protected:
+        std::vector<T> m_untaggedObjects = {};
+
+        struct FrameObjects
+        {
+            uint64_t fenceValue = 0;
+
+            std::vector<T> objects = {};
+        };
+        std::deque<FrameObjects> m_frames = {};
+
+    public:
+        void push(T object)
+        {
+            m_untaggedObjects.push_back(std::move(object));
+        }
+
+        // Call this after signaling the fence of the frame.
+        void finishFrame(uint64_t fenceValue)
+        {
+            if (m_untaggedObjects.empty()) return;
+
+            // The fence values are increasing, so the frames can be merged
+            // if finishFrame is called more than once with the same value.
+            if (!m_frames.empty() && m_frames.back().fenceValue == fenceValue)
+            {
+                auto& objects = m_frames.back().objects;
+
+                std::move(m_untaggedObjects.begin(), m_untaggedObjects.end(), std::back_inserter(objects));
+                m_untaggedObjects.clear();
+            }
+            else m_frames.push_back({ fenceValue, std::move(m_untaggedObjects) });
+
+            m_untaggedObjects.clear();
+        }
+
+        // Call this with ID3D12Fence::GetCompletedValue (or similar), which
+        // returns how many objects are released.
+        size_t retire(uint64_t completedFenceValue)
+        {
+            size_t count = 0;
+            while (!m_frames.empty() && m_frames.front().fenceValue <= completedFenceValue)
+            {
+                // Release after popping in case a destructor pushes another.
+                auto objects = std::move(m_frames.front().objects);
+                m_frames.pop_front();
+
+                count += objects.size();
+            }
+            return count;
+        }
+
+        // Call this only when the GPU is idle (e.g. the device is replaced).
+        void releaseAll()
+        {
+            // Release after moving out in case a destructor pushes another.
+            auto untaggedObjects = std::move(m_untaggedObjects);
+            auto frames = std::move(m_frames);
+
+            m_untaggedObjects.clear();
+            m_frames.clear();
+        }
+
+        size_t pendingObjectCount() const
+        {
+            size_t count = m_untaggedObjects.size();
+            for (auto& frame : m_frames)
+            {
+                count += frame.objects.size();
+            }
+            return count;
+        }
+
+        size_t pendingFrameCount() const
+        {
+            return m_frames.size();
+        }
+    };
+}
@@ -0,0 +1,81 @@
+﻿#include "Common/Precompile.h"
+
+#include "Renderer/DrawList.h"
+
+namespace d14engine::renderer
+{
+    void DrawList::build(const DrawObjectSet& objects, OptParam<math_utils::Frustum> frustum)
+    {
+        m_objects.clear();
+        m_candidates.clear();
+        m_boundedIndices.clear();
+        m_bounds.clear();
+
+        for (auto& obj : objects)
+        {
+            if (!obj->isD3d12ObjectVisible()) continue;
+
+            if (frustum.has_value())
+            {
+                if (auto bounds = obj->d3d12ObjectBounds())
+                {
+                    m_boundedIndices.push_back(m_candidates.size());
+                    m_bounds.push(bounds.value());
+                }
+            }
+            m_candidates.push_back(obj.get());
+        }
+        statistics.visibleCount = m_candidates.size();
+        statistics.culledCount = 0;
+
+        auto boundedCount = m_bounds.size();
+        if (boundedCount == 0)
+        {
+            m_objects.swap(m_candidates);
+            return;
+        }
+        m_cullingResults.resize(boundedCount);
+
+        size_t threadCount = std::thread::hardware_concurrency();
+
+        if (boundedCount >= parallelCullingThreshold && threadCount > 1)
+        {
+            if (m_cullingWorkers == nullptr)
+            {
+                // The calling thread takes the chunks too.
+                m_cullingWorkers = std::make_unique<WorkerPool>(threadCount - 1);
+            }
+            auto chunkSize = (boundedCount + threadCount - 1) / threadCount;
+            auto chunkCount = (boundedCount + chunkSize - 1) / chunkSize;
+
+            m_cullingWorkers->run(chunkCount, [&](size_t index)
+            {
+                auto offset = index * chunkSize;
+                auto count = std::min(chunkSize, boundedCount - offset);
+
+                math_utils::cullAABBs(frustum.value(), m_bounds, offset, count, m_cullingResults.data());
+            });
+        }
+        else math_utils::cullAABBs(frustum.value(), m_bounds, 0, boundedCount, m_cullingResults.data());
+
+        // Merge the culling results back in the original order.
+        size_t boundedIndex = 0;
+        for (size_t i = 0; i < m_candidates.size(); ++i)
+        {
+            if (boundedIndex < boundedCount && m_boundedIndices[boundedIndex] == i)
+            {
+                if (!m_cullingResults[boundedIndex++])
+                {
+                    ++statistics.culledCount;
+                    continue;
+                }
+            }
+            m_objects.push_back(m_candidates[i]);
+        }
+    }
+
+    const std::vector<IDrawObject*>& DrawList::objects() const
+    {
+        return m_objects;
+    }
+}
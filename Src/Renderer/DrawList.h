@@ -0,0 +1,58 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include "Common/MathUtils/Culling.h"
+
+#include "Renderer/Interfaces/IDrawObject.h"
+#include "Renderer/WorkerPool.h"
+
+namespace d14engine::renderer
+{
+    // Collects the objects of a draw layer that survive the visibility
+    // check and the frustum culling, so the draw loop only visits what is
+    // really drawn.  The storage is reused across frames to avoid the
+    // per-frame allocations.
+    struct DrawList
+    {
+        using DrawObjectSet = ISortable<IDrawObject>::ShrdPrioritySet;
+
+        // The culling pass is split into chunks and run on the persistent
+        // culling workers when the bounded object count reaches this.
+        //
+        // cullAABBs takes about 4 ns per box, so 16384 boxes take ~65 us on
+        // one thread, which is well above the cost of waking the workers (a
+        // few microseconds per run), while the smaller sets finish before
+        // the workers would even start.  Set this to SIZE_MAX to never split.
+        size_t parallelCullingThreshold = 16384;
+
+        void build(const DrawObjectSet& objects, OptParam<math_utils::Frustum> frustum);
+
+        // In the same order as the draw object set.
+        const std::vector<IDrawObject*>& objects() const;
+
+        struct Statistics
+        {
+            size_t visibleCount = 0; // passed isD3d12ObjectVisible
+            size_t culledCount = 0; // rejected by the frustum
+        }
+        statistics = {};
+
+    protected:
+        std::vector<IDrawObject*> m_objects = {};
+
+        std::vector<IDrawObject*> m_candidates = {};
+
+        // Indices (in m_candidates) of the objects with bounds.
+        std::vector<size_t> m_boundedIndices = {};
+
+        math_utils::AABBArray m_bounds = {};
+
+        std::vector<uint8_t> m_cullingResults = {};
+
+        // Created the first time the parallel pass is needed, and then kept
+        // for the following frames.  Null if there is only one hardware
+        // thread, in which case the pass always runs on the calling thread.
+        UniquePtr<WorkerPool> m_cullingWorkers = {};
+    };
+}
@@ -0,0 +1,286 @@
+﻿#include "Common/Precompile.h"
+
+#include "Renderer/FrameWriter.h"
+
+#include "Common/ImageUtils/ImageEncoder.h"
+
+#include <cstring>
+
+namespace d14engine::renderer
+{
+    FrameWriter::FrameWriter(const Settings& settings)
+        : m_settings(settings)
+    {
+        std::error_code ec = {};
+        std::filesystem::create_directories(m_settings.directory, ec);
+
+        if (m_settings.format == Format::RawStream)
+        {
+            auto path = std::filesystem::path(m_settings.directory) / (m_settings.prefix + L".raw");
+            m_rawStream.open(path, std::ios::binary | std::ios::trunc);
+
+            m_failed = !m_rawStream.is_open();
+        }
+        m_worker = std::thread([this] { work(); });
+    }
+
+    FrameWriter::~FrameWriter()
+    {
+        finish();
+    }
+
+    void FrameWriter::work()
+    {
+        while (true)
+        {
+            Frame frame = {};
+            bool failed = false;
+            {
+                std::unique_lock lock(m_mutex);
+                m_frameQueued.wait(lock, [this]
+                {
+                    return !m_frames.empty() || (m_finishing && m_copyingFrameCount == 0);
+                });
+                if (m_frames.empty()) break; // finished
+
+                frame = std::move(m_frames.front());
+                failed = m_failed;
+            }
+            // Write without holding the lock, so pushing is never blocked
+            // by the I/O, and release the bytes only after written.
+            bool succeeded = !failed && writeFrame(frame);
+            {
+                std::unique_lock lock(m_mutex);
+
+                m_frames.pop_front();
+                m_queuedBytes -= frame.pixels.size();
+
+                if (succeeded) ++m_writtenFrameCount;
+                else
+                {
+                    m_failed = true;
+                    ++m_droppedFrameCount;
+                }
+            }
+            m_frameWritten.notify_all();
+        }
+    }
+
+    bool FrameWriter::writeFrame(const Frame& frame)
+    {
+        switch (m_settings.format)
+        {
+        case Format::BmpSequence:
+        case Format::PngSequence:
+        case Format::QoiSequence:
+        {
+            wchar_t number[16] = {};
+            swprintf(number, std::size(number), L"%06u", frame.index);
+
+            auto extension = L".bmp";
+            if (m_settings.format == Format::PngSequence) extension = L".png";
+            else if (m_settings.format == Format::QoiSequence) extension = L".qoi";
+
+            auto path = std::filesystem::path(m_settings.directory) / (m_settings.prefix + number + extension);
+
+            if (m_settings.format == Format::BmpSequence) return writeBmp(frame, path);
+            else return writeEncoded(frame, path);
+        }
+        case Format::RawStream: return writeRaw(frame);
+
+        default: return false;
+        }
+    }
+
+    static void appendUint32LE(std::vector<uint8_t>& bytes, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            bytes.push_back((uint8_t)(value >> (8 * i)));
+        }
+    }
+
+    bool FrameWriter::writeBmp(const Frame& frame, const std::filesystem::path& path)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+
+        constexpr uint32_t headerSize = 14 + 40;
+        auto pixelBytes = (uint32_t)frame.pixels.size();
+
+        std::vector<uint8_t> header = {};
+        header.reserve(headerSize);
+
+        // BITMAPFILEHEADER
+        header.push_back('B'); header.push_back('M');
+        appendUint32LE(header, headerSize + pixelBytes);
+        appendUint32LE(header, 0); // reserved
+        appendUint32LE(header, headerSize);
+
+        // BITMAPINFOHEADER (32 bpp, BI_RGB, top-down)
+        appendUint32LE(header, 40);
+        appendUint32LE(header, frame.width);
+        appendUint32LE(header, (uint32_t)-(int32_t)frame.height);
+        appendUint32LE(header, 1 | (32 << 16)); // planes, bit count
+        appendUint32LE(header, 0); // compression
+        appendUint32LE(header, pixelBytes);
+        appendUint32LE(header, 2835); // 72 DPI
+        appendUint32LE(header, 2835);
+        appendUint32LE(header, 0); // palette
+        appendUint32LE(header, 0);
+
+        file.write((const char*)header.data(), header.size());
+
+        // BMP stores BGRA, and 32-bit rows need no padding.
+        std::vector<uint8_t> row(frame.width * 4);
+        for (uint32_t y = 0; y < frame.height; ++y)
+        {
+            auto src = frame.pixels.data() + (size_t)y * row.size();
+            for (size_t x = 0; x < row.size(); x += 4)
+            {
+                row[x + 0] = src[x + 2];
+                row[x + 1] = src[x + 1];
+                row[x + 2] = src[x + 0];
+                row[x + 3] = src[x + 3];
+            }
+            file.write((const char*)row.data(), row.size());
+        }
+        return file.good();
+    }
+
+    bool FrameWriter::writeEncoded(const Frame& frame, const std::filesystem::path& path)
+    {
+        image_utils::ImageView image = {};
+        image.data = frame.pixels.data();
+        image.width = frame.width;
+        image.height = frame.height;
+        image.rowPitch = (size_t)frame.width * 4;
+
+        std::vector<uint8_t> bytes = {};
+        if (m_settings.format == Format::PngSequence)
+        {
+            image_utils::PngSettings settings = {};
+            settings.level = m_settings.pngLevel;
+
+            bytes = image_utils::encodePng(image, settings);
+        }
+        else bytes = image_utils::encodeQoi(image);
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+
+        file.write((const char*)bytes.data(), bytes.size());
+
+        return file.good();
+    }
+
+    bool FrameWriter::writeRaw(const Frame& frame)
+    {
+        std::vector<uint8_t> header = {};
+        appendUint32LE(header, frame.width);
+        appendUint32LE(header, frame.height);
+        appendUint32LE(header, frame.index);
+
+        m_rawStream.write((const char*)header.data(), header.size());
+        m_rawStream.write((const char*)frame.pixels.data(), frame.pixels.size());
+
+        return m_rawStream.good();
+    }
+
+    const FrameWriter::Settings& FrameWriter::settings() const
+    {
+        return m_settings;
+    }
+
+    bool FrameWriter::push(uint32_t width, uint32_t height, const uint8_t* pixels, size_t rowPitch)
+    {
+        size_t rowBytes = (size_t)width * 4;
+        size_t byteSize = rowBytes * height;
+
+        // The frames are numbered in the pushing order including the dropped
+        // ones, so the gaps show where the frames are dropped.
+        uint32_t frameIndex = 0;
+        {
+            std::unique_lock lock(m_mutex);
+
+            auto hasRoom = [&]
+            {
+                // A frame larger than the limit is accepted when the queue
+                // is empty, otherwise it would never be written.
+                return m_queuedBytes == 0 || m_queuedBytes + byteSize <= m_settings.maxQueuedBytes;
+            };
+            if (m_settings.blockWhenFull)
+            {
+                m_frameWritten.wait(lock, [&] { return hasRoom() || m_failed || m_finishing; });
+            }
+            if (!hasRoom() || m_failed || m_finishing)
+            {
+                ++m_droppedFrameCount;
+                ++m_nextFrameIndex;
+                return false;
+            }
+            frameIndex = m_nextFrameIndex++;
+
+            m_queuedBytes += byteSize;
+            ++m_copyingFrameCount;
+        }
+        // Copy without holding the lock since the bytes have been reserved.
+        Frame frame = {};
+        frame.index = frameIndex;
+        frame.width = width;
+        frame.height = height;
+        frame.pixels.resize(byteSize);
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            memcpy(frame.pixels.data() + y * rowBytes, pixels + y * rowPitch, rowBytes);
+        }
+        {
+            std::unique_lock lock(m_mutex);
+
+            --m_copyingFrameCount;
+            m_frames.push_back(std::move(frame));
+        }
+        m_frameQueued.notify_one();
+
+        return true;
+    }
+
+    void FrameWriter::finish()
+    {
+        {
+            std::unique_lock lock(m_mutex);
+            m_finishing = true;
+        }
+        m_frameQueued.notify_all();
+        m_frameWritten.notify_all();
+
+        if (m_worker.joinable()) m_worker.join();
+
+        if (m_rawStream.is_open()) m_rawStream.close();
+    }
+
+    size_t FrameWriter::queuedBytes() const
+    {
+        std::unique_lock lock(m_mutex);
+        return m_queuedBytes;
+    }
+
+    size_t FrameWriter::writtenFrameCount() const
+    {
+        std::unique_lock lock(m_mutex);
+        return m_writtenFrameCount;
+    }
+
+    size_t FrameWriter::droppedFrameCount() const
+    {
+        std::unique_lock lock(m_mutex);
+        return m_droppedFrameCount;
+    }
+
+    bool FrameWriter::failed() const
+    {
+        std::unique_lock lock(m_mutex);
+        return m_failed;
+    }
+}
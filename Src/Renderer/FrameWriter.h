@@ -0,0 +1,126 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include "Common/CppLangUtils/NonCopyable.h"
+
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+namespace d14engine::renderer
+{
+    // Writes the captured frames (RGBA8) to the disk on a worker thread, so
+    // that recording a session never blocks the render loop on the I/O.
+    // Only the standard library is used, so it can be tested anywhere.
+    //
+    // The queued frames take at most maxQueuedBytes; the frames pushed
+    // beyond that are dropped (and counted) unless blockWhenFull is set.
+    struct FrameWriter : cpp_lang_utils::NonCopyable
+    {
+        enum class Format
+        {
+            // <directory>/<prefix>000000.bmp, <prefix>000001.bmp, ...
+            BmpSequence,
+
+            // <directory>/<prefix>000000.png, ... (see pngLevel)
+            PngSequence,
+
+            // <directory>/<prefix>000000.qoi, ..., which is much faster to
+            // encode than PNG with a somewhat larger size.
+            QoiSequence,
+
+            // <directory>/<prefix>.raw, where each frame is a 12-byte header
+            // (width, height and frame index in uint32 little-endian) and
+            // then width * height * 4 bytes of RGBA.
+            RawStream
+        };
+
+        struct Settings
+        {
+            Wstring directory = L".";
+            Wstring prefix = L"frame";
+
+            Format format = Format::BmpSequence;
+
+            // The compression level of PngSequence (see image_utils::PngSettings).
+            int pngLevel = 1;
+
+            size_t maxQueuedBytes = 256 * 1024 * 1024;
+
+            bool blockWhenFull = false;
+        };
+
+        explicit FrameWriter(const Settings& settings);
+
+        virtual ~FrameWriter();
+
+    protected:
+        Settings m_settings = {};
+
+        struct Frame
+        {
+            uint32_t index = 0;
+
+            uint32_t width = 0, height = 0;
+
+            std::vector<uint8_t> pixels = {};
+        };
+        std::deque<Frame> m_frames = {};
+
+        size_t m_queuedBytes = 0;
+
+        // The frames being copied into the queue, which the worker waits for
+        // before finishing.
+        size_t m_copyingFrameCount = 0;
+
+        uint32_t m_nextFrameIndex = 0;
+
+        size_t m_writtenFrameCount = 0;
+        size_t m_droppedFrameCount = 0;
+
+        bool m_finishing = false;
+        bool m_failed = false;
+
+        // Guards all the members above after the worker starts.
+        mutable std::mutex m_mutex = {};
+
+        std::condition_variable m_frameQueued = {};
+        std::condition_variable m_frameWritten = {};
+
+        std::ofstream m_rawStream = {};
+
+        std::thread m_worker = {};
+
+        void work();
+
+        bool writeFrame(const Frame& frame);
+
+        bool writeBmp(const Frame& frame, const std::filesystem::path& path);
+
+        bool writeEncoded(const Frame& frame, const std::filesystem::path& path);
+
+        bool writeRaw(const Frame& frame);
+
+    public:
+        const Settings& settings() const;
+
+        // Copies the pixels (rowPitch bytes per row) into the queue, which
+        // returns false if the frame is dropped (the queue is full or the
+        // writer has failed/finished).
+        bool push(uint32_t width, uint32_t height, const uint8_t* pixels, size_t rowPitch);
+
+        // Writes all the queued frames and stops the worker, which is also
+        // called when destroyed.
+        void finish();
+
+        size_t queuedBytes() const;
+
+        size_t writtenFrameCount() const;
+        size_t droppedFrameCount() const;
+
+        // The writing stops at the first I/O error.
+        bool failed() const;
+    };
+}
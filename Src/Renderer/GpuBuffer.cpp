@@ -6,10 +6,11 @@
 
 #include "Renderer/GraphUtils/Barrier.h"
 #include "Renderer/GraphUtils/ParamHelper.h"
+#include "Renderer/UploadRingBuffer.h"
 
 namespace d14engine::renderer
 {
-    DefaultBuffer::DefaultBuffer(ID3D12Device* device, UINT64 byteSize)
+    DefaultBuffer::DefaultBuffer(ID3D12Device* device, UINT64 byteSize, bool createIntermediate)
     {
         THROW_IF_FAILED(device->CreateCommittedResource(
             &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
@@ -19,6 +20,8 @@ namespace d14engine::renderer
             nullptr,
             IID_PPV_ARGS(&m_resource)));
 
+        if (!createIntermediate) return;
+
         THROW_IF_FAILED(device->CreateCommittedResource(
             &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
             D3D12_HEAP_FLAG_NONE,
@@ -53,6 +56,22 @@ namespace d14engine::renderer
         cmdList->ResourceBarrier(1, &barrier);
     }
 
+    void DefaultBuffer::uploadData(ID3D12GraphicsCommandList* cmdList, UploadRingBuffer* ring, void* pSrc, UINT64 byteSize)
+    {
+        auto barrier = CD3DX12_RESOURCE_BARRIER::Transition
+        (
+            m_resource.Get(),
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            D3D12_RESOURCE_STATE_COPY_DEST
+        );
+        cmdList->ResourceBarrier(1, &barrier);
+
+        ring->stageBuffer(cmdList, m_resource.Get(), 0, pSrc, byteSize);
+
+        graph_utils::revertBarrier(1, &barrier);
+        cmdList->ResourceBarrier(1, &barrier);
+    }
+
     UploadBuffer::UploadBuffer(ID3D12Device* device, UINT elemCount, UINT64 elemByteSize)
         : m_elemCount(elemCount), m_elemByteSize(elemByteSize)
     {
@@ -4,6 +4,8 @@
 
 namespace d14engine::renderer
 {
+    struct UploadRingBuffer;
+
     struct GpuBuffer
     {
     protected:
@@ -18,7 +20,8 @@ namespace d14engine::renderer
     // Cons: immutable at runtime, isolated between CPU and GPU.
     struct DefaultBuffer : GpuBuffer
     {
-        DefaultBuffer(ID3D12Device* device, UINT64 byteSize);
+        // Skip the intermediate if the data is always staged with a ring.
+        DefaultBuffer(ID3D12Device* device, UINT64 byteSize, bool createIntermediate = true);
 
     protected:
         ComPtr<ID3D12Resource> m_intermediate = {};
@@ -28,6 +31,10 @@ namespace d14engine::renderer
 
     public:
         void uploadData(ID3D12GraphicsCommandList* cmdList, void* pSrc, UINT64 byteSize);
+
+        // Stages the data in the ring instead of the private intermediate,
+        // so the upload memory is shared and recycled with the frames.
+        void uploadData(ID3D12GraphicsCommandList* cmdList, UploadRingBuffer* ring, void* pSrc, UINT64 byteSize);
     };
 
     // Maintains a resource buffer with UPLOAD type (dynamic).
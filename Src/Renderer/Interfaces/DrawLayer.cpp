@@ -24,6 +24,15 @@ namespace d14engine::renderer
         m_visible = value;
     }
 
+    Optional<math_utils::Frustum> DrawLayer::cullingFrustum() const
+    {
+        if (auto camera = cullingCamera.lock())
+        {
+            return camera->frustum();
+        }
+        return std::nullopt;
+    }
+
     void DrawLayer::onRendererUpdateLayer(Renderer* rndr)
     {
         if (f_onRendererUpdateLayerBefore)
@@ -2,8 +2,12 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
+
 #include "IDrawLayer.h"
 
+#include "ICamera.h"
+
 namespace d14engine::renderer
 {
     struct DrawLayer : IDrawLayer
@@ -19,15 +23,20 @@ namespace d14engine::renderer
 
         void setD3d12LayerVisible(bool value) override;
 
+        // Usually the camera drawn in this layer.
+        WeakPtr<ICamera> cullingCamera = {};
+
+        Optional<math_utils::Frustum> cullingFrustum() const override;
+
         void onRendererUpdateLayer(Renderer* rndr) override;
 
-        Function<void(DrawLayer*, Renderer*)>
+        cpp_lang_utils::LazyFunction<void(DrawLayer*, Renderer*)>
             f_onRendererUpdateLayerBefore = {},
             f_onRendererUpdateLayerAfter = {};
 
         void onRendererDrawD3d12Layer(Renderer* rndr) override;
 
-        Function<void(DrawLayer*, Renderer*)>
+        cpp_lang_utils::LazyFunction<void(DrawLayer*, Renderer*)>
             f_onRendererDrawD3d12LayerBefore = {},
             f_onRendererDrawD3d12LayerAfter = {};
     };
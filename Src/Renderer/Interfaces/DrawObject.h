@@ -2,6 +2,8 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
+
 #include "IDrawObject.h"
 
 namespace d14engine::renderer
@@ -19,15 +21,19 @@ namespace d14engine::renderer
 
         void setD3d12ObjectVisible(bool value) override;
 
+        Optional<math_utils::AABB> bounds = std::nullopt;
+
+        Optional<math_utils::AABB> d3d12ObjectBounds() const override;
+
         void onRendererUpdateObject(Renderer* rndr) override;
 
-        Function<void(DrawObject*, Renderer*)>
+        cpp_lang_utils::LazyFunction<void(DrawObject*, Renderer*)>
             f_onRendererUpdateObjectBefore = {},
             f_onRendererUpdateObjectAfter = {};
 
         void onRendererDrawD3d12Object(Renderer* rndr) override;
 
-        Function<void(DrawObject*, Renderer*)>
+        cpp_lang_utils::LazyFunction<void(DrawObject*, Renderer*)>
             f_onRendererDrawD3d12ObjectBefore = {},
             f_onRendererDrawD3d12ObjectAfter = {};
     };
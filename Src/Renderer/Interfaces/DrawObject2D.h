@@ -2,6 +2,8 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
+
 #include "IDrawObject2D.h"
 
 namespace d14engine::renderer
@@ -21,13 +23,13 @@ namespace d14engine::renderer
 
         void onRendererUpdateObject2D(Renderer* rndr) override;
 
-        Function<void(DrawObject2D*, Renderer*)>
+        cpp_lang_utils::LazyFunction<void(DrawObject2D*, Renderer*)>
             f_onRendererUpdateObject2DBefore = {},
             f_onRendererUpdateObject2DAfter = {};
 
         void onRendererDrawD2d1Object(Renderer* rndr) override;
 
-        Function<void(DrawObject2D*, Renderer*)>
+        cpp_lang_utils::LazyFunction<void(DrawObject2D*, Renderer*)>
             f_onRendererDrawD2d1ObjectBefore = {},
             f_onRendererDrawD2d1ObjectAfter = {};
     };
@@ -2,6 +2,8 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/MathUtils/Culling.h"
+
 namespace d14engine::renderer
 {
     struct ICamera
@@ -14,5 +16,7 @@ namespace d14engine::renderer
         virtual Scissors scissors() const = 0;
 
         virtual void onViewResize(UINT viewWidth, UINT viewHeight) = 0;
+
+        virtual math_utils::Frustum frustum() const = 0;
     };
 }
@@ -0,0 +1,13 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::renderer
+{
+    // The time source of TickTimer, which only needs to be monotonic (the
+    // origin is arbitrary) so it can be replaced by a simulated one.
+    struct IClock
+    {
+        virtual double nowSecs() = 0;
+    };
+}
@@ -3,6 +3,7 @@
 #include "Common/Precompile.h"
 
 #include "Common/Interfaces/ISortable.h"
+#include "Common/MathUtils/Culling.h"
 
 namespace d14engine::renderer
 {
@@ -14,6 +15,10 @@ namespace d14engine::renderer
 
         virtual void setD3d12LayerVisible(bool value) = 0;
 
+        // The objects of the layer are culled against this frustum before
+        // drawing; std::nullopt disables the culling for the layer.
+        virtual Optional<math_utils::Frustum> cullingFrustum() const = 0;
+
         virtual void onRendererUpdateLayer(Renderer* rndr) = 0;
 
         virtual void onRendererDrawD3d12Layer(Renderer* rndr) = 0;
@@ -3,6 +3,7 @@
 #include "Common/Precompile.h"
 
 #include "Common/Interfaces/ISortable.h"
+#include "Common/MathUtils/Culling.h"
 
 namespace d14engine::renderer
 {
@@ -14,6 +15,10 @@ namespace d14engine::renderer
 
         virtual void setD3d12ObjectVisible(bool value) = 0;
 
+        // World-space bounds for the frustum culling; std::nullopt means
+        // the object is never culled (e.g. cameras, pipeline switchers).
+        virtual Optional<math_utils::AABB> d3d12ObjectBounds() const = 0;
+
         virtual void onRendererUpdateObject(Renderer* rndr) = 0;
 
         virtual void onRendererDrawD3d12Object(Renderer* rndr) = 0;
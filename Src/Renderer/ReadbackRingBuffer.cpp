@@ -0,0 +1,118 @@
+﻿#include "Common/Precompile.h"
+
+#include "Renderer/ReadbackRingBuffer.h"
+
+#include "Common/CppLangUtils/FinalAction.h"
+#include "Common/DirectXError.h"
+
+#include "Renderer/GraphUtils/Barrier.h"
+
+namespace d14engine::renderer
+{
+    ReadbackRingBuffer::ReadbackRingBuffer(ID3D12Device* device, size_t slotCount)
+        : m_device(device), m_ring(slotCount), m_slots(slotCount) { }
+
+    ReadbackRingBuffer::~ReadbackRingBuffer()
+    {
+        for (auto& slot : m_slots)
+        {
+            if (slot.resource) slot.resource->Unmap(0, nullptr);
+        }
+    }
+
+    size_t ReadbackRingBuffer::freeSlotCount() const
+    {
+        return m_ring.freeSlotCount();
+    }
+
+    bool ReadbackRingBuffer::capture(
+        ID3D12GraphicsCommandList* cmdList,
+        ID3D12Resource* texture,
+        D3D12_RESOURCE_STATES orgState,
+        const Callback& callback)
+    {
+        auto index = m_ring.acquire();
+        if (!index.has_value()) return false;
+
+        auto& slot = m_slots[index.value()];
+
+        auto texDesc = texture->GetDesc();
+
+        UINT64 byteSize = 0;
+        m_device->GetCopyableFootprints(
+            /* pResourceDesc    */ &texDesc,
+            /* FirstSubresource */ 0,
+            /* NumSubresources  */ 1,
+            /* BaseOffset       */ 0,
+            /* pLayouts         */ &slot.footprint,
+            /* pNumRows         */ nullptr,
+            /* pRowSizeInBytes  */ nullptr,
+            /* pTotalBytes      */ &byteSize);
+
+        // The slot is free, i.e. the GPU has finished using the buffer, so
+        // it can be replaced directly when the size grows.
+        if (slot.byteSize < byteSize)
+        {
+            if (slot.resource) slot.resource->Unmap(0, nullptr);
+
+            THROW_IF_FAILED(m_device->CreateCommittedResource(
+                &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
+                D3D12_HEAP_FLAG_NONE,
+                &CD3DX12_RESOURCE_DESC::Buffer(byteSize),
+                D3D12_RESOURCE_STATE_COPY_DEST,
+                nullptr,
+                IID_PPV_ARGS(&slot.resource)));
+
+            THROW_IF_FAILED(slot.resource->Map(0, nullptr, (void**)&slot.mapped));
+
+            slot.byteSize = byteSize;
+        }
+        slot.callback = callback;
+
+        auto barrier = CD3DX12_RESOURCE_BARRIER::Transition
+        (
+            texture, orgState, D3D12_RESOURCE_STATE_COPY_SOURCE
+        );
+        cmdList->ResourceBarrier(1, &barrier);
+
+        CD3DX12_TEXTURE_COPY_LOCATION dst(slot.resource.Get(), slot.footprint);
+        CD3DX12_TEXTURE_COPY_LOCATION src(texture, 0);
+
+        cmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+
+        graph_utils::revertBarrier(1, &barrier);
+        cmdList->ResourceBarrier(1, &barrier);
+
+        return true;
+    }
+
+    void ReadbackRingBuffer::finishFrame(UINT64 fenceValue)
+    {
+        m_ring.finishFrame(fenceValue);
+    }
+
+    void ReadbackRingBuffer::retire(UINT64 completedFenceValue)
+    {
+        while (auto index = m_ring.popCompleted(completedFenceValue))
+        {
+            auto& slot = m_slots[index.value()];
+
+            auto callback = std::move(slot.callback);
+            slot.callback = {};
+
+            // Released after the callback, which may capture another frame.
+            auto release = cpp_lang_utils::finally([&] { m_ring.release(index.value()); });
+
+            if (callback)
+            {
+                Frame frame = {};
+                frame.width = slot.footprint.Footprint.Width;
+                frame.height = slot.footprint.Footprint.Height;
+                frame.rowPitch = slot.footprint.Footprint.RowPitch;
+                frame.data = slot.mapped;
+
+                callback(frame);
+            }
+        }
+    }
+}
@@ -0,0 +1,66 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include "Renderer/ReadbackSlotRing.h"
+
+namespace d14engine::renderer
+{
+    // Reads the textures back with a few persistently mapped READBACK
+    // buffers instead of creating one and waiting for the GPU each time.
+    // The copy recorded on a frame is handed to the callback on a later
+    // frame when its fence has completed (see ReadbackSlotRing).
+    struct ReadbackRingBuffer
+    {
+        explicit ReadbackRingBuffer(ID3D12Device* device, size_t slotCount = 3);
+
+        virtual ~ReadbackRingBuffer();
+
+        // Only valid in the callback.
+        struct Frame
+        {
+            UINT width = 0, height = 0;
+
+            // Aligned to D3D12_TEXTURE_DATA_PITCH_ALIGNMENT.
+            UINT rowPitch = 0;
+
+            const BYTE* data = nullptr;
+        };
+        using Callback = Function<void(const Frame&)>;
+
+    protected:
+        ComPtr<ID3D12Device> m_device = {};
+
+        ReadbackSlotRing m_ring;
+
+        struct Slot
+        {
+            ComPtr<ID3D12Resource> resource = {};
+            UINT64 byteSize = 0;
+
+            BYTE* mapped = nullptr;
+
+            D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+
+            Callback callback = {};
+        };
+        std::vector<Slot> m_slots = {};
+
+    public:
+        size_t freeSlotCount() const;
+
+        // Records a copy of the texture (the first subresource) to a free
+        // slot, which returns false if all the slots are waiting for the GPU.
+        bool capture(
+            ID3D12GraphicsCommandList* cmdList,
+            ID3D12Resource* texture,
+            D3D12_RESOURCE_STATES orgState,
+            const Callback& callback);
+
+        // Called by the renderer with the fence value of each frame.
+        void finishFrame(UINT64 fenceValue);
+
+        // Calls the callbacks of the completed slots in the capturing order.
+        void retire(UINT64 completedFenceValue);
+    };
+}
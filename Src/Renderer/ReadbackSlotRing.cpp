@@ -0,0 +1,73 @@
+﻿#include "Common/Precompile.h"
+
+#include "Renderer/ReadbackSlotRing.h"
+
+namespace d14engine::renderer
+{
+    ReadbackSlotRing::ReadbackSlotRing(size_t slotCount)
+        : m_slots(slotCount) { }
+
+    size_t ReadbackSlotRing::slotCount() const
+    {
+        return m_slots.size();
+    }
+
+    size_t ReadbackSlotRing::freeSlotCount() const
+    {
+        return std::count_if(m_slots.begin(), m_slots.end(),
+            [](const Slot& slot) { return slot.state == SlotState::Free; });
+    }
+
+    Optional<size_t> ReadbackSlotRing::acquire()
+    {
+        for (size_t i = 0; i < m_slots.size(); ++i)
+        {
+            if (m_slots[i].state == SlotState::Free)
+            {
+                m_slots[i].state = SlotState::Recorded;
+                m_busySlots.push_back(i);
+
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void ReadbackSlotRing::finishFrame(uint64_t fenceValue)
+    {
+        // The recorded slots are always at the back.
+        for (auto itor = m_busySlots.rbegin(); itor != m_busySlots.rend(); ++itor)
+        {
+            auto& slot = m_slots[*itor];
+            if (slot.state != SlotState::Recorded) break;
+
+            slot.state = SlotState::Submitted;
+            slot.fenceValue = fenceValue;
+        }
+    }
+
+    Optional<size_t> ReadbackSlotRing::popCompleted(uint64_t completedFenceValue)
+    {
+        if (m_busySlots.empty()) return std::nullopt;
+
+        auto& slot = m_slots[m_busySlots.front()];
+
+        if (slot.state != SlotState::Submitted ||
+            slot.fenceValue > completedFenceValue) return std::nullopt;
+
+        slot.state = SlotState::Completed;
+
+        size_t index = m_busySlots.front();
+        m_busySlots.pop_front();
+
+        return index;
+    }
+
+    void ReadbackSlotRing::release(size_t slot)
+    {
+        if (slot < m_slots.size() && m_slots[slot].state == SlotState::Completed)
+        {
+            m_slots[slot].state = SlotState::Free;
+        }
+    }
+}
@@ -0,0 +1,50 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::renderer
+{
+    // The slot/fence bookkeeping of a multi-frame readback ring, which only
+    // uses the standard library so it can be tested without a GPU device.
+    //
+    // A copy is recorded into a free slot on frame N (acquire), finishFrame
+    // tags the slots acquired since the last call with the fence value of
+    // the frame, and the slots are read back in the acquiring order on the
+    // frame N + k when the fence has completed (popCompleted), so neither
+    // the CPU nor the GPU waits for the other.
+    struct ReadbackSlotRing
+    {
+        explicit ReadbackSlotRing(size_t slotCount);
+
+    protected:
+        enum class SlotState { Free, Recorded, Submitted, Completed };
+
+        struct Slot
+        {
+            SlotState state = SlotState::Free;
+
+            uint64_t fenceValue = 0;
+        };
+        std::vector<Slot> m_slots = {};
+
+        // The recorded/submitted slots in the acquiring order.
+        std::deque<size_t> m_busySlots = {};
+
+    public:
+        size_t slotCount() const;
+
+        size_t freeSlotCount() const;
+
+        // Returns std::nullopt if all the slots are waiting for the GPU.
+        Optional<size_t> acquire();
+
+        // Call this after signaling the fence of the frame.
+        void finishFrame(uint64_t fenceValue);
+
+        // Returns the oldest slot whose fence has completed, which is not
+        // acquired again until released (i.e. after read).
+        Optional<size_t> popCompleted(uint64_t completedFenceValue);
+
+        void release(size_t slot);
+    };
+}
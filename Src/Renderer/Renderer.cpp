@@ -15,6 +15,7 @@
 #include "Renderer/Interfaces/IDrawObject2D.h"
 #include "Renderer/Letterbox.h"
 #include "Renderer/TickTimer.h"
+#include "Renderer/UploadRingBuffer.h"
 
 #ifdef _DEBUG
 #include "Renderer/DebugUtils.h"
@@ -34,7 +35,10 @@ namespace d14engine::renderer
         m_sceneColor = createInfo.sceneColor;
 
         m_timer = std::make_unique<TickTimer>();
-        
+
+        m_fenceEvent = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
+        THROW_IF_NULL(m_fenceEvent);
+
         createDxgiFactory();
         queryDxgiFactoryInfo();
         checkDxgiFactoryConfigs();
@@ -50,6 +54,8 @@ namespace d14engine::renderer
     Renderer::~Renderer()
     {
         waitGpuCommand();
+
+        CloseHandle(m_fenceEvent);
     }
 
     Renderer::Window::Window(Renderer* master, HWND ptr)
@@ -221,11 +227,18 @@ namespace d14engine::renderer
     {
         waitCurrFrameResource();
 
+        auto completedFenceValue = m_fence->GetCompletedValue();
+
+        m_uploadRing->retire(completedFenceValue);
+        m_readbackRing->retire(completedFenceValue);
+        m_releaseQueue.retire(completedFenceValue);
+
         currFrameResource()->resetCmdList(m_cmdList.Get());
 
         if (!skipUpdating)
         {
-            update();
+            // Run once per fixed step in the fixed-step mode (maybe 0 times).
+            for (UINT i = 0; i < m_timer->stepCount(); ++i) update();
         }
         clearSceneBuffer();
 
@@ -289,6 +302,13 @@ namespace d14engine::renderer
         rndr->createFence();
         rndr->createCommandObjects();
 
+        rndr->m_uploadRing = std::make_unique<UploadRingBuffer>(rndr->m_d3d12Device.Get());
+        rndr->m_readbackRing = std::make_unique<ReadbackRingBuffer>(rndr->m_d3d12Device.Get());
+
+        // The new fence starts from 0, so the pending objects of the previous
+        // device would never be retired otherwise.
+        rndr->m_releaseQueue.releaseAll();
+
         if (rndr->m_letterbox == nullptr)
         {
             rndr->m_letterbox = std::make_unique<Letterbox>(rndr, Letterbox::Token{});
@@ -1122,19 +1142,23 @@ namespace d14engine::renderer
         m_cmdQueue->ExecuteCommandLists(NUM_ARR_ARGS(ppCmdList));
     }
 
+    void Renderer::waitFenceValue(UINT64 value)
+    {
+        if (m_fence->GetCompletedValue() < value)
+        {
+            // The event is auto-reset, so it is ready for the next wait.
+            THROW_IF_FAILED(m_fence->SetEventOnCompletion(value, m_fenceEvent));
+            WaitForSingleObject(m_fenceEvent, INFINITE);
+        }
+    }
+
     void Renderer::flushCmdQueue()
     {
         ++m_fenceValue;
         THROW_IF_FAILED(m_cmdQueue->Signal(m_fence.Get(), m_fenceValue));
 
-        if (m_fence->GetCompletedValue() < m_fenceValue)
-        {
-            HANDLE hEvent = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
-            THROW_IF_NULL(hEvent);
-            // m_fenceValue ==> wait all submitted commands
-            THROW_IF_FAILED(m_fence->SetEventOnCompletion(m_fenceValue, hEvent));
-            WaitForSingleObject(hEvent, INFINITE);
-        }
+        // m_fenceValue ==> wait all submitted commands
+        waitFenceValue(m_fenceValue);
     }
 
     void Renderer::beginGpuCommand()
@@ -1149,25 +1173,31 @@ namespace d14engine::renderer
     {
         submitCmdList();
         flushCmdQueue();
+
+        // All the staged data has been consumed after the flushing.
+        m_uploadRing->finishFrame(m_fenceValue);
+        m_uploadRing->retire(m_fenceValue);
+
+        m_releaseQueue.finishFrame(m_fenceValue);
+        m_releaseQueue.retire(m_fenceValue);
     }
 
     void Renderer::waitGpuCommand()
     {
         m_d3d11DeviceContext->Flush();
         flushCmdQueue();
+
+        // Nothing submitted so far is still running.
+        m_releaseQueue.finishFrame(m_fenceValue);
+        m_releaseQueue.retire(m_fenceValue);
     }
 
     void Renderer::waitCurrFrameResource()
     {
-        if (currFrameResource()->m_fenceValue != 0 &&
-            m_fence->GetCompletedValue() < currFrameResource()->m_fenceValue)
+        if (currFrameResource()->m_fenceValue != 0)
         {
-            HANDLE hEvent = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
-            THROW_IF_NULL(hEvent);
             // FrameResource::m_fenceValue ==> wait commands submitted in previous render pass
-            THROW_IF_FAILED(m_fence->SetEventOnCompletion(currFrameResource()->m_fenceValue, hEvent));
-            WaitForSingleObject(hEvent, INFINITE);
-            CloseHandle(hEvent);
+            waitFenceValue(currFrameResource()->m_fenceValue);
         }
     }
 
@@ -1207,6 +1237,8 @@ namespace d14engine::renderer
 
     void Renderer::present()
     {
+        captureScene();
+
         m_letterbox->present();
 
         auto& syncInterval = m_dxgiFactoryInfo.setting.m_syncInterval;
@@ -1221,6 +1253,10 @@ namespace d14engine::renderer
         currFrameResource()->m_fenceValue = ++m_fenceValue;
         THROW_IF_FAILED(m_cmdQueue->Signal(m_fence.Get(), m_fenceValue));
 
+        m_uploadRing->finishFrame(m_fenceValue);
+        m_readbackRing->finishFrame(m_fenceValue);
+        m_releaseQueue.finishFrame(m_fenceValue);
+
         m_currFrameIndex = m_swapChain->GetCurrentBackBufferIndex();
     }
 
@@ -1253,15 +1289,19 @@ namespace d14engine::renderer
 
         // Recreate the scene buffer with the new color to optimize clearing.
 
-        flushCmdQueue();
-        resetCmdList();
         clearInterpStates();
 
+        // The frames in flight still render to the previous buffers.  Only
+        // the letterbox reads the SRV of the scene buffer when executing,
+        // in which case the descriptor can not be overwritten until then.
+        if (m_d3d12DeviceInfo.setting.m_resolutionScaling) flushCmdQueue();
+
+        deferRelease(m_d2d1RenderTarget);
+        deferRelease(m_wrappedBuffer);
+        deferRelease(m_sceneBuffer);
+
         createSceneBuffer();
         createWrappedBuffer();
-
-        submitCmdList();
-        flushCmdQueue();
     }
 
     TickTimer* Renderer::timer() const
@@ -1274,6 +1314,61 @@ namespace d14engine::renderer
         return m_letterbox.get();
     }
 
+    UploadRingBuffer* Renderer::uploadRing() const
+    {
+        return m_uploadRing.get();
+    }
+
+    void Renderer::captureScene()
+    {
+        if (m_sceneReadbackRequests.empty() && !m_sceneRecorder) return;
+
+        if (m_readbackRing->freeSlotCount() == 0)
+        {
+            if (m_sceneRecorder) ++m_droppedRecordedFrameCount;
+            return;
+        }
+        // All the requests share the same copy.
+        auto callback = [requests = std::move(m_sceneReadbackRequests),
+                         recorder = m_sceneRecorder]
+                         (const ReadbackRingBuffer::Frame& frame)
+        {
+            for (auto& request : requests) request(frame);
+
+            if (recorder) recorder(frame);
+        };
+        m_sceneReadbackRequests.clear();
+
+        // The allocator has been reset at the beginning of the render pass,
+        // and a list can be reset with it again after submitted.
+        THROW_IF_FAILED(m_cmdList->Reset(currFrameResource()->m_cmdAlloc.Get(), nullptr));
+
+        m_readbackRing->capture(m_cmdList.Get(), m_sceneBuffer.Get(), D3D12_RESOURCE_STATE_COMMON, callback);
+
+        submitCmdList();
+    }
+
+    void Renderer::requestSceneReadback(const ReadbackRingBuffer::Callback& callback)
+    {
+        if (callback) m_sceneReadbackRequests.push_back(callback);
+    }
+
+    void Renderer::setSceneRecorder(const ReadbackRingBuffer::Callback& recorder)
+    {
+        m_sceneRecorder = recorder;
+        m_droppedRecordedFrameCount = 0;
+    }
+
+    UINT64 Renderer::droppedRecordedFrameCount() const
+    {
+        return m_droppedRecordedFrameCount;
+    }
+
+    void Renderer::deferRelease(ComPtr<IUnknown> object)
+    {
+        if (object) m_releaseQueue.push(std::move(object));
+    }
+
     Renderer::CommandLayer::CommandLayer(ID3D12Device* device)
     {
         for (auto& cmdAlloc : m_cmdAllocs)
@@ -1296,6 +1391,11 @@ namespace d14engine::renderer
         cmdList->Reset(cmdAlloc.Get(), nullptr);
     }
 
+    const DrawList& Renderer::drawList() const
+    {
+        return m_drawList;
+    }
+
     void Renderer::drawD3d12Target(CommandLayer::D3D12Target& target)
     {
         auto barrier = CD3DX12_RESOURCE_BARRIER::Transition
@@ -1312,12 +1412,11 @@ namespace d14engine::renderer
             {
                 layer.first->onRendererDrawD3d12Layer(this);
             }
-            for (auto& obj : layer.second)
+            m_drawList.build(layer.second, layer.first->cullingFrustum());
+
+            for (auto& obj : m_drawList.objects())
             {
-                if (obj->isD3d12ObjectVisible())
-                {
-                    obj->onRendererDrawD3d12Object(this);
-                }
+                obj->onRendererDrawD3d12Object(this);
             }
         }
         graph_utils::revertBarrier(1, &barrier);
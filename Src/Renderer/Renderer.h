@@ -5,7 +5,10 @@
 #include "Common/CppLangUtils/EnableMasterPtr.h"
 #include "Common/Interfaces/ISortable.h"
 
+#include "Renderer/DeferredReleaseQueue.h"
+#include "Renderer/DrawList.h"
 #include "Renderer/FrameResource.h"
+#include "Renderer/ReadbackRingBuffer.h"
 
 namespace d14engine::renderer
 {
@@ -14,6 +17,7 @@ namespace d14engine::renderer
     struct IDrawObject2D;
     struct Letterbox;
     struct TickTimer;
+    struct UploadRingBuffer;
 
     struct Renderer : cpp_lang_utils::NonCopyable
     {
@@ -273,6 +277,12 @@ namespace d14engine::renderer
 
         UINT64 m_fenceValue = 0;
 
+        // Reused by all the waits, which never overlap, instead of creating
+        // a new event for each of them.
+        HANDLE m_fenceEvent = nullptr;
+
+        void waitFenceValue(UINT64 value);
+
     public:
         ID3D12Fence* fence() const;
 
@@ -468,6 +478,50 @@ namespace d14engine::renderer
     public:
         Letterbox* letterbox() const;
 
+    private:
+        // Recreated with the device in selectAdapter.
+        UniquePtr<UploadRingBuffer> m_uploadRing = {};
+
+    public:
+        // The chunks allocated from the ring are only valid in the current
+        // render pass (or the current begin/endGpuCommand scope).
+        UploadRingBuffer* uploadRing() const;
+
+    private:
+        // Recreated with the device in selectAdapter.
+        UniquePtr<ReadbackRingBuffer> m_readbackRing = {};
+
+        std::vector<ReadbackRingBuffer::Callback> m_sceneReadbackRequests = {};
+
+        ReadbackRingBuffer::Callback m_sceneRecorder = {};
+
+        UINT64 m_droppedRecordedFrameCount = 0;
+
+        // Copies the scene buffer to the readback ring after drawing.
+        void captureScene();
+
+    public:
+        // The callback is called with the pixels of the scene buffer on a
+        // later frame (usually 2 or 3) when the GPU has copied them, which
+        // never waits for the GPU.  The requests are delayed if all the
+        // slots of the ring are busy.
+        void requestSceneReadback(const ReadbackRingBuffer::Callback& callback);
+
+        // The recorder is called with every frame (null to stop), and the
+        // frames are dropped if all the slots of the ring are busy.
+        void setSceneRecorder(const ReadbackRingBuffer::Callback& recorder);
+
+        UINT64 droppedRecordedFrameCount() const;
+
+    private:
+        DeferredReleaseQueue<ComPtr<IUnknown>> m_releaseQueue = {};
+
+    public:
+        // Keeps the object alive until the frames submitted so far (and the
+        // current one) have completed on the GPU, which is used to replace
+        // a resource without waiting for the GPU.  Null objects are ignored.
+        void deferRelease(ComPtr<IUnknown> object);
+
     public:
         struct CommandLayer : ISortable<CommandLayer>
         {
@@ -505,6 +559,14 @@ namespace d14engine::renderer
 
         CommandLayerSet cmdLayers = {};
 
+    private:
+        // Reused by all the draw layers to avoid the per-frame allocations.
+        DrawList m_drawList = {};
+
+    public:
+        // Holds the result of the last drawn layer.
+        const DrawList& drawList() const;
+
     private:
         void drawD3d12Target(CommandLayer::D3D12Target& target);
 
@@ -0,0 +1,90 @@
+﻿#include "Common/Precompile.h"
+
+#include "Renderer/RingAllocator.h"
+
+namespace d14engine::renderer
+{
+    RingAllocator::RingAllocator(uint64_t capacity)
+        : m_capacity(capacity) { }
+
+    uint64_t RingAllocator::capacity() const
+    {
+        return m_capacity;
+    }
+
+    uint64_t RingAllocator::usedSize() const
+    {
+        return m_usedSize;
+    }
+
+    Optional<uint64_t> RingAllocator::allocate(uint64_t size, uint64_t alignment)
+    {
+        if (size == 0 || size > m_capacity) return std::nullopt;
+
+        // Restart from the beginning when everything has been retired,
+        // which keeps the large chunks from being split by the wrapping.
+        if (m_usedSize == 0) m_head = m_tail = 0;
+
+        // The alignment must be a power of 2.
+        auto offset = (m_head + alignment - 1) & ~(alignment - 1);
+        uint64_t taken = 0;
+
+        bool full = (m_head == m_tail && m_usedSize > 0);
+
+        if (m_head >= m_tail && !full) // free: [head, capacity) + [0, tail)
+        {
+            if (offset + size <= m_capacity)
+            {
+                taken = offset + size - m_head;
+            }
+            else if (size <= m_tail) // skip the end
+            {
+                taken = (m_capacity - m_head) + size;
+                offset = 0;
+            }
+            else return std::nullopt;
+        }
+        else // free: [head, tail)
+        {
+            if (offset + size <= m_tail)
+            {
+                taken = offset + size - m_head;
+            }
+            else return std::nullopt;
+        }
+        m_head = offset + size;
+        if (m_head == m_capacity) m_head = 0;
+
+        m_usedSize += taken;
+        m_frameSize += taken;
+
+        return offset;
+    }
+
+    void RingAllocator::finishFrame(uint64_t fenceValue)
+    {
+        // Nothing to release for an empty frame.
+        if (m_frameSize == 0) return;
+
+        m_frames.push_back({ fenceValue, m_head, m_frameSize });
+        m_frameSize = 0;
+    }
+
+    void RingAllocator::retire(uint64_t completedFenceValue)
+    {
+        while (!m_frames.empty() && m_frames.front().fenceValue <= completedFenceValue)
+        {
+            auto& frame = m_frames.front();
+
+            m_tail = frame.headOffset;
+            m_usedSize -= frame.size;
+
+            m_frames.pop_front();
+        }
+    }
+
+    size_t RingAllocator::pendingFrameCount() const
+    {
+        return m_frames.size();
+    }
+}
@@ -0,0 +1,58 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::renderer
+{
+    // The offset/fence bookkeeping of a frame-fenced ring buffer, which only
+    // uses the standard library so it can be tested without a GPU device.
+    //
+    // The chunks are sub-allocated linearly from the head; finishFrame tags
+    // all the chunks since the last call with the fence value of the frame,
+    // and retire moves the tail past the frames whose fences have completed.
+    struct RingAllocator
+    {
+        explicit RingAllocator(uint64_t capacity);
+
+        constexpr static uint64_t g_defaultAlignment = 256;
+
+    protected:
+        uint64_t m_capacity = 0;
+
+        uint64_t m_head = 0, m_tail = 0;
+
+        // Including the padding skipped for the alignment and the wrapping.
+        uint64_t m_usedSize = 0;
+
+        // How many bytes have been taken since the last finishFrame.
+        uint64_t m_frameSize = 0;
+
+        struct FrameMark
+        {
+            uint64_t fenceValue = 0;
+
+            uint64_t headOffset = 0; // where the frame ends
+            uint64_t size = 0; // released when the fence completes
+        };
+        std::deque<FrameMark> m_frames = {};
+
+    public:
+        uint64_t capacity() const;
+
+        uint64_t usedSize() const;
+
+        // Returns the offset of the chunk, or std::nullopt if the ring has
+        // no enough space before the pending frames are retired.  A chunk
+        // never straddles the end of the ring, i.e. the remaining space at
+        // the end is skipped when it is too small.
+        Optional<uint64_t> allocate(uint64_t size, uint64_t alignment = g_defaultAlignment);
+
+        // Call this after signaling the fence of the frame.
+        void finishFrame(uint64_t fenceValue);
+
+        // Call this with ID3D12Fence::GetCompletedValue (or similar).
+        void retire(uint64_t completedFenceValue);
+
+        size_t pendingFrameCount() const;
+    };
+}
@@ -2,12 +2,32 @@
 
 #include "Renderer/TickTimer.h"
 
+#include "Renderer/Clocks.h"
+
+#include <cmath>
+
 namespace d14engine::renderer
 {
-    TickTimer::TickTimer()
+    TickTimer::TickTimer(ShrdPtrParam<IClock> clock)
+    {
+        setClock(clock);
+    }
+
+    const SharedPtr<IClock>& TickTimer::clock() const
     {
-        QueryPerformanceFrequency((LARGE_INTEGER*)&m_tickCountPerSec);
-        m_secPerTickCount = 1.0 / m_tickCountPerSec;
+        return m_clock;
+    }
+
+    void TickTimer::setClock(ShrdPtrParam<IClock> clock)
+    {
+        m_clock = clock ? clock : std::make_shared<RealClock>();
+
+        if (!m_isPause)
+        {
+            m_elapsedSecsAtLastPause = elapsedSecs();
+            m_elapsedSecsSinceResume = 0.0;
+        }
+        m_baseSecs = m_clock->nowSecs();
     }
 
     bool TickTimer::isPause() const
@@ -19,30 +39,49 @@ namespace d14engine::renderer
     {
         m_isPause = false;
 
-        QueryPerformanceCounter((LARGE_INTEGER*)&m_baseTickCount);
-        m_currTickCount = m_baseTickCount;
+        m_baseSecs = m_clock->nowSecs();
 
         m_fps = 0;
         m_frameCount = 0;
         m_oneSecPoint = 0.0;
 
-        m_deltaSecs = 0.0;
+        m_frameDeltaSecs = 0.0;
 
         m_elapsedSecsAtLastPause = 0.0;
         m_elapsedSecsSinceResume = 0.0;
+
+        m_accumulatedSecs = 0.0;
+        m_stepCount = 0;
     }
 
     void TickTimer::tick()
     {
         if (m_isPause) return;
 
-        QueryPerformanceCounter((LARGE_INTEGER*)&m_currTickCount);
-        double currElapsedSecs = (m_currTickCount - m_baseTickCount) * m_secPerTickCount;
+        double currElapsedSecs = m_clock->nowSecs() - m_baseSecs;
 
-        m_deltaSecs = currElapsedSecs - m_elapsedSecsSinceResume;
+        m_frameDeltaSecs = std::max(currElapsedSecs - m_elapsedSecsSinceResume, 0.0);
 
         m_elapsedSecsSinceResume = currElapsedSecs;
 
+        if (m_fixedStepMode.enabled)
+        {
+            m_accumulatedSecs += m_frameDeltaSecs;
+
+            auto& mode = m_fixedStepMode;
+
+            auto stepCount = (uint32_t)std::min(
+                std::floor(m_accumulatedSecs / mode.stepSecs), (double)mode.maxStepCount);
+
+            m_accumulatedSecs -= stepCount * mode.stepSecs;
+            m_stepCount = stepCount;
+
+            // Drop the whole steps that can not be caught up with.
+            if (m_accumulatedSecs >= mode.stepSecs)
+            {
+                m_accumulatedSecs = std::fmod(m_accumulatedSecs, mode.stepSecs);
+            }
+        }
         ++m_frameCount;
         if (elapsedSecs() >= m_oneSecPoint + 1)
         {
@@ -60,10 +99,13 @@ namespace d14engine::renderer
         m_frameCount = 0;
         m_oneSecPoint = 0.0;
 
-        m_deltaSecs = 0.0;
+        m_frameDeltaSecs = 0.0;
 
         m_elapsedSecsAtLastPause = elapsedSecs();
         m_elapsedSecsSinceResume = 0.0;
+
+        m_accumulatedSecs = 0.0;
+        m_stepCount = 0;
     }
 
     void TickTimer::resume()
@@ -71,53 +113,65 @@ namespace d14engine::renderer
         if (m_isPause)
         {
             m_isPause = false;
-            QueryPerformanceCounter((LARGE_INTEGER*)&m_baseTickCount);
-            m_currTickCount = m_baseTickCount;
+            m_baseSecs = m_clock->nowSecs();
         }
     }
 
-    UINT TickTimer::fps() const
+    uint32_t TickTimer::fps() const
     {
         return m_fps;
     }
 
-    __int64 TickTimer::tickCountPerSec() const
+    double TickTimer::deltaSecs() const
     {
-        return m_tickCountPerSec;
+        return m_fixedStepMode.enabled ? m_fixedStepMode.stepSecs : m_frameDeltaSecs;
     }
 
-    __int64 TickTimer::baseTickCount() const
+    double TickTimer::frameDeltaSecs() const
     {
-        return m_baseTickCount;
+        return m_frameDeltaSecs;
     }
 
-    __int64 TickTimer::currTickCount() const
+    double TickTimer::elapsedSecsAtLastPause() const
     {
-        return m_currTickCount;
+        return m_elapsedSecsAtLastPause;
     }
 
-    double TickTimer::secPerTickCount() const
+    double TickTimer::elapsedSecsSinceResume() const
     {
-        return m_secPerTickCount;
+        return m_elapsedSecsSinceResume;
     }
 
-    double TickTimer::deltaSecs() const
+    double TickTimer::elapsedSecs() const
     {
-        return m_deltaSecs;
+        return m_elapsedSecsAtLastPause + m_elapsedSecsSinceResume;
     }
 
-    double TickTimer::elapsedSecsAtLastPause() const
+    const TickTimer::FixedStepMode& TickTimer::fixedStepMode() const
     {
-        return m_elapsedSecsAtLastPause;
+        return m_fixedStepMode;
     }
 
-    double TickTimer::elapsedSecsSinceResume() const
+    void TickTimer::setFixedStepMode(const FixedStepMode& mode)
     {
-        return m_elapsedSecsSinceResume;
+        m_fixedStepMode = mode;
+
+        // A step of 0 would never be consumed.
+        m_fixedStepMode.stepSecs = std::max(mode.stepSecs, 1e-6);
+
+        m_accumulatedSecs = 0.0;
+        m_stepCount = 0;
     }
 
-    double TickTimer::elapsedSecs() const
+    uint32_t TickTimer::stepCount() const
     {
-        return m_elapsedSecsAtLastPause + m_elapsedSecsSinceResume;
+        return m_fixedStepMode.enabled ? m_stepCount : 1;
+    }
+
+    double TickTimer::interpolationAlpha() const
+    {
+        if (!m_fixedStepMode.enabled) return 0.0;
+
+        return std::min(m_accumulatedSecs / m_fixedStepMode.stepSecs, 1.0);
     }
 }
@@ -2,11 +2,26 @@
 
 #include "Common/Precompile.h"
 
+#include "Renderer/Interfaces/IClock.h"
+
 namespace d14engine::renderer
 {
     struct TickTimer
     {
-        TickTimer();
+        // The real clock is used if the clock is null.
+        explicit TickTimer(ShrdPtrParam<IClock> clock = nullptr);
+
+    private:
+        SharedPtr<IClock> m_clock = {};
+
+        // The clock time when started/resumed.
+        double m_baseSecs = 0.0;
+
+    public:
+        const SharedPtr<IClock>& clock() const;
+
+        // The elapsed time is kept, i.e. the new clock continues from it.
+        void setClock(ShrdPtrParam<IClock> clock);
 
     private:
         bool m_isPause = false;
@@ -20,39 +35,66 @@ namespace d14engine::renderer
         void resume();
 
     private:
-        UINT m_fps = 0;
-        UINT m_frameCount = 0;
+        uint32_t m_fps = 0;
+        uint32_t m_frameCount = 0;
         double m_oneSecPoint = 0.0;
 
     public:
-        UINT fps() const;
+        uint32_t fps() const;
 
     private:
-        __int64 m_tickCountPerSec = 0;
-
-        __int64 m_baseTickCount = 0;
-        __int64 m_currTickCount = 0;
-
-        double m_secPerTickCount = 0.0;
-
-        double m_deltaSecs = 0.0;
+        double m_frameDeltaSecs = 0.0;
 
         double m_elapsedSecsAtLastPause = 0.0;
         double m_elapsedSecsSinceResume = 0.0;
 
     public:
-        __int64 tickCountPerSec() const;
-
-        __int64 baseTickCount() const;
-        __int64 currTickCount() const;
-
-        double secPerTickCount() const;
-
+        // In the fixed-step mode, this is the step since each update advances
+        // by exactly one step; otherwise it equals frameDeltaSecs.
         double deltaSecs() const;
 
+        // The real time between the last 2 frames.
+        double frameDeltaSecs() const;
+
         double elapsedSecsAtLastPause() const;
         double elapsedSecsSinceResume() const;
 
         double elapsedSecs() const;
+
+    public:
+        // The frame time is accumulated and consumed by the fixed steps, so
+        // the updates (i.e. the animations) advance identically regardless
+        // of the frame rate, and the leftover (see interpolationAlpha) can be
+        // used to blend the last 2 steps when drawing.
+        //
+        // At most maxStepCount steps are run per frame and the rest of the
+        // time is dropped, otherwise the updates of a slow frame would make
+        // the next frame even slower.
+        struct FixedStepMode
+        {
+            bool enabled = false;
+
+            double stepSecs = 1.0 / 60.0;
+
+            uint32_t maxStepCount = 8;
+        };
+
+    private:
+        FixedStepMode m_fixedStepMode = {};
+
+        double m_accumulatedSecs = 0.0;
+
+        uint32_t m_stepCount = 0;
+
+    public:
+        const FixedStepMode& fixedStepMode() const;
+        void setFixedStepMode(const FixedStepMode& mode);
+
+        // How many times the updates should run in the current frame, which
+        // is always 1 unless the fixed-step mode is enabled.
+        uint32_t stepCount() const;
+
+        // The leftover of the fixed steps in [0, 1), or 0 if disabled.
+        double interpolationAlpha() const;
     };
 }
@@ -0,0 +1,124 @@
+﻿#include "Common/Precompile.h"
+
+#include "Renderer/UploadRingBuffer.h"
+
+#include "Common/DirectXError.h"
+
+#include "Renderer/GraphUtils/ParamHelper.h"
+
+#include <cstring>
+
+namespace d14engine::renderer
+{
+    UploadRingBuffer::UploadRingBuffer(ID3D12Device* device, UINT64 pageByteSize)
+        : m_device(device), m_pageByteSize(pageByteSize)
+    {
+        createPage(m_pageByteSize);
+    }
+
+    UploadRingBuffer::~UploadRingBuffer()
+    {
+        for (auto& page : m_pages)
+        {
+            page->resource->Unmap(0, nullptr); page->mapped = nullptr;
+        }
+    }
+
+    UploadRingBuffer::Page* UploadRingBuffer::createPage(UINT64 byteSize)
+    {
+        auto page = std::make_unique<Page>(Page{ .ring = RingAllocator(byteSize) });
+
+        THROW_IF_FAILED(m_device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(byteSize),
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            nullptr,
+            IID_PPV_ARGS(&page->resource)));
+
+        THROW_IF_FAILED(page->resource->Map(0, nullptr, (void**)&page->mapped));
+
+        return m_pages.emplace_back(std::move(page)).get();
+    }
+
+    UploadRingBuffer::Allocation UploadRingBuffer::allocate(UINT64 byteSize, UINT64 alignment)
+    {
+        auto makeAllocation = [](Page* page, UINT64 offset)
+        {
+            Allocation allocation = {};
+
+            allocation.resource = page->resource.Get();
+            allocation.offset = offset;
+
+            allocation.mapped = page->mapped + offset;
+            allocation.gpuAddress = page->resource->GetGPUVirtualAddress() + offset;
+
+            return allocation;
+        };
+        for (auto& page : m_pages)
+        {
+            auto offset = page->ring.allocate(byteSize, alignment);
+            if (offset.has_value())
+            {
+                page->idleFrameCount = 0;
+                return makeAllocation(page.get(), offset.value());
+            }
+        }
+        // Oversized requests get a dedicated page, which is recycled by the
+        // fence like the others and released after pageReleaseIdleFrameCount
+        // frames without use.
+        auto pageByteSize = std::max(m_pageByteSize, (byteSize + alignment - 1) & ~(alignment - 1));
+
+        auto page = createPage(pageByteSize);
+        return makeAllocation(page, page->ring.allocate(byteSize, alignment).value());
+    }
+
+    void UploadRingBuffer::stageBuffer(
+        ID3D12GraphicsCommandList* cmdList,
+        ID3D12Resource* dst,
+        UINT64 dstOffset,
+        const void* pSrc,
+        UINT64 byteSize)
+    {
+        // CopyBufferRegion has no alignment requirement for the offsets.
+        auto allocation = allocate(byteSize, 4);
+
+        memcpy(allocation.mapped, pSrc, byteSize);
+
+        cmdList->CopyBufferRegion(dst, dstOffset, allocation.resource, allocation.offset, byteSize);
+    }
+
+    void UploadRingBuffer::finishFrame(UINT64 fenceValue)
+    {
+        for (auto& page : m_pages) page->ring.finishFrame(fenceValue);
+    }
+
+    void UploadRingBuffer::retire(UINT64 completedFenceValue)
+    {
+        for (auto& page : m_pages) page->ring.retire(completedFenceValue);
+
+        // An empty page has no chunk in use by either the CPU or the GPU
+        // (all its frames have completed), so it can be released directly.
+        for (auto itor = m_pages.begin() + 1; itor != m_pages.end();)
+        {
+            auto& page = *itor;
+            if (page->ring.usedSize() > 0)
+            {
+                page->idleFrameCount = 0;
+            }
+            else if (++page->idleFrameCount >= pageReleaseIdleFrameCount)
+            {
+                page->resource->Unmap(0, nullptr);
+
+                itor = m_pages.erase(itor);
+                continue;
+            }
+            ++itor;
+        }
+    }
+
+    size_t UploadRingBuffer::pageCount() const
+    {
+        return m_pages.size();
+    }
+}
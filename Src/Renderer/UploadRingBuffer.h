@@ -0,0 +1,76 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include "Renderer/RingAllocator.h"
+
+namespace d14engine::renderer
+{
+    // Sub-allocates the per-frame dynamic data (constants, instances etc.)
+    // from a few large persistently mapped UPLOAD heaps instead of keeping
+    // g_bufferCount copies of buffers in each owner.  The chunks are valid
+    // until the end of the frame and recycled when its fence completes.
+    struct UploadRingBuffer
+    {
+        explicit UploadRingBuffer(ID3D12Device* device, UINT64 pageByteSize = 4 * 1024 * 1024);
+
+        virtual ~UploadRingBuffer();
+
+        struct Allocation
+        {
+            ID3D12Resource* resource = nullptr;
+            UINT64 offset = 0;
+
+            BYTE* mapped = nullptr;
+            D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = 0;
+        };
+
+    protected:
+        ComPtr<ID3D12Device> m_device = {};
+
+        UINT64 m_pageByteSize = 0;
+
+        struct Page
+        {
+            ComPtr<ID3D12Resource> resource = {};
+
+            BYTE* mapped = nullptr;
+
+            RingAllocator ring;
+
+            // How many retire calls in a row have found the page empty.
+            UINT idleFrameCount = 0;
+        };
+        // A new page is appended only when all the existing pages are full,
+        // so there are usually only 1 or 2 pages after the warming up.
+        std::vector<UniquePtr<Page>> m_pages = {};
+
+        Page* createPage(UINT64 byteSize);
+
+    public:
+        // The pages except the first one are released after staying empty
+        // for this many frames, so a burst of uploads (e.g. an oversized
+        // one-off allocation, which gets a dedicated page) does not grow the
+        // ring permanently.
+        UINT pageReleaseIdleFrameCount = 120;
+
+        // The alignment defaults to 256 so that the chunk can be bound as a
+        // constant buffer directly.
+        Allocation allocate(UINT64 byteSize, UINT64 alignment = RingAllocator::g_defaultAlignment);
+
+        // Stages the source data in the ring and records a copy to the
+        // destination, which must be in the COPY_DEST state.
+        void stageBuffer(
+            ID3D12GraphicsCommandList* cmdList,
+            ID3D12Resource* dst,
+            UINT64 dstOffset,
+            const void* pSrc,
+            UINT64 byteSize);
+
+        // Called by the renderer with the fence value of each frame.
+        void finishFrame(UINT64 fenceValue);
+        void retire(UINT64 completedFenceValue);
+
+        size_t pageCount() const;
+    };
+}
@@ -0,0 +1,104 @@
+﻿#include "Common/Precompile.h"
+
+#include "Renderer/WorkerPool.h"
+
+namespace d14engine::renderer
+{
+    WorkerPool::WorkerPool(size_t workerCount)
+    {
+        m_workers.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; ++i)
+        {
+            m_workers.emplace_back([this] { work(); });
+        }
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::unique_lock lock(m_mutex);
+            m_exiting = true;
+        }
+        m_runStarted.notify_all();
+
+        for (auto& worker : m_workers) worker.join();
+    }
+
+    void WorkerPool::work()
+    {
+        uint64_t lastGeneration = 0;
+        while (true)
+        {
+            const Function<void(size_t)>* task = nullptr;
+            size_t taskCount = 0;
+            {
+                std::unique_lock lock(m_mutex);
+                m_runStarted.wait(lock, [&]
+                {
+                    return m_exiting || m_runGeneration != lastGeneration;
+                });
+                if (m_exiting) break;
+
+                lastGeneration = m_runGeneration;
+
+                // Woken too late, i.e. the run has finished without this.
+                if (m_task == nullptr) continue;
+
+                task = m_task;
+                taskCount = m_taskCount;
+
+                ++m_activeWorkerCount;
+            }
+            takeTasks(*task, taskCount);
+            {
+                std::unique_lock lock(m_mutex);
+                --m_activeWorkerCount;
+            }
+            m_workerFinished.notify_all();
+        }
+    }
+
+    void WorkerPool::takeTasks(const Function<void(size_t)>& task, size_t taskCount)
+    {
+        size_t index = 0;
+        while ((index = m_nextTaskIndex.fetch_add(1)) < taskCount)
+        {
+            task(index);
+        }
+    }
+
+    size_t WorkerPool::workerCount() const
+    {
+        return m_workers.size();
+    }
+
+    void WorkerPool::run(size_t taskCount, FuncParam<void(size_t)> task)
+    {
+        if (taskCount == 0) return;
+
+        if (m_workers.empty() || taskCount == 1)
+        {
+            for (size_t i = 0; i < taskCount; ++i) task(i);
+            return;
+        }
+        {
+            std::unique_lock lock(m_mutex);
+
+            m_task = &task;
+            m_taskCount = taskCount;
+            m_nextTaskIndex = 0;
+
+            ++m_runGeneration;
+        }
+        m_runStarted.notify_all();
+
+        takeTasks(task, taskCount);
+
+        // All the tasks have been taken at this point, so only wait for the
+        // workers still running theirs, and stop the late ones from joining.
+        std::unique_lock lock(m_mutex);
+
+        m_task = nullptr;
+        m_workerFinished.wait(lock, [this] { return m_activeWorkerCount == 0; });
+    }
+}
@@ -0,0 +1,63 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include "Common/CppLangUtils/NonCopyable.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace d14engine::renderer
+{
+    // Runs the per-frame data-parallel passes (e.g. the frustum culling of
+    // DrawList) on a few persistent threads, so each frame only wakes them
+    // instead of creating new threads like std::async does.
+    //
+    // The calling thread also takes the tasks, so a pool with 0 worker just
+    // runs them in place.
+    struct WorkerPool : cpp_lang_utils::NonCopyable
+    {
+        explicit WorkerPool(size_t workerCount);
+
+        ~WorkerPool();
+
+    protected:
+        std::vector<std::thread> m_workers = {};
+
+        // The task of the current run, which is null between the runs.
+        const Function<void(size_t)>* m_task = nullptr;
+
+        size_t m_taskCount = 0;
+
+        // The next index to take, which is shared by all the threads.
+        std::atomic<size_t> m_nextTaskIndex = 0;
+
+        // Bumped by each run, so a worker never takes the same run twice.
+        uint64_t m_runGeneration = 0;
+
+        // The workers that have joined the current run, which the caller
+        // waits for before returning (the task is only valid until then).
+        size_t m_activeWorkerCount = 0;
+
+        bool m_exiting = false;
+
+        // Guards all the members above except m_nextTaskIndex.
+        std::mutex m_mutex = {};
+
+        std::condition_variable m_runStarted = {};
+        std::condition_variable m_workerFinished = {};
+
+        void work();
+
+        void takeTasks(const Function<void(size_t)>& task, size_t taskCount);
+
+    public:
+        size_t workerCount() const;
+
+        // Calls task(index) for each index in [0, taskCount) on the workers
+        // and the calling thread, and returns when all the calls return.
+        // The task must not throw, and runs must not be nested.
+        void run(size_t taskCount, FuncParam<void(size_t)> task);
+    };
+}
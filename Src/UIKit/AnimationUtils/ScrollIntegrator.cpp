@@ -0,0 +1,154 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/AnimationUtils/ScrollIntegrator.h"
+
+#include <cmath>
+
+namespace d14engine::uikit::animation_utils
+{
+    namespace
+    {
+        // The motion is considered settled below these thresholds, which
+        // are invisible since the viewport offset is in pixels.
+        constexpr float g_restDistance = 0.5f;
+        constexpr float g_restVelocity = 10.0f;
+    }
+
+    void ScrollIntegrator::step()
+    {
+        constexpr float h = g_stepSecs;
+
+        if (m_target.has_value())
+        {
+            // Semi-implicit Euler is stable here as long as stiffness * h
+            // is far less than 1, which holds for any sane stiffness.
+            float a = stiffness * stiffness * (m_target.value() - m_position) - 2.0f * stiffness * m_velocity;
+
+            m_velocity = std::clamp(m_velocity + a * h, -maxVelocity, maxVelocity);
+            m_position += m_velocity * h;
+
+            if (std::abs(m_target.value() - m_position) < g_restDistance &&
+                std::abs(m_velocity) < g_restVelocity)
+            {
+                m_position = m_target.value();
+                stop();
+            }
+        }
+        else // flinging
+        {
+            m_velocity *= std::exp(-friction * h);
+            m_position += m_velocity * h;
+
+            if (std::abs(m_velocity) < g_restVelocity) stop();
+        }
+        clamp();
+    }
+
+    void ScrollIntegrator::clamp()
+    {
+        if (m_position <= m_minPosition)
+        {
+            m_position = m_minPosition;
+            m_velocity = std::max(m_velocity, 0.0f);
+        }
+        else if (m_position >= m_maxPosition)
+        {
+            m_position = m_maxPosition;
+            m_velocity = std::min(m_velocity, 0.0f);
+        }
+        else return;
+
+        // A fling ends at the boundary, while a scrolling goes on until
+        // reaching the target (which is always in range).
+        if (!m_target.has_value() && m_velocity == 0.0f) stop();
+    }
+
+    float ScrollIntegrator::position() const
+    {
+        return m_position;
+    }
+
+    float ScrollIntegrator::velocity() const
+    {
+        return m_velocity;
+    }
+
+    bool ScrollIntegrator::isMoving() const
+    {
+        return m_isMoving;
+    }
+
+    void ScrollIntegrator::reset(float position)
+    {
+        stop();
+
+        m_position = std::clamp(position, m_minPosition, m_maxPosition);
+    }
+
+    void ScrollIntegrator::stop()
+    {
+        m_velocity = 0.0f;
+        m_target.reset();
+
+        m_isMoving = false;
+        m_remainingSecs = 0.0f;
+    }
+
+    void ScrollIntegrator::setRange(float minPosition, float maxPosition)
+    {
+        m_minPosition = minPosition;
+        m_maxPosition = std::max(minPosition, maxPosition);
+
+        if (m_target.has_value())
+        {
+            m_target = std::clamp(m_target.value(), m_minPosition, m_maxPosition);
+        }
+        m_position = std::clamp(m_position, m_minPosition, m_maxPosition);
+    }
+
+    void ScrollIntegrator::scrollBy(float distance)
+    {
+        float target = m_target.value_or(m_position) + distance;
+
+        m_target = std::clamp(target, m_minPosition, m_maxPosition);
+
+        m_isMoving = true;
+    }
+
+    void ScrollIntegrator::fling(float velocity)
+    {
+        m_target.reset();
+
+        m_velocity = std::clamp(velocity, -maxVelocity, maxVelocity);
+
+        m_isMoving = std::abs(m_velocity) >= g_restVelocity;
+
+        if (!m_isMoving) stop();
+    }
+
+    void ScrollIntegrator::translate(float distance)
+    {
+        m_position = std::clamp(m_position + distance, m_minPosition, m_maxPosition);
+
+        if (m_target.has_value())
+        {
+            m_target = std::clamp(m_target.value() + distance, m_minPosition, m_maxPosition);
+        }
+    }
+
+    bool ScrollIntegrator::advance(float deltaSecs)
+    {
+        if (!m_isMoving) return false;
+
+        m_remainingSecs += std::clamp(deltaSecs, 0.0f, g_maxDeltaSecs);
+
+        while (m_isMoving && m_remainingSecs >= g_stepSecs)
+        {
+            step();
+            m_remainingSecs -= g_stepSecs;
+        }
+        if (!m_isMoving) m_remainingSecs = 0.0f;
+
+        return m_isMoving;
+    }
+}
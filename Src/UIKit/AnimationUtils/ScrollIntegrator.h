@@ -0,0 +1,90 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::uikit::animation_utils
+{
+    // Integrates the scroll position of one axis, which only uses the
+    // standard library so it can be tested without creating any UI object.
+    //
+    // The inputs (wheel notches, drag velocities etc.) are only accumulated
+    // when they arrive, and the position is advanced once per frame, so the
+    // owner only needs to update its viewport once per frame no matter how
+    // many inputs are received in between.
+    //
+    // There are 2 kinds of motion:
+    //
+    // Scrolling: the position chases a target with a critically damped
+    //            spring, and scrollBy moves the target, so that consecutive
+    //            wheel notches accumulate into one smooth motion.
+    // Flinging: the position moves freely with a velocity that decays
+    //           exponentially, i.e. the inertia after releasing a drag.
+    //
+    // The position is always clamped to the range, and the motion is stepped
+    // with a fixed time step, so the result only depends on the inputs and
+    // the total elapsed time instead of how the frames are split.
+    struct ScrollIntegrator
+    {
+        // The angular frequency (rad/s) of the spring, and the target is
+        // reached in about 5 / stiffness seconds.
+        float stiffness = 32.0f;
+
+        // The decay rate (1/s) of the fling velocity, i.e. the velocity is
+        // multiplied by exp(-friction) per second.
+        float friction = 4.0f;
+
+        // In pixels per second.
+        float maxVelocity = 8000.0f;
+
+        constexpr static float g_stepSecs = 1.0f / 240.0f;
+
+        // Avoids integrating a huge number of steps after a long stall
+        // (e.g. when the window is being dragged).
+        constexpr static float g_maxDeltaSecs = 0.1f;
+
+    protected:
+        float m_position = 0.0f;
+        float m_velocity = 0.0f;
+
+        float m_minPosition = 0.0f;
+        float m_maxPosition = 0.0f;
+
+        Optional<float> m_target = {}; // empty when flinging
+
+        bool m_isMoving = false;
+
+        float m_remainingSecs = 0.0f;
+
+        void step();
+
+        void clamp();
+
+    public:
+        float position() const;
+        float velocity() const;
+
+        bool isMoving() const;
+
+        // Stops the motion and jumps to the position.
+        void reset(float position);
+
+        void stop();
+
+        // An empty range (max < min) is treated as [min, min].
+        void setRange(float minPosition, float maxPosition);
+
+        // Moves the target (and keeps the current velocity), which starts
+        // from the current position if not scrolling yet.
+        void scrollBy(float distance);
+
+        // Starts a free motion with the velocity, e.g. after releasing a drag.
+        void fling(float velocity);
+
+        // Shifts the whole motion without changing its shape, e.g. when the
+        // owner changes the position for other reasons (scroll anchoring).
+        void translate(float distance);
+
+        // Returns whether the motion is still going on after advancing.
+        bool advance(float deltaSecs);
+    };
+}
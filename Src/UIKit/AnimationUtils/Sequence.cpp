@@ -17,34 +17,46 @@ namespace d14engine::uikit::animation_utils
         m_prevFrameElapsedSecs = 0.0f;
     }
 
+    float DynamicBitmap::currFrameTimeSpan() const
+    {
+        if (equalTimeSpanOptimization.enabled)
+        {
+            return equalTimeSpanOptimization.durationInSecs;
+        }
+        else if (m_currFrameIndex >= 0 && m_currFrameIndex < timeSpansInSecs.size())
+        {
+            return timeSpansInSecs[m_currFrameIndex];
+        }
+        else return 0.0f;
+    }
+
     void DynamicBitmap::update(Renderer* rndr)
     {
         if (!frames.empty())
         {
-            float ts = 0.0f;
-
-            if (equalTimeSpanOptimization.enabled)
-            {
-                ts = equalTimeSpanOptimization.durationInSecs;
-            }
-            else if (frames.size() == timeSpansInSecs.size())
-            {
-                if (m_currFrameIndex >= 0 && m_currFrameIndex < frames.size())
-                {
-                    ts = timeSpansInSecs[m_currFrameIndex];
-                }
-            }
-            else // Both control modes are invalid.
+            if (!equalTimeSpanOptimization.enabled &&
+                frames.size() != timeSpansInSecs.size())
             {
+                // Both control modes are invalid.
                 m_currFrameIndex = SIZE_MAX;
                 return;
             }
             m_prevFrameElapsedSecs += (float)rndr->timer()->deltaSecs();
 
-            if (m_prevFrameElapsedSecs >= ts)
+            // Carry the leftover over to the next frame instead of dropping
+            // it, so the sequence plays at the same pace at any frame rate.
+            float ts = currFrameTimeSpan();
+            while (m_prevFrameElapsedSecs >= ts)
             {
                 m_currFrameIndex = (m_currFrameIndex + 1) % frames.size();
-                m_prevFrameElapsedSecs = 0.0f;
+
+                if (ts <= 0.0f)
+                {
+                    m_prevFrameElapsedSecs = 0.0f;
+                    break;
+                }
+                m_prevFrameElapsedSecs -= ts;
+                ts = currFrameTimeSpan();
             }
         }
         else m_currFrameIndex = SIZE_MAX;
@@ -54,9 +66,12 @@ namespace d14engine::uikit::animation_utils
     {
         if (visible && m_currFrameIndex >= 0 && m_currFrameIndex < frames.size())
         {
+            auto sourceRect = (m_currFrameIndex < sourceRects.size()) ?
+                &sourceRects[m_currFrameIndex] : nullptr;
+
             rndr->d2d1DeviceContext()->DrawBitmap(
                 frames[m_currFrameIndex].Get(), rect,
-                opacity, BitmapObject::g_interpolationMode);
+                opacity, BitmapObject::g_interpolationMode, sourceRect);
         }
     }
 }
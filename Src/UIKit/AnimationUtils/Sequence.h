@@ -35,10 +35,19 @@ namespace d14engine::uikit::animation_utils
 
         TimeSpanArray timeSpansInSecs = {};
 
+        // The frames may share the same bitmap (e.g. an atlas page) and be
+        // selected by the source rectangles, which are ignored if empty.
+
+        using SourceRectArray = std::vector<D2D1_RECT_F>;
+
+        SourceRectArray sourceRects = {};
+
     private:
         size_t m_currFrameIndex = SIZE_MAX;
         float m_prevFrameElapsedSecs = 0.0f;
 
+        float currFrameTimeSpan() const;
+
     public:
         void restore();
 
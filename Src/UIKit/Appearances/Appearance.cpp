@@ -1,10 +1,6 @@
 ﻿#include "Common/Precompile.h"
 
 #include "UIKit/Application.h"
-#include "UIKit/ColorUtils.h"
-
-using namespace d14engine::uikit::color_utils;
-
 #include "UIKit/Appearances/Button.h"
 #include "UIKit/Appearances/CheckBox.h"
 #include "UIKit/Appearances/ComboBox.h"
@@ -78,38 +74,9 @@ namespace d14engine::uikit::appearance
         }
         else themeStyle = Application::g_app->systemThemeStyle();
 
-        iHSB hsb = rgb2hsb(convert(themeStyle.color));
-        iHSB primary = hsb, secondary = hsb, tertiary = hsb;
+        bool light = (themeStyle.mode == Application::ThemeStyle::Mode::Light);
 
-        // Transform HSB color according to the selected theme mode.
-        // Also see D14Engine/Src/UIKit/Appearances/ColorScheme.txt.
-        switch (themeStyle.mode)
-        {
-        case Application::ThemeStyle::Mode::Light:
-        {
-            primary.S = 100;
-            secondary.S = 85;
-            tertiary.S = 70;
-            primary.B = 70;
-            secondary.B = 75;
-            tertiary.B = 80;
-            break;
-        }
-        case Application::ThemeStyle::Mode::Dark:
-        {
-            primary.S = 50;
-            secondary.S = 50;
-            tertiary.S = 50;
-            primary.B = 90;
-            secondary.B = 85;
-            tertiary.B = 80;
-            break;
-        }
-        default: break;
-        }
-        g_colorGroup.primary = convert(hsb2rgb(primary));
-        g_colorGroup.secondary = convert(hsb2rgb(secondary));
-        g_colorGroup.tertiary = convert(hsb2rgb(tertiary));
+        *this = generate(themeStyle.color, light ? ThemeID::Light : ThemeID::Dark);
     }
 
     ColorGroup g_colorGroup = {};
@@ -2,10 +2,46 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/EnumClassMap.h"
+
+#include "UIKit/ColorUtils.h"
+
 namespace d14engine::uikit::appearance
 {
     void initialize();
 
+#pragma region Theme IDs
+
+    // The built-in themes, by which the theme styles are indexed, so that
+    // reading a theme style is an array indexing instead of a hash lookup.
+    enum class ThemeID { Light, Dark, Count };
+
+    // The unknown theme names fall back to Light.
+    inline ThemeID themeID(WstrParam themeName)
+    {
+        if (themeName == L"Dark") return ThemeID::Dark;
+
+        return ThemeID::Light;
+    }
+
+    template<typename ThemeStyle_T>
+    struct ThemeStyleTable : cpp_lang_utils::EnumClassMap<ThemeID, ThemeStyle_T>
+    {
+        using Base = cpp_lang_utils::EnumClassMap<ThemeID, ThemeStyle_T>;
+
+        using Base::operator[];
+        using Base::at;
+
+        ThemeStyle_T& operator[](ThemeID id) { return Base::operator[]((size_t)id); }
+        const ThemeStyle_T& operator[](ThemeID id) const { return Base::operator[]((size_t)id); }
+
+        // Kept for the callers that refer to the themes by name.
+        ThemeStyle_T& at(WstrParam themeName) { return (*this)[themeID(themeName)]; }
+        const ThemeStyle_T& at(WstrParam themeName) const { return (*this)[themeID(themeName)]; }
+    };
+
+#pragma endregion
+
 #pragma region Interfaces
 
     struct Appearance
@@ -24,7 +60,7 @@ namespace d14engine::uikit::appearance
     }
 
 #define _D14_SET_THEME_STYLE_MAP_DECL \
-    using ThemeStyleMap = std::unordered_map<Wstring, ThemeStyle>; \
+    using ThemeStyleMap = ThemeStyleTable<ThemeStyle>; \
     static ThemeStyleMap g_themeStyles
 
 #define _D14_REF_THEME_STYLE_MAP_DECL(Type_Name) \
@@ -65,22 +101,63 @@ namespace d14engine::uikit::appearance
     {
         D2D1_COLOR_F primary = {}, secondary = {}, tertiary = {};
 
+        // Only the accent color is decided at runtime (by the system or the
+        // custom theme style), so the toned colors of any known accent can
+        // be generated at compile time with this.
+        static constexpr ColorGroup generate(const D2D1_COLOR_F& accent, ThemeID theme);
+
         void generateTonedColors();
     };
     // Generated from the selected theme style dynamically.
     extern ColorGroup g_colorGroup;
 
+    constexpr ColorGroup ColorGroup::generate(const D2D1_COLOR_F& accent, ThemeID theme)
+    {
+        using namespace color_utils;
+
+        iHSB hsb = rgb2hsb(convert(accent));
+        iHSB primary = hsb, secondary = hsb, tertiary = hsb;
+
+        // Transform HSB color according to the selected theme mode.
+        // Also see D14Engine/Src/UIKit/Appearances/ColorScheme.txt.
+        switch (theme)
+        {
+        case ThemeID::Light:
+        {
+            primary.S = 100;
+            secondary.S = 85;
+            tertiary.S = 70;
+            primary.B = 70;
+            secondary.B = 75;
+            tertiary.B = 80;
+            break;
+        }
+        case ThemeID::Dark:
+        {
+            primary.S = 50;
+            secondary.S = 50;
+            tertiary.S = 50;
+            primary.B = 90;
+            secondary.B = 85;
+            tertiary.B = 80;
+            break;
+        }
+        default: break;
+        }
+        return
+        {
+            convert(hsb2rgb(primary)),
+            convert(hsb2rgb(secondary)),
+            convert(hsb2rgb(tertiary))
+        };
+    }
+
 #pragma endregion
 
 #pragma region Macro Helpers
 
 #define _D14_FIND_THEME_STYLE(Theme_Name) \
-    auto _itor  = g_themeStyles.find(themeName); \
-    if ( _itor == g_themeStyles.end()) \
-    { \
-         _itor  = g_themeStyles.find(L"Light"); \
-    } \
-    auto& _ref  = _itor->second /* fall through */
+    auto& _ref = g_themeStyles[themeID(themeName)] /* fall back to Light */
 
 #define _D14_UPDATE_THEME_STYLE_DATA_1(Data_Name) \
     Data_Name = _ref.Data_Name
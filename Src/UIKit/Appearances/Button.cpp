@@ -12,11 +12,11 @@ namespace d14engine::uikit::appearance
 
     void Button::Appearance::initialize()
     {
-        auto& light = (g_themeStyles[L"Light"] = {});
+        auto& light = (g_themeStyles[ThemeID::Light] = {});
         {
             light.foreground.color = D2D1::ColorF{ 0x000000 };
         }
-        auto& dark = (g_themeStyles[L"Dark"] = {});
+        auto& dark = (g_themeStyles[ThemeID::Dark] = {});
         {
             dark.foreground.color = D2D1::ColorF{ 0xe5e5e5 };
         }
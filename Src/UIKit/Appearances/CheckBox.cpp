@@ -6,7 +6,7 @@ namespace d14engine::uikit::appearance
 {
     void CheckBox::Appearance::initialize()
     {
-        auto& light = (g_themeStyles[L"Light"] = {});
+        auto& light = (g_themeStyles[ThemeID::Light] = {});
         {
             light.icon.background[(size_t)CheckBoxState::Flag::UncheckedIdle] =
             light.icon.background[(size_t)CheckBoxState::Flag::UncheckedHover] =
@@ -104,7 +104,7 @@ namespace d14engine::uikit::appearance
                 }
             };
         }
-        auto& dark = (g_themeStyles[L"Dark"] = {});
+        auto& dark = (g_themeStyles[ThemeID::Dark] = {});
         {
             dark.icon.background[(size_t)CheckBoxState::Flag::UncheckedIdle] =
             dark.icon.background[(size_t)CheckBoxState::Flag::UncheckedHover] =
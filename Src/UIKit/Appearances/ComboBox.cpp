@@ -6,7 +6,7 @@ namespace d14engine::uikit::appearance
 {
     void ComboBox::Appearance::initialize()
     {
-        auto& light = (g_themeStyles[L"Light"]);
+        auto& light = (g_themeStyles[ThemeID::Light]);
         {
             light.main[(size_t)uikit::Button::State::Idle] =
             {
@@ -87,7 +87,7 @@ namespace d14engine::uikit::appearance
             light.arrow.background.color = D2D1::ColorF{ 0x000000 };
             light.arrow.secondaryBackground.color = D2D1::ColorF{ 0x9e9e9e };
         }
-        auto& dark = (g_themeStyles[L"Dark"]);
+        auto& dark = (g_themeStyles[ThemeID::Dark]);
         {
             dark.main[(size_t)uikit::Button::State::Idle] =
             {
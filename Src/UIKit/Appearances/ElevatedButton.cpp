@@ -6,7 +6,7 @@ namespace d14engine::uikit::appearance
 {
     void ElevatedButton::Appearance::initialize()
     {
-        auto& light = (g_themeStyles[L"Light"] = {});
+        auto& light = (g_themeStyles[ThemeID::Light] = {});
         {
             light.shadow.color[(size_t)uikit::Button::State::Idle] =
             light.shadow.color[(size_t)uikit::Button::State::Hover] = D2D1::ColorF
@@ -21,7 +21,7 @@ namespace d14engine::uikit::appearance
                 0.0f // alpha
             };
         }
-        auto& dark = (g_themeStyles[L"Dark"] = {});
+        auto& dark = (g_themeStyles[ThemeID::Dark] = {});
         {
             dark.shadow.color[(size_t)uikit::Button::State::Idle] =
             dark.shadow.color[(size_t)uikit::Button::State::Hover] = D2D1::ColorF
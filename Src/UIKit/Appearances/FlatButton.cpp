@@ -6,7 +6,7 @@ namespace d14engine::uikit::appearance
 {
     void FlatButton::Appearance::initialize()
     {
-        auto& light = (g_themeStyles[L"Light"] = {});
+        auto& light = (g_themeStyles[ThemeID::Light] = {});
         {
             light.main[(size_t)uikit::Button::State::Idle] =
             {
@@ -85,7 +85,7 @@ namespace d14engine::uikit::appearance
                 }
             };
         }
-        auto& dark = (g_themeStyles[L"Dark"] = {});
+        auto& dark = (g_themeStyles[ThemeID::Dark] = {});
         {
             dark.main[(size_t)uikit::Button::State::Idle] =
             {
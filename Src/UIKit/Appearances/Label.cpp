@@ -12,12 +12,12 @@ namespace d14engine::uikit::appearance
 
     void Label::Appearance::initialize()
     {
-        auto& light = (g_themeStyles[L"Light"] = {});
+        auto& light = (g_themeStyles[ThemeID::Light] = {});
         {
             light.foreground.color = D2D1::ColorF{ 0x000000 };
             light.secondaryForeground.color = D2D1::ColorF{ 0x9e9e9e };
         }
-        auto& dark = (g_themeStyles[L"Dark"] = {});
+        auto& dark = (g_themeStyles[ThemeID::Dark] = {});
         {
             dark.foreground.color = D2D1::ColorF{ 0xe5e5e5 };
             dark.secondaryForeground.color = D2D1::ColorF{ 0x777777 };
@@ -11,12 +11,12 @@ namespace d14engine::uikit::appearance
 
     void LabelArea::Appearance::initialize()
     {
-        auto& light = (g_themeStyles[L"Light"] = {});
+        auto& light = (g_themeStyles[ThemeID::Light] = {});
         {
             light.hiliteRange.background.color = D2D1::ColorF{ 0xadd6ff };
             light.indicator.background.color = D2D1::ColorF{ 0x000000 };
         }
-        auto& dark = (g_themeStyles[L"Dark"] = {});
+        auto& dark = (g_themeStyles[ThemeID::Dark] = {});
         {
             dark.hiliteRange.background.color = D2D1::ColorF{ 0x264f78 };
             dark.indicator.background.color = D2D1::ColorF{ 0xffffff };
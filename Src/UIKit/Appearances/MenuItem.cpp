@@ -6,7 +6,7 @@ namespace d14engine::uikit::appearance
 {
     void MenuItem::Appearance::initialize()
     {
-        auto& light = (g_themeStyles[L"Light"] = {});
+        auto& light = (g_themeStyles[ThemeID::Light] = {});
         {
             light.main[(size_t)ViewItem::State::Idle] =
             {
@@ -58,7 +58,7 @@ namespace d14engine::uikit::appearance
                 1.0f // opacity
             };
         }
-        auto& dark = (g_themeStyles[L"Dark"] = {});
+        auto& dark = (g_themeStyles[ThemeID::Dark] = {});
         {
             dark.main[(size_t)ViewItem::State::Idle] =
             {
@@ -60,7 +60,7 @@ namespace d14engine::uikit::appearance
 
     void OnOffSwitch::Appearance::initialize()
     {
-        auto& light = (g_themeStyles[L"Light"] = {});
+        auto& light = (g_themeStyles[ThemeID::Light] = {});
         {
             light.main[(size_t)OnOffSwitchState::Flag::OnDisabled] =
             {
@@ -165,7 +165,7 @@ namespace d14engine::uikit::appearance
                 1.0f // opacity
             };
         }
-        auto& dark = (g_themeStyles[L"Dark"] = {});
+        auto& dark = (g_themeStyles[ThemeID::Dark] = {});
         {
             dark.main[(size_t)OnOffSwitchState::Flag::OnDisabled] =
             {
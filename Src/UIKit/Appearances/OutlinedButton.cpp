@@ -6,7 +6,7 @@ namespace d14engine::uikit::appearance
 {
     void OutlinedButton::Appearance::initialize()
     {
-        auto& light = (g_themeStyles[L"Light"] = {});
+        auto& light = (g_themeStyles[ThemeID::Light] = {});
         {
             light.main[(size_t)uikit::Button::State::Disabled] =
             {
@@ -28,7 +28,7 @@ namespace d14engine::uikit::appearance
                 }
             };
         }
-        auto& dark = (g_themeStyles[L"Dark"] = {});
+        auto& dark = (g_themeStyles[ThemeID::Dark] = {});
         {
             dark.main[(size_t)uikit::Button::State::Disabled] =
             {
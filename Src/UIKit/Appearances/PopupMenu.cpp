@@ -6,7 +6,7 @@ namespace d14engine::uikit::appearance
 {
     void PopupMenu::Appearance::initialize()
     {
-        auto& light = (g_themeStyles[L"Light"] = {});
+        auto& light = (g_themeStyles[ThemeID::Light] = {});
         {
             light.background =
             {
@@ -15,7 +15,7 @@ namespace d14engine::uikit::appearance
             };
             light.shadow.color = D2D1::ColorF{ 0x808080 };
         }
-        auto& dark = (g_themeStyles[L"Dark"] = {});
+        auto& dark = (g_themeStyles[ThemeID::Dark] = {});
         {
             dark.background =
             {
@@ -6,7 +6,7 @@ namespace d14engine::uikit::appearance
 {
     void RawTextInput::Appearance::initialize()
     {
-        auto& light = (g_themeStyles[L"Light"] = {});
+        auto& light = (g_themeStyles[ThemeID::Light] = {});
         {
             light.background.color = D2D1::ColorF{ 0xfdfdfd };
             light.stroke.color = D2D1::ColorF{ 0xe5e5e5 };
@@ -17,7 +17,7 @@ namespace d14engine::uikit::appearance
                 1.0f // opacity
             };
         }
-        auto& dark = (g_themeStyles[L"Dark"] = {});
+        auto& dark = (g_themeStyles[ThemeID::Dark] = {});
         {
             dark.background.color = D2D1::ColorF{ 0x343434 };
             dark.stroke.color = D2D1::ColorF{ 0x1d1d1d };
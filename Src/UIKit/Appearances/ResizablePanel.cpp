@@ -6,7 +6,7 @@ namespace d14engine::uikit::appearance
 {
     void ResizablePanel::Appearance::initialize()
     {
-        g_themeStyles = { { L"Light", {} }, { L"Dark", {} } };
+        g_themeStyles = {};
     }
     _D14_SET_THEME_STYLE_MAP_IMPL(ResizablePanel);
 
@@ -20,7 +20,7 @@ namespace d14engine::uikit::appearance
 
     void Slider::Appearance::initialize()
     {
-        auto& light = (g_themeStyles[L"Light"] = {});
+        auto& light = (g_themeStyles[ThemeID::Light] = {});
         {
             light.bar.filled.secondaryBackground =
             {
@@ -48,7 +48,7 @@ namespace d14engine::uikit::appearance
             };
             light.valueLabel.shadow.color = D2D1::ColorF{ 0x8c8c8c };
         }
-        auto& dark = (g_themeStyles[L"Dark"] = {});
+        auto& dark = (g_themeStyles[ThemeID::Dark] = {});
         {
             dark.bar.filled.secondaryBackground =
             {
@@ -6,7 +6,7 @@ namespace d14engine::uikit::appearance
 {
     void TabCaption::Appearance::initialize()
     {
-        auto& light = (g_themeStyles[L"Light"] = {});
+        auto& light = (g_themeStyles[ThemeID::Light] = {});
         {
             light.closeX.icon.background[(size_t)ButtonState::Idle] =
             {
@@ -39,7 +39,7 @@ namespace d14engine::uikit::appearance
                 0.2f // opacity
             };
         }
-        auto& dark = (g_themeStyles[L"Dark"] = {});
+        auto& dark = (g_themeStyles[ThemeID::Dark] = {});
         {
             dark.closeX.icon.background[(size_t)ButtonState::Idle] =
             {
@@ -21,7 +21,7 @@ namespace d14engine::uikit::appearance
 
     void TabGroup::Appearance::initialize()
     {
-        auto& light = (g_themeStyles[L"Light"] = {});
+        auto& light = (g_themeStyles[ThemeID::Light] = {});
         {
             light.background.color = D2D1::ColorF{ 0xf3f3f3 };
             light.stroke.color = D2D1::ColorF{ 0xe5e5e5 };
@@ -70,7 +70,7 @@ namespace d14engine::uikit::appearance
                 0.65f // opacity
             };
         }
-        auto& dark = (g_themeStyles[L"Dark"] = {});
+        auto& dark = (g_themeStyles[ThemeID::Dark] = {});
         {
             dark.background.color = D2D1::ColorF{ 0x202020 };
             dark.stroke.color = D2D1::ColorF{ 0x1d1d1d };
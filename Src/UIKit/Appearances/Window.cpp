@@ -6,7 +6,7 @@ namespace d14engine::uikit::appearance
 {
     void Window::Appearance::initialize()
     {
-        auto& light = (g_themeStyles[L"Light"] = {});
+        auto& light = (g_themeStyles[ThemeID::Light] = {});
         {
             light.background.color = D2D1::ColorF{ 0xf9f9f9 };
             light.shadow.color = D2D1::ColorF{ 0x808080 };
@@ -94,7 +94,7 @@ namespace d14engine::uikit::appearance
                 }
             };
         }
-        auto& dark = (g_themeStyles[L"Dark"] = {});
+        auto& dark = (g_themeStyles[ThemeID::Dark] = {});
         {
             dark.background.color = D2D1::ColorF{ 0x272727 };
             dark.shadow.color = D2D1::ColorF{ 0x000000 };
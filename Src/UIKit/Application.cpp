@@ -3,7 +3,6 @@
 #include "UIKit/Application.h"
 
 #include "Common/CppLangUtils/FinalAction.h"
-#include "Common/CppLangUtils/PointerEquality.h"
 #include "Common/DirectXError.h"
 #include "Common/MathUtils/GDI.h"
 
@@ -13,8 +12,10 @@
 #include "UIKit/Appearances/Appearance.h"
 #include "UIKit/BitmapUtils.h"
 #include "UIKit/Cursor.h"
+#include "UIKit/DrawStatisticsOverlay.h"
 #include "UIKit/PlatformUtils.h"
 #include "UIKit/ResourceUtils.h"
+#include "UIKit/TextAtlas.h"
 #include "UIKit/TextInputObject.h"
 
 using namespace d14engine::renderer;
@@ -152,6 +153,8 @@ namespace d14engine::uikit
         m_cursor->setVisible(false);
         m_cursor->registerDrawObjects();
         // The cursor does not need to receive any UI event.
+
+        m_textAtlas = std::make_shared<TextAtlas>();
     }
 
     int Application::run(FuncParam<void(Application* app)> onLaunch)
@@ -183,9 +186,13 @@ namespace d14engine::uikit
             // Use "else-if" instead of "if" here to empty the Win32 message
             // queue between each frame since there are usually dozens of UI
             // messages queued up during a single frame.
-            else if (m_animationCount > 0)
+            else
             {
-                m_renderer->renderNextFrame();
+                // Dispatch the mouse events collected during the frame,
+                // which also invalidates the window to request a WM_PAINT.
+                flushCoalescedInput();
+
+                if (m_animationCount > 0) m_renderer->renderNextFrame();
             }
         }
         return (int)msg.wParam;
@@ -223,6 +230,18 @@ namespace d14engine::uikit
                 return 0;
             }
         }
+        if (app != nullptr && !app->m_isHandlingSensitiveUIEvent)
+        {
+            // WM_SETCURSOR and WM_NCHITTEST are sent along with each mouse
+            // movement, so they must not break the coalescing.
+            if (message != WM_MOUSEMOVE &&
+                message != WM_MOUSEWHEEL &&
+                message != WM_SETCURSOR &&
+                message != WM_NCHITTEST)
+            {
+                app->flushCoalescedInput();
+            }
+        }
         switch (message)
         {
         case WM_SIZE:
@@ -342,7 +361,6 @@ namespace d14engine::uikit
         case WM_MOUSEMOVE:
         {
             if (app == nullptr) return 0;
-            app->m_isHandlingSensitiveUIEvent = true;
 
             auto rawCursorPoint =
             platform_utils::restoredByDpi(POINT
@@ -355,140 +373,12 @@ namespace d14engine::uikit
                 (float)rawCursorPoint.x,
                 (float)rawCursorPoint.y
             };
-            if (!app->isTriggerDraggingWin32Window)
-            {
-                app->m_cursor->move(cursorPoint.x, cursorPoint.y);
-            }
-            app->m_cursor->setIcon(Cursor::Arrow);
-
-            MouseMoveEvent e = {};
-            e.cursorPoint = cursorPoint;
-
-            e.buttonState.leftPressed = wParam & MK_LBUTTON;
-            e.buttonState.middlePressed = wParam & MK_MBUTTON;
-            e.buttonState.rightPressed = wParam & MK_RBUTTON;
-
-            e.keyState.ALT = wParam & MK_ALT;
-            e.keyState.CTRL = wParam & MK_CONTROL;
-            e.keyState.SHIFT = wParam & MK_SHIFT;
-
-            e.lastCursorPoint = app->m_lastCursorPoint;
-            app->m_lastCursorPoint = e.cursorPoint;
-
-            if (!app->m_currFocusedUIObject.expired() &&
-                 app->m_currFocusedUIObject.lock()->forceGlobalExclusiveFocusing)
-            {
-                app->m_currFocusedUIObject.lock()->onMouseMove(e);
-            }
-            else // Deliver mouse-move event normally.
-            {
-                UIObjectTempSet currHitUIObjects = {};
-                for (auto& uiobj : app->m_uiObjects)
-                {
-                    if (uiobj->appEventReactability.hitTest && uiobj->isHit(cursorPoint))
-                    {
-                        currHitUIObjects.insert(uiobj);
-                    }
-                }
-                if (app->forceSingleMouseEnterLeaveEvent)
-                {
-                    WeakPtr<Panel> enterCandidate = {}, leaveCandidate = {};
-                    if (!currHitUIObjects.empty())
-                    {
-                        enterCandidate = *currHitUIObjects.begin();
-                    }
-                    if (!app->m_hitUIObjects.empty())
-                    {
-                        leaveCandidate = *app->m_hitUIObjects.begin();
-                    }
-                    if (!cpp_lang_utils::isMostDerivedEqual(enterCandidate.lock(), leaveCandidate.lock()))
-                    {
-                        if (!enterCandidate.expired())
-                        {
-                            auto candidate = enterCandidate.lock();
-                            if (candidate->appEventReactability.mouse.enter)
-                            {
-                                candidate->onMouseEnter(e);
-                            }
-                        }
-                        if (!leaveCandidate.expired())
-                        {
-                            auto candidate = leaveCandidate.lock();
-                            if (candidate->appEventReactability.mouse.leave)
-                            {
-                                candidate->onMouseLeave(e);
-                            }
-                        }
-                    }
-                }
-                else // trigger multiple mouse-enter-leave events
-                {
-                    ISortable<Panel>::foreach(currHitUIObjects, [&](ShrdPtrParam<Panel> uiobj)
-                    {
-                        // Moved in just now, trigger mouse-enter event.
-                        if (app->m_hitUIObjects.find(uiobj) == app->m_hitUIObjects.end())
-                        {
-                            if (uiobj->appEventReactability.mouse.enter)
-                            {
-                                uiobj->onMouseEnter(e);
-                            }
-                            return uiobj->appEventTransparency.mouse.enter;
-                        }
-                        return true;
-                    });
-                    ISortable<Panel>::foreach(app->m_hitUIObjects, [&](ShrdPtrParam<Panel> uiobj)
-                    {
-                        // Moved out just now, trigger mouse-leave event.
-                        if (currHitUIObjects.find(uiobj) == currHitUIObjects.end())
-                        {
-                            if (uiobj->appEventReactability.mouse.leave)
-                            {
-                                uiobj->onMouseLeave(e);
-                            }
-                            return uiobj->appEventTransparency.mouse.leave;
-                        }
-                        return true;
-                    });
-                }
-                app->m_hitUIObjects = std::move(currHitUIObjects);
-
-                ISortable<Panel>::foreach(app->m_hitUIObjects, [&](ShrdPtrParam<Panel> uiobj)
-                {
-                    if (uiobj->appEventReactability.mouse.move)
-                    {
-                        uiobj->onMouseMove(e);
-                    }
-                    return uiobj->appEventTransparency.mouse.move;
-                });
-                app->updateDiffPinnedUIObjects();
-
-                ISortable<Panel>::foreach(app->m_diffPinnedUIObjects, [&](ShrdPtrParam<Panel> uiobj)
-                {
-                    if (uiobj->appEventReactability.mouse.move)
-                    {
-                        uiobj->onMouseMove(e);
-                    }
-                    return uiobj->appEventTransparency.mouse.move;
-                });
-            }
-            // Register mouse-leave event for the Win32 window.
-            TRACKMOUSEEVENT tme = {};
-            tme.cbSize = sizeof(TRACKMOUSEEVENT);
-            tme.dwFlags = TME_LEAVE;
-            tme.hwndTrack = hwnd;
-
-            TrackMouseEvent(&tme);
-
-            // The cursor will be hidden if moves out of the Win32 window,
-            // so we need to show it explicitly in every mouse-move event.
-            app->m_cursor->setVisible(true);
-            if (app->m_cursor->useSystemIcons)
+            if (app->coalesceMouseInput)
             {
-                app->m_cursor->setSystemIcon();
+                app->m_inputCoalescer.pushMove(cursorPoint, (uint32_t)wParam);
             }
-            InvalidateRect(hwnd, nullptr, FALSE);
+            else app->handleMouseMoveEvent(cursorPoint, (uint32_t)wParam, { &cursorPoint, 1 });
 
-            app->m_isHandlingSensitiveUIEvent = false;
             return 0;
         }
         case WM_MOUSELEAVE:
@@ -527,6 +417,7 @@ namespace d14engine::uikit
                     return uiobj->appEventTransparency.mouse.leave;
                 });
                 app->m_hitUIObjects.clear();
+                app->m_hitUIObjectsCache.invalidate();
             }
             app->m_cursor->setVisible(false);
 
@@ -612,7 +503,6 @@ namespace d14engine::uikit
         case WM_MOUSEWHEEL:
         {
             if (app == nullptr) return 0;
-            app->m_isHandlingSensitiveUIEvent = true;
 
             POINT screenCursorPoint =
             {
@@ -623,52 +513,20 @@ namespace d14engine::uikit
 
             screenCursorPoint = platform_utils::restoredByDpi(screenCursorPoint);
 
-            MouseWheelEvent e = {};
-            e.cursorPoint =
+            D2D1_POINT_2F cursorPoint =
             {
                 (float)screenCursorPoint.x,
                 (float)screenCursorPoint.y
             };
-            auto lowParam = LOWORD(wParam);
+            auto state = (uint32_t)LOWORD(wParam);
+            auto wheelDelta = (int)GET_WHEEL_DELTA_WPARAM(wParam);
 
-            e.buttonState.leftPressed = lowParam & MK_LBUTTON;
-            e.buttonState.middlePressed = lowParam & MK_MBUTTON;
-            e.buttonState.rightPressed = lowParam & MK_RBUTTON;
-
-            e.keyState.CTRL = lowParam & MK_CONTROL;
-            e.keyState.SHIFT = lowParam & MK_SHIFT;
-
-            // The wheel distance can be negative.
-            e.deltaCount = GET_Y_LPARAM(wParam) / WHEEL_DELTA;
-
-            if (!app->m_currFocusedUIObject.expired() &&
-                 app->m_currFocusedUIObject.lock()->forceGlobalExclusiveFocusing)
-            {
-                app->m_currFocusedUIObject.lock()->onMouseWheel(e);
-            }
-            else // Deliver mouse-wheel event normally.
+            if (app->coalesceMouseInput)
             {
-                ISortable<Panel>::foreach(app->m_hitUIObjects, [&](ShrdPtrParam<Panel> uiobj)
-                {
-                    if (uiobj->appEventReactability.mouse.wheel)
-                    {
-                        uiobj->onMouseWheel(e);
-                    }
-                    return uiobj->appEventTransparency.mouse.wheel;
-                });
-                ISortable<Panel>::foreach(app->m_diffPinnedUIObjects, [&](ShrdPtrParam<Panel> uiobj)
-                {
-                    if (uiobj->appEventReactability.mouse.wheel)
-                    {
-                        uiobj->onMouseWheel(e);
-                    }
-                    return uiobj->appEventTransparency.mouse.wheel;
-                });
-                app->handleImmediateMouseMoveEventCallback();
+                app->m_inputCoalescer.pushWheel(cursorPoint, state, wheelDelta);
             }
-            InvalidateRect(hwnd, nullptr, FALSE);
+            else app->handleMouseWheelEvent(cursorPoint, state, wheelDelta);
 
-            app->m_isHandlingSensitiveUIEvent = false;
             return 0;
         }
         case WM_KEYDOWN:
@@ -805,6 +663,14 @@ namespace d14engine::uikit
             }
             return 0;
         }
+        case (UINT)CustomWin32Message::HandleImmediateMouseMoveEvent:
+        {
+            if (app != nullptr)
+            {
+                app->handleImmediateMouseMoveEventCallback();
+            }
+            return 0;
+        }
         case WM_DESTROY:
         {
             PostQuitMessage(0);
@@ -902,6 +768,48 @@ namespace d14engine::uikit
         return bitmap_utils::loadBitmap(pixSize.width, pixSize.height, mapped);
     }
 
+    void Application::requestScreenshot(const ScreenshotCallback& callback)
+    {
+        m_renderer->requestSceneReadback([=](const ReadbackRingBuffer::Frame& frame)
+        {
+            auto image = bitmap_utils::loadBitmap(frame.width, frame.height);
+            THROW_IF_FAILED(image->CopyFromMemory(nullptr, frame.data, frame.rowPitch));
+
+            if (callback) callback(image);
+        });
+    }
+
+    void Application::startRecording(const FrameWriter::Settings& settings)
+    {
+        stopRecording();
+
+        m_recorder = std::make_shared<FrameWriter>(settings);
+
+        // The frames in flight may be read back after stopRecording.
+        WeakPtr<FrameWriter> weakRecorder = m_recorder;
+
+        m_renderer->setSceneRecorder([=](const ReadbackRingBuffer::Frame& frame)
+        {
+            if (auto recorder = weakRecorder.lock())
+            {
+                recorder->push(frame.width, frame.height, frame.data, frame.rowPitch);
+            }
+        });
+    }
+
+    void Application::stopRecording()
+    {
+        m_renderer->setSceneRecorder(nullptr);
+
+        // The frames captured but not read back yet are discarded.
+        m_recorder.reset();
+    }
+
+    FrameWriter* Application::recorder() const
+    {
+        return m_recorder.get();
+    }
+
     int Application::animationCount() const
     {
         return m_animationCount;
@@ -958,11 +866,14 @@ namespace d14engine::uikit
             m_topmostPriority.uiObject,
             uiobj->ISortable<Panel>::m_priority
         );
+        HitTestCache::invalidateAll();
     }
 
     void Application::removeUIObject(ShrdPtrParam<Panel> uiobj)
     {
         m_uiObjects.erase(uiobj);
+
+        HitTestCache::invalidateAll();
     }
 
     void Application::pinUIObject(ShrdPtrParam<Panel> uiobj)
@@ -1015,7 +926,7 @@ namespace d14engine::uikit
 
     void Application::focusUIObject(ShrdPtrParam<Panel> uiobj)
     {
-        if (!cpp_lang_utils::isMostDerivedEqual(m_currFocusedUIObject.lock(), uiobj))
+        if (!isSameUIObject(m_currFocusedUIObject.lock(), uiobj))
         {
             if (!m_currFocusedUIObject.expired())
             {
@@ -1032,7 +943,11 @@ namespace d14engine::uikit
             if (uiobj && uiobj->appEventReactability.focus.get)
             {
                 m_currFocusedUIObject = uiobj;
-                m_focusedTextInputObject = std::dynamic_pointer_cast<TextInputObject>(uiobj);
+                if (auto textInput = uiobj->textInputObject())
+                {
+                    // Share the ownership with the UI object.
+                    m_focusedTextInputObject = SharedPtr<TextInputObject>(uiobj, textInput);
+                }
 
                 uiobj->onGetFocus();
             }
@@ -1049,6 +964,60 @@ namespace d14engine::uikit
         return m_lastCursorPoint;
     }
 
+    TextAtlas* Application::textAtlas() const
+    {
+        return m_textAtlas.get();
+    }
+
+    DrawStatistics* Application::drawStatistics()
+    {
+        return m_drawStatisticsOverlay ? &m_drawStatistics : nullptr;
+    }
+
+    bool Application::isDrawStatisticsEnabled() const
+    {
+        return m_drawStatisticsOverlay != nullptr;
+    }
+
+    void Application::setDrawStatisticsEnabled(bool value)
+    {
+        if (value == isDrawStatisticsEnabled()) return;
+
+        auto& drawobjs2d = std::get<Renderer::CommandLayer::D2D1Target>(m_uiCmdLayer->drawTarget);
+        if (value)
+        {
+            m_drawStatisticsOverlay = std::make_shared<DrawStatisticsOverlay>(&m_drawStatistics);
+            drawobjs2d.insert(m_drawStatisticsOverlay);
+        }
+        else // disable
+        {
+            drawobjs2d.erase(m_drawStatisticsOverlay);
+            m_drawStatisticsOverlay.reset();
+
+            m_drawStatistics = {};
+        }
+    }
+
+    bool Application::isOverdrawHeatMapVisible() const
+    {
+        return m_drawStatisticsOverlay && m_drawStatisticsOverlay->showHeatMap;
+    }
+
+    void Application::setOverdrawHeatMapVisible(bool value)
+    {
+        if (value) setDrawStatisticsEnabled(true);
+
+        if (m_drawStatisticsOverlay)
+        {
+            m_drawStatisticsOverlay->showHeatMap = value;
+        }
+    }
+
+    std::string Application::dumpDrawStatistics() const
+    {
+        return m_drawStatisticsOverlay ? m_drawStatistics.dump() : std::string{};
+    }
+
     const Wstring& Application::currThemeName() const
     {
         return m_currThemeName;
@@ -1068,12 +1037,33 @@ namespace d14engine::uikit
         }        
         m_currThemeName = themeName;
 
-        for (auto& uiobj : m_uiObjects)
+        // The cached texts are rasterized with the colors of the old theme.
+        m_textAtlas->invalidate();
+
+        // Instead of walking all the UI objects here, which freezes the UI
+        // if there are tens of thousands of them, only bump the generation
+        // and let each UI object catch up before being drawn next time.
+        for (auto& uiobj : m_themeGeneration.advance())
         {
             uiobj->onChangeTheme(themeName);
         }
     }
 
+    UINT64 Application::themeGeneration() const
+    {
+        return m_themeGeneration.value();
+    }
+
+    void Application::subscribeThemeChange(ShrdPtrParam<Panel> uiobj)
+    {
+        m_themeGeneration.subscribe(uiobj);
+    }
+
+    void Application::unsubscribeThemeChange(ShrdPtrParam<Panel> uiobj)
+    {
+        m_themeGeneration.unsubscribe(uiobj);
+    }
+
     void Application::ThemeStyle::querySystemSettingsFromRegistry()
     {
         querySystemModeSetting();
@@ -1137,6 +1127,249 @@ namespace d14engine::uikit
         }
     }
 
+    void Application::handleMouseMoveEvent(
+        const D2D1_POINT_2F& cursorPoint,
+        uint32_t state,
+        std::span<const D2D1_POINT_2F> history)
+    {
+        m_isHandlingSensitiveUIEvent = true;
+
+        if (!isTriggerDraggingWin32Window)
+        {
+            m_cursor->move(cursorPoint.x, cursorPoint.y);
+        }
+        m_cursor->setIcon(Cursor::Arrow);
+
+        MouseMoveEvent e = {};
+        e.cursorPoint = cursorPoint;
+
+        e.buttonState.leftPressed = state & MK_LBUTTON;
+        e.buttonState.middlePressed = state & MK_MBUTTON;
+        e.buttonState.rightPressed = state & MK_RBUTTON;
+
+        e.keyState.ALT = state & MK_ALT;
+        e.keyState.CTRL = state & MK_CONTROL;
+        e.keyState.SHIFT = state & MK_SHIFT;
+
+        e.history = history;
+
+        e.lastCursorPoint = m_lastCursorPoint;
+        m_lastCursorPoint = e.cursorPoint;
+
+        if (!m_currFocusedUIObject.expired() &&
+             m_currFocusedUIObject.lock()->forceGlobalExclusiveFocusing)
+        {
+            m_currFocusedUIObject.lock()->onMouseMove(e);
+        }
+        else // Deliver mouse-move event normally.
+        {
+            UIObjectTempSet currHitUIObjects = {};
+
+            HitTestCache::Point cachePoint = { cursorPoint.x, cursorPoint.y };
+
+            // A re-synthesized mouse-move event or a small jitter usually
+            // hits the same UI objects, so there is no need to walk them.
+            if (m_hitUIObjectsCache.isValid(cachePoint))
+            {
+                currHitUIObjects = m_hitUIObjects;
+            }
+            else // hit-test the UI objects again
+            {
+                m_hitUIObjectsCache.begin(cachePoint);
+
+                for (auto& uiobj : m_uiObjects)
+                {
+                    if (uiobj->appEventReactability.hitTest)
+                    {
+                        bool isHit = uiobj->isHit(cursorPoint);
+                        if (isHit) currHitUIObjects.insert(uiobj);
+
+                        m_hitUIObjectsCache.update(cachePoint, uiobj->hitTestCacheBounds(), isHit);
+                    }
+                }
+            }
+            if (forceSingleMouseEnterLeaveEvent)
+            {
+                WeakPtr<Panel> enterCandidate = {}, leaveCandidate = {};
+                if (!currHitUIObjects.empty())
+                {
+                    enterCandidate = *currHitUIObjects.begin();
+                }
+                if (!m_hitUIObjects.empty())
+                {
+                    leaveCandidate = *m_hitUIObjects.begin();
+                }
+                if (!isSameUIObject(enterCandidate.lock(), leaveCandidate.lock()))
+                {
+                    if (!enterCandidate.expired())
+                    {
+                        auto candidate = enterCandidate.lock();
+                        if (candidate->appEventReactability.mouse.enter)
+                        {
+                            candidate->onMouseEnter(e);
+                        }
+                    }
+                    if (!leaveCandidate.expired())
+                    {
+                        auto candidate = leaveCandidate.lock();
+                        if (candidate->appEventReactability.mouse.leave)
+                        {
+                            candidate->onMouseLeave(e);
+                        }
+                    }
+                }
+            }
+            else // trigger multiple mouse-enter-leave events
+            {
+                ISortable<Panel>::foreach(currHitUIObjects, [&](ShrdPtrParam<Panel> uiobj)
+                {
+                    // Moved in just now, trigger mouse-enter event.
+                    if (m_hitUIObjects.find(uiobj) == m_hitUIObjects.end())
+                    {
+                        if (uiobj->appEventReactability.mouse.enter)
+                        {
+                            uiobj->onMouseEnter(e);
+                        }
+                        return uiobj->appEventTransparency.mouse.enter;
+                    }
+                    return true;
+                });
+                ISortable<Panel>::foreach(m_hitUIObjects, [&](ShrdPtrParam<Panel> uiobj)
+                {
+                    // Moved out just now, trigger mouse-leave event.
+                    if (currHitUIObjects.find(uiobj) == currHitUIObjects.end())
+                    {
+                        if (uiobj->appEventReactability.mouse.leave)
+                        {
+                            uiobj->onMouseLeave(e);
+                        }
+                        return uiobj->appEventTransparency.mouse.leave;
+                    }
+                    return true;
+                });
+            }
+            m_hitUIObjects = std::move(currHitUIObjects);
+
+            ISortable<Panel>::foreach(m_hitUIObjects, [&](ShrdPtrParam<Panel> uiobj)
+            {
+                if (uiobj->appEventReactability.mouse.move)
+                {
+                    uiobj->onMouseMove(e);
+                }
+                return uiobj->appEventTransparency.mouse.move;
+            });
+            updateDiffPinnedUIObjects();
+
+            ISortable<Panel>::foreach(m_diffPinnedUIObjects, [&](ShrdPtrParam<Panel> uiobj)
+            {
+                if (uiobj->appEventReactability.mouse.move)
+                {
+                    uiobj->onMouseMove(e);
+                }
+                return uiobj->appEventTransparency.mouse.move;
+            });
+        }
+        // Register mouse-leave event for the Win32 window.
+        TRACKMOUSEEVENT tme = {};
+        tme.cbSize = sizeof(TRACKMOUSEEVENT);
+        tme.dwFlags = TME_LEAVE;
+        tme.hwndTrack = m_win32Window;
+
+        TrackMouseEvent(&tme);
+
+        // The cursor will be hidden if moves out of the Win32 window,
+        // so we need to show it explicitly in every mouse-move event.
+        m_cursor->setVisible(true);
+        if (m_cursor->useSystemIcons)
+        {
+            m_cursor->setSystemIcon();
+        }
+        InvalidateRect(m_win32Window, nullptr, FALSE);
+
+        m_isHandlingSensitiveUIEvent = false;
+    }
+
+    void Application::handleMouseWheelEvent(
+        const D2D1_POINT_2F& cursorPoint,
+        uint32_t state,
+        int wheelDelta)
+    {
+        m_isHandlingSensitiveUIEvent = true;
+
+        MouseWheelEvent e = {};
+        e.cursorPoint = cursorPoint;
+
+        e.buttonState.leftPressed = state & MK_LBUTTON;
+        e.buttonState.middlePressed = state & MK_MBUTTON;
+        e.buttonState.rightPressed = state & MK_RBUTTON;
+
+        e.keyState.CTRL = state & MK_CONTROL;
+        e.keyState.SHIFT = state & MK_SHIFT;
+
+        // The wheel distance can be negative.
+        e.deltaCount = wheelDelta / WHEEL_DELTA;
+        e.preciseDeltaCount = (float)wheelDelta / WHEEL_DELTA;
+
+        if (!m_currFocusedUIObject.expired() &&
+             m_currFocusedUIObject.lock()->forceGlobalExclusiveFocusing)
+        {
+            m_currFocusedUIObject.lock()->onMouseWheel(e);
+        }
+        else // Deliver mouse-wheel event normally.
+        {
+            ISortable<Panel>::foreach(m_hitUIObjects, [&](ShrdPtrParam<Panel> uiobj)
+            {
+                if (uiobj->appEventReactability.mouse.wheel)
+                {
+                    uiobj->onMouseWheel(e);
+                }
+                return uiobj->appEventTransparency.mouse.wheel;
+            });
+            ISortable<Panel>::foreach(m_diffPinnedUIObjects, [&](ShrdPtrParam<Panel> uiobj)
+            {
+                if (uiobj->appEventReactability.mouse.wheel)
+                {
+                    uiobj->onMouseWheel(e);
+                }
+                return uiobj->appEventTransparency.mouse.wheel;
+            });
+            handleImmediateMouseMoveEventCallback();
+        }
+        InvalidateRect(m_win32Window, nullptr, FALSE);
+
+        m_isHandlingSensitiveUIEvent = false;
+    }
+
+    void Application::flushCoalescedInput()
+    {
+        if (m_inputCoalescer.empty()) return;
+
+        // The handlers may receive new messages (e.g. SendMessage) that push
+        // into the coalescer or flush it again, so dispatch from a copy.
+        InputCoalescer<D2D1_POINT_2F> dispatching = {};
+        dispatching.swap(m_inputCoalescer);
+
+        for (auto& entry : dispatching.entries())
+        {
+            using Kind = InputCoalescer<D2D1_POINT_2F>::Entry::Kind;
+
+            if (entry.kind == Kind::Move)
+            {
+                handleMouseMoveEvent(entry.point, entry.state, dispatching.history(entry));
+            }
+            else if (entry.kind == Kind::Wheel)
+            {
+                handleMouseWheelEvent(entry.point, entry.state, entry.wheelDelta);
+            }
+        }
+        // Give the storage back unless new entries are waiting.
+        if (m_inputCoalescer.empty())
+        {
+            dispatching.clear();
+            m_inputCoalescer.swap(dispatching);
+        }
+    }
+
     void Application::handleImmediateMouseMoveEventCallback()
     {
         if (sendNextImmediateMouseMoveEvent)
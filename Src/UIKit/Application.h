@@ -2,11 +2,18 @@
 
 #include "Common/Precompile.h"
 
+#include "Renderer/FrameWriter.h"
 #include "Renderer/Renderer.h"
 
+#include "UIKit/DrawStatistics.h"
+#include "UIKit/InputCoalescer.h"
+#include "UIKit/ThemeGeneration.h"
+
 namespace d14engine::uikit
 {
     struct Cursor;
+    struct DrawStatisticsOverlay;
+    struct TextAtlas;
     struct TextInputObject;
 
     struct Application : cpp_lang_utils::NonCopyable
@@ -103,8 +110,29 @@ namespace d14engine::uikit
     public:
         renderer::Renderer* dxRenderer() const;
 
+        // Waits for the GPU to copy the scene, which stalls both the GPU and
+        // the UI thread, so prefer requestScreenshot if possible.
         ComPtr<ID2D1Bitmap1> screenshot() const;
 
+        using ScreenshotCallback = Function<void(ComPtr<ID2D1Bitmap1>)>;
+
+        // The callback is called on a later frame without any stall.
+        void requestScreenshot(const ScreenshotCallback& callback);
+
+    private:
+        SharedPtr<renderer::FrameWriter> m_recorder = {};
+
+    public:
+        // Writes every presented frame to the disk on a worker thread until
+        // stopRecording, and the frames are dropped (see the writer) if the
+        // GPU or the disk can not keep up.
+        void startRecording(const renderer::FrameWriter::Settings& settings);
+
+        // Waits for the queued frames to be written.
+        void stopRecording();
+
+        renderer::FrameWriter* recorder() const;
+
     private:
         // Indicates how many UI objects are playing animations.
         int m_animationCount = 0;
@@ -138,6 +166,9 @@ namespace d14engine::uikit
         using UIObjectTempSet = ISortable<Panel>::WeakPrioritySet;
 
         UIObjectTempSet m_hitUIObjects = {};
+
+        // See Panel::m_hitChildrenCache.
+        HitTestCache m_hitUIObjectsCache = {};
         
         // The pinned UI objects keep receiving UI events while not hitting.
         // 
@@ -194,13 +225,57 @@ namespace d14engine::uikit
 
         bool isTriggerDraggingWin32Window = false;
 
+    private:
+        // Shared by the labels that enable the text raster cache.
+        SharedPtr<TextAtlas> m_textAtlas = {};
+
+    public:
+        TextAtlas* textAtlas() const;
+
+    private:
+        DrawStatistics m_drawStatistics = {};
+
+        // Not null only if the draw statistics are enabled.
+        SharedPtr<DrawStatisticsOverlay> m_drawStatisticsOverlay = {};
+
+    public:
+        // Returns nullptr if disabled, which is the default.
+        DrawStatistics* drawStatistics();
+
+        bool isDrawStatisticsEnabled() const;
+        void setDrawStatisticsEnabled(bool value);
+
+        bool isOverdrawHeatMapVisible() const;
+        void setOverdrawHeatMapVisible(bool value);
+
+        // The latest finished frame as a JSON object, or an empty string if
+        // the draw statistics are disabled.
+        std::string dumpDrawStatistics() const;
+
     private:
         Wstring m_currThemeName = {};
 
+        // Increased in each changeTheme; the UI objects compare it with the
+        // generation they have applied and catch up before being drawn.
+        ThemeGeneration<Panel> m_themeGeneration = {};
+
     public:
         const Wstring& currThemeName() const;
         void changeTheme(WstrParam themeName);
 
+        UINT64 themeGeneration() const;
+
+        // The subscribed UI objects are notified immediately in changeTheme,
+        // which is necessary if they must be up to date even when not drawn
+        // (e.g. they hold the data read by others).
+        //
+        // None of the built-in UI objects subscribes: the masks, shadows and
+        // text layouts they hold take the appearance colors in the draw
+        // helpers, which run right after the catch-up, and the placeholder
+        // of a text input is themed by its owner.
+        void subscribeThemeChange(ShrdPtrParam<Panel> uiobj);
+        void unsubscribeThemeChange(ShrdPtrParam<Panel> uiobj);
+
     public:
         struct ThemeStyle
         {
@@ -261,11 +336,38 @@ namespace d14engine::uikit
 
         void handleImmediateMouseMoveEventCallback();
 
+    public:
+        // Collapses the mouse-move and mouse-wheel messages received during
+        // a frame into one dispatch (see InputCoalescer for the rules); the
+        // sub-frame cursor points are still available in the history span
+        // of MouseMoveEvent for the widgets that need every sample.
+        bool coalesceMouseInput = true;
+
+    private:
+        InputCoalescer<D2D1_POINT_2F> m_inputCoalescer = {};
+
+        void handleMouseMoveEvent(
+            const D2D1_POINT_2F& cursorPoint,
+            uint32_t state,
+            std::span<const D2D1_POINT_2F> history);
+
+        void handleMouseWheelEvent(
+            const D2D1_POINT_2F& cursorPoint,
+            uint32_t state,
+            int wheelDelta);
+
+        // Called before any other message is handled and when the Win32
+        // message queue becomes empty, i.e. once per frame at most.
+        void flushCoalescedInput();
+
     public:
         enum class CustomWin32Message
         {
             UpdateRootDiffPinnedUIObjects = WM_USER,
-            UpdateMiscDiffPinnedUIObjects = WM_USER + 1
+            UpdateMiscDiffPinnedUIObjects = WM_USER + 1,
+            // Delivers sendNextImmediateMouseMoveEvent outside of the UI
+            // events, e.g. after an animation frame moves the UI objects.
+            HandleImmediateMouseMoveEvent = WM_USER + 2
         };
         void postCustomWin32Message(CustomWin32Message message);
 
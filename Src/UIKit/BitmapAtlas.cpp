@@ -0,0 +1,206 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/BitmapAtlas.h"
+
+#include "Common/DirectXError.h"
+#include "Common/RuntimeError.h"
+
+#include "UIKit/Application.h"
+#include "UIKit/BitmapUtils.h"
+
+using namespace d14engine::renderer;
+
+namespace d14engine::uikit
+{
+    BitmapAtlas::BitmapAtlas(const CreateInfo& info)
+        :
+        createInfo(info) { }
+
+    void BitmapAtlas::addBitmap(WstrParam name, ID2D1Bitmap1* bitmap)
+    {
+        THROW_IF_NULL(bitmap);
+
+        m_pendingBitmaps.emplace_back(name, bitmap);
+    }
+
+    void BitmapAtlas::build()
+    {
+        if (m_pendingBitmaps.empty()) return;
+
+        // Place the large ones first, and then the names break the ties,
+        // which keeps the result independent of the adding order.
+        std::sort(m_pendingBitmaps.begin(), m_pendingBitmaps.end(),
+        [](const PendingBitmap& a, const PendingBitmap& b)
+        {
+            auto sa = a.second->GetPixelSize(), sb = b.second->GetPixelSize();
+
+            auto maxSideA = std::max(sa.width, sa.height);
+            auto maxSideB = std::max(sb.width, sb.height);
+            if (maxSideA != maxSideB) return maxSideA > maxSideB;
+
+            auto areaA = (UINT64)sa.width * sa.height;
+            auto areaB = (UINT64)sb.width * sb.height;
+            if (areaA != areaB) return areaA > areaB;
+
+            return a.first < b.first;
+        });
+        auto rndr = Application::g_app->dxRenderer();
+        rndr->beginGpuCommand();
+
+        auto context = rndr->d2d1DeviceContext();
+
+        struct Placement
+        {
+            ID2D1Bitmap1* source = nullptr;
+            math_utils::PackedRect rect = {};
+        };
+        std::vector<std::vector<Placement>> placements = {};
+        placements.resize(m_pages.size());
+
+        for (auto& pending : m_pendingBitmaps)
+        {
+            auto& name = pending.first;
+            auto source = pending.second.Get();
+
+            auto size = source->GetPixelSize();
+
+            Optional<math_utils::PackedRect> rect = {};
+            size_t pageIndex = 0;
+
+            for (; pageIndex < m_pages.size(); ++pageIndex)
+            {
+                if (rect = m_pages[pageIndex].packer.insert((int)size.width, (int)size.height)) break;
+            }
+            if (!rect.has_value())
+            {
+                auto& page = m_pages.emplace_back();
+
+                page.packer = math_utils::MaxRectsPacker(
+                    createInfo.pageWidth, createInfo.pageHeight,
+                    createInfo.padding, createInfo.allowRotation);
+
+                page.bitmap = bitmap_utils::loadBitmap(
+                    (UINT)createInfo.pageWidth, (UINT)createInfo.pageHeight,
+                    nullptr, D2D1_BITMAP_OPTIONS_TARGET);
+
+                // The padding must stay transparent to avoid bleeding.
+                context->SetTarget(page.bitmap.Get());
+                context->BeginDraw();
+                context->Clear(D2D1::ColorF{ 0x000000, 0.0f });
+                THROW_IF_FAILED(context->EndDraw());
+
+                placements.emplace_back();
+
+                if (!(rect = page.packer.insert((int)size.width, (int)size.height)))
+                {
+                    THROW_ERROR(L"The bitmap is too large to fit in the atlas page: " + name);
+                }
+            }
+            placements[pageIndex].push_back({ source, rect.value() });
+
+            auto& r = rect.value();
+            m_entries[name] =
+            {
+                pageIndex, r,
+                {
+                    (float)r.x / createInfo.pageWidth,
+                    (float)r.y / createInfo.pageHeight,
+                    (float)(r.x + r.width) / createInfo.pageWidth,
+                    (float)(r.y + r.height) / createInfo.pageHeight
+                }
+            };
+        }
+        for (size_t pageIndex = 0; pageIndex < placements.size(); ++pageIndex)
+        {
+            auto pageBitmap = m_pages[pageIndex].bitmap.Get();
+
+            bool hasRotated = false;
+            for (auto& p : placements[pageIndex])
+            {
+                if (p.rect.rotated)
+                {
+                    hasRotated = true;
+                    continue;
+                }
+                // The pixels are copied as-is since both of the bitmaps
+                // share the same pixel format, i.e. no resampling at all.
+                D2D1_POINT_2U dstPoint = { (UINT32)p.rect.x, (UINT32)p.rect.y };
+                THROW_IF_FAILED(pageBitmap->CopyFromBitmap(&dstPoint, p.source, nullptr));
+            }
+            if (!hasRotated) continue;
+
+            float dpiX = 96.0f, dpiY = 96.0f;
+            pageBitmap->GetDpi(&dpiX, &dpiY);
+
+            auto scaleX = 96.0f / dpiX, scaleY = 96.0f / dpiY;
+
+            context->SetTarget(pageBitmap);
+            context->BeginDraw();
+
+            for (auto& p : placements[pageIndex])
+            {
+                if (!p.rect.rotated) continue;
+
+                auto size = p.source->GetPixelSize();
+
+                // Rotate 90 degrees clockwise around the top-left corner,
+                // and then move the rotated image into the placed rectangle.
+                context->SetTransform(
+                    D2D1::Matrix3x2F::Rotation(90.0f) *
+                    D2D1::Matrix3x2F::Translation(
+                        (p.rect.x + p.rect.width) * scaleX, p.rect.y * scaleY));
+
+                context->DrawBitmap(
+                    p.source,
+                    { 0.0f, 0.0f, size.width * scaleX, size.height * scaleY },
+                    1.0f, D2D1_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+            }
+            context->SetTransform(D2D1::Matrix3x2F::Identity());
+
+            THROW_IF_FAILED(context->EndDraw());
+        }
+        rndr->endGpuCommand();
+
+        m_pendingBitmaps.clear();
+    }
+
+    const BitmapAtlas::EntryMap& BitmapAtlas::entries() const
+    {
+        return m_entries;
+    }
+
+    const BitmapAtlas::Entry* BitmapAtlas::find(WstrParam name) const
+    {
+        auto itor = m_entries.find(name);
+        return itor != m_entries.end() ? &itor->second : nullptr;
+    }
+
+    size_t BitmapAtlas::pageCount() const
+    {
+        return m_pages.size();
+    }
+
+    ID2D1Bitmap1* BitmapAtlas::page(size_t index) const
+    {
+        return index < m_pages.size() ? m_pages[index].bitmap.Get() : nullptr;
+    }
+
+    D2D1_RECT_F BitmapAtlas::sourceRect(const Entry& entry) const
+    {
+        float dpiX = 96.0f, dpiY = 96.0f;
+        if (entry.pageIndex < m_pages.size())
+        {
+            m_pages[entry.pageIndex].bitmap->GetDpi(&dpiX, &dpiY);
+        }
+        auto scaleX = 96.0f / dpiX, scaleY = 96.0f / dpiY;
+
+        auto& r = entry.rect;
+        return
+        {
+            r.x * scaleX,
+            r.y * scaleY,
+            (r.x + r.width) * scaleX,
+            (r.y + r.height) * scaleY
+        };
+    }
+}
@@ -0,0 +1,85 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include "Common/CppLangUtils/NonCopyable.h"
+#include "Common/MathUtils/Packing.h"
+
+namespace d14engine::uikit
+{
+    // Bakes many small bitmaps (icons, cursor frames, sprites etc.) into a
+    // few large pages, so that the users can bind one texture and select
+    // the images with the source rectangles (or the UV coordinates).
+
+    struct BitmapAtlas : cpp_lang_utils::NonCopyable
+    {
+        struct CreateInfo
+        {
+            // in pixels
+            int pageWidth = 1024;
+            int pageHeight = 1024;
+
+            int padding = 1;
+
+            // The rotated images must be sampled with the rotated UVs,
+            // so keep this disabled for the DrawBitmap based users.
+            bool allowRotation = false;
+        };
+
+        explicit BitmapAtlas(const CreateInfo& info = {});
+
+        // This field stores the original create-info passed in the ctor.
+        const CreateInfo createInfo = {};
+
+        struct Entry
+        {
+            size_t pageIndex = 0;
+
+            // in pixels
+            math_utils::PackedRect rect = {};
+
+            // Normalized in [0, 1] of the page size.
+            D2D1_RECT_F uv = {};
+        };
+
+    protected:
+        struct Page
+        {
+            math_utils::MaxRectsPacker packer = {};
+
+            ComPtr<ID2D1Bitmap1> bitmap = {};
+        };
+        std::vector<Page> m_pages = {};
+
+        using EntryMap = std::unordered_map<Wstring, Entry>;
+
+        EntryMap m_entries = {};
+
+        using PendingBitmap = std::pair<Wstring, ComPtr<ID2D1Bitmap1>>;
+
+        std::vector<PendingBitmap> m_pendingBitmaps = {};
+
+    public:
+        // The bitmaps are only queued here and baked when calling build,
+        // and the existing entries with the same name are replaced.
+        void addBitmap(WstrParam name, ID2D1Bitmap1* bitmap);
+
+        // The queued bitmaps are placed into the free spaces of the existing
+        // pages first, so it is fine to call this multiple times.  Note that
+        // this must not be called during the rendering since it flushes the
+        // GPU command queue.
+        void build();
+
+        const EntryMap& entries() const;
+
+        // Returns nullptr if the name has not been built yet.
+        const Entry* find(WstrParam name) const;
+
+        size_t pageCount() const;
+
+        ID2D1Bitmap1* page(size_t index) const;
+
+        // The source rectangle (in DIPs of the page) for DrawBitmap.
+        D2D1_RECT_F sourceRect(const Entry& entry) const;
+    };
+}
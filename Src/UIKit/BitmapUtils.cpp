@@ -2,6 +2,7 @@
 
 #include "UIKit/BitmapUtils.h"
 
+#include "Common/CppLangUtils/FinalAction.h"
 #include "Common/DirectXError.h"
 #include "Common/ResourcePack.h"
 
@@ -11,6 +12,8 @@
 #include "UIKit/Application.h"
 #include "UIKit/PlatformUtils.h"
 
+#include <fstream>
+
 using namespace d14engine::renderer;
 
 namespace d14engine::uikit::bitmap_utils
@@ -74,6 +77,68 @@ namespace d14engine::uikit::bitmap_utils
         THROW_IF_FAILED(stream->Commit(STGC_DEFAULT));
     }
 
+    using BitmapReader = Function<void(const image_utils::ImageView&)>;
+
+    static void readBitmap(ID2D1Bitmap1* bitmap, const BitmapReader& read)
+    {
+        ComPtr<ID2D1Bitmap1> readable = bitmap;
+        if ((bitmap->GetOptions() & D2D1_BITMAP_OPTIONS_CPU_READ) == 0)
+        {
+            auto pixSize = bitmap->GetPixelSize();
+            readable = loadBitmap(pixSize.width, pixSize.height, nullptr,
+                D2D1_BITMAP_OPTIONS_CPU_READ | D2D1_BITMAP_OPTIONS_CANNOT_DRAW);
+
+            THROW_IF_FAILED(readable->CopyFromBitmap(nullptr, bitmap, nullptr));
+        }
+        D2D1_MAPPED_RECT mapped = {};
+        THROW_IF_FAILED(readable->Map(D2D1_MAP_OPTIONS_READ, &mapped));
+
+        auto unmap = cpp_lang_utils::finally([&] { readable->Unmap(); });
+
+        auto pixSize = readable->GetPixelSize();
+
+        image_utils::ImageView image = {};
+        image.data = mapped.bits;
+        image.width = pixSize.width;
+        image.height = pixSize.height;
+        image.rowPitch = mapped.pitch;
+
+        read(image);
+    }
+
+    using ImageEncoder = Function<std::vector<uint8_t>(const image_utils::ImageView&)>;
+
+    static void saveEncodedBitmap(ID2D1Bitmap1* bitmap, WstrParam imagePath, const ImageEncoder& encode)
+    {
+        std::vector<uint8_t> bytes = {};
+        readBitmap(bitmap, [&](const image_utils::ImageView& image)
+        {
+            bytes = encode(image);
+        });
+        std::ofstream file(imagePath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            THROW_ERROR(L"Failed to open the image file: " + imagePath);
+        }
+        file.write((const char*)bytes.data(), bytes.size());
+    }
+
+    void savePng(ID2D1Bitmap1* bitmap, WstrParam imagePath, const image_utils::PngSettings& settings)
+    {
+        saveEncodedBitmap(bitmap, imagePath, [&](const image_utils::ImageView& image)
+        {
+            return image_utils::encodePng(image, settings);
+        });
+    }
+
+    void saveQoi(ID2D1Bitmap1* bitmap, WstrParam imagePath)
+    {
+        saveEncodedBitmap(bitmap, imagePath, [&](const image_utils::ImageView& image)
+        {
+            return image_utils::encodeQoi(image);
+        });
+    }
+
     ComPtr<ID2D1Bitmap1> loadBitmap(UINT width, UINT height, BYTE* data, D2D1_BITMAP_OPTIONS options)
     {
         auto dpi = platform_utils::dpi();
@@ -157,4 +222,58 @@ namespace d14engine::uikit::bitmap_utils
         ));
         return bitmap;
     }
+
+    MipLevels loadMipLevels(const image_utils::ImageView& image, image_utils::MipFilter filter)
+    {
+        MipLevels levels = {};
+        for (auto& level : image_utils::generateMipChain(image, filter))
+        {
+            levels.push_back(loadBitmap(level.width, level.height, level.pixels.data()));
+        }
+        return levels;
+    }
+
+    MipLevels loadMipLevels(ID2D1Bitmap1* bitmap, image_utils::MipFilter filter)
+    {
+        MipLevels levels = {};
+        readBitmap(bitmap, [&](const image_utils::ImageView& image)
+        {
+            levels = loadMipLevels(image, filter);
+        });
+        return levels;
+    }
+
+    ComPtr<ID2D1Bitmap1> loadBitmap(WstrParam imagePath, MipLevels& mipLevels, image_utils::MipFilter filter, D2D1_BITMAP_OPTIONS options)
+    {
+        auto source = graph_utils::bitmap::load(imagePath);
+
+        UINT width = 0, height = 0;
+        THROW_IF_FAILED(source->GetSize(&width, &height));
+
+        std::vector<BYTE> pixels((size_t)width * height * 4);
+        THROW_IF_FAILED(source->CopyPixels(nullptr, 4 * width, (UINT)pixels.size(), pixels.data()));
+
+        mipLevels = loadMipLevels({ pixels.data(), width, height, 4 * (size_t)width }, filter);
+
+        return loadBitmap(width, height, pixels.data(), options);
+    }
+
+    ID2D1Bitmap1* pickMipLevel(ID2D1Bitmap1* bitmap, const MipLevels& levels, const D2D1_SIZE_F& size)
+    {
+        auto dpi = platform_utils::dpi();
+
+        float width = size.width * dpi / 96.0f;
+        float height = size.height * dpi / 96.0f;
+
+        // The levels are getting smaller, so search from the smallest one.
+        for (auto itor = levels.rbegin(); itor != levels.rend(); ++itor)
+        {
+            auto pixSize = (*itor)->GetPixelSize();
+            if (pixSize.width >= width && pixSize.height >= height)
+            {
+                return itor->Get();
+            }
+        }
+        return bitmap;
+    }
 }
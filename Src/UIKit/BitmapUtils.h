@@ -2,13 +2,47 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/ImageUtils/ImageEncoder.h"
+#include "Common/ImageUtils/MipChain.h"
+
 namespace d14engine::uikit::bitmap_utils
 {
     void saveBitmap(ID2D1Bitmap1* image, WstrParam imagePath, const GUID& format = GUID_ContainerFormatPng);
 
+    // Encodes with image_utils instead of WIC, which filters and deflates
+    // the stripes in parallel and is much faster for the large bitmaps
+    // (e.g. 4K screenshots).  The bitmap is copied to a CPU-readable one
+    // first unless it is already CPU-readable.
+    void savePng(ID2D1Bitmap1* image, WstrParam imagePath, const image_utils::PngSettings& settings = {});
+
+    void saveQoi(ID2D1Bitmap1* image, WstrParam imagePath);
+
     ComPtr<ID2D1Bitmap1> loadBitmap(UINT width, UINT height, BYTE* data = nullptr, D2D1_BITMAP_OPTIONS options = D2D1_BITMAP_OPTIONS_NONE);
 
     ComPtr<ID2D1Bitmap1> loadBitmap(WstrParam imagePath, D2D1_BITMAP_OPTIONS options = D2D1_BITMAP_OPTIONS_NONE);
 
     ComPtr<ID2D1Bitmap1> loadPackedBitmap(WstrParam resName, WstrParam resType = L"PNG", D2D1_BITMAP_OPTIONS options = D2D1_BITMAP_OPTIONS_NONE);
+
+    // The halved levels of a bitmap (level 1 first), generated on the CPU
+    // at load time, so that a bitmap drawn much smaller than its size (e.g.
+    // a thumbnail) is sampled from the level near the drawn size instead of
+    // being resampled from the full resolution in every frame.
+    using MipLevels = std::vector<ComPtr<ID2D1Bitmap1>>;
+
+    MipLevels loadMipLevels(const image_utils::ImageView& image, image_utils::MipFilter filter = image_utils::MipFilter::Box);
+
+    // The bitmap is copied to a CPU-readable one first unless it is already
+    // CPU-readable, so prefer loading the levels with the bitmap.
+    MipLevels loadMipLevels(ID2D1Bitmap1* bitmap, image_utils::MipFilter filter = image_utils::MipFilter::Box);
+
+    // Decodes the image once for both the bitmap and its levels.
+    ComPtr<ID2D1Bitmap1> loadBitmap(
+        WstrParam imagePath,
+        MipLevels& mipLevels,
+        image_utils::MipFilter filter = image_utils::MipFilter::Box,
+        D2D1_BITMAP_OPTIONS options = D2D1_BITMAP_OPTIONS_NONE);
+
+    // Returns the smallest level that still has at least one pixel for each
+    // device pixel of the size (in DIPs), or the bitmap itself if none.
+    ID2D1Bitmap1* pickMipLevel(ID2D1Bitmap1* bitmap, const MipLevels& levels, const D2D1_SIZE_F& size);
 }
@@ -77,6 +77,15 @@ namespace d14engine::uikit
         }
     }
 
+    void Button::onRendererDrawD2d1LayerHelper(Renderer* rndr)
+    {
+        // The children drawing is taken over (see onRendererDrawD2d1ObjectHelper).
+        if (m_content->isD2d1ObjectVisible())
+        {
+            m_content->onRendererDrawD2d1Layer(rndr);
+        }
+    }
+
     void Button::onRendererDrawD2d1ObjectHelper(Renderer* rndr)
     {
         // Background
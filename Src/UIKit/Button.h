@@ -41,6 +41,7 @@ namespace d14engine::uikit
 
     protected:
         // IDrawObject2D
+        void onRendererDrawD2d1LayerHelper(renderer::Renderer* rndr) override;
         void onRendererDrawD2d1ObjectHelper(renderer::Renderer* rndr) override;
 
         // Panel
@@ -0,0 +1,381 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/CassowaryLayout.h"
+
+namespace d14engine::uikit
+{
+    // Weaker than required (so the edit is accepted by the solver) but much
+    // stronger than any user constraint below required.
+    static const double g_layoutSizeStrength = CassowaryLayout::Strength::make(999.0, 0.0, 0.0);
+
+    CassowaryLayout::CassowaryLayout(const D2D1_RECT_F& rect)
+        :
+        Panel(rect, resource_utils::g_solidColorBrush),
+        Layout(rect)
+    {
+        m_widthVariable = addVariable(nullptr);
+        m_heightVariable = addVariable(nullptr);
+
+        m_solver.addEditVariable(m_widthVariable, g_layoutSizeStrength);
+        m_solver.addEditVariable(m_heightVariable, g_layoutSizeStrength);
+
+        m_solver.suggestValue(m_widthVariable, width());
+        m_solver.suggestValue(m_heightVariable, height());
+    }
+
+    CassowaryLayout::Solver::Variable CassowaryLayout::addVariable(Panel* owner)
+    {
+        m_variableOwners.push_back(owner);
+
+        return m_solver.addVariable();
+    }
+
+    bool CassowaryLayout::appendTerm(Solver::Expression& expression, const Term& term) const
+    {
+        auto& terms = expression.terms;
+        double k = term.coefficient;
+
+        if (term.elem == nullptr)
+        {
+            switch (term.anchor)
+            {
+            case Anchor::Right:
+            case Anchor::Width: terms.push_back({ m_widthVariable, k }); break;
+            case Anchor::Bottom:
+            case Anchor::Height: terms.push_back({ m_heightVariable, k }); break;
+            case Anchor::CenterX: terms.push_back({ m_widthVariable, 0.5 * k }); break;
+            case Anchor::CenterY: terms.push_back({ m_heightVariable, 0.5 * k }); break;
+            default: break; // left and top are always 0
+            }
+            return true;
+        }
+        auto infoItor = m_elemInfos.find(term.elem);
+        if (infoItor == m_elemInfos.end()) return false;
+
+        auto& info = infoItor->second;
+        switch (term.anchor)
+        {
+        case Anchor::Left: terms.push_back({ info.left, k }); break;
+        case Anchor::Top: terms.push_back({ info.top, k }); break;
+        case Anchor::Right: terms.push_back({ info.right, k }); break;
+        case Anchor::Bottom: terms.push_back({ info.bottom, k }); break;
+        case Anchor::Width:
+        {
+            terms.push_back({ info.right, k });
+            terms.push_back({ info.left, -k });
+            break;
+        }
+        case Anchor::Height:
+        {
+            terms.push_back({ info.bottom, k });
+            terms.push_back({ info.top, -k });
+            break;
+        }
+        case Anchor::CenterX:
+        {
+            terms.push_back({ info.left, 0.5 * k });
+            terms.push_back({ info.right, 0.5 * k });
+            break;
+        }
+        case Anchor::CenterY:
+        {
+            terms.push_back({ info.top, 0.5 * k });
+            terms.push_back({ info.bottom, 0.5 * k });
+            break;
+        }
+        default: break;
+        }
+        return true;
+    }
+
+    void CassowaryLayout::removeSizeConstraints(ElementInfo& info)
+    {
+        for (auto constraint : info.sizeConstraints)
+        {
+            m_solver.removeConstraint(constraint);
+        }
+        info.sizeConstraints.clear();
+    }
+
+    void CassowaryLayout::updateLayout()
+    {
+        std::unordered_set<Panel*> changedElems = {};
+
+        for (auto variable : m_solver.updateVariables())
+        {
+            if (auto owner = m_variableOwners[variable]) changedElems.insert(owner);
+        }
+        for (auto elem : changedElems)
+        {
+            auto& info = m_elemInfos.at(elem);
+
+            // Round the edges instead of the sizes to avoid the seams.
+            float left = std::round((float)m_solver.value(info.left));
+            float top = std::round((float)m_solver.value(info.top));
+            float right = std::round((float)m_solver.value(info.right));
+            float bottom = std::round((float)m_solver.value(info.bottom));
+
+            elem->transform(left, top, right - left, bottom - top);
+        }
+    }
+
+    const CassowaryLayout::Solver& CassowaryLayout::solver() const
+    {
+        return m_solver;
+    }
+
+    Optional<CassowaryLayout::ConstraintID> CassowaryLayout::addConstraint(
+        const std::vector<Term>& terms, double constant,
+        Relation relation, double strength)
+    {
+        Solver::Expression expression = {};
+        expression.constant = constant;
+
+        std::vector<Panel*> elems = {};
+        for (auto& term : terms)
+        {
+            if (!appendTerm(expression, term)) return std::nullopt;
+
+            if (term.elem != nullptr) elems.push_back(term.elem);
+        }
+        auto constraint = m_solver.addConstraint(expression, relation, strength);
+        if (constraint.has_value())
+        {
+            m_userConstraints[constraint.value()] = std::move(elems);
+
+            updateLayout();
+        }
+        return constraint;
+    }
+
+    Optional<CassowaryLayout::ConstraintID> CassowaryLayout::addConstraint(
+        ShrdPtrParam<Panel> lhs, Anchor lhsAnchor,
+        Relation relation,
+        ShrdPtrParam<Panel> rhs, Anchor rhsAnchor,
+        double multiplier, double constant, double strength)
+    {
+        return addConstraint(
+        {
+            { lhs.get(), lhsAnchor, 1.0 },
+            { rhs.get(), rhsAnchor, -multiplier }
+        },
+        -constant, relation, strength);
+    }
+
+    bool CassowaryLayout::removeConstraint(ConstraintID constraint)
+    {
+        auto constraintItor = m_userConstraints.find(constraint);
+        if (constraintItor == m_userConstraints.end()) return false;
+
+        m_userConstraints.erase(constraintItor);
+        m_solver.removeConstraint(constraint);
+
+        updateLayout();
+
+        return true;
+    }
+
+    bool CassowaryLayout::beginEdit(ShrdPtrParam<Panel> elem, Anchor anchor, double strength)
+    {
+        // The size of the layout is always being edited.
+        if (!elem || m_edits.contains({ elem.get(), anchor })) return false;
+
+        Solver::Expression expression = {};
+        if (!appendTerm(expression, { elem.get(), anchor })) return false;
+
+        // Start from the current value, otherwise the anchor would jump to 0
+        // (the initial value of the edit) until the first suggestion.
+        double current = 0.0;
+        for (auto& term : expression.terms)
+        {
+            current += term.coefficient * m_solver.value(term.variable);
+        }
+        EditInfo edit = {};
+        if (expression.terms.size() == 1)
+        {
+            edit.variable = expression.terms.front().variable;
+        }
+        else // derived anchor
+        {
+            edit.variable = addVariable(nullptr);
+
+            expression.terms.push_back({ edit.variable, -1.0 });
+            edit.alias = m_solver.addConstraint(expression, Relation::Equal);
+        }
+        if (!m_solver.addEditVariable(edit.variable, strength))
+        {
+            if (edit.alias.has_value()) m_solver.removeConstraint(edit.alias.value());
+            return false;
+        }
+        m_solver.suggestValue(edit.variable, current);
+
+        m_edits[{ elem.get(), anchor }] = edit;
+
+        return true;
+    }
+
+    bool CassowaryLayout::suggestValue(ShrdPtrParam<Panel> elem, Anchor anchor, double value)
+    {
+        auto editItor = m_edits.find({ elem.get(), anchor });
+        if (editItor == m_edits.end()) return false;
+
+        m_solver.suggestValue(editItor->second.variable, value);
+
+        updateLayout();
+
+        return true;
+    }
+
+    bool CassowaryLayout::endEdit(ShrdPtrParam<Panel> elem, Anchor anchor)
+    {
+        auto editItor = m_edits.find({ elem.get(), anchor });
+        if (editItor == m_edits.end()) return false;
+
+        auto& edit = editItor->second;
+
+        m_solver.removeEditVariable(edit.variable);
+        if (edit.alias.has_value()) m_solver.removeConstraint(edit.alias.value());
+
+        m_edits.erase(editItor);
+
+        updateLayout();
+
+        return true;
+    }
+
+    void CassowaryLayout::removeElement(ShrdPtrParam<Panel> elem)
+    {
+        auto infoItor = m_elemInfos.find(elem.get());
+        if (infoItor != m_elemInfos.end())
+        {
+            for (auto editItor = m_edits.begin(); editItor != m_edits.end();)
+            {
+                if (editItor->first.first == elem.get())
+                {
+                    m_solver.removeEditVariable(editItor->second.variable);
+                    if (editItor->second.alias.has_value())
+                    {
+                        m_solver.removeConstraint(editItor->second.alias.value());
+                    }
+                    editItor = m_edits.erase(editItor);
+                }
+                else ++editItor;
+            }
+            for (auto constraintItor = m_userConstraints.begin(); constraintItor != m_userConstraints.end();)
+            {
+                auto& elems = constraintItor->second;
+                if (std::find(elems.begin(), elems.end(), elem.get()) != elems.end())
+                {
+                    m_solver.removeConstraint(constraintItor->first);
+                    constraintItor = m_userConstraints.erase(constraintItor);
+                }
+                else ++constraintItor;
+            }
+            auto& info = infoItor->second;
+            removeSizeConstraints(info);
+
+            // The variables are not reused since the solver never removes
+            // them, and they are free after removing all the constraints.
+            for (auto variable : { info.left, info.top, info.right, info.bottom })
+            {
+                m_variableOwners[variable] = nullptr;
+            }
+            m_elemInfos.erase(infoItor);
+        }
+        Layout::removeElement(elem);
+
+        updateLayout();
+    }
+
+    void CassowaryLayout::clearAllElements()
+    {
+        // Remove one by one since the constraints between the elements must
+        // be removed from the solver as well.
+        while (!m_elemGeoInfos.empty())
+        {
+            auto elem = m_elemGeoInfos.begin()->first;
+            removeElement(elem);
+        }
+    }
+
+    void CassowaryLayout::updateElement(ShrdPtrParam<Panel> elem, const GeometryInfo& geoInfo)
+    {
+        auto infoItor = m_elemInfos.find(elem.get());
+        if (infoItor == m_elemInfos.end())
+        {
+            ElementInfo info = {};
+            info.left = addVariable(elem.get());
+            info.top = addVariable(elem.get());
+            info.right = addVariable(elem.get());
+            info.bottom = addVariable(elem.get());
+
+            infoItor = m_elemInfos.insert({ elem.get(), info }).first;
+
+            // Keep the position when added (weakly) as well, otherwise the
+            // unconstrained elements would stack at the origin.
+            auto rect = elem->relativeRect();
+
+            auto& constraints = infoItor->second.sizeConstraints;
+            for (auto& [variable, value] :
+            {
+                std::pair{ info.left, rect.left }, std::pair{ info.top, rect.top }
+            })
+            {
+                constraints.push_back(m_solver.addConstraint(
+                    { { { variable, 1.0 } }, -value },
+                    Relation::Equal, Strength::Weak).value());
+            }
+        }
+        auto& info = infoItor->second;
+
+        // Only the position constraints added above are kept.
+        while (info.sizeConstraints.size() > 2)
+        {
+            m_solver.removeConstraint(info.sizeConstraints.back());
+            info.sizeConstraints.pop_back();
+        }
+        auto addSizeConstraint = [&](Anchor anchor, Relation relation, float value, double strength)
+        {
+            Solver::Expression expression = {};
+            appendTerm(expression, { elem.get(), anchor });
+            expression.constant = -value;
+
+            // The min/max constraints of an element never conflict with the
+            // others unless the user constrains its size the other way, in
+            // which case the min/max are skipped.
+            auto constraint = m_solver.addConstraint(expression, relation, strength);
+            if (constraint.has_value()) info.sizeConstraints.push_back(constraint.value());
+        };
+        addSizeConstraint(Anchor::Width, Relation::GreaterEqual, elem->minimalWidth(), Strength::Required);
+        addSizeConstraint(Anchor::Height, Relation::GreaterEqual, elem->minimalHeight(), Strength::Required);
+
+        if (elem->maximalWidth() < FLT_MAX)
+        {
+            addSizeConstraint(Anchor::Width, Relation::LessEqual, elem->maximalWidth(), Strength::Required);
+        }
+        if (elem->maximalHeight() < FLT_MAX)
+        {
+            addSizeConstraint(Anchor::Height, Relation::LessEqual, elem->maximalHeight(), Strength::Required);
+        }
+        if (geoInfo.keepSizeStrength.has_value())
+        {
+            double strength = geoInfo.keepSizeStrength.value();
+
+            addSizeConstraint(Anchor::Width, Relation::Equal, elem->width(), strength);
+            addSizeConstraint(Anchor::Height, Relation::Equal, elem->height(), strength);
+        }
+        updateLayout();
+    }
+
+    void CassowaryLayout::onSizeHelper(SizeEvent& e)
+    {
+        // Skip Layout::onSizeHelper since only the affected elements need
+        // to be transformed instead of updating all of them.
+        ResizablePanel::onSizeHelper(e);
+
+        m_solver.suggestValue(m_widthVariable, width());
+        m_solver.suggestValue(m_heightVariable, height());
+
+        updateLayout();
+    }
+}
@@ -0,0 +1,135 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include "Common/MathUtils/ConstraintSolver.h"
+
+#include "UIKit/Layout.h"
+
+namespace d14engine::uikit
+{
+    struct CassowaryLayoutGeometryInfo
+    {
+        // The strength of keeping the size of the element when updated,
+        // which is usually weak to let the other constraints decide the
+        // size, or std::nullopt to not keep the size at all.
+        Optional<double> keepSizeStrength = math_utils::ConstraintSolver::Strength::Weak;
+    };
+
+    // Places the elements by the linear constraints between their anchors
+    // (e.g. "b.left = a.right + 8" or "a.width = 0.5 * layout.width") with
+    // priorities, which are solved incrementally by math_utils::Constraint
+    // Solver.  The elements are also constrained by their minimal/maximal
+    // sizes (required) and optionally their current sizes (see the geometry
+    // info).
+    //
+    // The size of the layout is an edit variable, so resizing the layout
+    // (e.g. dragging its sizing frame) only re-solves the affected rows, and
+    // so do beginEdit/suggestValue/endEdit for dragging an anchor of an
+    // element (e.g. a splitter between 2 panes).  Only the elements whose
+    // variables changed are transformed.
+    struct CassowaryLayout : Layout<CassowaryLayoutGeometryInfo>
+    {
+        using Solver = math_utils::ConstraintSolver;
+
+        using Strength = Solver::Strength;
+        using Relation = Solver::Relation;
+        using ConstraintID = Solver::ConstraintID;
+
+        enum class Anchor { Left, Top, Right, Bottom, Width, Height, CenterX, CenterY };
+
+        // A null element refers to the layout itself, whose left and top are
+        // always 0 in the self coordinate.
+        struct Term
+        {
+            Panel* elem = nullptr;
+            Anchor anchor = Anchor::Left;
+            double coefficient = 1.0;
+        };
+
+        explicit CassowaryLayout(const D2D1_RECT_F& rect = {});
+
+    protected:
+        Solver m_solver = {};
+
+        Solver::Variable m_widthVariable = {}, m_heightVariable = {};
+
+        struct ElementInfo
+        {
+            Solver::Variable left = {}, top = {}, right = {}, bottom = {};
+
+            // The constraints of the min/max sizes and keeping the size.
+            std::vector<ConstraintID> sizeConstraints = {};
+        };
+        std::unordered_map<Panel*, ElementInfo> m_elemInfos = {};
+
+        // The element of each variable (null for the layout and the removed
+        // elements), so only the elements whose variables changed are
+        // transformed after solving.
+        std::vector<Panel*> m_variableOwners = {};
+
+        Solver::Variable addVariable(Panel* owner);
+
+        // The elements referred by each constraint added by the user, so
+        // the constraints can be removed along with the elements.
+        std::map<ConstraintID, std::vector<Panel*>> m_userConstraints = {};
+
+        struct EditInfo
+        {
+            Solver::Variable variable = {};
+
+            // Binds the derived anchors (e.g. Width) to an alias variable.
+            Optional<ConstraintID> alias = std::nullopt;
+        };
+        std::map<std::pair<Panel*, Anchor>, EditInfo> m_edits = {};
+
+        // Returns false if the element is not in the layout.
+        bool appendTerm(Solver::Expression& expression, const Term& term) const;
+
+        void removeSizeConstraints(ElementInfo& info);
+
+        void updateLayout();
+
+    public:
+        const Solver& solver() const;
+
+        // Adds "sum(coefficient * elem.anchor) + constant relation 0", and
+        // returns std::nullopt if any element is not in the layout or the
+        // required constraint conflicts with the existing ones.
+        Optional<ConstraintID> addConstraint(
+            const std::vector<Term>& terms, double constant,
+            Relation relation, double strength = Strength::Required);
+
+        // lhs.lhsAnchor relation rhs.rhsAnchor * multiplier + constant
+        Optional<ConstraintID> addConstraint(
+            ShrdPtrParam<Panel> lhs, Anchor lhsAnchor,
+            Relation relation,
+            ShrdPtrParam<Panel> rhs, Anchor rhsAnchor,
+            double multiplier = 1.0, double constant = 0.0,
+            double strength = Strength::Required);
+
+        bool removeConstraint(ConstraintID constraint);
+
+        // The anchor is pulled to the suggested values with the strength
+        // until endEdit, e.g. from the start to the end of a drag.
+        bool beginEdit(ShrdPtrParam<Panel> elem, Anchor anchor, double strength = Strength::Strong);
+
+        bool suggestValue(ShrdPtrParam<Panel> elem, Anchor anchor, double value);
+
+        bool endEdit(ShrdPtrParam<Panel> elem, Anchor anchor);
+
+    public:
+        using Layout::updateElement;
+
+        void removeElement(ShrdPtrParam<Panel> elem) override;
+
+        void clearAllElements() override;
+
+    protected:
+        void updateElement(ShrdPtrParam<Panel> elem, const GeometryInfo& geoInfo) override;
+
+    protected:
+        // Panel
+        void onSizeHelper(SizeEvent& e) override;
+    };
+}
@@ -2,6 +2,8 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
+
 #include "UIKit/Panel.h"
 
 namespace d14engine::uikit
@@ -24,11 +26,11 @@ namespace d14engine::uikit
     public:
         void onMouseButtonPress(Event& e);
 
-        Function<void(ClickablePanel*, Event&)> f_onMouseButtonPress = {};
+        cpp_lang_utils::LazyFunction<void(ClickablePanel*, Event&)> f_onMouseButtonPress = {};
 
         void onMouseButtonRelease(Event& e);
 
-        Function<void(ClickablePanel*, Event&)> f_onMouseButtonRelease = {};
+        cpp_lang_utils::LazyFunction<void(ClickablePanel*, Event&)> f_onMouseButtonRelease = {};
 
     protected:
         virtual void onMouseButtonPressHelper(Event& e);
@@ -2,6 +2,8 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
+
 #include "UIKit/Appearances/ComboBox.h"
 #include "UIKit/FlatButton.h"
 
@@ -31,7 +33,7 @@ namespace d14engine::uikit
     public:
         void onSelectedChange(IconLabel* content);
 
-        Function<void(ComboBox*, IconLabel*)> f_onSelectedChange = {};
+        cpp_lang_utils::LazyFunction<void(ComboBox*, IconLabel*)> f_onSelectedChange = {};
 
     protected:
         void onSelectedChangeHelper(IconLabel* content);
@@ -5,6 +5,7 @@
 #include "Common/MathUtils/2D.h"
 
 #include "UIKit/Application.h"
+#include "UIKit/BitmapAtlas.h"
 #include "UIKit/BitmapObject.h"
 #include "UIKit/BitmapUtils.h"
 #include "UIKit/FileSystemUtils.h"
@@ -36,11 +37,14 @@ namespace d14engine::uikit
 
     Cursor::BasicIconThemeMap Cursor::loadBasicIcons()
     {
-        return
+        BasicIconThemeMap icons =
         {
             { L"Light", loadBasicIconSeries(L"Light") },
             { L"Dark", loadBasicIconSeries(L"Dark") }
         };
+        bakeBasicIcons(icons);
+
+        return icons;
     }
 
     Cursor::IconSeries Cursor::loadBasicIconSeries(WstrParam themeName)
@@ -131,6 +135,71 @@ namespace d14engine::uikit
         return icon;
     }
 
+    void Cursor::bakeBasicIcons(BasicIconThemeMap& icons)
+    {
+        // 2 themes * (15 static icons + frames of 2 dynamic icons) * 32x32
+        // fit in a single 512x512 page with the 1px padding.
+        BitmapAtlas atlas({ 512, 512 });
+
+        auto staticIconName = [](WstrParam themeName, size_t index)
+        {
+            return themeName + L"/Static/" + std::to_wstring(index);
+        };
+        auto dynamicIconName = [](WstrParam themeName, size_t index, size_t frameIndex)
+        {
+            return themeName + L"/Dynamic/" + std::to_wstring(index) + L"/" + std::to_wstring(frameIndex);
+        };
+        for (auto& series : icons)
+        {
+            for (size_t i = 0; i < series.second.staticIcons.size(); ++i)
+            {
+                auto& bitmap = series.second.staticIcons[i].bitmap;
+                if (bitmap) atlas.addBitmap(staticIconName(series.first, i), bitmap.Get());
+            }
+            for (size_t i = 0; i < series.second.dynamicIcons.size(); ++i)
+            {
+                auto& frames = series.second.dynamicIcons[i].bitmap.frames;
+                for (size_t j = 0; j < frames.size(); ++j)
+                {
+                    if (frames[j]) atlas.addBitmap(dynamicIconName(series.first, i, j), frames[j].Get());
+                }
+            }
+        }
+        atlas.build();
+
+        for (auto& series : icons)
+        {
+            for (size_t i = 0; i < series.second.staticIcons.size(); ++i)
+            {
+                auto& icon = series.second.staticIcons[i];
+                if (auto entry = atlas.find(staticIconName(series.first, i)))
+                {
+                    icon.bitmap = atlas.page(entry->pageIndex);
+                    icon.sourceRect = atlas.sourceRect(*entry);
+                }
+            }
+            for (size_t i = 0; i < series.second.dynamicIcons.size(); ++i)
+            {
+                auto& bitmap = series.second.dynamicIcons[i].bitmap;
+
+                bitmap.sourceRects.resize(bitmap.frames.size());
+                for (size_t j = 0; j < bitmap.frames.size(); ++j)
+                {
+                    if (auto entry = atlas.find(dynamicIconName(series.first, i, j)))
+                    {
+                        bitmap.frames[j] = atlas.page(entry->pageIndex);
+                        bitmap.sourceRects[j] = atlas.sourceRect(*entry);
+                    }
+                    else if (bitmap.frames[j])
+                    {
+                        auto size = bitmap.frames[j]->GetSize();
+                        bitmap.sourceRects[j] = { 0.0f, 0.0f, size.width, size.height };
+                    }
+                }
+            }
+        }
+    }
+
     void Cursor::registerIcon(WstrParam themeName, StaticIconIndex index, const StaticIcon& icon)
     {
         auto categoryItor = m_classifiedBasicIcons.find(themeName);
@@ -290,9 +359,15 @@ namespace d14engine::uikit
             rect = math_utils::roundf(rect);
             if (!useSystemIcons)
             {
+                auto sourceRect = icon.sourceRect.has_value() ?
+                    &icon.sourceRect.value() : nullptr;
+
+                auto bitmap = sourceRect ? icon.bitmap.Get() :
+                    bitmap_utils::pickMipLevel(icon.bitmap.Get(), icon.bitmapMipLevels, math_utils::size(rect));
+
                 rndr->d2d1DeviceContext()->DrawBitmap(
-                    icon.bitmap.Get(), rect, icon.bitmapOpacity,
-                    BitmapObject::g_interpolationMode);
+                    bitmap, rect, icon.bitmapOpacity,
+                    BitmapObject::g_interpolationMode, sourceRect);
             }
         }
         else if (m_selectedIconID.index() == g_dynamicIconSeat)
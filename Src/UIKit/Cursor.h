@@ -50,6 +50,12 @@ namespace d14engine::uikit
             D2D1_POINT_2F displayOffset = {};
             ComPtr<ID2D1Bitmap1> bitmap = {};
             float bitmapOpacity = 1.0f;
+
+            // Selects the icon from a shared bitmap (e.g. an atlas page).
+            Optional<D2D1_RECT_F> sourceRect = std::nullopt;
+
+            // Optional, only used without sourceRect (see Panel::bitmapMipLevels).
+            bitmap_utils::MipLevels bitmapMipLevels = {};
         };
         struct DynamicIcon
         {
@@ -82,6 +88,10 @@ namespace d14engine::uikit
         static IconSeries loadBasicIconSeries(WstrParam themeName);
         static DynamicIcon loadBasicIconFrames(WstrParam framesPath);
 
+        // Moves all the basic icons into a few atlas pages, so drawing the
+        // cursor with any icon binds the same bitmap.
+        static void bakeBasicIcons(BasicIconThemeMap& icons);
+
     protected:
         BasicIconThemeMap m_classifiedBasicIcons = {};
 
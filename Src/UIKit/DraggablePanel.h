@@ -2,6 +2,8 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
+
 #include "UIKit/Panel.h"
 
 namespace d14engine::uikit
@@ -16,15 +18,15 @@ namespace d14engine::uikit
     public:
         void onStartDragging();
 
-        Function<void(DraggablePanel*)> f_onStartDragging = {};
+        cpp_lang_utils::LazyFunction<void(DraggablePanel*)> f_onStartDragging = {};
 
         void onEndDragging();
 
-        Function<void(DraggablePanel*)> f_onEndDragging = {};
+        cpp_lang_utils::LazyFunction<void(DraggablePanel*)> f_onEndDragging = {};
 
         bool isTriggerDragging(const Event::Point& p);
 
-        Function<bool(DraggablePanel*, const Event::Point&)> f_isTriggerDragging = {};
+        cpp_lang_utils::LazyFunction<bool(DraggablePanel*, const Event::Point&)> f_isTriggerDragging = {};
 
     protected:
         virtual void onStartDraggingHelper();
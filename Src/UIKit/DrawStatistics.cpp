@@ -0,0 +1,186 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/DrawStatistics.h"
+
+#include <chrono>
+
+namespace d14engine::uikit
+{
+    double DrawStatistics::Frame::overdraw() const
+    {
+        double screenArea = (double)screenWidth * screenHeight;
+
+        return screenArea > 0.0 ? coveredArea / screenArea : 0.0;
+    }
+
+    double DrawStatistics::now()
+    {
+        using namespace std::chrono;
+        return duration<double>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    DrawStatistics::ClassInfo& DrawStatistics::classInfo(std::string_view className)
+    {
+        auto& classes = m_currFrame.classes;
+
+        // Avoid constructing a string when the class has been found.
+        auto itor = classes.find(className);
+        if (itor == classes.end())
+        {
+            itor = classes.emplace(std::string(className), ClassInfo{}).first;
+        }
+        return itor->second;
+    }
+
+    void DrawStatistics::enterScope(ClassInfo& info, double nowSecs)
+    {
+        Scope scope = {};
+        scope.info = &info;
+        scope.startSecs = nowSecs;
+
+        m_scopeStack.push_back(scope);
+    }
+
+    bool DrawStatistics::isInFrame() const
+    {
+        return m_isInFrame;
+    }
+
+    void DrawStatistics::beginFrame(float screenWidth, float screenHeight)
+    {
+        uint64_t index = m_lastFrame.index + 1;
+
+        m_currFrame = {};
+        m_currFrame.index = index;
+        m_currFrame.screenWidth = std::max(screenWidth, 0.0f);
+        m_currFrame.screenHeight = std::max(screenHeight, 0.0f);
+
+        m_scopeStack.clear();
+
+        m_isInFrame = true;
+    }
+
+    void DrawStatistics::endFrame()
+    {
+        if (!m_isInFrame) return;
+
+        m_scopeStack.clear();
+
+        m_lastFrame = std::move(m_currFrame);
+        m_currFrame = {};
+
+        m_isInFrame = false;
+    }
+
+    void DrawStatistics::enterObject(std::string_view className, const Rect& rect, double nowSecs)
+    {
+        if (!m_isInFrame) return;
+
+        auto& info = classInfo(className);
+        ++info.objectCount;
+        ++m_currFrame.objectCount;
+
+        Rect clipped =
+        {
+            std::max(rect.left, 0.0f),
+            std::max(rect.top, 0.0f),
+            std::min(rect.right, m_currFrame.screenWidth),
+            std::min(rect.bottom, m_currFrame.screenHeight)
+        };
+        if (clipped.right > clipped.left && clipped.bottom > clipped.top)
+        {
+            m_currFrame.coveredArea += (double)(clipped.right - clipped.left) * (clipped.bottom - clipped.top);
+
+            if (collectRects) m_currFrame.rects.push_back(clipped);
+        }
+        enterScope(info, nowSecs);
+    }
+
+    void DrawStatistics::enterLayer(std::string_view className, double nowSecs)
+    {
+        if (!m_isInFrame) return;
+
+        auto& info = classInfo(className);
+        ++info.layerCount;
+        ++m_currFrame.layerCount;
+
+        enterScope(info, nowSecs);
+    }
+
+    void DrawStatistics::leave(double nowSecs)
+    {
+        if (!m_isInFrame || m_scopeStack.empty()) return;
+
+        auto scope = m_scopeStack.back();
+        m_scopeStack.pop_back();
+
+        double elapsedSecs = std::max(nowSecs - scope.startSecs, 0.0);
+
+        scope.info->selfSecs += std::max(elapsedSecs - scope.nestedSecs, 0.0);
+
+        if (!m_scopeStack.empty())
+        {
+            m_scopeStack.back().nestedSecs += elapsedSecs;
+        }
+    }
+
+    void DrawStatistics::addMaskPass()
+    {
+        if (m_isInFrame) ++m_currFrame.maskPassCount;
+    }
+
+    void DrawStatistics::addShadowPass()
+    {
+        if (m_isInFrame) ++m_currFrame.shadowPassCount;
+    }
+
+    void DrawStatistics::addTextLayout()
+    {
+        if (m_isInFrame) ++m_currFrame.textLayoutCount;
+    }
+
+    const DrawStatistics::Frame& DrawStatistics::lastFrame() const
+    {
+        return m_lastFrame;
+    }
+
+    std::string DrawStatistics::dump() const
+    {
+        auto& frame = m_lastFrame;
+
+        std::ostringstream out = {};
+        out << std::setprecision(9);
+
+        out << "{\"frame\":" << frame.index
+            << ",\"objects\":" << frame.objectCount
+            << ",\"layers\":" << frame.layerCount
+            << ",\"maskPasses\":" << frame.maskPassCount
+            << ",\"shadowPasses\":" << frame.shadowPassCount
+            << ",\"textLayouts\":" << frame.textLayoutCount
+            << ",\"screenWidth\":" << frame.screenWidth
+            << ",\"screenHeight\":" << frame.screenHeight
+            << ",\"coveredArea\":" << frame.coveredArea
+            << ",\"overdraw\":" << frame.overdraw()
+            << ",\"classes\":[";
+
+        bool first = true;
+        for (auto& [name, info] : frame.classes)
+        {
+            if (!first) out << ',';
+            first = false;
+
+            out << "{\"name\":\"";
+            for (auto ch : name)
+            {
+                if (ch == '"' || ch == '\\') out << '\\';
+                out << ch;
+            }
+            out << "\",\"objects\":" << info.objectCount
+                << ",\"layers\":" << info.layerCount
+                << ",\"selfSecs\":" << info.selfSecs << '}';
+        }
+        out << "]}";
+
+        return out.str();
+    }
+}
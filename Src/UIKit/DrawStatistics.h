@@ -0,0 +1,112 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::uikit
+{
+    // Collects what the UI objects have drawn in each frame, which only uses
+    // the standard library so it can be tested without creating any UI
+    // object (the time points are passed in by the caller).
+    //
+    // A frame records:
+    //
+    // the number of the drawn objects and layers (i.e. the calls of
+    // onRendererDrawD2d1Object/Layer), the offscreen passes of MaskStyle/
+    // ShadowStyle (each is a separate BeginDraw/EndDraw), the drawn text
+    // layouts, the time spent in each class and the estimated overdraw,
+    // which is the summed area of the drawn objects (clipped to the screen)
+    // divided by the screen area.
+    //
+    // The time of a class excludes the time of the nested objects (e.g. the
+    // children of a panel), so the expensive classes stand out directly.
+    struct DrawStatistics
+    {
+        struct Rect
+        {
+            float left = 0.0f, top = 0.0f, right = 0.0f, bottom = 0.0f;
+        };
+
+        struct ClassInfo
+        {
+            size_t objectCount = 0;
+            size_t layerCount = 0;
+
+            // Excluding the nested objects.
+            double selfSecs = 0.0;
+        };
+
+        struct Frame
+        {
+            uint64_t index = 0;
+
+            size_t objectCount = 0;
+            size_t layerCount = 0;
+
+            size_t maskPassCount = 0;
+            size_t shadowPassCount = 0;
+
+            size_t textLayoutCount = 0;
+
+            float screenWidth = 0.0f, screenHeight = 0.0f;
+
+            double coveredArea = 0.0;
+
+            double overdraw() const;
+
+            // Sorted by the class name.
+            std::map<std::string, ClassInfo, std::less<>> classes = {};
+
+            // The clipped rect of each drawn object (in the drawing order),
+            // which is only collected if collectRects is true.
+            std::vector<Rect> rects = {};
+        };
+
+        // For the heat map, which costs a vector push per drawn object.
+        bool collectRects = false;
+
+        static double now(); // a monotonic time point in seconds
+
+    protected:
+        bool m_isInFrame = false;
+
+        Frame m_currFrame = {}, m_lastFrame = {};
+
+        struct Scope
+        {
+            ClassInfo* info = nullptr;
+
+            double startSecs = 0.0;
+            double nestedSecs = 0.0;
+        };
+        std::vector<Scope> m_scopeStack = {};
+
+        ClassInfo& classInfo(std::string_view className);
+
+        void enterScope(ClassInfo& info, double nowSecs);
+
+    public:
+        bool isInFrame() const;
+
+        // The data outside of a frame are discarded.
+        void beginFrame(float screenWidth, float screenHeight);
+
+        // The unbalanced scopes (e.g. interrupted by exceptions) are dropped.
+        void endFrame();
+
+        void enterObject(std::string_view className, const Rect& rect, double nowSecs);
+        void enterLayer(std::string_view className, double nowSecs);
+
+        // Leaves the latest entered object/layer.
+        void leave(double nowSecs);
+
+        void addMaskPass();
+        void addShadowPass();
+        void addTextLayout();
+
+        // The latest finished frame.
+        const Frame& lastFrame() const;
+
+        // Formats the latest finished frame as a JSON object.
+        std::string dump() const;
+    };
+}
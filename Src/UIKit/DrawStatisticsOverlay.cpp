@@ -0,0 +1,54 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/DrawStatisticsOverlay.h"
+
+#include "Renderer/Renderer.h"
+
+#include "UIKit/DrawStatistics.h"
+#include "UIKit/ResourceUtils.h"
+
+using namespace d14engine::renderer;
+
+namespace d14engine::uikit
+{
+    DrawStatisticsOverlay::DrawStatisticsOverlay(DrawStatistics* statistics)
+        :
+        m_statistics(statistics)
+    {
+        // Keep the overlay right below the cursor.
+        ISortable<IDrawObject2D>::m_priority = INT_MAX - 1;
+    }
+
+    void DrawStatisticsOverlay::onRendererDrawD2d1Layer(Renderer* rndr)
+    {
+        // This method intentionally left blank.
+    }
+
+    void DrawStatisticsOverlay::onRendererDrawD2d1ObjectHelper(Renderer* rndr)
+    {
+        if (m_statistics == nullptr) return;
+
+        m_statistics->endFrame();
+
+        if (showHeatMap)
+        {
+            auto context = rndr->d2d1DeviceContext();
+
+            resource_utils::g_solidColorBrush->SetColor(D2D1::ColorF{ 1.0f, 0.0f, 0.0f });
+            resource_utils::g_solidColorBrush->SetOpacity(heatMapOpacity);
+
+            for (auto& rect : m_statistics->lastFrame().rects)
+            {
+                context->FillRectangle(
+                    { rect.left, rect.top, rect.right, rect.bottom },
+                    resource_utils::g_solidColorBrush.Get());
+            }
+        }
+        m_statistics->collectRects = showHeatMap;
+
+        // The screen size is in DIPs, the same as the rects of the objects.
+        auto screenSize = rndr->d2d1DeviceContext()->GetSize();
+
+        m_statistics->beginFrame(screenSize.width, screenSize.height);
+    }
+}
@@ -0,0 +1,37 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include "Renderer/Interfaces/DrawObject2D.h"
+
+namespace d14engine::uikit
+{
+    struct DrawStatistics;
+
+    // Marks the frame boundaries of DrawStatistics and optionally draws the
+    // overdraw heat map, i.e. fills the rect of every drawn object with a
+    // translucent red, so the more times a pixel is drawn the redder it is.
+    //
+    // It is drawn after all of the UI objects except the cursor, so a frame
+    // is counted from one overlay drawing to the next one.
+    struct DrawStatisticsOverlay : renderer::DrawObject2D
+    {
+        explicit DrawStatisticsOverlay(DrawStatistics* statistics);
+
+        bool showHeatMap = false;
+
+        // The opacity added by each drawn object.
+        float heatMapOpacity = 0.08f;
+
+    protected:
+        DrawStatistics* m_statistics = nullptr;
+
+    public:
+        // IDrawObject2D
+        void onRendererDrawD2d1Layer(renderer::Renderer* rndr) override;
+
+    protected:
+        // DrawObject2D
+        void onRendererDrawD2d1ObjectHelper(renderer::Renderer* rndr) override;
+    };
+}
@@ -71,6 +71,12 @@ namespace d14engine::uikit
         keyState = {};
 
         CursorPoint lastCursorPoint = {};
+
+        // All the cursor points received since the last mouse-move event
+        // (the last one is cursorPoint), which helps the freehand drawing
+        // and similar things recover the sub-frame movements when the mouse
+        // input is coalesced.  Only valid in the callback.
+        std::span<const CursorPoint> history = {};
     };
 
     struct MouseButtonEvent : MouseEvent
@@ -129,6 +135,10 @@ namespace d14engine::uikit
         keyState = {};
 
         int deltaCount = 0;
+
+        // Keeps the fraction of a notch, e.g. 0.25 from a high-resolution
+        // touchpad, which is truncated to 0 in deltaCount.
+        float preciseDeltaCount = 0.0f;
     };
 
     struct KeyboardEvent : Event
@@ -0,0 +1,160 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/FlexLayout.h"
+
+namespace d14engine::uikit
+{
+    FlexLayout::FlexLayout(const Settings& settings, const D2D1_RECT_F& rect)
+        :
+        Panel(rect, resource_utils::g_solidColorBrush),
+        Layout(rect)
+    {
+        m_model.setSettings(settings);
+        m_model.resize(width(), height());
+    }
+
+    void FlexLayout::updateLayout()
+    {
+        if (m_batchUpdateCount > 0) return;
+
+        for (size_t index : m_model.update())
+        {
+            auto& rect = m_model.rect(index);
+
+            // Round the edges instead of the sizes to avoid the seams.
+            float left = std::round(rect.left);
+            float top = std::round(rect.top);
+
+            m_orderedElems[index]->transform
+            (
+                left, top,
+                std::round(rect.right) - left,
+                std::round(rect.bottom) - top
+            );
+        }
+    }
+
+    const FlexLayout::Settings& FlexLayout::settings() const
+    {
+        return m_model.settings();
+    }
+
+    void FlexLayout::setSettings(const Settings& settings)
+    {
+        m_model.setSettings(settings);
+
+        updateLayout();
+    }
+
+    const FlexLayoutModel& FlexLayout::model() const
+    {
+        return m_model;
+    }
+
+    void FlexLayout::beginBatchUpdate()
+    {
+        ++m_batchUpdateCount;
+    }
+
+    void FlexLayout::endBatchUpdate()
+    {
+        if (m_batchUpdateCount > 0 && --m_batchUpdateCount == 0) updateLayout();
+    }
+
+    void FlexLayout::removeElement(ShrdPtrParam<Panel> elem)
+    {
+        auto indexItor = m_elemIndices.find(elem.get());
+        if (indexItor != m_elemIndices.end())
+        {
+            size_t index = indexItor->second;
+
+            m_model.erase(index);
+            m_orderedElems.erase(m_orderedElems.begin() + index);
+
+            m_elemIndices.erase(indexItor);
+            for (size_t i = index; i < m_orderedElems.size(); ++i)
+            {
+                m_elemIndices[m_orderedElems[i].get()] = i;
+            }
+        }
+        Layout::removeElement(elem);
+
+        updateLayout();
+    }
+
+    void FlexLayout::clearAllElements()
+    {
+        m_model.clear();
+        m_orderedElems.clear();
+        m_elemIndices.clear();
+
+        Layout::clearAllElements();
+    }
+
+    void FlexLayout::updateAllElements()
+    {
+        beginBatchUpdate();
+        for (auto& elem : m_orderedElems)
+        {
+            Layout::updateElement(elem);
+        }
+        endBatchUpdate();
+    }
+
+    void FlexLayout::updateElement(ShrdPtrParam<Panel> elem, const GeometryInfo& geoInfo)
+    {
+        FlexLayoutModel::Item item = {};
+
+        auto indexItor = m_elemIndices.find(elem.get());
+        if (geoInfo.preferredSize.has_value())
+        {
+            item.width = geoInfo.preferredSize.value().width;
+            item.height = geoInfo.preferredSize.value().height;
+        }
+        // The size of the element is the layout result after added.
+        else if (indexItor != m_elemIndices.end())
+        {
+            auto& original = m_model.item(indexItor->second);
+
+            item.width = original.width;
+            item.height = original.height;
+        }
+        else // newly added
+        {
+            item.width = elem->width();
+            item.height = elem->height();
+        }
+        item.minWidth = elem->minimalWidth();
+        item.maxWidth = elem->maximalWidth();
+        item.minHeight = elem->minimalHeight();
+        item.maxHeight = elem->maximalHeight();
+
+        item.grow = geoInfo.grow;
+        item.shrink = geoInfo.shrink;
+        item.alignSelf = geoInfo.alignSelf;
+
+        if (indexItor != m_elemIndices.end())
+        {
+            m_model.setItem(indexItor->second, item);
+        }
+        else // newly added
+        {
+            m_elemIndices[elem.get()] = m_orderedElems.size();
+            m_orderedElems.push_back(elem);
+
+            m_model.insert(m_model.count(), item);
+        }
+        updateLayout();
+    }
+
+    void FlexLayout::onSizeHelper(SizeEvent& e)
+    {
+        // Skip Layout::onSizeHelper since the model relayouts the affected
+        // elements only instead of updating all of them.
+        ResizablePanel::onSizeHelper(e);
+
+        m_model.resize(width(), height());
+
+        updateLayout();
+    }
+}
@@ -0,0 +1,76 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include "UIKit/FlexLayoutModel.h"
+#include "UIKit/Layout.h"
+
+namespace d14engine::uikit
+{
+    struct FlexLayoutGeometryInfo
+    {
+        float grow = 0.0f, shrink = 1.0f;
+
+        Optional<FlexLayoutModel::Align> alignSelf = std::nullopt;
+
+        // The size used as the flex-basis (main axis) and the cross size.
+        // If empty, the size of the element when added is used.
+        Optional<D2D1_SIZE_F> preferredSize = std::nullopt;
+    };
+
+    // Arranges the elements in the order of adding along a direction with
+    // the optional wrapping, growing/shrinking and alignment like the CSS
+    // flexbox, where the min/max sizes come from minimalWidth/maximalWidth
+    // (and the height counterparts) of the elements.
+    //
+    // The results are cached (see FlexLayoutModel), so only the elements
+    // whose rects actually change are transformed.
+    struct FlexLayout : Layout<FlexLayoutGeometryInfo>
+    {
+        using Direction = FlexLayoutModel::Direction;
+        using Justify = FlexLayoutModel::Justify;
+        using Align = FlexLayoutModel::Align;
+
+        using Settings = FlexLayoutModel::Settings;
+
+        explicit FlexLayout(const Settings& settings = {}, const D2D1_RECT_F& rect = {});
+
+    protected:
+        FlexLayoutModel m_model = {};
+
+        // The elements in the order of the model.
+        std::vector<SharedPtr<Panel>> m_orderedElems = {};
+        std::unordered_map<Panel*, size_t> m_elemIndices = {};
+
+        size_t m_batchUpdateCount = 0;
+
+        void updateLayout();
+
+    public:
+        const Settings& settings() const;
+        void setSettings(const Settings& settings);
+
+        const FlexLayoutModel& model() const;
+
+        // Defers the relayout until the outermost endBatchUpdate, which is
+        // much faster when adding/updating a large number of elements.
+        void beginBatchUpdate();
+        void endBatchUpdate();
+
+    public:
+        using Layout::updateElement;
+
+        void removeElement(ShrdPtrParam<Panel> elem) override;
+
+        void clearAllElements() override;
+
+        void updateAllElements() override;
+
+    protected:
+        void updateElement(ShrdPtrParam<Panel> elem, const GeometryInfo& geoInfo) override;
+
+    protected:
+        // Panel
+        void onSizeHelper(SizeEvent& e) override;
+    };
+}
@@ -0,0 +1,484 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/FlexLayoutModel.h"
+
+namespace d14engine::uikit
+{
+    // NaN never equals anything, so the new items are always reported.
+    static const FlexLayoutModel::Rect g_unplacedRect =
+    {
+        std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::quiet_NaN()
+    };
+
+    bool FlexLayoutModel::isRow() const
+    {
+        return m_settings.direction == Direction::Row;
+    }
+
+    float FlexLayoutModel::mainSize() const
+    {
+        auto& pad = m_settings.padding;
+        if (isRow())
+        {
+            return std::max(m_width - pad.left - pad.right, 0.0f);
+        }
+        else return std::max(m_height - pad.top - pad.bottom, 0.0f);
+    }
+
+    float FlexLayoutModel::crossSize() const
+    {
+        auto& pad = m_settings.padding;
+        if (isRow())
+        {
+            return std::max(m_height - pad.top - pad.bottom, 0.0f);
+        }
+        else return std::max(m_width - pad.left - pad.right, 0.0f);
+    }
+
+    float FlexLayoutModel::mainPreferred(const Item& item) const
+    {
+        return isRow() ? item.width : item.height;
+    }
+
+    float FlexLayoutModel::mainMin(const Item& item) const
+    {
+        return isRow() ? item.minWidth : item.minHeight;
+    }
+
+    float FlexLayoutModel::mainMax(const Item& item) const
+    {
+        return isRow() ? item.maxWidth : item.maxHeight;
+    }
+
+    float FlexLayoutModel::crossPreferred(const Item& item) const
+    {
+        return isRow() ? item.height : item.width;
+    }
+
+    float FlexLayoutModel::crossMin(const Item& item) const
+    {
+        return isRow() ? item.minHeight : item.minWidth;
+    }
+
+    float FlexLayoutModel::crossMax(const Item& item) const
+    {
+        return isRow() ? item.maxHeight : item.maxWidth;
+    }
+
+    float FlexLayoutModel::mainHypothetical(const Item& item) const
+    {
+        // The min wins if it is greater than the max, the same as CSS.
+        return std::max(std::min(mainPreferred(item), mainMax(item)), mainMin(item));
+    }
+
+    float FlexLayoutModel::crossHypothetical(const Item& item) const
+    {
+        return std::max(std::min(crossPreferred(item), crossMax(item)), crossMin(item));
+    }
+
+    void FlexLayoutModel::breakLines(std::vector<Line>& lines) const
+    {
+        lines.clear();
+
+        size_t n = m_items.size();
+        if (n == 0) return;
+
+        if (!m_settings.wrap)
+        {
+            lines.push_back({ 0, n });
+            return;
+        }
+        float available = mainSize();
+
+        Line line = {};
+        float lineExtent = 0.0f;
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            float extent = mainHypothetical(m_items[i]);
+
+            if (i > line.begin)
+            {
+                // Keep at least one item in each line.
+                if (lineExtent + m_settings.mainGap + extent > available)
+                {
+                    line.end = i;
+                    lines.push_back(line);
+
+                    line.begin = i;
+                    lineExtent = extent;
+                }
+                else lineExtent += m_settings.mainGap + extent;
+            }
+            else lineExtent = extent;
+        }
+        line.end = n;
+        lines.push_back(line);
+    }
+
+    void FlexLayoutModel::resolveLine(const Line& line)
+    {
+        size_t count = line.end - line.begin;
+
+        m_resolvedItemCount += count;
+
+        m_bases.resize(count);
+        m_targets.resize(count);
+        m_frozen.assign(count, false);
+
+        float available = mainSize() - m_settings.mainGap * (count - 1);
+
+        float hypotheticalSum = 0.0f;
+        for (size_t k = 0; k < count; ++k)
+        {
+            auto& item = m_items[line.begin + k];
+
+            m_bases[k] = std::max(mainPreferred(item), 0.0f);
+            m_targets[k] = mainHypothetical(item);
+
+            hypotheticalSum += m_targets[k];
+        }
+        bool isGrowing = hypotheticalSum < available;
+
+        // Freeze the inflexible items, i.e. those without the factor or
+        // already clamped in the direction of the flexing.
+        for (size_t k = 0; k < count; ++k)
+        {
+            auto& item = m_items[line.begin + k];
+
+            float factor = isGrowing ? item.grow : item.shrink;
+            if (factor <= 0.0f ||
+                (isGrowing && m_bases[k] > m_targets[k]) ||
+                (!isGrowing && m_bases[k] < m_targets[k]))
+            {
+                m_frozen[k] = true;
+            }
+        }
+        // Distribute the free space among the unfrozen items, and freeze
+        // the ones violating min/max until all of them are satisfied.
+        while (true)
+        {
+            float freeSpace = available;
+            float factorSum = 0.0f;
+
+            for (size_t k = 0; k < count; ++k)
+            {
+                auto& item = m_items[line.begin + k];
+
+                if (m_frozen[k]) freeSpace -= m_targets[k];
+                else
+                {
+                    freeSpace -= m_bases[k];
+                    factorSum += isGrowing ? item.grow : item.shrink * m_bases[k];
+                }
+            }
+            if (factorSum <= 0.0f) break;
+
+            float totalViolation = 0.0f;
+            for (size_t k = 0; k < count; ++k)
+            {
+                if (m_frozen[k]) continue;
+
+                auto& item = m_items[line.begin + k];
+
+                float factor = isGrowing ? item.grow : item.shrink * m_bases[k];
+                float target = m_bases[k] + freeSpace * factor / factorSum;
+
+                float clamped = std::max(std::min(target, mainMax(item)), mainMin(item));
+
+                totalViolation += clamped - target;
+                m_targets[k] = clamped;
+            }
+            bool isDone = true;
+            for (size_t k = 0; k < count; ++k)
+            {
+                if (m_frozen[k]) continue;
+
+                auto& item = m_items[line.begin + k];
+
+                // Zero violation freezes all; a positive one freezes the
+                // min-violated items and a negative one the max-violated.
+                if (totalViolation == 0.0f ||
+                    (totalViolation > 0.0f && m_targets[k] <= mainMin(item)) ||
+                    (totalViolation < 0.0f && m_targets[k] >= mainMax(item)))
+                {
+                    m_frozen[k] = true;
+                }
+                else isDone = false;
+            }
+            if (isDone) break;
+        }
+        float usedExtent = 0.0f;
+        for (size_t k = 0; k < count; ++k) usedExtent += m_targets[k];
+
+        float remaining = available - usedExtent;
+
+        float leading = 0.0f, between = 0.0f;
+        switch (m_settings.justifyContent)
+        {
+        case Justify::Center: leading = remaining * 0.5f; break;
+        case Justify::End: leading = remaining; break;
+        case Justify::SpaceBetween:
+        {
+            if (remaining > 0.0f && count > 1) between = remaining / (count - 1);
+            break;
+        }
+        case Justify::SpaceAround:
+        {
+            if (remaining > 0.0f)
+            {
+                between = remaining / count;
+                leading = between * 0.5f;
+            }
+            else leading = remaining * 0.5f;
+            break;
+        }
+        case Justify::SpaceEvenly:
+        {
+            if (remaining > 0.0f)
+            {
+                between = leading = remaining / (count + 1);
+            }
+            else leading = remaining * 0.5f;
+            break;
+        }
+        default: break;
+        }
+        float offset = (isRow() ? m_settings.padding.left : m_settings.padding.top) + leading;
+
+        for (size_t k = 0; k < count; ++k)
+        {
+            m_mainOffsets[line.begin + k] = offset;
+            m_mainExtents[line.begin + k] = m_targets[k];
+
+            offset += m_targets[k] + m_settings.mainGap + between;
+        }
+    }
+
+    void FlexLayoutModel::placeLine(const Line& line)
+    {
+        for (size_t i = line.begin; i < line.end; ++i)
+        {
+            auto& item = m_items[i];
+
+            float crossExtent = crossHypothetical(item);
+            float crossOffset = line.crossOffset;
+
+            switch (item.alignSelf.value_or(m_settings.alignItems))
+            {
+            case Align::Center: crossOffset += (line.crossExtent - crossExtent) * 0.5f; break;
+            case Align::End: crossOffset += line.crossExtent - crossExtent; break;
+            case Align::Stretch:
+            {
+                crossExtent = std::max(std::min(line.crossExtent, crossMax(item)), crossMin(item));
+                break;
+            }
+            default: break;
+            }
+            float mainOffset = m_mainOffsets[i];
+            float mainExtent = m_mainExtents[i];
+
+            Rect rect = {};
+            if (isRow())
+            {
+                rect = { mainOffset, crossOffset, mainOffset + mainExtent, crossOffset + crossExtent };
+            }
+            else rect = { crossOffset, mainOffset, crossOffset + crossExtent, mainOffset + mainExtent };
+
+            if (!(rect == m_rects[i]))
+            {
+                m_rects[i] = rect;
+                m_changedItems.push_back(i);
+            }
+        }
+    }
+
+    const FlexLayoutModel::Settings& FlexLayoutModel::settings() const
+    {
+        return m_settings;
+    }
+
+    void FlexLayoutModel::setSettings(const Settings& settings)
+    {
+        m_settings = settings;
+
+        m_allDirty = true;
+    }
+
+    float FlexLayoutModel::width() const
+    {
+        return m_width;
+    }
+
+    float FlexLayoutModel::height() const
+    {
+        return m_height;
+    }
+
+    void FlexLayoutModel::resize(float width, float height)
+    {
+        float originalMainSize = mainSize();
+
+        m_width = width;
+        m_height = height;
+
+        // Changing the cross size only moves/stretches the items, which is
+        // detected by comparing the cross extents of the lines.
+        if (mainSize() != originalMainSize) m_allDirty = true;
+    }
+
+    size_t FlexLayoutModel::count() const
+    {
+        return m_items.size();
+    }
+
+    const FlexLayoutModel::Item& FlexLayoutModel::item(size_t index) const
+    {
+        return m_items.at(index);
+    }
+
+    void FlexLayoutModel::setItem(size_t index, const Item& item)
+    {
+        m_items.at(index) = item;
+
+        m_dirtyItems.push_back(index);
+    }
+
+    void FlexLayoutModel::insert(size_t index, const Item& item)
+    {
+        index = std::min(index, m_items.size());
+
+        m_items.insert(m_items.begin() + index, item);
+        m_rects.insert(m_rects.begin() + index, g_unplacedRect);
+
+        m_mainOffsets.insert(m_mainOffsets.begin() + index, 0.0f);
+        m_mainExtents.insert(m_mainExtents.begin() + index, 0.0f);
+
+        m_allDirty = true;
+    }
+
+    void FlexLayoutModel::erase(size_t index, size_t count)
+    {
+        if (index >= m_items.size()) return;
+
+        size_t last = index + std::min(count, m_items.size() - index);
+
+        m_items.erase(m_items.begin() + index, m_items.begin() + last);
+        m_rects.erase(m_rects.begin() + index, m_rects.begin() + last);
+
+        m_mainOffsets.erase(m_mainOffsets.begin() + index, m_mainOffsets.begin() + last);
+        m_mainExtents.erase(m_mainExtents.begin() + index, m_mainExtents.begin() + last);
+
+        m_allDirty = true;
+    }
+
+    void FlexLayoutModel::clear()
+    {
+        m_items.clear();
+        m_rects.clear();
+
+        m_mainOffsets.clear();
+        m_mainExtents.clear();
+
+        m_lines.clear();
+        m_dirtyItems.clear();
+
+        m_allDirty = true;
+    }
+
+    const std::vector<size_t>& FlexLayoutModel::update()
+    {
+        m_changedItems.clear();
+        m_resolvedItemCount = 0;
+
+        breakLines(m_newLines);
+
+        if (!m_allDirty)
+        {
+            // Mark the old lines that contain the changed items.
+            for (size_t index : m_dirtyItems)
+            {
+                auto itor = std::upper_bound(m_lines.begin(), m_lines.end(), index,
+                    [](size_t value, const Line& line) { return value < line.begin; });
+
+                if (itor != m_lines.begin()) std::prev(itor)->dirty = true;
+            }
+            // A new line reuses the main results of the old one if they
+            // have the same items and neither of them changed.
+            auto oldItor = m_lines.begin();
+            for (auto& line : m_newLines)
+            {
+                while (oldItor != m_lines.end() && oldItor->begin < line.begin) ++oldItor;
+
+                if (oldItor != m_lines.end() && oldItor->begin == line.begin &&
+                    oldItor->end == line.end && !oldItor->dirty)
+                {
+                    line.dirty = false;
+                }
+            }
+        }
+        float crossCursor = isRow() ? m_settings.padding.top : m_settings.padding.left;
+
+        auto oldItor = m_lines.begin();
+        for (auto& line : m_newLines)
+        {
+            while (oldItor != m_lines.end() && oldItor->begin < line.begin) ++oldItor;
+
+            const Line* oldLine = nullptr;
+            if (oldItor != m_lines.end() && oldItor->begin == line.begin && oldItor->end == line.end)
+            {
+                oldLine = &(*oldItor);
+            }
+            if (!m_settings.wrap)
+            {
+                line.crossExtent = crossSize();
+            }
+            else if (line.dirty || oldLine == nullptr)
+            {
+                line.crossExtent = 0.0f;
+                for (size_t i = line.begin; i < line.end; ++i)
+                {
+                    line.crossExtent = std::max(line.crossExtent, crossHypothetical(m_items[i]));
+                }
+            }
+            else line.crossExtent = oldLine->crossExtent;
+
+            line.crossOffset = crossCursor;
+            crossCursor += line.crossExtent + m_settings.crossGap;
+
+            if (line.dirty) resolveLine(line);
+
+            if (line.dirty || oldLine == nullptr ||
+                oldLine->crossOffset != line.crossOffset ||
+                oldLine->crossExtent != line.crossExtent)
+            {
+                placeLine(line);
+            }
+            line.dirty = false;
+        }
+        std::swap(m_lines, m_newLines);
+
+        m_dirtyItems.clear();
+        m_allDirty = false;
+
+        return m_changedItems;
+    }
+
+    const FlexLayoutModel::Rect& FlexLayoutModel::rect(size_t index) const
+    {
+        return m_rects.at(index);
+    }
+
+    size_t FlexLayoutModel::lineCount() const
+    {
+        return m_lines.size();
+    }
+
+    size_t FlexLayoutModel::resolvedItemCount() const
+    {
+        return m_resolvedItemCount;
+    }
+}
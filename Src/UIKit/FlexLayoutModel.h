@@ -0,0 +1,150 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include <cfloat>
+
+namespace d14engine::uikit
+{
+    // Arranges a sequence of items in lines along the main axis (the x-axis
+    // for Row and the y-axis for Column) like the CSS flexbox, which only
+    // uses the standard library so it can be tested without creating any UI
+    // object.
+    //
+    // The results are cached per line: update only resolves the lines whose
+    // items/available space changed (e.g. resizing an item only touches its
+    // own line and moves the following ones), and reports the items whose
+    // rects actually changed, so the other items keep their results.
+    struct FlexLayoutModel
+    {
+        enum class Direction { Row, Column };
+
+        enum class Justify { Start, Center, End, SpaceBetween, SpaceAround, SpaceEvenly };
+
+        enum class Align { Start, Center, End, Stretch };
+
+        struct Item
+        {
+            // The preferred size, where the main part is the flex-basis.
+            float width = 0.0f, height = 0.0f;
+
+            float minWidth = 0.0f, maxWidth = FLT_MAX;
+            float minHeight = 0.0f, maxHeight = FLT_MAX;
+
+            float grow = 0.0f, shrink = 1.0f;
+
+            // Overrides the alignItems of the model.
+            Optional<Align> alignSelf = std::nullopt;
+        };
+
+        struct Rect
+        {
+            float left = 0.0f, top = 0.0f, right = 0.0f, bottom = 0.0f;
+
+            bool operator==(const Rect&) const = default;
+        };
+
+        struct Settings
+        {
+            Direction direction = Direction::Row;
+
+            // Breaks the items into multiple lines if the main axis is full,
+            // otherwise the items shrink to fit in a single line.
+            bool wrap = false;
+
+            Justify justifyContent = Justify::Start;
+            Align alignItems = Align::Stretch;
+
+            float mainGap = 0.0f, crossGap = 0.0f;
+
+            Rect padding = {};
+        };
+
+    protected:
+        Settings m_settings = {};
+
+        float m_width = 0.0f, m_height = 0.0f;
+
+        std::vector<Item> m_items = {};
+        std::vector<Rect> m_rects = {};
+
+        // The results of the main axis, which are kept for the clean lines.
+        std::vector<float> m_mainOffsets = {}, m_mainExtents = {};
+
+        struct Line
+        {
+            size_t begin = 0, end = 0;
+
+            float crossOffset = 0.0f, crossExtent = 0.0f;
+
+            bool dirty = true;
+        };
+        std::vector<Line> m_lines = {}, m_newLines = {};
+
+        // Whether every line needs to be broken and resolved again, e.g.
+        // after changing the settings or inserting/erasing items.
+        bool m_allDirty = true;
+
+        std::vector<size_t> m_dirtyItems = {};
+        std::vector<size_t> m_changedItems = {};
+
+        size_t m_resolvedItemCount = 0;
+
+        // The scratch buffers of resolveLine.
+        std::vector<float> m_bases = {}, m_targets = {};
+        std::vector<bool> m_frozen = {};
+
+        bool isRow() const;
+
+        float mainSize() const;
+        float crossSize() const;
+
+        float mainPreferred(const Item& item) const;
+        float mainMin(const Item& item) const;
+        float mainMax(const Item& item) const;
+
+        float crossPreferred(const Item& item) const;
+        float crossMin(const Item& item) const;
+        float crossMax(const Item& item) const;
+
+        // The preferred extent clamped by the min/max.
+        float mainHypothetical(const Item& item) const;
+        float crossHypothetical(const Item& item) const;
+
+        void breakLines(std::vector<Line>& lines) const;
+
+        void resolveLine(const Line& line);
+
+        void placeLine(const Line& line);
+
+    public:
+        const Settings& settings() const;
+        void setSettings(const Settings& settings);
+
+        float width() const;
+        float height() const;
+
+        void resize(float width, float height);
+
+        size_t count() const;
+
+        const Item& item(size_t index) const;
+        void setItem(size_t index, const Item& item);
+
+        void insert(size_t index, const Item& item);
+        void erase(size_t index, size_t count = 1);
+
+        void clear();
+
+        // Lays out the dirty lines and returns the indices of the items
+        // whose rects changed (in ascending order).
+        const std::vector<size_t>& update();
+
+        const Rect& rect(size_t index) const;
+
+        size_t lineCount() const;
+
+        // The number of the items in the lines resolved by the last update.
+        size_t resolvedItemCount() const;
+    };
+}
@@ -0,0 +1,89 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/HitTestCache.h"
+
+#include <cfloat>
+
+namespace d14engine::uikit
+{
+    uint64_t HitTestCache::g_treeVersion = 0;
+
+    uint64_t HitTestCache::treeVersion()
+    {
+        return g_treeVersion;
+    }
+
+    void HitTestCache::invalidateAll()
+    {
+        ++g_treeVersion;
+    }
+
+    const HitTestCache::Rect& HitTestCache::stabilityRect() const
+    {
+        return m_stabilityRect;
+    }
+
+    bool HitTestCache::isValid(const Point& p) const
+    {
+        return m_treeVersion == g_treeVersion &&
+               p.x > m_stabilityRect.left && p.x < m_stabilityRect.right &&
+               p.y > m_stabilityRect.top && p.y < m_stabilityRect.bottom;
+    }
+
+    void HitTestCache::invalidate()
+    {
+        m_stabilityRect = { 0.0f, 0.0f, 0.0f, 0.0f };
+    }
+
+    void HitTestCache::begin(const Point& p)
+    {
+        m_stabilityRect = { -FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX };
+
+        m_treeVersion = g_treeVersion;
+    }
+
+    void HitTestCache::update(const Point& p, const Optional<Rect>& bounds, bool isHit)
+    {
+        if (!bounds.has_value())
+        {
+            invalidate();
+            return;
+        }
+        auto& r = m_stabilityRect;
+        auto& b = bounds.value();
+
+        if (isHit)
+        {
+            r.left   = std::max(r.left,   b.left  );
+            r.top    = std::max(r.top,    b.top   );
+            r.right  = std::min(r.right,  b.right );
+            r.bottom = std::min(r.bottom, b.bottom);
+            return;
+        }
+        // Already disjoint, nothing to exclude.
+        if (b.right <= r.left || b.left >= r.right ||
+            b.bottom <= r.top || b.top >= r.bottom) return;
+
+        // The point is inside the bounds but not hit, so the hit region is
+        // smaller than the bounds and the result cannot be predicted.
+        if (p.x > b.left && p.x < b.right &&
+            p.y > b.top && p.y < b.bottom)
+        {
+            invalidate();
+            return;
+        }
+        // Cut off the side that keeps the point farthest from the new edge,
+        // which tends to leave the largest room for the cursor jitters.
+        float leftRoom   = (b.right  <= p.x) ? p.x - b.right  : -1.0f;
+        float rightRoom  = (b.left   >= p.x) ? b.left - p.x   : -1.0f;
+        float topRoom    = (b.bottom <= p.y) ? p.y - b.bottom : -1.0f;
+        float bottomRoom = (b.top    >= p.y) ? b.top - p.y    : -1.0f;
+
+        float maxRoom = std::max({ leftRoom, rightRoom, topRoom, bottomRoom });
+
+        if (maxRoom == leftRoom) r.left = std::max(r.left, b.right);
+        else if (maxRoom == rightRoom) r.right = std::min(r.right, b.left);
+        else if (maxRoom == topRoom) r.top = std::max(r.top, b.bottom);
+        else r.bottom = std::min(r.bottom, b.top);
+    }
+}
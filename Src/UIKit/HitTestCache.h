@@ -0,0 +1,60 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::uikit
+{
+    // Remembers the result of hit-testing a group of sibling UI objects, so
+    // that the next mouse-move event can reuse it without calling isHit for
+    // every sibling, which only uses the standard library (with its own
+    // point and rect types converted by Panel) so it can be tested without
+    // creating any UI object.
+    //
+    // While hit-testing, each sibling reports its hit bounds (see
+    // Panel::hitTestBounds) and whether it has been hit, from which the
+    // stability rect is derived: the cursor can move freely inside the
+    // rect without changing the result, as the rect is inside the bounds
+    // of every hit sibling and outside those of the others.
+    //
+    // Anything that may change the result without the cursor moving (e.g.
+    // moving, resizing or hiding an object, adding/removing children and
+    // changing priorities) must call invalidateAll, which bumps the global
+    // tree version and thus invalidates every cache at once.
+    struct HitTestCache
+    {
+        struct Point { float x = 0.0f, y = 0.0f; };
+
+        struct Rect { float left = 0.0f, top = 0.0f, right = 0.0f, bottom = 0.0f; };
+
+    protected:
+        static uint64_t g_treeVersion;
+
+    public:
+        static uint64_t treeVersion();
+
+        static void invalidateAll();
+
+    protected:
+        // Empty (i.e. not containing any point) when invalid.
+        Rect m_stabilityRect = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+        uint64_t m_treeVersion = 0;
+
+    public:
+        const Rect& stabilityRect() const;
+
+        // The point must be strictly inside the stability rect, which makes
+        // the result independent of whether a hit test includes the edges.
+        bool isValid(const Point& p) const;
+
+        void invalidate();
+
+        // Starts a new hit test at the point.
+        void begin(const Point& p);
+
+        // Reports the result of a sibling, where the empty bounds means the
+        // hit region is unknown (e.g. a custom f_isHit), which disables the
+        // cache until the next hit test.
+        void update(const Point& p, const Optional<Rect>& bounds, bool isHit);
+    };
+}
@@ -302,6 +302,16 @@ namespace d14engine::uikit
         return Panel::destroyUIObjectHelper(uiobj);
     }
 
+    void IconLabel::onRendererDrawD2d1LayerHelper(Renderer* rndr)
+    {
+        // The children drawing is taken over, so the layer of the label
+        // (e.g. the text raster cache) must be drawn here.
+        if (m_label->isD2d1ObjectVisible())
+        {
+            m_label->onRendererDrawD2d1Layer(rndr);
+        }
+    }
+
     void IconLabel::onRendererDrawD2d1ObjectHelper(Renderer* rndr)
     {
         // Label Text
@@ -315,8 +325,8 @@ namespace d14engine::uikit
             auto rect = math_utils::roundf(selfCoordToAbsolute(icon.rect));
 
             rndr->d2d1DeviceContext()->DrawBitmap(
-                icon.bitmap.Get(), rect, icon.bitmapOpacity,
-                BitmapObject::g_interpolationMode);
+                bitmap_utils::pickMipLevel(icon.bitmap.Get(), icon.bitmapMipLevels, math_utils::size(rect)),
+                rect, icon.bitmapOpacity, BitmapObject::g_interpolationMode);
         }
     }
 }
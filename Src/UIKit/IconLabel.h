@@ -2,6 +2,8 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
+
 #include "UIKit/Panel.h"
 
 namespace d14engine::uikit
@@ -28,6 +30,9 @@ namespace d14engine::uikit
             ComPtr<ID2D1Bitmap1> bitmap = {};
             float bitmapOpacity = {};
 
+            // Optional, see Panel::bitmapMipLevels.
+            bitmap_utils::MipLevels bitmapMipLevels = {};
+
             Optional<D2D1_SIZE_F> customSize = std::nullopt;
         }
         icon = {};
@@ -42,7 +47,7 @@ namespace d14engine::uikit
     public:
         void updateLayout();
 
-        Function<void(IconLabel*)> f_updateLayout = {};
+        cpp_lang_utils::LazyFunction<void(IconLabel*)> f_updateLayout = {};
 
     protected:
         virtual void updateLayoutHelper();
@@ -83,6 +88,7 @@ namespace d14engine::uikit
     protected:
         void onSizeHelper(SizeEvent& e) override;
         bool destroyUIObjectHelper(ShrdPtrParam<Panel> uiobj) override;
+        void onRendererDrawD2d1LayerHelper(renderer::Renderer* rndr) override;
         void onRendererDrawD2d1ObjectHelper(renderer::Renderer* rndr) override;
     };
 }
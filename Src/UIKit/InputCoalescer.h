@@ -0,0 +1,120 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::uikit
+{
+    // Collects the mouse-move and mouse-wheel messages received between two
+    // frames, so that the application only performs one hit-test and one
+    // dispatch for each run of them instead of one for each message.
+    //
+    // The merging rules:
+    // 1. Consecutive moves with the same state (buttons and modifiers) are
+    //    merged into one entry, whose point is the last one, and all the
+    //    points are kept in order as the history of the entry.
+    // 2. Consecutive wheels with the same point and state are merged into
+    //    one entry, whose delta is the sum of the deltas.
+    // 3. Any other input (button, keyboard etc.) is a barrier, i.e. the
+    //    caller should flush the entries before handling it, so the order
+    //    between the different kinds of events is always kept.
+    //
+    // Only the standard library is used, and Point can be any type that has
+    // the x and y members, so the rules can be tested without Win32.
+    template<typename Point>
+    struct InputCoalescer
+    {
+        struct Entry
+        {
+            enum class Kind { Move, Wheel } kind = Kind::Move;
+
+            // e.g. the MK_* flags of the Win32 messages
+            uint32_t state = 0;
+
+            Point point = {};
+
+            // Move: the range of the points in the history.
+            size_t historyOffset = 0, historyCount = 0;
+
+            // Wheel: in the raw units, e.g. WHEEL_DELTA for one notch.
+            int wheelDelta = 0;
+        };
+
+    protected:
+        std::vector<Entry> m_entries = {};
+
+        std::vector<Point> m_history = {};
+
+    public:
+        void pushMove(const Point& point, uint32_t state)
+        {
+            if (!m_entries.empty())
+            {
+                auto& last = m_entries.back();
+                if (last.kind == Entry::Kind::Move && last.state == state)
+                {
+                    last.point = point;
+                    ++last.historyCount;
+
+                    m_history.push_back(point);
+                    return;
+                }
+            }
+            Entry entry = {};
+            entry.kind = Entry::Kind::Move;
+            entry.state = state;
+            entry.point = point;
+            entry.historyOffset = m_history.size();
+            entry.historyCount = 1;
+
+            m_entries.push_back(entry);
+            m_history.push_back(point);
+        }
+
+        void pushWheel(const Point& point, uint32_t state, int delta)
+        {
+            if (!m_entries.empty())
+            {
+                auto& last = m_entries.back();
+                if (last.kind == Entry::Kind::Wheel && last.state == state &&
+                    last.point.x == point.x && last.point.y == point.y)
+                {
+                    last.wheelDelta += delta;
+                    return;
+                }
+            }
+            Entry entry = {};
+            entry.kind = Entry::Kind::Wheel;
+            entry.state = state;
+            entry.point = point;
+            entry.wheelDelta = delta;
+
+            m_entries.push_back(entry);
+        }
+
+        bool empty() const { return m_entries.empty(); }
+
+        // In the receiving order.
+        const std::vector<Entry>& entries() const { return m_entries; }
+
+        // The points of a move entry, the last one of which is entry.point.
+        std::span<const Point> history(const Entry& entry) const
+        {
+            return { m_history.data() + entry.historyOffset, entry.historyCount };
+        }
+
+        // The storage is kept to avoid the per-frame allocations.
+        void clear()
+        {
+            m_entries.clear();
+            m_history.clear();
+        }
+
+        // Takes the entries (and their storage) out before dispatching, so
+        // the handlers can push or flush again without invalidating them.
+        void swap(InputCoalescer& other) noexcept
+        {
+            m_entries.swap(other.m_entries);
+            m_history.swap(other.m_history);
+        }
+    };
+}
@@ -0,0 +1,204 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/ItemExtentModel.h"
+
+namespace d14engine::uikit
+{
+    void ItemExtentModel::addToTrees(size_t index, double extentDelta, ptrdiff_t unmeasuredDelta)
+    {
+        for (size_t i = index + 1; i < m_extentTree.size(); i += (i & (~i + 1)))
+        {
+            m_extentTree[i] += extentDelta;
+            m_unmeasuredTree[i] += unmeasuredDelta;
+        }
+    }
+
+    void ItemExtentModel::pushToTrees(float extent, bool measured)
+    {
+        size_t i = m_extentTree.size(); // the new 1-based index
+        size_t lowbit = (i & (~i + 1));
+
+        // The new node covers (i - lowbit, i], whose sum except the last one
+        // can be derived from the prefixes.
+        m_extentTree.push_back(measuredPrefix(i - 1) - measuredPrefix(i - lowbit) + (measured ? extent : 0.0));
+        m_unmeasuredTree.push_back(unmeasuredPrefix(i - 1) - unmeasuredPrefix(i - lowbit) + (measured ? 0 : 1));
+    }
+
+    void ItemExtentModel::rebuildTrees()
+    {
+        size_t n = m_extents.size();
+
+        m_extentTree.assign(n + 1, 0.0);
+        m_unmeasuredTree.assign(n + 1, 0);
+
+        for (size_t i = 1; i <= n; ++i)
+        {
+            if (m_measured[i - 1])
+            {
+                m_extentTree[i] += m_extents[i - 1];
+            }
+            else ++m_unmeasuredTree[i];
+
+            size_t parent = i + (i & (~i + 1));
+            if (parent <= n)
+            {
+                m_extentTree[parent] += m_extentTree[i];
+                m_unmeasuredTree[parent] += m_unmeasuredTree[i];
+            }
+        }
+    }
+
+    double ItemExtentModel::measuredPrefix(size_t count) const
+    {
+        double sum = 0.0;
+        for (size_t i = count; i > 0; i -= (i & (~i + 1)))
+        {
+            sum += m_extentTree[i];
+        }
+        return sum;
+    }
+
+    size_t ItemExtentModel::unmeasuredPrefix(size_t count) const
+    {
+        size_t sum = 0;
+        for (size_t i = count; i > 0; i -= (i & (~i + 1)))
+        {
+            sum += m_unmeasuredTree[i];
+        }
+        return sum;
+    }
+
+    float ItemExtentModel::estimatedExtent() const
+    {
+        return m_estimatedExtent;
+    }
+
+    void ItemExtentModel::setEstimatedExtent(float value)
+    {
+        m_estimatedExtent = std::max(value, 0.0f);
+    }
+
+    size_t ItemExtentModel::count() const
+    {
+        return m_extents.size();
+    }
+
+    void ItemExtentModel::insert(size_t index, size_t count)
+    {
+        index = std::min(index, m_extents.size());
+
+        m_extents.insert(m_extents.begin() + index, count, 0.0f);
+        m_measured.insert(m_measured.begin() + index, count, false);
+
+        if (index + count == m_extents.size()) // append
+        {
+            for (size_t i = 0; i < count; ++i) pushToTrees(0.0f, false);
+        }
+        else rebuildTrees();
+    }
+
+    void ItemExtentModel::insert(size_t index, std::span<const float> extents)
+    {
+        index = std::min(index, m_extents.size());
+
+        m_extents.insert(m_extents.begin() + index, extents.begin(), extents.end());
+        m_measured.insert(m_measured.begin() + index, extents.size(), true);
+
+        if (index + extents.size() == m_extents.size()) // append
+        {
+            for (auto& extent : extents) pushToTrees(extent, true);
+        }
+        else rebuildTrees();
+    }
+
+    void ItemExtentModel::erase(size_t index, size_t count)
+    {
+        if (index >= m_extents.size()) return;
+
+        count = std::min(count, m_extents.size() - index);
+
+        m_extents.erase(m_extents.begin() + index, m_extents.begin() + index + count);
+        m_measured.erase(m_measured.begin() + index, m_measured.begin() + index + count);
+
+        if (index == m_extents.size()) // pop back
+        {
+            m_extentTree.resize(index + 1);
+            m_unmeasuredTree.resize(index + 1);
+        }
+        else rebuildTrees();
+    }
+
+    void ItemExtentModel::clear()
+    {
+        m_extents.clear();
+        m_measured.clear();
+
+        rebuildTrees();
+    }
+
+    bool ItemExtentModel::isMeasured(size_t index) const
+    {
+        return m_measured[index];
+    }
+
+    float ItemExtentModel::extent(size_t index) const
+    {
+        return m_measured[index] ? m_extents[index] : m_estimatedExtent;
+    }
+
+    void ItemExtentModel::setExtent(size_t index, float value)
+    {
+        value = std::max(value, 0.0f);
+
+        if (m_measured[index])
+        {
+            addToTrees(index, (double)value - m_extents[index], 0);
+        }
+        else addToTrees(index, value, -1);
+
+        m_extents[index] = value;
+        m_measured[index] = true;
+    }
+
+    float ItemExtentModel::offset(size_t index) const
+    {
+        index = std::min(index, m_extents.size());
+
+        return (float)(measuredPrefix(index) + (double)unmeasuredPrefix(index) * m_estimatedExtent);
+    }
+
+    float ItemExtentModel::totalExtent() const
+    {
+        return offset(m_extents.size());
+    }
+
+    size_t ItemExtentModel::indexAt(float offset) const
+    {
+        if (offset < 0.0f) return m_extents.size();
+
+        size_t n = m_extents.size();
+
+        size_t step = 1;
+        while ((step << 1) <= n) step <<= 1;
+
+        // Descend the trees to find the longest prefix whose sum <= offset,
+        // and the next item is the one that covers the offset.
+        size_t pos = 0;
+        double remaining = offset;
+
+        for (; step > 0; step >>= 1)
+        {
+            size_t next = pos + step;
+            if (next <= n)
+            {
+                double sum = m_extentTree[next] + (double)m_unmeasuredTree[next] * m_estimatedExtent;
+                if (sum <= remaining)
+                {
+                    pos = next;
+                    remaining -= sum;
+                }
+            }
+        }
+        return pos; // == n if the offset is beyond the total extent
+    }
+}
@@ -0,0 +1,72 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::uikit
+{
+    // Keeps the extents (e.g. heights) of a sequence of items and answers
+    // the offset/total-extent/hit queries in O(log n) with Fenwick trees,
+    // which only uses the standard library so it can be tested without
+    // creating any UI object.
+    //
+    // An item is either measured, whose extent is known, or unmeasured,
+    // which takes estimatedExtent until it is measured (e.g. when it is laid
+    // out the first time).  The measured extents and the unmeasured counts
+    // are summed separately, so changing estimatedExtent is O(1).
+    //
+    // Appending/setting is O(log n); inserting/erasing in the middle
+    // rebuilds the trees in O(n).
+    struct ItemExtentModel
+    {
+    protected:
+        // Must be non-negative to keep the offsets monotonic.
+        float m_estimatedExtent = 0.0f;
+
+        std::vector<float> m_extents = {};
+        std::vector<bool> m_measured = {};
+
+        // 1-based Fenwick trees, where m_extentTree[0] is unused.
+        std::vector<double> m_extentTree = { 0.0 };
+        std::vector<size_t> m_unmeasuredTree = { 0 };
+
+        void addToTrees(size_t index, double extentDelta, ptrdiff_t unmeasuredDelta);
+
+        void pushToTrees(float extent, bool measured);
+
+        void rebuildTrees();
+
+        double measuredPrefix(size_t count) const;
+        size_t unmeasuredPrefix(size_t count) const;
+
+    public:
+        float estimatedExtent() const;
+        void setEstimatedExtent(float value);
+
+        size_t count() const;
+
+        void insert(size_t index, size_t count); // unmeasured
+        void insert(size_t index, std::span<const float> extents); // measured
+
+        void erase(size_t index, size_t count = 1);
+
+        void clear();
+
+        bool isMeasured(size_t index) const;
+
+        // Returns estimatedExtent if the item is unmeasured.
+        float extent(size_t index) const;
+
+        // Marks the item as measured.
+        void setExtent(size_t index, float value);
+
+        // The sum of the extents of the items before the index.
+        float offset(size_t index) const;
+
+        float totalExtent() const;
+
+        // Returns the index of the item that covers the offset, i.e.
+        // offset(index) <= offset < offset(index + 1), or count() if there
+        // is no such item.  The zero-extent items are never returned.
+        size_t indexAt(float offset) const;
+    };
+}
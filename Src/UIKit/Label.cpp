@@ -6,6 +6,7 @@
 #include "Common/MathUtils/2D.h"
 
 #include "UIKit/Application.h"
+#include "UIKit/PlatformUtils.h"
 #include "UIKit/ResourceUtils.h"
 
 using namespace d14engine::renderer;
@@ -51,6 +52,8 @@ namespace d14engine::uikit
         }
         else m_text = text;
 
+        m_lineIndex.reset();
+
         m_textLayout = getTextLayout();
         updateTextOverhangMetrics();
     }
@@ -70,6 +73,10 @@ namespace d14engine::uikit
         }
         else m_text.insert(offset, fragment.data(), fragment.size());
 
+        if (m_lineIndex)
+        {
+            m_lineIndex->insert(offset, out.has_value() ? out.value() : fragment);
+        }
         m_textLayout = getTextLayout();
         updateTextOverhangMetrics();
     }
@@ -83,6 +90,10 @@ namespace d14engine::uikit
         }
         else m_text.append(fragment.data(), fragment.size());
 
+        if (m_lineIndex)
+        {
+            m_lineIndex->insert(m_lineIndex->textLength(), out.has_value() ? out.value() : fragment);
+        }
         m_textLayout = getTextLayout();
         updateTextOverhangMetrics();
     }
@@ -94,6 +105,8 @@ namespace d14engine::uikit
 
         m_text.erase(validOffset, validCount);
 
+        if (m_lineIndex) m_lineIndex->erase(validOffset, validCount);
+
         m_textLayout = getTextLayout();
         updateTextOverhangMetrics();
     }
@@ -110,6 +123,8 @@ namespace d14engine::uikit
         if (text.has_value())
         {
             m_text = text.value();
+
+            m_lineIndex.reset();
         }
         TextLayoutParams layoutParams =
         {
@@ -149,6 +164,15 @@ namespace d14engine::uikit
         drawTextOptions = source->drawTextOptions;
     }
 
+    const LineIndex& Label::lineIndex() const
+    {
+        if (!m_lineIndex)
+        {
+            m_lineIndex = std::make_unique<LineIndex>(m_text);
+        }
+        return *m_lineIndex;
+    }
+
     IDWriteTextLayout* Label::textLayout() const { return m_textLayout.Get(); }
 
     DWRITE_TEXT_METRICS Label::textMetrics() const
@@ -299,13 +323,8 @@ namespace d14engine::uikit
         Panel::drawBackground(rndr);
     }
 
-    void Label::drawText(renderer::Renderer* rndr)
+    D2D1_POINT_2F Label::textOrigin() const
     {
-        auto& foreground = m_enabled ? getAppearance().foreground : getAppearance().secondaryForeground;
-
-        resource_utils::g_solidColorBrush->SetColor(foreground.color);
-        resource_utils::g_solidColorBrush->SetOpacity(foreground.opacity);
-
         auto origin = absolutePosition();
         switch (hardAlignment.horz)
         {
@@ -345,11 +364,223 @@ namespace d14engine::uikit
         }
         default: /* VertAlignment::None */ break;
         }
-        rndr->d2d1DeviceContext()->DrawTextLayout(
-            origin,
-            m_textLayout.Get(),
-            resource_utils::g_solidColorBrush.Get(),
-            drawTextOptions);
+        return origin;
+    }
+
+    void Label::onRendererDrawD2d1Layer(Renderer* rndr)
+    {
+        // Must be outside the BeginDraw/EndDraw of the layer cache (see
+        // TextAtlas::beginDraw), i.e. before drawing this layer, and after
+        // the pending theme so as not to cache the previous colors.
+        if (enableTextRasterCache)
+        {
+            applyPendingTheme();
+            updateTextRasterCache(rndr);
+        }
+
+        Panel::onRendererDrawD2d1Layer(rndr);
+    }
+
+    void Label::updateTextRasterCache(renderer::Renderer* rndr)
+    {
+        auto& cache = m_textRasterCache;
+        auto atlas = Application::g_app->textAtlas();
+
+        auto& foreground = m_enabled ? getAppearance().foreground : getAppearance().secondaryForeground;
+
+        auto dpi = platform_utils::dpi();
+
+        D2D1_SIZE_F textLayoutSize =
+        {
+            m_textLayout->GetMaxWidth(), m_textLayout->GetMaxHeight()
+        };
+        D2D1_RECT_F textOverhangs =
+        {
+            m_textOverhangs.left, m_textOverhangs.top,
+            m_textOverhangs.right, m_textOverhangs.bottom
+        };
+        auto textAlignment = m_textLayout->GetTextAlignment();
+        auto paragraphAlignment = m_textLayout->GetParagraphAlignment();
+        auto wordWrapping = m_textLayout->GetWordWrapping();
+        auto incrementalTabStop = m_textLayout->GetIncrementalTabStop();
+
+        auto isSameColor = [](const D2D1_COLOR_F& a, const D2D1_COLOR_F& b)
+        {
+            return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+        };
+        auto isSameRect = [](const D2D1_RECT_F& a, const D2D1_RECT_F& b)
+        {
+            return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+        };
+        if (cache.slot.has_value() && atlas->isValid(cache.slot.value()) &&
+            cache.textLayout == m_textLayout && isSameColor(cache.color, foreground.color) &&
+            cache.drawTextOptions == drawTextOptions && cache.dpi == dpi &&
+            cache.textLayoutSize.width == textLayoutSize.width &&
+            cache.textLayoutSize.height == textLayoutSize.height &&
+            isSameRect(cache.textOverhangs, textOverhangs) &&
+            cache.textAlignment == textAlignment &&
+            cache.paragraphAlignment == paragraphAlignment &&
+            cache.wordWrapping == wordWrapping &&
+            cache.incrementalTabStop == incrementalTabStop)
+        {
+            atlas->touch(cache.slot.value());
+            return;
+        }
+        cache.slot.reset();
+
+        cache.textLayout = m_textLayout;
+        cache.color = foreground.color;
+        cache.drawTextOptions = drawTextOptions;
+        cache.textLayoutSize = textLayoutSize;
+        cache.textOverhangs = textOverhangs;
+        cache.dpi = dpi;
+        cache.textAlignment = textAlignment;
+        cache.paragraphAlignment = paragraphAlignment;
+        cache.wordWrapping = wordWrapping;
+        cache.incrementalTabStop = incrementalTabStop;
+
+        if (m_text.empty()) return;
+
+        // Keep the glyphs that overhang the layout box, and leave 1 DIP
+        // for the antialiasing pixels on the edges.
+        auto scale = dpi / 96.0f;
+
+        D2D1_RECT_F region =
+        {
+            -std::max(m_textOverhangs.left, 0.0f) - 1.0f,
+            -std::max(m_textOverhangs.top, 0.0f) - 1.0f,
+            textLayoutSize.width + std::max(m_textOverhangs.right, 0.0f) + 1.0f,
+            textLayoutSize.height + std::max(m_textOverhangs.bottom, 0.0f) + 1.0f
+        };
+        region.left = std::floor(region.left * scale) / scale;
+        region.top = std::floor(region.top * scale) / scale;
+
+        auto pixWidth = std::ceil((region.right - region.left) * scale);
+        auto pixHeight = std::ceil((region.bottom - region.top) * scale);
+
+        if (pixWidth > (float)atlas->createInfo.pageWidth ||
+            pixHeight > (float)atlas->createInfo.pageHeight) return;
+
+        TextAtlas::Key key = {};
+        key.text = m_text;
+
+        auto familyNameLength = m_textLayout->GetFontFamilyNameLength() + 1;
+        key.fontFamilyName.resize(familyNameLength);
+        THROW_IF_FAILED(m_textLayout->GetFontFamilyName(key.fontFamilyName.data(), familyNameLength));
+        key.fontFamilyName.pop_back(); // null-terminator
+
+        auto localeNameLength = m_textLayout->GetLocaleNameLength() + 1;
+        key.localeName.resize(localeNameLength);
+        THROW_IF_FAILED(m_textLayout->GetLocaleName(key.localeName.data(), localeNameLength));
+        key.localeName.pop_back(); // null-terminator
+
+        key.fontSize = m_textLayout->GetFontSize();
+        key.fontWeight = m_textLayout->GetFontWeight();
+        key.fontStyle = m_textLayout->GetFontStyle();
+        key.fontStretch = m_textLayout->GetFontStretch();
+
+        key.maxWidth = textLayoutSize.width;
+        key.maxHeight = textLayoutSize.height;
+        key.incrementalTabStop = incrementalTabStop;
+
+        key.textAlignment = textAlignment;
+        key.paragraphAlignment = paragraphAlignment;
+        key.wordWrapping = wordWrapping;
+        key.drawTextOptions = drawTextOptions;
+
+        auto& color = foreground.color;
+        key.color = { color.r, color.g, color.b, color.a };
+
+        key.dpi = dpi;
+
+        cache.region = region;
+
+        if (cache.slot = atlas->find(key)) return;
+
+        if (cache.slot = atlas->allocate(key, (int)pixWidth, (int)pixHeight))
+        {
+            auto context = rndr->d2d1DeviceContext();
+            atlas->beginDraw(context, cache.slot.value());
+            {
+                // The opacity is applied when drawing the cached bitmap.
+                resource_utils::g_solidColorBrush->SetColor(color);
+                resource_utils::g_solidColorBrush->SetOpacity(1.0f);
+
+                if (auto statistics = Application::g_app->drawStatistics())
+                {
+                    statistics->addTextLayout();
+                }
+                context->DrawTextLayout(
+                    { -region.left, -region.top },
+                    m_textLayout.Get(),
+                    resource_utils::g_solidColorBrush.Get(),
+                    drawTextOptions);
+            }
+            atlas->endDraw(context);
+        }
+    }
+
+    void Label::drawText(renderer::Renderer* rndr)
+    {
+        auto& foreground = m_enabled ? getAppearance().foreground : getAppearance().secondaryForeground;
+
+        auto origin = textOrigin();
+
+        auto& cache = m_textRasterCache;
+        auto atlas = Application::g_app->textAtlas();
+
+        // The owners may change the foreground after the layer pass (e.g.
+        // Button in onRendererDrawD2d1ObjectHelper), so the cached one is
+        // only used if rasterized with the current color.
+        auto& color = foreground.color;
+        bool isSameColor = cache.color.r == color.r && cache.color.g == color.g &&
+                           cache.color.b == color.b && cache.color.a == color.a;
+
+        if (enableTextRasterCache && isSameColor &&
+            cache.slot.has_value() && atlas->isValid(cache.slot.value()))
+        {
+            auto& slot = cache.slot.value();
+
+            // Snap to the pixel grid since the cached bitmap is sampled
+            // with the nearest-neighbor interpolation.
+            auto scale = platform_utils::dpi() / 96.0f;
+
+            float left = std::round((origin.x + cache.region.left) * scale) / scale;
+            float top = std::round((origin.y + cache.region.top) * scale) / scale;
+
+            auto slotRect = atlas->slotRect(slot);
+            D2D1_RECT_F srcRect =
+            {
+                slotRect.left, slotRect.top, slotRect.right, slotRect.bottom
+            };
+            D2D1_RECT_F dstRect =
+            {
+                left, top,
+                left + (srcRect.right - srcRect.left),
+                top + (srcRect.bottom - srcRect.top)
+            };
+            rndr->d2d1DeviceContext()->DrawBitmap(
+                atlas->pageBitmap(slot),
+                dstRect,
+                foreground.opacity,
+                D2D1_INTERPOLATION_MODE_NEAREST_NEIGHBOR,
+                srcRect);
+        }
+        else // fall back to the DirectWrite rendering
+        {
+            resource_utils::g_solidColorBrush->SetColor(foreground.color);
+            resource_utils::g_solidColorBrush->SetOpacity(foreground.opacity);
+
+            if (auto statistics = Application::g_app->drawStatistics())
+            {
+                statistics->addTextLayout();
+            }
+            rndr->d2d1DeviceContext()->DrawTextLayout(
+                origin,
+                m_textLayout.Get(),
+                resource_utils::g_solidColorBrush.Get(),
+                drawTextOptions);
+        }
     }
 
     void Label::drawOutline(renderer::Renderer* rndr)
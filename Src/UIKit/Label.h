@@ -3,7 +3,9 @@
 #include "Common/Precompile.h"
 
 #include "UIKit/Appearances/Label.h"
+#include "UIKit/LineIndex.h"
 #include "UIKit/Panel.h"
+#include "UIKit/TextAtlas.h"
 
 namespace d14engine::uikit
 {
@@ -34,6 +36,15 @@ namespace d14engine::uikit
 
         void copyTextStyle(Label* source, OptParam<WstringView> text = std::nullopt);
 
+    protected:
+        // Built on the first query and then kept in sync by the fragment
+        // edits, so the line queries of a long text (e.g. go-to-line in a
+        // TextEditor) need neither a rescan nor the text layout.
+        mutable UniquePtr<LineIndex> m_lineIndex = {};
+
+    public:
+        const LineIndex& lineIndex() const;
+
     protected:
         ComPtr<IDWriteTextLayout> m_textLayout = {};
 
@@ -98,6 +109,48 @@ namespace d14engine::uikit
     public:
         D2D1_DRAW_TEXT_OPTIONS drawTextOptions = D2D1_DRAW_TEXT_OPTIONS_NONE;
 
+        // Draws the text with the pre-rasterized bitmap in the text atlas
+        // instead of calling DrawTextLayout every frame, which is worth for
+        // the static labels (captions, menu items etc.).  The layout-wide
+        // formats set with textLayout() directly (alignments, word wrapping
+        // and tab stop) are checked every frame, but the range formats are
+        // not tracked by the cache.
+        bool enableTextRasterCache = false;
+
+        // IDrawObject2D
+        // The cache is updated here rather than in the layer helper, which
+        // the subclasses (e.g. RawTextInput) override without calling.
+        void onRendererDrawD2d1Layer(renderer::Renderer* rndr) override;
+
+    protected:
+        // Where to draw the text layout after applying the hard alignment.
+        D2D1_POINT_2F textOrigin() const;
+
+        struct TextRasterCache
+        {
+            Optional<TextAtlas::Slot> slot = std::nullopt;
+
+            // Relative to the text origin, in DIPs.
+            D2D1_RECT_F region = {};
+
+            // Checked every frame to skip building the full key.
+            ComPtr<IDWriteTextLayout> textLayout = {};
+            D2D1_COLOR_F color = {};
+            D2D1_DRAW_TEXT_OPTIONS drawTextOptions = {};
+            D2D1_SIZE_F textLayoutSize = {};
+            D2D1_RECT_F textOverhangs = {};
+            float dpi = 0.0f;
+
+            // Can be changed in place with textLayout()->SetXxx.
+            DWRITE_TEXT_ALIGNMENT textAlignment = {};
+            DWRITE_PARAGRAPH_ALIGNMENT paragraphAlignment = {};
+            DWRITE_WORD_WRAPPING wordWrapping = {};
+            float incrementalTabStop = 0.0f;
+        }
+        m_textRasterCache = {};
+
+        void updateTextRasterCache(renderer::Renderer* rndr);
+
         struct PointHitTestResult
         {
             BOOL isTrailingHit = {};
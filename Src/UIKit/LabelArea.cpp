@@ -61,6 +61,16 @@ namespace d14engine::uikit
         m_indicatorGeometry.second = { result.pointX, result.pointY + result.metrics.height };
     }
 
+    LineIndex::Position LabelArea::indicatorLinePosition() const
+    {
+        return lineIndex().positionOf(m_indicatorCharacterOffset);
+    }
+
+    void LabelArea::setIndicatorLinePosition(const LineIndex::Position& position)
+    {
+        setIndicatorPosition(lineIndex().offsetOf(position));
+    }
+
     void LabelArea::performCommandCtrlA()
     {
         setHiliteRange({ 0, m_text.size() });
@@ -48,6 +48,11 @@ namespace d14engine::uikit
         size_t indicatorPosition() const;
         virtual void setIndicatorPosition(size_t characterOffset);
 
+        // In the lines of lineIndex (e.g. for go-to-line), where the column
+        // is clamped to the line length.
+        LineIndex::Position indicatorLinePosition() const;
+        void setIndicatorLinePosition(const LineIndex::Position& position);
+
     public:
         virtual void performCommandCtrlA();
         virtual void performCommandCtrlC();
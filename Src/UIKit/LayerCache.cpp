@@ -0,0 +1,43 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/LayerCache.h"
+
+namespace d14engine::uikit
+{
+    bool LayerCacheState::isValid() const
+    {
+        return m_valid;
+    }
+
+    void LayerCacheState::invalidate()
+    {
+        m_valid = false;
+    }
+
+    bool LayerCacheState::beginFrame()
+    {
+        if (m_valid)
+        {
+            ++m_reuseCount;
+            return false;
+        }
+        else return true;
+    }
+
+    void LayerCacheState::markRendered()
+    {
+        m_valid = true;
+
+        ++m_renderCount;
+    }
+
+    size_t LayerCacheState::renderCount() const
+    {
+        return m_renderCount;
+    }
+
+    size_t LayerCacheState::reuseCount() const
+    {
+        return m_reuseCount;
+    }
+}
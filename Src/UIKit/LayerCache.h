@@ -0,0 +1,57 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::uikit
+{
+    // Tracks whether the retained bitmap of a "cache as bitmap" panel (see
+    // Panel::setCacheAsBitmap) is still up to date, which only uses the
+    // standard library so it can be tested without creating any UI object.
+    //
+    // The bitmap keeps the subtree in the self coordinate, so moving the
+    // panel itself (e.g. scrolling the content of a scroll view) only needs
+    // to composite the bitmap at the new position, while any change inside
+    // the subtree must invalidate the cache of every ancestor that caches,
+    // which is what invalidateLayerCaches does.
+    struct LayerCacheState
+    {
+    protected:
+        bool m_valid = false;
+
+        size_t m_renderCount = 0;
+        size_t m_reuseCount = 0;
+
+    public:
+        bool isValid() const;
+
+        void invalidate();
+
+        // Returns whether the subtree needs to be rendered into the bitmap
+        // again, and counts a reuse otherwise.
+        bool beginFrame();
+
+        // Called after rendering the subtree into the bitmap.
+        void markRendered();
+
+        size_t renderCount() const;
+        size_t reuseCount() const;
+    };
+
+    // Invalidates the caches of the node (if includeSelf) and its ancestors,
+    // where getParent returns the parent (or nullptr for the root) and
+    // getCache returns the cache state (or nullptr if not caching).
+    //
+    // All of the ancestors are visited instead of stopping at the first
+    // invalid one, since an invisible subtree is not rendered and thus can
+    // keep an invalid cache under a valid one.
+    template<typename Node_T, typename GetParent_T, typename GetCache_T>
+    void invalidateLayerCaches(Node_T* node, bool includeSelf, GetParent_T&& getParent, GetCache_T&& getCache)
+    {
+        if (node != nullptr && !includeSelf) node = getParent(node);
+
+        for (; node != nullptr; node = getParent(node))
+        {
+            if (LayerCacheState* cache = getCache(node)) cache->invalidate();
+        }
+    }
+}
@@ -45,13 +45,13 @@ namespace d14engine::uikit
             updateElement(elem, geoInfo);
         }
 
-        void removeElement(ShrdPtrParam<Panel> elem)
+        virtual void removeElement(ShrdPtrParam<Panel> elem)
         {
             m_elemGeoInfos.erase(elem);
             removeUIObject(elem);
         }
 
-        void clearAllElements()
+        virtual void clearAllElements()
         {
             m_elemGeoInfos.clear();
             clearAddedUIObjects();
@@ -67,7 +67,7 @@ namespace d14engine::uikit
             updateElement(m_elemGeoInfos.find(elem));
         }
 
-        void updateAllElements()
+        virtual void updateAllElements()
         {
             for (auto& kv : m_elemGeoInfos) updateElement(kv.first, kv.second);
         }
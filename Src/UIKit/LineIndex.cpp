@@ -0,0 +1,333 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/LineIndex.h"
+
+namespace d14engine::uikit
+{
+    LineIndex::LineIndex(WstringView text)
+    {
+        assign(text);
+    }
+
+    uint32_t LineIndex::createNode(size_t length)
+    {
+        // xorshift32, which is enough for the priorities.
+        m_seed ^= m_seed << 13;
+        m_seed ^= m_seed >> 17;
+        m_seed ^= m_seed << 5;
+
+        Node node = {};
+        node.priority = m_seed;
+        node.count = 1;
+        node.length = node.sum = length;
+
+        if (!m_freeNodes.empty())
+        {
+            auto index = m_freeNodes.back();
+            m_freeNodes.pop_back();
+
+            m_nodes[index] = node;
+            return index;
+        }
+        m_nodes.push_back(node);
+        return (uint32_t)(m_nodes.size() - 1);
+    }
+
+    void LineIndex::destroyTree(uint32_t node)
+    {
+        std::vector<uint32_t> nodes = {};
+        if (node != 0) nodes.push_back(node);
+
+        while (!nodes.empty())
+        {
+            auto index = nodes.back();
+            nodes.pop_back();
+
+            auto& target = m_nodes[index];
+            if (target.left != 0) nodes.push_back(target.left);
+            if (target.right != 0) nodes.push_back(target.right);
+
+            m_freeNodes.push_back(index);
+        }
+    }
+
+    void LineIndex::update(uint32_t node)
+    {
+        auto& target = m_nodes[node];
+        auto& left = m_nodes[target.left];
+        auto& right = m_nodes[target.right];
+
+        target.count = 1 + left.count + right.count;
+        target.sum = target.length + left.sum + right.sum;
+    }
+
+    std::pair<uint32_t, uint32_t> LineIndex::split(uint32_t node, size_t count)
+    {
+        if (node == 0) return { 0, 0 };
+
+        size_t leftCount = m_nodes[m_nodes[node].left].count;
+        if (count <= leftCount)
+        {
+            auto [left, right] = split(m_nodes[node].left, count);
+            m_nodes[node].left = right;
+            update(node);
+            return { left, node };
+        }
+        else // in the right subtree
+        {
+            auto [left, right] = split(m_nodes[node].right, count - leftCount - 1);
+            m_nodes[node].right = left;
+            update(node);
+            return { node, right };
+        }
+    }
+
+    uint32_t LineIndex::merge(uint32_t left, uint32_t right)
+    {
+        if (left == 0) return right;
+        if (right == 0) return left;
+
+        if (m_nodes[left].priority > m_nodes[right].priority)
+        {
+            m_nodes[left].right = merge(m_nodes[left].right, right);
+            update(left);
+            return left;
+        }
+        else // right on top
+        {
+            m_nodes[right].left = merge(left, m_nodes[right].left);
+            update(right);
+            return right;
+        }
+    }
+
+    uint32_t LineIndex::build(const std::vector<size_t>& lengths)
+    {
+        // The nodes popped from the right spine are complete (their right
+        // subtrees were popped before them), so they are updated then.
+        std::vector<uint32_t> spine = {};
+        for (auto length : lengths)
+        {
+            auto node = createNode(length);
+
+            uint32_t last = 0;
+            while (!spine.empty() && m_nodes[spine.back()].priority < m_nodes[node].priority)
+            {
+                last = spine.back();
+                spine.pop_back();
+                update(last);
+            }
+            m_nodes[node].left = last;
+
+            if (!spine.empty()) m_nodes[spine.back()].right = node;
+
+            spine.push_back(node);
+        }
+        for (auto itor = spine.rbegin(); itor != spine.rend(); ++itor)
+        {
+            update(*itor);
+        }
+        return spine.empty() ? 0 : spine.front();
+    }
+
+    std::pair<uint32_t, size_t> LineIndex::findLine(size_t line) const
+    {
+        uint32_t node = m_root;
+        size_t start = 0;
+
+        while (node != 0)
+        {
+            auto& target = m_nodes[node];
+            auto& left = m_nodes[target.left];
+
+            if (line < left.count)
+            {
+                node = target.left;
+            }
+            else if (line == left.count)
+            {
+                return { node, start + left.sum };
+            }
+            else // in the right subtree
+            {
+                start += left.sum + target.length;
+                line -= left.count + 1;
+                node = target.right;
+            }
+        }
+        return { 0, start };
+    }
+
+    void LineIndex::addLength(uint32_t node, size_t line, ptrdiff_t delta)
+    {
+        while (node != 0)
+        {
+            auto& target = m_nodes[node];
+            target.sum += delta;
+
+            size_t leftCount = m_nodes[target.left].count;
+            if (line < leftCount)
+            {
+                node = target.left;
+            }
+            else if (line == leftCount)
+            {
+                target.length += delta;
+                break;
+            }
+            else // in the right subtree
+            {
+                line -= leftCount + 1;
+                node = target.right;
+            }
+        }
+    }
+
+    void LineIndex::replaceLines(size_t first, size_t last, const std::vector<size_t>& lengths)
+    {
+        auto [before, rest] = split(m_root, first);
+        auto [lines, after] = split(rest, last - first + 1);
+
+        destroyTree(lines);
+
+        m_root = merge(merge(before, build(lengths)), after);
+    }
+
+    void LineIndex::assign(WstringView text)
+    {
+        m_nodes.clear();
+        m_nodes.push_back({}); // null
+
+        m_freeNodes.clear();
+
+        std::vector<size_t> lengths = {};
+
+        size_t start = 0;
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            if (text[i] == L'\n')
+            {
+                lengths.push_back(i + 1 - start);
+                start = i + 1;
+            }
+        }
+        lengths.push_back(text.size() - start);
+
+        m_nodes.reserve(lengths.size() + 1);
+
+        m_root = build(lengths);
+    }
+
+    size_t LineIndex::lineCount() const
+    {
+        return m_nodes[m_root].count;
+    }
+
+    size_t LineIndex::textLength() const
+    {
+        return m_nodes[m_root].sum;
+    }
+
+    LineIndex::Position LineIndex::positionOf(size_t offset) const
+    {
+        if (offset >= textLength())
+        {
+            // The last line never ends with '\n'.
+            size_t line = lineCount() - 1;
+            return { line, textLength() - findLine(line).second };
+        }
+        uint32_t node = m_root;
+        size_t line = 0;
+
+        while (node != 0)
+        {
+            auto& target = m_nodes[node];
+            auto& left = m_nodes[target.left];
+
+            if (offset < left.sum)
+            {
+                node = target.left;
+            }
+            else if (offset < left.sum + target.length)
+            {
+                return { line + left.count, offset - left.sum };
+            }
+            else // in the right subtree
+            {
+                offset -= left.sum + target.length;
+                line += left.count + 1;
+                node = target.right;
+            }
+        }
+        return {}; // unreachable since offset < textLength
+    }
+
+    size_t LineIndex::offsetOf(const Position& position) const
+    {
+        size_t line = std::min(position.line, lineCount() - 1);
+
+        return lineStart(line) + std::min(position.column, lineLength(line));
+    }
+
+    size_t LineIndex::lineStart(size_t line) const
+    {
+        return findLine(line).second;
+    }
+
+    size_t LineIndex::lineLength(size_t line) const
+    {
+        auto length = m_nodes[findLine(line).first].length;
+
+        return line + 1 < lineCount() ? length - 1 : length;
+    }
+
+    void LineIndex::insert(size_t offset, WstringView text)
+    {
+        if (text.empty()) return;
+
+        auto position = positionOf(offset);
+
+        auto lineBreak = text.find(L'\n');
+        if (lineBreak == WstringView::npos)
+        {
+            addLength(m_root, position.line, (ptrdiff_t)text.size());
+            return;
+        }
+        // The line is split at the column, and the text goes in between.
+        size_t length = m_nodes[findLine(position.line).first].length;
+
+        std::vector<size_t> lengths = {};
+        lengths.push_back(position.column + lineBreak + 1);
+
+        size_t start = lineBreak + 1;
+        while ((lineBreak = text.find(L'\n', start)) != WstringView::npos)
+        {
+            lengths.push_back(lineBreak + 1 - start);
+            start = lineBreak + 1;
+        }
+        lengths.push_back(text.size() - start + length - position.column);
+
+        replaceLines(position.line, position.line, lengths);
+    }
+
+    void LineIndex::erase(size_t offset, size_t count)
+    {
+        offset = std::min(offset, textLength());
+        count = std::min(count, textLength() - offset);
+
+        if (count == 0) return;
+
+        auto first = positionOf(offset);
+        auto last = positionOf(offset + count);
+
+        if (first.line == last.line)
+        {
+            addLength(m_root, first.line, -(ptrdiff_t)count);
+            return;
+        }
+        // The head of the first line joins the tail of the last line.
+        size_t length = m_nodes[findLine(last.line).first].length;
+
+        replaceLines(first.line, last.line, { first.column + length - last.column });
+    }
+}
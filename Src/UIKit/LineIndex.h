@@ -0,0 +1,103 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::uikit
+{
+    // Maps the character offsets of a text to (line, column) and back in
+    // O(log n), which only uses the standard library so it can be tested
+    // without creating any UI object (see Label::lineIndex).
+    //
+    // The lines are kept in a treap ordered by the line number, where each
+    // node stores the length of a line and the subtree sums the lengths,
+    // so an edit only updates the lines it touches instead of rescanning
+    // the text.  The lines are separated by '\n' (so a '\r' before it is
+    // counted as the last character of the line), and there is always at
+    // least one line, i.e. an empty text has one empty line.
+    struct LineIndex
+    {
+        explicit LineIndex(WstringView text = {});
+
+        struct Position
+        {
+            size_t line = 0, column = 0;
+
+            bool operator==(const Position&) const = default;
+        };
+
+    protected:
+        struct Node
+        {
+            uint32_t left = 0, right = 0;
+
+            uint32_t priority = 0;
+
+            // The lines in the subtree.
+            uint32_t count = 0;
+
+            // Including the '\n' at the end (if any).
+            size_t length = 0;
+
+            // The lengths of the lines in the subtree.
+            size_t sum = 0;
+        };
+        // The node 0 is the null one, whose count and sum are always 0.
+        std::vector<Node> m_nodes = {};
+
+        std::vector<uint32_t> m_freeNodes = {};
+
+        uint32_t m_root = 0;
+
+        uint32_t m_seed = 0x9e3779b9;
+
+        uint32_t createNode(size_t length);
+        void destroyTree(uint32_t node);
+
+        void update(uint32_t node);
+
+        // The first count lines go to the left.
+        std::pair<uint32_t, uint32_t> split(uint32_t node, size_t count);
+
+        uint32_t merge(uint32_t left, uint32_t right);
+
+        // Builds a treap of the lines in O(n) with the right spine.
+        uint32_t build(const std::vector<size_t>& lengths);
+
+        // Returns the node of the line and the offset of its start.
+        std::pair<uint32_t, size_t> findLine(size_t line) const;
+
+        // Adds the delta to the line and the sums above it.
+        void addLength(uint32_t node, size_t line, ptrdiff_t delta);
+
+        // Replaces the lines in [first, last] with the new lengths.
+        void replaceLines(size_t first, size_t last, const std::vector<size_t>& lengths);
+
+    public:
+        void assign(WstringView text);
+
+        size_t lineCount() const;
+
+        size_t textLength() const;
+
+        // The offset is clamped to the text length, where the offset right
+        // after a '\n' is at the start of the next line.
+        Position positionOf(size_t offset) const;
+
+        // The line is clamped to the last line, and the column is clamped
+        // to the line length (excluding the '\n').
+        size_t offsetOf(const Position& position) const;
+
+        // The line must be less than lineCount.
+        size_t lineStart(size_t line) const;
+
+        // Excluding the '\n', where the line must be less than lineCount.
+        size_t lineLength(size_t line) const;
+
+        // Updates the lines for the text inserted at the offset.
+        void insert(size_t offset, WstringView text);
+
+        // Updates the lines for the characters erased from the text, where
+        // the range is clamped to the text length.
+        void erase(size_t offset, size_t count);
+    };
+}
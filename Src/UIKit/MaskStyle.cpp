@@ -17,8 +17,8 @@ namespace d14engine::uikit
 
     void MaskStyle::loadBitmap(UINT width, UINT height)
     {
-        auto rndr = Application::g_app->dxRenderer();
-        rndr->beginGpuCommand();
+        // The previous bitmap might be still used by the frames in flight.
+        Application::g_app->dxRenderer()->deferRelease(bitmap);
 
         auto dipSize = SIZE{ (LONG)width, (LONG)height };
         auto pixSize = platform_utils::scaledByDpi(dipSize);
@@ -26,8 +26,6 @@ namespace d14engine::uikit
         bitmap = bitmap_utils::loadBitmap(
             (UINT)pixSize.cx, (UINT)pixSize.cy,
             nullptr, D2D1_BITMAP_OPTIONS_TARGET);
-
-        rndr->endGpuCommand();
     }
 
     void MaskStyle::loadBitmap(const D2D1_SIZE_U& size)
@@ -42,6 +40,11 @@ namespace d14engine::uikit
         // resource and still bound to the context when calling BeginDraw.
         context->SetTarget(bitmap.Get());
         context->BeginDraw();
+
+        if (auto statistics = Application::g_app->drawStatistics())
+        {
+            statistics->addMaskPass();
+        }
         context->SetTransform(transform);
         context->Clear(color);
     }
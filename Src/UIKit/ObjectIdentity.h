@@ -0,0 +1,37 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::uikit
+{
+    // The results of the dynamic casts needed by the hot paths (e.g. the
+    // enter/leave comparison in every mouse-move), which are cached by the
+    // factory that knows the most-derived type (see makeUIObject) and only
+    // use the standard library so they can be tested without creating any
+    // UI object.
+    template<typename Interface_T>
+    struct ObjectIdentity
+    {
+        // The address of the most-derived object.
+        const void* mostDerived = nullptr;
+
+        // nullptr if the object does not implement the interface.
+        Interface_T* interfaceObject = nullptr;
+
+        // Not initialized yet while constructing the object.
+        bool isValid() const { return mostDerived != nullptr; }
+
+        template<typename T>
+        static ObjectIdentity make(T* object)
+        {
+            ObjectIdentity identity = {};
+            identity.mostDerived = static_cast<const void*>(object);
+
+            if constexpr (std::is_base_of_v<Interface_T, T>)
+            {
+                identity.interfaceObject = static_cast<Interface_T*>(object);
+            }
+            return identity;
+        }
+    };
+}
@@ -2,17 +2,24 @@
 
 #include "UIKit/Panel.h"
 
-#include "Common/CppLangUtils/PointerEquality.h"
 #include "Common/MathUtils/2D.h"
 #include "Common/MathUtils/Basic.h"
 
 #include "UIKit/Application.h"
 #include "UIKit/BitmapObject.h"
+#include "UIKit/PlatformUtils.h"
+#include "UIKit/TextInputObject.h"
 
 using namespace d14engine::renderer;
 
 namespace d14engine::uikit
 {
+    // The 23 f_* hooks used to be std::function (64 bytes each with MSVC
+    // x64), which made a Panel about 1880 bytes instead of about 600 now.
+
+    static_assert(sizeof(Panel) <= 600,
+        "Panel grew, so check whether the new members can be lazy too.");
+
     Panel::Panel(
         const D2D1_RECT_F& rect,
         ComPtrParam<ID2D1Brush> brush,
@@ -33,6 +40,8 @@ namespace d14engine::uikit
 
     void Panel::onInitializeFinish()
     {
+        m_themeGeneration = Application::g_app->themeGeneration();
+
         onChangeThemeHelper(Application::g_app->currThemeName());
         onChangeLangLocaleHelper(Application::g_app->currLangLocaleName());
     }
@@ -78,6 +87,32 @@ namespace d14engine::uikit
         else return destroyUIObjectHelper(uiobj);
     }
 
+    const void* Panel::identity() const
+    {
+        // Not cached yet if called during the construction.
+        if (!m_identity.isValid())
+        {
+            return dynamic_cast<const void*>(this);
+        }
+        return m_identity.mostDerived;
+    }
+
+    TextInputObject* Panel::textInputObject() const
+    {
+        if (!m_identity.isValid())
+        {
+            return dynamic_cast<TextInputObject*>(const_cast<Panel*>(this));
+        }
+        return m_identity.interfaceObject;
+    }
+
+    bool isSameUIObject(const Panel* lhs, const Panel* rhs)
+    {
+        if (lhs == nullptr || rhs == nullptr) return lhs == rhs;
+
+        return lhs->identity() == rhs->identity();
+    }
+
     bool Panel::isD2d1ObjectVisible() const
     {
         return m_visible;
@@ -85,6 +120,11 @@ namespace d14engine::uikit
 
     void Panel::setD2d1ObjectVisible(bool value)
     {
+        if (m_visible != value)
+        {
+            HitTestCache::invalidateAll();
+            invalidateAncestorLayerCaches();
+        }
         m_visible = value;
     }
 
@@ -97,9 +137,75 @@ namespace d14engine::uikit
         onRendererUpdateObject2DHelper(rndr);
 
         if (f_onRendererUpdateObject2DAfter) f_onRendererUpdateObject2DAfter(this, rndr);
+
+        // The animation changes the appearance in every frame.
+        if (m_isPlayAnimation) invalidateLayerCaches();
     }
 
     void Panel::onRendererDrawD2d1Layer(Renderer* rndr)
+    {
+        applyPendingTheme();
+
+        auto statistics = Application::g_app->drawStatistics();
+        if (statistics)
+        {
+            statistics->enterLayer(typeid(*this).name(), DrawStatistics::now());
+        }
+        if (m_layerCache && m_layerCache->bitmap.bitmap)
+        {
+            // The offscreen rendering must be done in the layer pass, and
+            // the layers of the subtree must be ready before that.
+            if (m_layerCache->state.beginFrame())
+            {
+                drawD2d1LayerContent(rndr);
+
+                auto context = rndr->d2d1DeviceContext();
+
+                auto cacheDrawTrans = D2D1::Matrix3x2F::Translation
+                (
+                    -m_absoluteRect.left, -m_absoluteRect.top
+                );
+                m_layerCache->bitmap.beginDraw(context, cacheDrawTrans);
+                {
+                    drawD2d1ObjectContent(rndr);
+                }
+                m_layerCache->bitmap.endDraw(context);
+
+                m_layerCache->state.markRendered();
+            }
+        }
+        else drawD2d1LayerContent(rndr);
+
+        if (statistics) statistics->leave(DrawStatistics::now());
+    }
+
+    void Panel::onRendererDrawD2d1Object(Renderer* rndr)
+    {
+        applyPendingTheme();
+
+        auto statistics = Application::g_app->drawStatistics();
+        if (statistics)
+        {
+            auto& rect = m_absoluteRect;
+            statistics->enterObject(
+                typeid(*this).name(),
+                { rect.left, rect.top, rect.right, rect.bottom },
+                DrawStatistics::now());
+        }
+        if (m_layerCache && m_layerCache->state.isValid())
+        {
+            auto& cache = m_layerCache->bitmap;
+
+            rndr->d2d1DeviceContext()->DrawBitmap(
+                cache.bitmap.Get(), math_utils::roundf(m_absoluteRect),
+                cache.opacity, cache.getInterpolationMode());
+        }
+        else drawD2d1ObjectContent(rndr);
+
+        if (statistics) statistics->leave(DrawStatistics::now());
+    }
+
+    void Panel::drawD2d1LayerContent(Renderer* rndr)
     {
         if (f_onRendererDrawD2d1LayerBefore) f_onRendererDrawD2d1LayerBefore(this, rndr);
 
@@ -110,7 +216,7 @@ namespace d14engine::uikit
         if (f_onRendererDrawD2d1LayerAfter) f_onRendererDrawD2d1LayerAfter(this, rndr);
     }
 
-    void Panel::onRendererDrawD2d1Object(Renderer* rndr)
+    void Panel::drawD2d1ObjectContent(Renderer* rndr)
     {
         if (f_onRendererDrawD2d1ObjectBefore) f_onRendererDrawD2d1ObjectBefore(this, rndr);
 
@@ -163,6 +269,81 @@ namespace d14engine::uikit
         }
     }
 
+    size_t Panel::g_layerCacheCount = 0;
+
+    Panel::LayerCache::LayerCache()
+    {
+        ++g_layerCacheCount;
+    }
+
+    Panel::LayerCache::~LayerCache()
+    {
+        --g_layerCacheCount;
+    }
+
+    bool Panel::cacheAsBitmap() const
+    {
+        return m_layerCache != nullptr;
+    }
+
+    void Panel::setCacheAsBitmap(bool value)
+    {
+        if (value == cacheAsBitmap()) return;
+
+        if (value)
+        {
+            m_layerCache = std::make_unique<LayerCache>();
+            loadLayerCacheBitmap();
+        }
+        else m_layerCache.reset();
+
+        // Switching between the cached and direct drawing changes nothing
+        // visually, but the ancestors may have cached the old bitmap.
+        invalidateAncestorLayerCaches();
+    }
+
+    void Panel::invalidateLayerCaches()
+    {
+        if (g_layerCacheCount == 0) return;
+
+        uikit::invalidateLayerCaches(this, true,
+            [](Panel* node) { return node->m_parent.lock().get(); },
+            [](Panel* node) { return node->m_layerCache ? &node->m_layerCache->state : nullptr; });
+    }
+
+    void Panel::invalidateAncestorLayerCaches()
+    {
+        if (g_layerCacheCount == 0) return;
+
+        uikit::invalidateLayerCaches(this, false,
+            [](Panel* node) { return node->m_parent.lock().get(); },
+            [](Panel* node) { return node->m_layerCache ? &node->m_layerCache->state : nullptr; });
+    }
+
+    const LayerCacheState* Panel::layerCacheState() const
+    {
+        return m_layerCache ? &m_layerCache->state : nullptr;
+    }
+
+    void Panel::loadLayerCacheBitmap()
+    {
+        if (!m_layerCache) return;
+
+        auto size = math_utils::roundu(this->size());
+        auto pixelSize = platform_utils::scaledByDpi(SIZE{ (LONG)size.width, (LONG)size.height });
+
+        auto maxSize = (LONG)Application::g_app->dxRenderer()->d2d1DeviceContext()->GetMaximumBitmapSize();
+
+        if (pixelSize.cx > 0 && pixelSize.cy > 0 &&
+            pixelSize.cx <= maxSize && pixelSize.cy <= maxSize)
+        {
+            m_layerCache->bitmap.loadBitmap(size);
+        }
+        else m_layerCache->bitmap.bitmap.Reset();
+
+        m_layerCache->state.invalidate();
+    }
+
     void Panel::ApplicationEventReactability::setFlag(bool value)
     {
         ApplicationEventGroup::setFlag(value);
@@ -179,6 +360,21 @@ namespace d14engine::uikit
         else return isHitHelper(p);
     }
 
+    Optional<D2D1_RECT_F> Panel::hitTestBounds() const
+    {
+        if (f_isHit) return std::nullopt;
+        else return hitTestBoundsHelper();
+    }
+
+    Optional<HitTestCache::Rect> Panel::hitTestCacheBounds() const
+    {
+        if (auto bounds = hitTestBounds())
+        {
+            return HitTestCache::Rect{ bounds->left, bounds->top, bounds->right, bounds->bottom };
+        }
+        else return std::nullopt;
+    }
+
     float Panel::minimalWidth() const
     {
         return minimalWidthHint.has_value() ? minimalWidthHint.value() : 0.0f;
@@ -214,6 +410,10 @@ namespace d14engine::uikit
         onSizeHelper(e);
 
         if (f_onSize) f_onSize(this, e);
+
+        if (m_layerCache) loadLayerCacheBitmap();
+
+        invalidateLayerCaches();
     }
 
     void Panel::onParentSize(SizeEvent& e)
@@ -239,9 +439,17 @@ namespace d14engine::uikit
 
     void Panel::onChangeTheme(WstrParam themeName)
     {
+        m_themeGeneration = Application::g_app->themeGeneration();
+
+        // The hit region may depend on the appearance (e.g. the extension
+        // of the sizing frame of a resizable panel).
+        HitTestCache::invalidateAll();
+
         onChangeThemeHelper(themeName);
 
         if (f_onChangeTheme) f_onChangeTheme(this, themeName);
+
+        invalidateLayerCaches();
     }
 
     void Panel::onChangeLangLocale(WstrParam langLocaleName)
@@ -256,6 +464,8 @@ namespace d14engine::uikit
         onGetFocusHelper();
 
         if (f_onGetFocus) f_onGetFocus(this);
+
+        invalidateLayerCaches();
     }
 
     void Panel::onLoseFocus()
@@ -263,12 +473,13 @@ namespace d14engine::uikit
         onLoseFocusHelper();
 
         if (f_onLoseFocus) f_onLoseFocus(this);
+
+        invalidateLayerCaches();
     }
 
     bool Panel::isFocused() const
     {
-        return cpp_lang_utils::isMostDerivedEqual(
-            Application::g_app->currFocusedUIObject().lock(), shared_from_this());
+        return isSameUIObject(Application::g_app->currFocusedUIObject().lock().get(), this);
     }
 
     void Panel::onMouseEnter(MouseMoveEvent& e)
@@ -276,6 +487,8 @@ namespace d14engine::uikit
         onMouseEnterHelper(e);
 
         if (f_onMouseEnter) f_onMouseEnter(this, e);
+
+        invalidateLayerCaches();
     }
 
     void Panel::onMouseMove(MouseMoveEvent& e)
@@ -283,6 +496,14 @@ namespace d14engine::uikit
         onMouseMoveHelper(e);
 
         if (f_onMouseMove) f_onMouseMove(this, e);
+
+        // Hovering alone changes nothing except entering/leaving (e.g. the
+        // hover states of the children), while dragging usually does.
+        auto& buttons = e.buttonState;
+        if (buttons.leftPressed || buttons.rightPressed || buttons.middlePressed)
+        {
+            invalidateLayerCaches();
+        }
     }
 
     void Panel::onMouseLeave(MouseMoveEvent& e)
@@ -290,6 +511,8 @@ namespace d14engine::uikit
         onMouseLeaveHelper(e);
 
         if (f_onMouseLeave) f_onMouseLeave(this, e);
+
+        invalidateLayerCaches();
     }
 
     void Panel::onMouseButton(MouseButtonEvent& e)
@@ -297,6 +520,8 @@ namespace d14engine::uikit
         onMouseButtonHelper(e);
 
         if (f_onMouseButton) f_onMouseButton(this, e);
+
+        invalidateLayerCaches();
     }
 
     void Panel::onMouseWheel(MouseWheelEvent& e)
@@ -311,6 +536,8 @@ namespace d14engine::uikit
         onKeyboardHelper(e);
 
         if (f_onKeyboard) f_onKeyboard(this, e);
+
+        invalidateLayerCaches();
     }
 
     bool Panel::isHitHelper(const Event::Point& p) const
@@ -318,6 +545,11 @@ namespace d14engine::uikit
         return math_utils::isOverlapped(p, m_absoluteRect);
     }
 
+    D2D1_RECT_F Panel::hitTestBoundsHelper() const
+    {
+        return m_absoluteRect;
+    }
+
     bool Panel::destroyUIObjectHelper(ShrdPtrParam<Panel> uiobj)
     {
         removeUIObject(uiobj);
@@ -361,7 +593,12 @@ namespace d14engine::uikit
 
     void Panel::onChangeThemeHelper(WstrParam themeName)
     {
-        if (m_skipChangeChildrenThemes) return;
+        if (m_skipChangeChildrenThemes)
+        {
+            skipChildrenPendingThemes();
+            return;
+        }
+        if (m_isApplyingPendingTheme) return;
 
         for (auto& child : m_children)
         {
@@ -369,6 +606,34 @@ namespace d14engine::uikit
         }
     }
 
+    void Panel::applyPendingTheme()
+    {
+        auto app = Application::g_app;
+
+        if (m_themeGeneration == app->themeGeneration()) return;
+
+        // The parentless objects that are not added to the application are
+        // drawn by their owners (e.g. the placeholder of a text input), who
+        // are responsible for updating their themes.
+        if (m_parent.expired() && !app->uiObjects().contains(shared_from_this()))
+        {
+            m_themeGeneration = app->themeGeneration();
+            return;
+        }
+        m_isApplyingPendingTheme = true;
+        onChangeTheme(app->currThemeName());
+        m_isApplyingPendingTheme = false;
+    }
+
+    void Panel::skipChildrenPendingThemes()
+    {
+        for (auto& child : m_children)
+        {
+            child->m_themeGeneration = Application::g_app->themeGeneration();
+            child->skipChildrenPendingThemes();
+        }
+    }
+
     void Panel::onChangeLangLocaleHelper(WstrParam langLocaleName)
     {
         if (m_skipChangeChildrenLangLocale) return;
@@ -403,13 +668,28 @@ namespace d14engine::uikit
         }
         ChildObjectTempSet currHitChildren = {};
 
-        if (!m_skipUpdateChildrenHitStatesInMouseMoveEvent)
+        HitTestCache::Point cachePoint = { e.cursorPoint.x, e.cursorPoint.y };
+
+        if (m_skipUpdateChildrenHitStatesInMouseMoveEvent)
         {
+            m_hitChildrenCache.invalidate();
+        }
+        else if (m_hitChildrenCache.isValid(cachePoint))
+        {
+            currHitChildren = m_hitChildren;
+        }
+        else // hit-test the children again
+        {
+            m_hitChildrenCache.begin(cachePoint);
+
             for (auto& child : m_children)
             {
-                if (child->appEventReactability.hitTest && child->isHit(e.cursorPoint))
+                if (child->appEventReactability.hitTest)
                 {
-                    currHitChildren.insert(child);
+                    bool isHit = child->isHit(e.cursorPoint);
+                    if (isHit) currHitChildren.insert(child);
+
+                    m_hitChildrenCache.update(cachePoint, child->hitTestCacheBounds(), isHit);
                 }
             }
         }
@@ -424,7 +704,7 @@ namespace d14engine::uikit
             {
                 leaveCandidate = *m_hitChildren.begin();
             }
-            if (!cpp_lang_utils::isMostDerivedEqual(enterCandidate.lock(), leaveCandidate.lock()))
+            if (!isSameUIObject(enterCandidate.lock(), leaveCandidate.lock()))
             {
                 if (!enterCandidate.expired())
                 {
@@ -508,6 +788,7 @@ namespace d14engine::uikit
                 return child->appEventTransparency.mouse.leave;
             });
             m_hitChildren.clear();
+            m_hitChildrenCache.invalidate();
         }
         else onMouseMoveHelper(e); // use mouse-move to simulate mouse-leave
     }
@@ -725,9 +1006,11 @@ namespace d14engine::uikit
         }
         if (bitmap)
         {
-            rndr->d2d1DeviceContext()->DrawBitmap( // round to fit pixel size
-                bitmap.Get(), math_utils::roundf(m_absoluteRect),
-                bitmapOpacity, BitmapObject::g_interpolationMode);
+            auto rect = math_utils::roundf(m_absoluteRect); // round to fit pixel size
+
+            rndr->d2d1DeviceContext()->DrawBitmap(
+                bitmap_utils::pickMipLevel(bitmap.Get(), bitmapMipLevels, math_utils::size(rect)),
+                rect, bitmapOpacity, BitmapObject::g_interpolationMode);
         }
     }
 
@@ -772,6 +1055,8 @@ namespace d14engine::uikit
         m_enabled = value;
 
         appEventReactability.setFlag(value);
+
+        HitTestCache::invalidateAll();
     }
 
     float Panel::width() const
@@ -908,6 +1193,9 @@ namespace d14engine::uikit
     {
         m_rect = math_utils::rect(point.x, point.y, width(), height());
         updateAbsoluteRect();
+
+        // The cached bitmap of this is only composited at the new position.
+        invalidateAncestorLayerCaches();
     }
 
     void Panel::move(float left, float top)
@@ -925,6 +1213,8 @@ namespace d14engine::uikit
         {
             m_rect = rect;
             updateAbsoluteRect();
+
+            invalidateAncestorLayerCaches();
         }
     }
 
@@ -935,6 +1225,7 @@ namespace d14engine::uikit
 
     void Panel::updateAbsoluteRect()
     {
+        auto originalRect = m_absoluteRect;
         auto originalSize = math_utils::size(m_absoluteRect);
         auto originalPosition = absolutePosition();
 
@@ -944,6 +1235,12 @@ namespace d14engine::uikit
         }
         else m_absoluteRect = m_rect;
 
+        if (originalRect.left != m_absoluteRect.left || originalRect.top != m_absoluteRect.top ||
+            originalRect.right != m_absoluteRect.right || originalRect.bottom != m_absoluteRect.bottom)
+        {
+            HitTestCache::invalidateAll();
+        }
+
         if (math_utils::round(originalSize.width) != math_utils::round(width()) ||
             math_utils::round(originalSize.height) != math_utils::round(height()))
         {
@@ -1036,7 +1333,7 @@ namespace d14engine::uikit
         if (!m_parent.expired())
         {
             auto pa = m_parent.lock();
-            if (!cpp_lang_utils::isMostDerivedEqual(pa, uiobj))
+            if (!isSameUIObject(pa, uiobj))
             {
                 // The ref-count of this may be 0 after removed from parent,
                 // so we must retain a temporary ptr to avoid sudden release.
@@ -1068,6 +1365,9 @@ namespace d14engine::uikit
         m_children.insert(uiobj);
         m_drawObjects2D.insert(uiobj);
 
+        HitTestCache::invalidateAll();
+        invalidateLayerCaches();
+
         m_topmostPriority.uiObject = std::min
         (
             m_topmostPriority.uiObject,
@@ -1094,6 +1394,9 @@ namespace d14engine::uikit
         }
         m_children.erase(uiobj);
         m_drawObjects2D.erase(uiobj);
+
+        HitTestCache::invalidateAll();
+        invalidateLayerCaches();
     }
 
     void Panel::pinUIObject(ShrdPtrParam<Panel> uiobj)
@@ -1120,6 +1423,9 @@ namespace d14engine::uikit
         }
         m_children.clear();
         m_drawObjects2D.clear();
+
+        HitTestCache::invalidateAll();
+        invalidateLayerCaches();
     }
 
     void Panel::clearPinnedUIObjects()
@@ -2,13 +2,22 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
+
 #include "Renderer/Interfaces/IDrawObject2D.h"
 #include "Renderer/Renderer.h"
 
+#include "UIKit/BitmapUtils.h"
 #include "UIKit/Event.h"
+#include "UIKit/HitTestCache.h"
+#include "UIKit/LayerCache.h"
+#include "UIKit/MaskStyle.h"
+#include "UIKit/ObjectIdentity.h"
 
 namespace d14engine::uikit
 {
+    struct TextInputObject;
+
     template<typename T = Panel>
     SharedPtr<T> nullUIObj() { return nullptr; }
 
@@ -16,6 +25,7 @@ namespace d14engine::uikit
     SharedPtr<T> makeUIObject(Types&& ...args)
     {
         auto uiobj = std::make_shared<T>(args...);
+        uiobj->initializeIdentity(uiobj.get());
         uiobj->onInitializeFinish();
         return uiobj;
     }
@@ -60,6 +70,9 @@ namespace d14engine::uikit
     {
         friend struct Application;
 
+        template<typename T, typename... Types>
+        friend SharedPtr<T> makeUIObject(Types&& ...args);
+
         Panel(
             const D2D1_RECT_F& rect = {},
             ComPtrParam<ID2D1Brush> brush = nullptr,
@@ -73,11 +86,30 @@ namespace d14engine::uikit
 
         bool destroy();
 
-        Function<void(Panel*)> f_onDestroy = {};
+        cpp_lang_utils::LazyFunction<void(Panel*)> f_onDestroy = {};
 
         bool destroyUIObject(ShrdPtrParam<Panel> uiobj);
 
-        Function<bool(Panel*, ShrdPtrParam<Panel>)> f_destroyUIObject = {};
+        cpp_lang_utils::LazyFunction<bool(Panel*, ShrdPtrParam<Panel>)> f_destroyUIObject = {};
+
+    protected:
+        // makeUIObject knows the most-derived type, so the results of the
+        // dynamic casts are cached there, which lets the hot paths (e.g. the
+        // enter/leave comparison in every mouse-move) avoid RTTI entirely.
+        ObjectIdentity<TextInputObject> m_identity = {};
+
+        template<typename T>
+        void initializeIdentity(T* self)
+        {
+            m_identity = ObjectIdentity<TextInputObject>::make(self);
+        }
+
+    public:
+        // The address of the most-derived object.
+        const void* identity() const;
+
+        // Returns nullptr if the UI object is not a text input object.
+        TextInputObject* textInputObject() const;
 
     public:
         bool isD2d1ObjectVisible() const override;
@@ -86,19 +118,19 @@ namespace d14engine::uikit
 
         void onRendererUpdateObject2D(renderer::Renderer* rndr) override;
 
-        Function<void(Panel*, renderer::Renderer*)>
+        cpp_lang_utils::LazyFunction<void(Panel*, renderer::Renderer*)>
             f_onRendererUpdateObject2DBefore = {},
             f_onRendererUpdateObject2DAfter = {};
 
         void onRendererDrawD2d1Layer(renderer::Renderer* rndr) override;
 
-        Function<void(Panel*, renderer::Renderer*)>
+        cpp_lang_utils::LazyFunction<void(Panel*, renderer::Renderer*)>
             f_onRendererDrawD2d1LayerBefore = {},
             f_onRendererDrawD2d1LayerAfter = {};
 
         void onRendererDrawD2d1Object(renderer::Renderer* rndr) override;
 
-        Function<void(Panel*, renderer::Renderer*)>
+        cpp_lang_utils::LazyFunction<void(Panel*, renderer::Renderer*)>
             f_onRendererDrawD2d1ObjectBefore = {},
             f_onRendererDrawD2d1ObjectAfter = {};
 
@@ -121,6 +153,55 @@ namespace d14engine::uikit
         void increaseAnimationCount();
         void decreaseAnimationCount();
 
+    public:
+        // Renders the subtree into a retained bitmap once and composites the
+        // bitmap in the following frames until something in the subtree
+        // changes, which suits a complex but static subtree (e.g. a settings
+        // page in a scroll view).  Moving the panel itself only composites
+        // the bitmap at the new position, so scrolling costs nothing.
+        //
+        // The cache is invalidated when anything in the subtree changes its
+        // geometry/visibility/children/theme, plays an animation or receives
+        // a UI event (except mouse-wheel and mouse-move without any pressed
+        // button), and invalidateLayerCaches must be called for the other
+        // changes (e.g. setting the text of a label in a timer callback).
+        //
+        // The subtree is clipped to the rect of the panel, and the text in it
+        // is antialiased in grayscale since the bitmap is transparent.
+        bool cacheAsBitmap() const;
+        void setCacheAsBitmap(bool value);
+
+        // Invalidates the caches of this and its ancestors.
+        void invalidateLayerCaches();
+
+        // Returns nullptr if not caching.
+        const LayerCacheState* layerCacheState() const;
+
+    protected:
+        struct LayerCache
+        {
+            LayerCache();
+            ~LayerCache();
+
+            LayerCacheState state = {};
+
+            // Null if the panel is empty or larger than the maximum bitmap
+            // size, in which case the subtree is drawn directly.
+            MaskStyle bitmap = {};
+        };
+        UniquePtr<LayerCache> m_layerCache = {};
+
+        // The number of the panels that cache, so the invalidation walks
+        // are skipped when nobody caches.
+        static size_t g_layerCacheCount;
+
+        void invalidateAncestorLayerCaches();
+
+        void loadLayerCacheBitmap();
+
+        void drawD2d1LayerContent(renderer::Renderer* rndr);
+        void drawD2d1ObjectContent(renderer::Renderer* rndr);
+
     public:
         template<bool presetBoolean>
         struct ApplicationEventGroup
@@ -177,7 +258,19 @@ namespace d14engine::uikit
     public:
         bool isHit(const Event::Point& p) const;
 
-        Function<bool(const Panel*, const Event::Point&)> f_isHit = {};
+        cpp_lang_utils::LazyFunction<bool(const Panel*, const Event::Point&)> f_isHit = {};
+
+        // The rect that contains the hit region, which is used to decide how
+        // far the cursor can move without changing the hit states, or empty
+        // if the hit region is unknown (i.e. f_isHit is set).
+        //
+        // Remember to call HitTestCache::invalidateAll after changing the
+        // hit region without moving/resizing the panel, e.g. assigning
+        // appEventReactability.hitTest or the resizable flags directly.
+        Optional<D2D1_RECT_F> hitTestBounds() const;
+
+        // The same as hitTestBounds, but converted for HitTestCache.
+        Optional<HitTestCache::Rect> hitTestCacheBounds() const;
 
         // The derived class can choose whether to prevent the user-defined
         // minimal/maximal hints from working by overriding these series of
@@ -204,68 +297,72 @@ namespace d14engine::uikit
 
         void onSize(SizeEvent& e);
 
-        Function<void(Panel*, SizeEvent&)> f_onSize = {};
+        cpp_lang_utils::LazyFunction<void(Panel*, SizeEvent&)> f_onSize = {};
 
         void onParentSize(SizeEvent& e);
 
-        Function<void(Panel*, SizeEvent&)> f_onParentSize = {};
+        cpp_lang_utils::LazyFunction<void(Panel*, SizeEvent&)> f_onParentSize = {};
 
         void onMove(MoveEvent& e);
 
-        Function<void(Panel*, MoveEvent&)> f_onMove = {};
+        cpp_lang_utils::LazyFunction<void(Panel*, MoveEvent&)> f_onMove = {};
 
         void onParentMove(MoveEvent& e);
 
-        Function<void(Panel*, MoveEvent&)> f_onParentMove = {};
+        cpp_lang_utils::LazyFunction<void(Panel*, MoveEvent&)> f_onParentMove = {};
 
         void onChangeTheme(WstrParam themeName);
 
-        Function<void(Panel*, WstrParam)> f_onChangeTheme = {};
+        cpp_lang_utils::LazyFunction<void(Panel*, WstrParam)> f_onChangeTheme = {};
 
         void onChangeLangLocale(WstrParam langLocaleName);
 
-        Function<void(Panel*, WstrParam)> f_onChangeLangLocale = {};
+        cpp_lang_utils::LazyFunction<void(Panel*, WstrParam)> f_onChangeLangLocale = {};
 
         void onGetFocus();
 
-        Function<void(Panel*)> f_onGetFocus = {};
+        cpp_lang_utils::LazyFunction<void(Panel*)> f_onGetFocus = {};
 
         void onLoseFocus();
 
-        Function<void(Panel*)> f_onLoseFocus = {};
+        cpp_lang_utils::LazyFunction<void(Panel*)> f_onLoseFocus = {};
 
         bool isFocused() const;
         bool forceGlobalExclusiveFocusing = false;
 
         void onMouseEnter(MouseMoveEvent& e);
 
-        Function<void(Panel*, MouseMoveEvent&)> f_onMouseEnter = {};
+        cpp_lang_utils::LazyFunction<void(Panel*, MouseMoveEvent&)> f_onMouseEnter = {};
 
         void onMouseMove(MouseMoveEvent& e);
 
-        Function<void(Panel*, MouseMoveEvent&)> f_onMouseMove = {};
+        cpp_lang_utils::LazyFunction<void(Panel*, MouseMoveEvent&)> f_onMouseMove = {};
 
         void onMouseLeave(MouseMoveEvent& e);
 
-        Function<void(Panel*, MouseMoveEvent&)> f_onMouseLeave = {};
+        cpp_lang_utils::LazyFunction<void(Panel*, MouseMoveEvent&)> f_onMouseLeave = {};
 
         bool forceSingleMouseEnterLeaveEvent = true;
         bool forceTriggerChildrenMouseLeaveEvents = true;
 
         void onMouseButton(MouseButtonEvent& e);
 
-        Function<void(Panel*, MouseButtonEvent&)> f_onMouseButton = {};
+        cpp_lang_utils::LazyFunction<void(Panel*, MouseButtonEvent&)> f_onMouseButton = {};
 
         void onMouseWheel(MouseWheelEvent& e);
 
-        Function<void(Panel*, MouseWheelEvent&)> f_onMouseWheel = {};
+        cpp_lang_utils::LazyFunction<void(Panel*, MouseWheelEvent&)> f_onMouseWheel = {};
 
         void onKeyboard(KeyboardEvent& e);
 
-        Function<void(Panel*, KeyboardEvent&)> f_onKeyboard = {};
+        cpp_lang_utils::LazyFunction<void(Panel*, KeyboardEvent&)> f_onKeyboard = {};
 
     protected:
         virtual bool isHitHelper(const Event::Point& p) const;
+
+        // Must be overridden together with isHitHelper, and the hit region
+        // must be inside the returned rect (the edges can be excluded).
+        virtual D2D1_RECT_F hitTestBoundsHelper() const;
         virtual bool destroyUIObjectHelper(ShrdPtrParam<Panel> uiobj);
 
         // Introduce onXxxHelper to solve the inheritance conflicts of
@@ -298,6 +395,24 @@ namespace d14engine::uikit
 
         bool m_skipChangeChildrenThemes = false;
         bool m_skipChangeChildrenLangLocale = false;
+
+        // The theme is applied lazily: Application::changeTheme only bumps
+        // the theme generation, and each UI object catches up before it is
+        // drawn next time, so the invisible ones (e.g. the items scrolled
+        // out of a list view) cost nothing until they are shown again.
+
+        UINT64 m_themeGeneration = 0;
+
+        // Only apply the theme of this, since the visible children will
+        // catch up by themselves when they are drawn.
+        bool m_isApplyingPendingTheme = false;
+
+        void applyPendingTheme();
+
+        // Called when m_skipChangeChildrenThemes is set, so the children
+        // managed by this will not catch up by themselves later.
+        void skipChildrenPendingThemes();
+
         bool m_skipDeliverNextMouseMoveEventToChildren = false;
         bool m_skipUpdateChildrenHitStatesInMouseMoveEvent = false;
 
@@ -332,6 +447,9 @@ namespace d14engine::uikit
         ComPtr<ID2D1Bitmap1> bitmap = {};
         float bitmapOpacity = 1.0f;
 
+        // Optional, drawn instead of bitmap when the panel is much smaller.
+        bitmap_utils::MipLevels bitmapMipLevels = {};
+
         float roundRadiusX = 0.0f, roundRadiusY = 0.0f;
 
     protected:
@@ -423,6 +541,10 @@ namespace d14engine::uikit
 
         ChildObjectTempSet m_hitChildren = {};
 
+        // Reused by the mouse-move events as long as the cursor stays in the
+        // stability rect and nothing has changed in the UI object tree.
+        HitTestCache m_hitChildrenCache = {};
+
         ChildObjectTempSet m_pinnedChildren = {}, m_diffPinnedChildren = {};
 
     public:
@@ -453,4 +575,14 @@ namespace d14engine::uikit
         void updateDiffPinnedUIObjects();
         void updateDiffPinnedUIObjectsLater();  
     };
+
+    // Like cpp_lang_utils::isMostDerivedEqual (2 empty objects are equal),
+    // but compares the identities cached by makeUIObject instead of casting.
+    bool isSameUIObject(const Panel* lhs, const Panel* rhs);
+
+    template<typename T, typename U>
+    bool isSameUIObject(ShrdPtrParam<T> lhs, ShrdPtrParam<U> rhs)
+    {
+        return isSameUIObject(lhs.get(), rhs.get());
+    }
 }
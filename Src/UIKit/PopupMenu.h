@@ -2,6 +2,8 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
+
 #include "UIKit/Appearances/PopupMenu.h"
 #include "UIKit/MenuItem.h"
 #include "UIKit/ShadowStyle.h"
@@ -28,13 +30,13 @@ namespace d14engine::uikit
     public:
         void onChangeActivity(bool value);
 
-        Function<void(PopupMenu*, bool)> f_onChangeActivity = {};
+        cpp_lang_utils::LazyFunction<void(PopupMenu*, bool)> f_onChangeActivity = {};
 
         using WaterfallView::ItemIndexParam;
 
         void onTriggerMenuItem(ItemIndexParam itemIndex);
 
-        Function<void(PopupMenu*, ItemIndexParam)> f_onTriggerMenuItem = {};
+        cpp_lang_utils::LazyFunction<void(PopupMenu*, ItemIndexParam)> f_onTriggerMenuItem = {};
 
     protected:
         virtual void onChangeActivityHelper(bool value);
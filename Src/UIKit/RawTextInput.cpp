@@ -3,6 +3,7 @@
 #include "UIKit/RawTextInput.h"
 
 #include "Common/DirectXError.h"
+#include "Common/MathUtils/2D.h"
 #include "Common/MathUtils/Basic.h"
 
 #include "UIKit/Application.h"
@@ -236,8 +237,76 @@ namespace d14engine::uikit
         onTextChange(m_text);
     }
 
+    void RawTextInput::moveIndicatorByLines(ptrdiff_t count)
+    {
+        UINT32 lineCount = 0;
+        m_textLayout->GetLineMetrics(nullptr, 0, &lineCount);
+        if (lineCount == 0) return;
+
+        std::vector<DWRITE_LINE_METRICS> lines(lineCount);
+        THROW_IF_FAILED(m_textLayout->GetLineMetrics(lines.data(), lineCount, &lineCount));
+
+        auto caret = hitTestTextPos((UINT32)m_indicatorCharacterOffset, false);
+
+        // Find the visual line of the caret by its vertical center, since
+        // the offset at a soft line break is shared by the adjacent lines.
+        float caretCenterY = caret.pointY + caret.metrics.height * 0.5f;
+
+        std::vector<float> lineTops(lineCount);
+        size_t currLine = 0;
+
+        float top = 0.0f;
+        for (UINT32 i = 0; i < lineCount; ++i)
+        {
+            lineTops[i] = top;
+            top += lines[i].height;
+
+            if (caretCenterY >= top) currLine = i + 1;
+        }
+        currLine = std::min(currLine, (size_t)lineCount - 1);
+
+        auto targetLine = (size_t)std::clamp(
+            (ptrdiff_t)currLine + count, (ptrdiff_t)0, (ptrdiff_t)lineCount - 1);
+
+        if (targetLine == currLine) return;
+
+        auto result = hitTestPoint(caret.pointX, lineTops[targetLine] + lines[targetLine].height * 0.5f);
+
+        auto offset = (size_t)result.metrics.textPosition;
+        if (result.isTrailingHit) ++offset;
+
+        // Stay on the target line, i.e. before its '\n' or, for a soft
+        // line break, before the start of the next line.
+        size_t lineStart = 0;
+        for (size_t i = 0; i < targetLine; ++i) lineStart += lines[i].length;
+
+        auto& line = lines[targetLine];
+        if (targetLine + 1 < lineCount && line.length > 0)
+        {
+            size_t lineEnd = lineStart + line.length - std::max(line.newlineLength, 1u);
+            offset = std::min(offset, lineEnd);
+        }
+        setIndicatorPosition(offset);
+    }
+
+    size_t RawTextInput::visibleLineCount() const
+    {
+        // The indicator is as high as the line it is in.
+        float lineHeight = m_indicatorGeometry.second.y - m_indicatorGeometry.first.y;
+        if (lineHeight <= 0.0f) return 1;
+
+        auto count = (size_t)(math_utils::height(m_visibleTextRect) / lineHeight);
+        return std::max(count, (size_t)1);
+    }
+
     void RawTextInput::onRendererDrawD2d1LayerHelper(Renderer* rndr)
     {
+        // The placeholder is drawn into the mask below, so its own layer
+        // (e.g. the text raster cache) must be ready before that.
+        if (m_placeholder->isD2d1ObjectVisible() && m_text.empty())
+        {
+            m_placeholder->onRendererDrawD2d1Layer(rndr);
+        }
         // Rendering ClearType text requires an opaque background, while the
         // other modes (e.g. Grayscale) do not.  The texts will be rendered
         // to m_visibleTextMask at first, so their background must be opaque
@@ -407,6 +476,26 @@ namespace d14engine::uikit
                 setIndicatorPosition(0);
                 break;
             }
+            case VK_UP:
+            case VK_DOWN:
+            case VK_PRIOR:
+            case VK_NEXT:
+            {
+                if (multiline)
+                {
+                    setHiliteRange({ 0, 0 });
+
+                    auto count = (ptrdiff_t)1;
+                    if (e.vkey == VK_PRIOR || e.vkey == VK_NEXT)
+                    {
+                        count = (ptrdiff_t)visibleLineCount();
+                    }
+                    if (e.vkey == VK_UP || e.vkey == VK_PRIOR) count = -count;
+
+                    moveIndicatorByLines(count);
+                }
+                break;
+            }
             case VK_LEFT:
             {
                 if (m_hiliteRange.count == 0)
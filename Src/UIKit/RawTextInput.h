@@ -2,6 +2,8 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
+
 #include "UIKit/Appearances/RawTextInput.h"
 #include "UIKit/LabelArea.h"
 #include "UIKit/MaskStyle.h"
@@ -22,7 +24,7 @@ namespace d14engine::uikit
     public:
         void onTextContentOffsetChange(const D2D1_POINT_2F& offset);
 
-        Function<void(RawTextInput*, const D2D1_POINT_2F&)> f_onTextContentOffsetChange = {};
+        cpp_lang_utils::LazyFunction<void(RawTextInput*, const D2D1_POINT_2F&)> f_onTextContentOffsetChange = {};
 
     protected:
         virtual void onTextContentOffsetChangeHelper(const D2D1_POINT_2F& offset);
@@ -75,6 +77,14 @@ namespace d14engine::uikit
     public:
         void changeCandidateText(WstrParam str);
 
+    protected:
+        // Moves by the visual lines of the text layout (i.e. with the word
+        // wrapping), where the caret keeps its x on the target line.
+        void moveIndicatorByLines(ptrdiff_t count);
+
+        // The lines shown in the visible text rect for Page Up/Down.
+        size_t visibleLineCount() const;
+
     protected:
         // IDrawObject2D
         void onRendererDrawD2d1LayerHelper(renderer::Renderer* rndr) override;
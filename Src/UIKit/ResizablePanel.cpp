@@ -87,6 +87,8 @@ namespace d14engine::uikit
     void ResizablePanel::setResizable(bool value)
     {
         isLeftResizable = isTopResizable = isRightResizable = isBottomResizable = value;
+
+        HitTestCache::invalidateAll();
     }
 
     bool ResizablePanel::isSizing() const
@@ -186,6 +188,11 @@ namespace d14engine::uikit
         return math_utils::isOverlapped(p, sizingFrameExtendedRect(m_absoluteRect));
     }
 
+    D2D1_RECT_F ResizablePanel::hitTestBoundsHelper() const
+    {
+        return sizingFrameExtendedRect(m_absoluteRect);
+    }
+
     void ResizablePanel::onChangeThemeHelper(WstrParam themeName)
     {
         Panel::onChangeThemeHelper(themeName);
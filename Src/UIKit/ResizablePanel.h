@@ -2,6 +2,8 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
+
 #include "UIKit/Appearances/ResizablePanel.h"
 #include "UIKit/Panel.h"
 
@@ -31,11 +33,11 @@ namespace d14engine::uikit
     public:
         void onStartResizing();
 
-        Function<void(ResizablePanel*)> f_onStartResizing = {};
+        cpp_lang_utils::LazyFunction<void(ResizablePanel*)> f_onStartResizing = {};
 
         void onEndResizing();
 
-        Function<void(ResizablePanel*)> f_onEndResizing = {};
+        cpp_lang_utils::LazyFunction<void(ResizablePanel*)> f_onEndResizing = {};
 
     protected:
         virtual void onStartResizingHelper();
@@ -91,6 +93,7 @@ namespace d14engine::uikit
 
         // Panel
         bool isHitHelper(const Event::Point& p) const override;
+        D2D1_RECT_F hitTestBoundsHelper() const override;
 
         void onChangeThemeHelper(WstrParam themeName) override;
         void onChangeThemeWrapper(WstrParam themeName);
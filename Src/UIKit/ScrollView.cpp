@@ -6,6 +6,7 @@
 #include "Common/MathUtils/2D.h"
 
 #include "Renderer/Renderer.h"
+#include "Renderer/TickTimer.h"
 
 #include "UIKit/Application.h"
 #include "UIKit/ResourceUtils.h"
@@ -37,6 +38,20 @@ namespace d14engine::uikit
         if (m_content) m_content->move(0, 0);
     }
 
+    void ScrollView::setD2d1ObjectVisible(bool value)
+    {
+        ResizablePanel::setD2d1ObjectVisible(value);
+
+        if (!value) stopKineticScrolling();
+    }
+
+    void ScrollView::setEnabled(bool value)
+    {
+        ResizablePanel::setEnabled(value);
+
+        if (!value) stopKineticScrolling();
+    }
+
     void ScrollView::onStartThumbScrolling(const D2D1_POINT_2F& offset)
     {
         onStartThumbScrollingHelper(offset);
@@ -167,6 +182,65 @@ namespace d14engine::uikit
         m_viewportOffset = validateViewportOffset(offset);
     }
 
+    void ScrollView::flingViewport(const D2D1_POINT_2F& velocity)
+    {
+        syncKineticScrolling();
+
+        kineticScrolling.horz.fling(velocity.x);
+        kineticScrolling.vert.fling(velocity.y);
+
+        startKineticScrolling();
+    }
+
+    void ScrollView::stopKineticScrolling()
+    {
+        if (m_isKineticScrolling)
+        {
+            m_isKineticScrolling = false;
+
+            kineticScrolling.horz.stop();
+            kineticScrolling.vert.stop();
+
+            decreaseAnimationCount();
+        }
+    }
+
+    void ScrollView::syncKineticScrolling()
+    {
+        auto maxOffset = validateViewportOffset({ FLT_MAX, FLT_MAX });
+
+        auto& horz = kineticScrolling.horz;
+        auto& vert = kineticScrolling.vert;
+
+        horz.setRange(0.0f, maxOffset.x);
+        vert.setRange(0.0f, maxOffset.y);
+
+        if (m_isKineticScrolling)
+        {
+            // Keep the motion going on from where the viewport was moved to
+            // (e.g. by scroll anchoring) instead of jumping back.
+            horz.translate(m_viewportOffset.x - m_kineticViewportOffset.x);
+            vert.translate(m_viewportOffset.y - m_kineticViewportOffset.y);
+        }
+        else // idle
+        {
+            horz.reset(m_viewportOffset.x);
+            vert.reset(m_viewportOffset.y);
+        }
+        m_kineticViewportOffset = m_viewportOffset;
+    }
+
+    void ScrollView::startKineticScrolling()
+    {
+        if (!m_isKineticScrolling &&
+            (kineticScrolling.horz.isMoving() || kineticScrolling.vert.isMoving()))
+        {
+            m_isKineticScrolling = true;
+
+            increaseAnimationCount();
+        }
+    }
+
     bool ScrollView::isControllingHorzBar() const
     {
         return m_isHorzBarHover || m_isHorzBarDown;
@@ -242,6 +316,38 @@ namespace d14engine::uikit
         else return math_utils::zeroRectF();
     }
 
+    void ScrollView::onRendererUpdateObject2DHelper(Renderer* rndr)
+    {
+        ResizablePanel::onRendererUpdateObject2DHelper(rndr);
+
+        if (m_isKineticScrolling)
+        {
+            syncKineticScrolling();
+
+            auto deltaSecs = (float)rndr->timer()->deltaSecs();
+
+            bool isHorzMoving = kineticScrolling.horz.advance(deltaSecs);
+            bool isVertMoving = kineticScrolling.vert.advance(deltaSecs);
+
+            // This is the only place where the kinetic scrolling changes
+            // the viewport, i.e. once per frame no matter how many wheel
+            // messages have been received.
+            setViewportOffset
+            ({
+                std::round(kineticScrolling.horz.position()),
+                std::round(kineticScrolling.vert.position())
+            });
+            m_kineticViewportOffset = m_viewportOffset;
+
+            // The content has moved under the cursor.
+            Application::g_app->sendNextImmediateMouseMoveEvent = true;
+            Application::g_app->postCustomWin32Message(
+                Application::CustomWin32Message::HandleImmediateMouseMoveEvent);
+
+            if (!isHorzMoving && !isVertMoving) stopKineticScrolling();
+        }
+    }
+
     void ScrollView::onRendererDrawD2d1LayerHelper(Renderer* rndr)
     {
         if (m_content && m_content->isD2d1ObjectVisible())
@@ -388,6 +494,8 @@ namespace d14engine::uikit
             }
         }
         // Update scroll bar state.
+        bool isHorzBarHover = m_isHorzBarHover, isVertBarHover = m_isVertBarHover;
+
         if (isHorzBarEnabled)
         {
             auto hstate = m_isHorzBarHover ? ScrollBarState::Hover : ScrollBarState::Idle;
@@ -402,6 +510,10 @@ namespace d14engine::uikit
 
             m_isVertBarHover = math_utils::isOverlapped(p, vrect);
         }
+        if (isHorzBarHover != m_isHorzBarHover || isVertBarHover != m_isVertBarHover)
+        {
+            invalidateLayerCaches();
+        }
         m_skipUpdateChildrenHitStatesInMouseMoveEvent = isControllingScrollBars();
     }
 
@@ -434,6 +546,8 @@ namespace d14engine::uikit
             }
             if (isControllingScrollBars())
             {
+                stopKineticScrolling();
+
                 onStartThumbScrolling(m_viewportOffset);
             }
             m_horzBarHoldOffset = p.x;
@@ -457,16 +571,31 @@ namespace d14engine::uikit
     {
         ResizablePanel::onMouseWheelHelper(e);
 
-        D2D1_POINT_2F nextOffset = m_viewportOffset;
+        // Use the precise one to keep the touchpad scrolling that is less
+        // than a notch per message, which is truncated to 0 in deltaCount.
+        D2D1_POINT_2F delta = { 0.0f, 0.0f };
 
         if (e.keyState.SHIFT)
         {
-            nextOffset.x -= e.deltaCount * deltaPixelsPerScroll.horz;
+            delta.x = -e.preciseDeltaCount * deltaPixelsPerScroll.horz;
         }
-        else nextOffset.y -= e.deltaCount * deltaPixelsPerScroll.vert;
+        else delta.y = -e.preciseDeltaCount * deltaPixelsPerScroll.vert;
+
+        if (kineticScrolling.enabled)
+        {
+            syncKineticScrolling();
 
-        setViewportOffset(nextOffset);
+            if (delta.x != 0.0f) kineticScrolling.horz.scrollBy(delta.x);
+            if (delta.y != 0.0f) kineticScrolling.vert.scrollBy(delta.y);
 
-        Application::g_app->sendNextImmediateMouseMoveEvent = true;
+            // The viewport will be advanced in the next update pass.
+            startKineticScrolling();
+        }
+        else // scroll immediately
+        {
+            setViewportOffset(math_utils::offset(m_viewportOffset, delta));
+
+            Application::g_app->sendNextImmediateMouseMoveEvent = true;
+        }
     }
 }
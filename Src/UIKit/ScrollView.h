@@ -2,6 +2,9 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
+
+#include "UIKit/AnimationUtils/ScrollIntegrator.h"
 #include "UIKit/Appearances/ScrollView.h"
 #include "UIKit/MaskStyle.h"
 #include "UIKit/ResizablePanel.h"
@@ -15,6 +18,13 @@ namespace d14engine::uikit
 
         void onInitializeFinish() override;
 
+        // Both stop the kinetic scrolling, which would otherwise keep the
+        // animation running (and the frames coming) for a view that can no
+        // longer be seen or scrolled.
+        void setD2d1ObjectVisible(bool value) override;
+
+        void setEnabled(bool value) override;
+
         MaskStyle contentMask = {};
 
         _D14_SET_APPEARANCE_GETTER(ScrollView)
@@ -22,15 +32,15 @@ namespace d14engine::uikit
     public:
         void onStartThumbScrolling(const D2D1_POINT_2F& offset);
 
-        Function<void(ScrollView*, const D2D1_POINT_2F&)> f_onStartThumbScrolling = {};
+        cpp_lang_utils::LazyFunction<void(ScrollView*, const D2D1_POINT_2F&)> f_onStartThumbScrolling = {};
 
         void onEndThumbScrolling(const D2D1_POINT_2F& offset);
 
-        Function<void(ScrollView*, const D2D1_POINT_2F&)> f_onEndThumbScrolling = {};
+        cpp_lang_utils::LazyFunction<void(ScrollView*, const D2D1_POINT_2F&)> f_onEndThumbScrolling = {};
 
         void onViewportOffsetChange(const D2D1_POINT_2F& offset);
 
-        Function<void(ScrollView*, const D2D1_POINT_2F&)> f_onViewportOffsetChange = {};
+        cpp_lang_utils::LazyFunction<void(ScrollView*, const D2D1_POINT_2F&)> f_onViewportOffsetChange = {};
 
     protected:
         virtual void onStartThumbScrollingHelper(const D2D1_POINT_2F& offset);
@@ -55,6 +65,35 @@ namespace d14engine::uikit
         }
         deltaPixelsPerScroll = {};
 
+        // When enabled, the wheel input is accumulated into the integrators
+        // and the viewport is advanced once per frame with inertia, instead
+        // of jumping by deltaPixelsPerScroll for each wheel message.  Off by
+        // default to keep the wheel behavior of the existing views.
+        struct KineticScrolling
+        {
+            bool enabled = false;
+
+            animation_utils::ScrollIntegrator horz = {}, vert = {};
+        }
+        kineticScrolling = {};
+
+        // Starts an inertial motion (in pixels per second), e.g. after
+        // releasing a touch drag.
+        void flingViewport(const D2D1_POINT_2F& velocity);
+
+        void stopKineticScrolling();
+
+    protected:
+        bool m_isKineticScrolling = false;
+
+        // The offset applied by the integrators in the last frame, which
+        // tells how much the viewport has been moved by others since then.
+        D2D1_POINT_2F m_kineticViewportOffset = { 0.0f, 0.0f };
+
+        void syncKineticScrolling();
+
+        void startKineticScrolling();
+
     protected:
         D2D1_SIZE_F getSelfSize() const;
         D2D1_SIZE_F getContentSize() const;
@@ -111,6 +150,8 @@ namespace d14engine::uikit
         
     protected:
         // IDrawObject2D
+        void onRendererUpdateObject2DHelper(renderer::Renderer* rndr) override;
+
         void onRendererDrawD2d1LayerHelper(renderer::Renderer* rndr) override;
 
         void onRendererDrawD2d1ObjectHelper(renderer::Renderer* rndr) override;
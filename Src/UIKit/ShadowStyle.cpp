@@ -20,8 +20,8 @@ namespace d14engine::uikit
     {
         resource_utils::g_shadowEffect->SetInput(0, nullptr);
 
-        auto rndr = Application::g_app->dxRenderer();
-        rndr->beginGpuCommand();
+        // The previous bitmap might be still used by the frames in flight.
+        Application::g_app->dxRenderer()->deferRelease(bitmap);
 
         auto dipSize = SIZE{ (LONG)width, (LONG)height };
         auto pixSize = platform_utils::scaledByDpi(dipSize);
@@ -29,8 +29,6 @@ namespace d14engine::uikit
         bitmap = bitmap_utils::loadBitmap(
             (UINT)pixSize.cx, (UINT)pixSize.cy,
             nullptr, D2D1_BITMAP_OPTIONS_TARGET);
-
-        rndr->endGpuCommand();
     }
 
     void ShadowStyle::loadBitmap(const D2D1_SIZE_U& size)
@@ -46,6 +44,11 @@ namespace d14engine::uikit
         context->SetTarget(bitmap.Get());
 
         context->BeginDraw();
+
+        if (auto statistics = Application::g_app->drawStatistics())
+        {
+            statistics->addShadowPass();
+        }
         context->SetTransform(transform);
         context->Clear(D2D1::ColorF{ 0x000000, 0.0f });
     }
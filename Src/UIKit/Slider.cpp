@@ -292,6 +292,11 @@ namespace d14engine::uikit
         return math_utils::isOverlapped(p, thumbAreaExtendedRect(m_absoluteRect));
     }
 
+    D2D1_RECT_F Slider::hitTestBoundsHelper() const
+    {
+        return thumbAreaExtendedRect(m_absoluteRect);
+    }
+
     void Slider::onSizeHelper(SizeEvent& e)
     {
         Panel::onSizeHelper(e);
@@ -2,6 +2,7 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
 #include "Common/MathUtils/2D.h"
 
 #include "UIKit/Appearances/Slider.h"
@@ -36,11 +37,11 @@ namespace d14engine::uikit
     public:
         void onStartSliding(float value);
 
-        Function<void(Slider*, float)> f_onStartSliding = {};
+        cpp_lang_utils::LazyFunction<void(Slider*, float)> f_onStartSliding = {};
 
         void onEndSliding(float value);
 
-        Function<void(Slider*, float)> f_onEndSliding = {};
+        cpp_lang_utils::LazyFunction<void(Slider*, float)> f_onEndSliding = {};
 
     protected:
         void onStartSlidingHelper(float value);
@@ -91,6 +92,7 @@ namespace d14engine::uikit
 
         // Panel
         bool isHitHelper(const Event::Point& p) const override;
+        D2D1_RECT_F hitTestBoundsHelper() const override;
 
         void onSizeHelper(SizeEvent& e) override;
 
@@ -2,6 +2,7 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
 #include "Common/CppLangUtils/TypeTraits.h"
 
 namespace d14engine::uikit
@@ -23,7 +24,7 @@ namespace d14engine::uikit
             if (f_onStateChange) f_onStateChange(this, e);
         }
 
-        Function<void(StatefulObject*, StateChangeEvent_T&)> f_onStateChange = {};
+        cpp_lang_utils::LazyFunction<void(StatefulObject*, StateChangeEvent_T&)> f_onStateChange = {};
 
     protected:
         virtual void onStateChangeHelper(StateChangeEvent_T& e) { }
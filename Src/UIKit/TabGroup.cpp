@@ -4,6 +4,7 @@
 
 #include "Common/CppLangUtils/PointerEquality.h"
 #include "Common/DirectXError.h"
+#include "Common/RuntimeError.h"
 
 #include "UIKit/Application.h"
 #include "UIKit/Cursor.h"
@@ -154,7 +155,7 @@ namespace d14engine::uikit
         }
         else if (m_currActiveCardTabIndex.valid())
         {
-            m_currActiveCardTabIndex->content->setEnabled(false);
+            deactivateTab(*m_currActiveCardTabIndex);
             m_currActiveCardTabIndex.invalidate();
 
             updateCandidateTabInfo();
@@ -196,6 +197,17 @@ namespace d14engine::uikit
         tabItor->m_previewItem = makeUIObject<MenuItem>(nullUIObj());
         tabItor->m_previewItem->isInstant = false;
 
+        tabItor->m_lifecycleKey = m_nextTabLifecycleKey++;
+
+        auto& lifecycle = tabItor->lifecycle;
+        m_tabLifecyclePolicy.insert
+        (
+            tabItor->m_lifecycleKey,
+            estimateTabMemory(*tabItor),
+            lifecycle && lifecycle->f_suspend && lifecycle->f_resume,
+            lifecycle && lifecycle->f_serialize && lifecycle->f_deserialize
+        );
+
 #define UPDATE_TAB_INDEX(Tab_Index) \
 do { \
     if (Tab_Index.generalValid()) \
@@ -225,6 +237,8 @@ do { \
             tabItor->m_previewItem->setContent(tabItor->caption);
         }
         updatePreviewPanelItems();
+
+        trimInactiveTabs();
     }
 
     void TabGroup::removeTab(TabIndexParam tabIndex, size_t count)
@@ -239,6 +253,8 @@ do { \
             removeUIObject(tabItor->content);
             tabItor->m_previewItem->destroy();
 
+            m_tabLifecyclePolicy.erase(tabItor->m_lifecycleKey);
+
             tabItor->caption->m_parentTabGroup.reset();
 
             tabItor = m_tabs.erase(tabItor);
@@ -285,7 +301,7 @@ do { \
         {
             if (m_currActiveCardTabIndex.valid())
             {
-                m_currActiveCardTabIndex->content->setEnabled(false);
+                deactivateTab(*m_currActiveCardTabIndex);
             }
         }
         if (tabIndex >= m_candidateTabCount)
@@ -302,6 +318,14 @@ do { \
 
         if (m_candidateTabCount > 0)
         {
+            loadTab(*m_currActiveCardTabIndex);
+
+            auto key = m_currActiveCardTabIndex->m_lifecycleKey;
+
+            m_tabLifecyclePolicy.activate(key);
+            m_tabLifecyclePolicy.update(key, TabLifecyclePolicy::State::Active,
+                estimateTabMemory(*m_currActiveCardTabIndex));
+
             m_currActiveCardTabIndex->content->setEnabled(true);
         }
         else m_currActiveCardTabIndex.invalidate();
@@ -315,6 +339,8 @@ do { \
             onSelectedTabIndexChange(m_currActiveCardTabIndex);
         }
         updatePreviewPanelItems();
+
+        trimInactiveTabs();
     }
 
     void TabGroup::swapTab(TabIndexParam tabIndex1, TabIndexParam tabIndex2)
@@ -540,6 +566,96 @@ do { \
             math_utils::rightTop(cardBarAbsoluteRect()), setting.offset), setting.size);
     }
 
+    size_t TabGroup::estimateTabMemory(const TabImpl& tab) const
+    {
+        if (tab.content == nullptr) return tab.m_snapshot.size();
+
+        if (tab.lifecycle && tab.lifecycle->f_estimateMemory)
+        {
+            return tab.lifecycle->f_estimateMemory(tab.content.get());
+        }
+        else return 0;
+    }
+
+    void TabGroup::loadTab(TabImpl& tab)
+    {
+        using State = TabLifecyclePolicy::State;
+
+        auto state = m_tabLifecyclePolicy.state(tab.m_lifecycleKey);
+
+        if (state == State::Suspended)
+        {
+            tab.lifecycle->f_resume(tab.content.get());
+        }
+        else if (state == State::Unloaded)
+        {
+            tab.content = tab.lifecycle->f_deserialize(tab.m_snapshot);
+            THROW_IF_NULL(tab.content);
+
+            tab.m_snapshot.clear();
+
+            addUIObject(tab.content);
+
+            tab.content->skipDrawPosteriorObjects = true;
+            tab.content->setEnabled(false);
+            tab.content->transform(selfCoordRect());
+        }
+        else return; // already loaded
+
+        m_tabLifecyclePolicy.update(tab.m_lifecycleKey, State::Loaded, estimateTabMemory(tab));
+    }
+
+    void TabGroup::deactivateTab(TabImpl& tab)
+    {
+        tab.content->setEnabled(false);
+
+        // The content may have grown or shrunk while being active.
+        m_tabLifecyclePolicy.update(tab.m_lifecycleKey,
+            TabLifecyclePolicy::State::Loaded, estimateTabMemory(tab));
+    }
+
+    void TabGroup::trimInactiveTabs()
+    {
+        using State = TabLifecyclePolicy::State;
+
+        while (auto action = m_tabLifecyclePolicy.nextAction())
+        {
+            auto tabItor = std::find_if(m_tabs.begin(), m_tabs.end(),
+                [&](const TabImpl& tab) { return tab.m_lifecycleKey == action->key; });
+
+            auto& tab = *tabItor;
+            if (action->target == State::Suspended)
+            {
+                tab.lifecycle->f_suspend(tab.content.get());
+            }
+            else // State::Unloaded
+            {
+                tab.m_snapshot = tab.lifecycle->f_serialize(tab.content.get());
+
+                removeUIObject(tab.content);
+                tab.content.reset();
+            }
+            m_tabLifecyclePolicy.update(tab.m_lifecycleKey, action->target, estimateTabMemory(tab));
+        }
+    }
+
+    const TabLifecyclePolicy& TabGroup::tabLifecyclePolicy() const
+    {
+        return m_tabLifecyclePolicy;
+    }
+
+    size_t TabGroup::tabMemoryBudget() const
+    {
+        return m_tabLifecyclePolicy.memoryBudget;
+    }
+
+    void TabGroup::setTabMemoryBudget(size_t byteSize)
+    {
+        m_tabLifecyclePolicy.memoryBudget = byteSize;
+
+        trimInactiveTabs();
+    }
+
     SharedPtr<Window> TabGroup::promoteTabToWindow(size_t index)
     {
         if (index >= 0 && index < m_tabs.size())
@@ -551,6 +667,8 @@ do { \
 
     SharedPtr<Window> TabGroup::promoteTabToWindow(TabIndexParam tabIndex)
     {
+        loadTab(*tabIndex);
+
         auto rect = math_utils::increaseTop
         (
             tabIndex->content->absoluteRect(), -Window::nonClientAreaDefaultHeight()
@@ -561,6 +679,7 @@ do { \
         tabIndex->content->setEnabled(true);
 
         w->setCenterUIObject(tabIndex->content);
+        w->tabLifecycle = tabIndex->lifecycle;
 
         removeTab(tabIndex, 1);
 
@@ -617,6 +736,13 @@ do { \
 
     void TabGroup::onRendererDrawD2d1LayerHelper(Renderer* rndr)
     {
+        for (TabIndex tabIndex = { &m_tabs, 0 }; tabIndex < m_candidateTabCount; ++tabIndex)
+        {
+            if (tabIndex->caption->isD2d1ObjectVisible())
+            {
+                tabIndex->caption->onRendererDrawD2d1Layer(rndr);
+            }
+        }
         if (m_currActiveCardTabIndex.valid())
         {
             if (m_currActiveCardTabIndex->content->isD2d1ObjectVisible())
@@ -917,6 +1043,11 @@ do { \
         return math_utils::isOverlapped(p, sizingFrameExtendedRect(cardBarExtendedAbsoluteRect()));
     }
 
+    D2D1_RECT_F TabGroup::hitTestBoundsHelper() const
+    {
+        return sizingFrameExtendedRect(cardBarExtendedAbsoluteRect());
+    }
+
     void TabGroup::onSizeHelper(SizeEvent& e)
     {
         ResizablePanel::onSizeHelper(e);
@@ -3,11 +3,13 @@
 #include "Common/Precompile.h"
 
 #include "Common/CppLangUtils/IndexIterator.h"
+#include "Common/CppLangUtils/LazyFunction.h"
 #include "Common/MathUtils/2D.h"
 
 #include "UIKit/Appearances/TabGroup.h"
 #include "UIKit/ResizablePanel.h"
 #include "UIKit/ShadowStyle.h"
+#include "UIKit/TabLifecyclePolicy.h"
 
 namespace d14engine::uikit
 {
@@ -16,13 +18,46 @@ namespace d14engine::uikit
     struct TabCaption;
     struct Window;
 
+    // The hooks to release the resources of an inactive tab's content,
+    // which are usually shared by all of the tabs of the same kind.  They
+    // stay with the content when the tab is promoted to a window and then
+    // demoted back, so they are declared outside TabGroup for Window.
+    struct TabLifecycle
+    {
+        // Returns how many bytes the content holds.  Called when the tab
+        // is inserted, deselected, suspended and resumed.
+        cpp_lang_utils::LazyFunction<size_t(Panel*)> f_estimateMemory = {};
+
+        // Releases/rebuilds the caches (text layouts, bitmaps etc.) while
+        // keeping the content alive.  Enables the suspended state.
+        cpp_lang_utils::LazyFunction<void(Panel*)> f_suspend = {};
+        cpp_lang_utils::LazyFunction<void(Panel*)> f_resume = {};
+
+        // Saves the content into a snapshot before it is destroyed, and
+        // rebuilds the content from the snapshot when the tab is selected
+        // again.  Enables the unloaded state.
+        cpp_lang_utils::LazyFunction<String(Panel*)> f_serialize = {};
+        cpp_lang_utils::LazyFunction<SharedPtr<Panel>(const String&)> f_deserialize = {};
+    };
+
     struct TabGroup : appearance::TabGroup, ResizablePanel
     {
         explicit TabGroup(const D2D1_RECT_F& rect = {});
 
         virtual ~TabGroup();
 
-        struct Tab { SharedPtr<TabCaption> caption; SharedPtr<Panel> content; };
+        // Kept as TabGroup::TabLifecycle for the existing users.
+        using TabLifecycle = uikit::TabLifecycle;
+
+        struct Tab
+        {
+            SharedPtr<TabCaption> caption = {};
+
+            // Null if the tab has been unloaded.
+            SharedPtr<Panel> content = {};
+
+            SharedPtr<TabLifecycle> lifecycle = {};
+        };
 
         void onInitializeFinish() override;
 
@@ -48,6 +83,10 @@ namespace d14engine::uikit
             SharedPtr<MenuItem> m_previewItem = {};
 
             D2D1_RECT_F m_cardAbsoluteRectCache = {};
+
+            TabLifecyclePolicy::Key m_lifecycleKey = 0;
+
+            String m_snapshot = {};
         };
         using TabList = std::list<TabImpl>;
 
@@ -66,7 +105,7 @@ namespace d14engine::uikit
 
         void onSelectedTabIndexChange(TabIndexParam index);
 
-        Function<void(TabGroup*, TabIndexParam)> f_onSelectedTabIndexChange = {};
+        cpp_lang_utils::LazyFunction<void(TabGroup*, TabIndexParam)> f_onSelectedTabIndexChange = {};
 
     protected:
         virtual void onSelectedTabIndexChangeHelper(TabIndexParam index);
@@ -132,6 +171,31 @@ namespace d14engine::uikit
         math_utils::Triangle2D moreCardsIconAbsoluteTriangle() const;
         D2D1_RECT_F moreCardsButtonAbsoluteRect() const;
 
+    protected:
+        TabLifecyclePolicy m_tabLifecyclePolicy = {};
+
+        TabLifecyclePolicy::Key m_nextTabLifecycleKey = 1;
+
+        size_t estimateTabMemory(const TabImpl& tab) const;
+
+        // Brings the content of the tab back to the loaded state.
+        void loadTab(TabImpl& tab);
+
+        void deactivateTab(TabImpl& tab);
+
+        // Suspends/unloads the least recently used tabs until the memory
+        // of all the tabs fits in the budget again.
+        void trimInactiveTabs();
+
+    public:
+        const TabLifecyclePolicy& tabLifecyclePolicy() const;
+
+        // The inactive tabs are suspended/unloaded when the total memory of
+        // the tabs exceeds the budget, which is unlimited by default.  Only
+        // the tabs that provide the lifecycle hooks can be trimmed.
+        size_t tabMemoryBudget() const;
+        void setTabMemoryBudget(size_t byteSize);
+
     protected:
         TabIndex m_currDraggedCardTabIndex{};
 
@@ -142,7 +206,7 @@ namespace d14engine::uikit
         SharedPtr<Window> promoteTabToWindow(TabIndexParam tabIndex);
 
     public:
-        Function<void(TabGroup*, Window*)> f_onTriggerTabPromoting = {};
+        cpp_lang_utils::LazyFunction<void(TabGroup*, Window*)> f_onTriggerTabPromoting = {};
 
         // When a window is being dragged, all of the tab-groups that have
         // been registered for the window will be associated with it, and if
@@ -167,6 +231,7 @@ namespace d14engine::uikit
 
         // Panel
         bool isHitHelper(const Event::Point& p) const override;
+        D2D1_RECT_F hitTestBoundsHelper() const override;
 
         void onSizeHelper(SizeEvent& e) override;
 
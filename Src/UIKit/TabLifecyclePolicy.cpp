@@ -0,0 +1,127 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/TabLifecyclePolicy.h"
+
+namespace d14engine::uikit
+{
+    void TabLifecyclePolicy::insert(Key key, size_t memory, bool suspendable, bool unloadable)
+    {
+        erase(key);
+
+        // A new tab has not been used yet, so it goes to the back.
+        m_lruList.push_back(key);
+
+        Entry entry = {};
+        entry.lruItor = std::prev(m_lruList.end());
+        entry.memory = memory;
+        entry.suspendable = suspendable;
+        entry.unloadable = unloadable;
+
+        m_entries.emplace(key, entry);
+
+        m_totalMemory += memory;
+    }
+
+    void TabLifecyclePolicy::erase(Key key)
+    {
+        auto itor = m_entries.find(key);
+        if (itor != m_entries.end())
+        {
+            m_totalMemory -= itor->second.memory;
+
+            m_lruList.erase(itor->second.lruItor);
+            m_entries.erase(itor);
+        }
+    }
+
+    bool TabLifecyclePolicy::contains(Key key) const
+    {
+        return m_entries.contains(key);
+    }
+
+    void TabLifecyclePolicy::activate(Key key)
+    {
+        auto itor = m_entries.find(key);
+        if (itor == m_entries.end()) return;
+
+        for (auto& entry : m_entries)
+        {
+            if (entry.second.state == State::Active) entry.second.state = State::Loaded;
+        }
+        // The caller is responsible for restoring the content, so the tab is
+        // considered to be fully alive from now on.
+        itor->second.state = State::Active;
+
+        m_lruList.splice(m_lruList.begin(), m_lruList, itor->second.lruItor);
+    }
+
+    void TabLifecyclePolicy::update(Key key, State state, size_t memory)
+    {
+        auto itor = m_entries.find(key);
+        if (itor == m_entries.end()) return;
+
+        m_totalMemory -= itor->second.memory;
+        m_totalMemory += memory;
+
+        itor->second.state = state;
+        itor->second.memory = memory;
+    }
+
+    Optional<TabLifecyclePolicy::Action> TabLifecyclePolicy::nextAction() const
+    {
+        if (m_totalMemory <= memoryBudget) return std::nullopt;
+
+        // Suspending is much cheaper to undo than unloading, so all of the
+        // loaded tabs are suspended before any tab gets unloaded.
+        for (auto key = m_lruList.rbegin(); key != m_lruList.rend(); ++key)
+        {
+            auto& entry = m_entries.at(*key);
+            if (entry.state == State::Loaded)
+            {
+                if (entry.suspendable)
+                {
+                    return Action{ *key, State::Suspended };
+                }
+                else if (entry.unloadable)
+                {
+                    return Action{ *key, State::Unloaded };
+                }
+            }
+        }
+        for (auto key = m_lruList.rbegin(); key != m_lruList.rend(); ++key)
+        {
+            auto& entry = m_entries.at(*key);
+            if (entry.state == State::Suspended && entry.unloadable)
+            {
+                return Action{ *key, State::Unloaded };
+            }
+        }
+        return std::nullopt;
+    }
+
+    TabLifecyclePolicy::State TabLifecyclePolicy::state(Key key) const
+    {
+        auto itor = m_entries.find(key);
+        if (itor != m_entries.end())
+        {
+            return itor->second.state;
+        }
+        else return State::Loaded;
+    }
+
+    size_t TabLifecyclePolicy::totalMemory() const
+    {
+        return m_totalMemory;
+    }
+
+    size_t TabLifecyclePolicy::count() const
+    {
+        return m_entries.size();
+    }
+
+    size_t TabLifecyclePolicy::count(State state) const
+    {
+        return std::count_if(m_entries.begin(), m_entries.end(),
+            [&](auto& entry) { return entry.second.state == state; });
+    }
+}
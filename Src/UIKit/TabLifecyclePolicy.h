@@ -0,0 +1,89 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include <cstdint>
+
+namespace d14engine::uikit
+{
+    // Decides which inactive tabs of a tab-group should release their
+    // resources, which only uses the standard library so it can be tested
+    // without creating any UI object.
+    //
+    // Each tab is in one of the following states:
+    //
+    // Active: the selected tab, which is never trimmed.
+    // Loaded: not selected, but the content is fully alive.
+    // Suspended: the content is kept, but its caches (text layouts, bitmaps
+    //            etc.) are released, which is cheap to resume.
+    // Unloaded: the content is destroyed and only a serialized snapshot is
+    //           kept, from which the content is rebuilt when selected.
+    //
+    // When the total memory of the tabs exceeds the budget, the least
+    // recently used tabs are suspended first, and then the least recently
+    // used suspended ones are unloaded, until it fits or nothing can be
+    // trimmed anymore.
+    struct TabLifecyclePolicy
+    {
+        using Key = uint64_t;
+
+        enum class State { Active, Loaded, Suspended, Unloaded };
+
+        struct Action
+        {
+            Key key = 0;
+
+            State target = State::Loaded;
+        };
+
+        // In bytes, including the active tab.
+        size_t memoryBudget = SIZE_MAX;
+
+    protected:
+        // The front is the most recently used one.
+        std::list<Key> m_lruList = {};
+
+        struct Entry
+        {
+            std::list<Key>::iterator lruItor = {};
+
+            State state = State::Loaded;
+
+            size_t memory = 0;
+
+            bool suspendable = false;
+            bool unloadable = false;
+        };
+        std::unordered_map<Key, Entry> m_entries = {};
+
+        size_t m_totalMemory = 0;
+
+    public:
+        // A tab that is neither suspendable nor unloadable still counts in
+        // the total memory, but is never trimmed.
+        void insert(Key key, size_t memory, bool suspendable, bool unloadable);
+
+        void erase(Key key);
+
+        bool contains(Key key) const;
+
+        // Selects the tab, i.e. moves it to the front of the LRU list and
+        // marks it as active, and the previous active tab becomes loaded.
+        void activate(Key key);
+
+        // Reports the new state and memory after applying an action, or the
+        // new memory when the content of a tab changes.
+        void update(Key key, State state, size_t memory);
+
+        // Returns the next action to get back to the budget, which must be
+        // applied (and then reported with update) before calling this again.
+        Optional<Action> nextAction() const;
+
+        State state(Key key) const;
+
+        size_t totalMemory() const;
+
+        size_t count() const;
+        size_t count(State state) const;
+    };
+}
@@ -0,0 +1,65 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/TextAtlas.h"
+
+#include "Common/DirectXError.h"
+
+#include "UIKit/BitmapUtils.h"
+
+namespace d14engine::uikit
+{
+    TextAtlas::TextAtlas(const CreateInfo& info)
+        :
+        TextAtlasCache(info) { }
+
+    void TextAtlas::onCreatePage(size_t pageIndex)
+    {
+        m_pageBitmaps.push_back(bitmap_utils::loadBitmap(
+            (UINT)createInfo.pageWidth, (UINT)createInfo.pageHeight,
+            nullptr, D2D1_BITMAP_OPTIONS_TARGET));
+    }
+
+    void TextAtlas::onClearPages()
+    {
+        m_pageBitmaps.clear();
+    }
+
+    ID2D1Bitmap1* TextAtlas::pageBitmap(const Slot& slot)
+    {
+        return isValid(slot) ? m_pageBitmaps[slot.pageIndex].Get() : nullptr;
+    }
+
+    void TextAtlas::beginDraw(ID2D1DeviceContext* context, const Slot& slot)
+    {
+        auto rect = slotRect(slot);
+
+        // It is recommended to call SetTarget before BeginDraw.
+        // See MaskStyle::beginDraw for more details.
+        context->SetTarget(pageBitmap(slot));
+        context->BeginDraw();
+
+        // ClearType needs the opaque background to blend the sub-pixels,
+        // which is not available for a transparent page, so we fall back
+        // to grayscale while rasterizing the cached text.
+        m_originalTextAntialiasMode = context->GetTextAntialiasMode();
+        if (m_originalTextAntialiasMode == D2D1_TEXT_ANTIALIAS_MODE_CLEARTYPE)
+        {
+            context->SetTextAntialiasMode(D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE);
+        }
+        context->SetTransform(D2D1::Matrix3x2F::Translation(rect.left, rect.top));
+
+        context->PushAxisAlignedClip(
+            { 0.0f, 0.0f, rect.right - rect.left, rect.bottom - rect.top },
+            D2D1_ANTIALIAS_MODE_ALIASED);
+
+        context->Clear(D2D1::ColorF{ 0x000000, 0.0f });
+    }
+
+    void TextAtlas::endDraw(ID2D1DeviceContext* context)
+    {
+        context->PopAxisAlignedClip();
+        context->SetTextAntialiasMode(m_originalTextAntialiasMode);
+
+        THROW_IF_FAILED(context->EndDraw());
+    }
+}
@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include "UIKit/TextAtlasCache.h"
+
+namespace d14engine::uikit
+{
+    // Caches the pre-rasterized text in a few shared bitmap pages, so that
+    // the static labels (captions, menu items, button texts etc.) can be
+    // drawn with DrawBitmap instead of passing through DirectWrite in every
+    // frame.  This only owns the page bitmaps and rasterizes into them, and
+    // the bookkeeping is done by TextAtlasCache.
+
+    struct TextAtlas : TextAtlasCache
+    {
+        TextAtlas() = default;
+
+        explicit TextAtlas(const CreateInfo& info);
+
+    protected:
+        // Parallel to the pages of the cache.
+        std::vector<ComPtr<ID2D1Bitmap1>> m_pageBitmaps = {};
+
+        void onCreatePage(size_t pageIndex) override;
+
+        void onClearPages() override;
+
+    public:
+        ID2D1Bitmap1* pageBitmap(const Slot& slot);
+
+        // The draw calls between beginDraw/endDraw only affect the region of
+        // the slot, which is cleared as transparent when begins.  Note that
+        // these must be called outside the BeginDraw/EndDraw of the scene.
+
+        void beginDraw(ID2D1DeviceContext* context, const Slot& slot);
+
+        void endDraw(ID2D1DeviceContext* context);
+
+    protected:
+        D2D1_TEXT_ANTIALIAS_MODE m_originalTextAntialiasMode = {};
+    };
+}
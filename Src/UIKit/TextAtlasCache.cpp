@@ -0,0 +1,181 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/TextAtlasCache.h"
+
+#include <numeric>
+
+namespace d14engine::uikit
+{
+    TextAtlasCache::TextAtlasCache()
+        :
+        TextAtlasCache(CreateInfo{}) { }
+
+    TextAtlasCache::TextAtlasCache(const CreateInfo& info)
+        :
+        createInfo(info) { }
+
+    size_t TextAtlasCache::KeyHash::operator()(const Key& key) const
+    {
+        size_t seed = std::hash<Wstring>{}(key.text);
+
+        auto combine = [&](size_t value)
+        {
+            seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        };
+        combine(std::hash<Wstring>{}(key.fontFamilyName));
+        combine(std::hash<float>{}(key.fontSize));
+        combine(std::hash<float>{}(key.maxWidth));
+        combine(std::hash<float>{}(key.maxHeight));
+        combine((size_t)key.fontWeight);
+        combine((size_t)key.textAlignment);
+        combine((size_t)key.paragraphAlignment);
+
+        for (auto& c : key.color) combine(std::hash<float>{}(c));
+
+        return seed;
+    }
+
+    Optional<TextAtlasCache::Slot> TextAtlasCache::find(const Key& key)
+    {
+        auto itor = m_slots.find(key);
+        if (itor != m_slots.end() && isValid(itor->second))
+        {
+            ++statistics.hitCount;
+            touch(itor->second);
+            return itor->second;
+        }
+        ++statistics.missCount;
+        return std::nullopt;
+    }
+
+    Optional<TextAtlasCache::Slot> TextAtlasCache::allocate(const Key& key, int width, int height)
+    {
+        if (width > createInfo.pageWidth - 2 * createInfo.padding ||
+            height > createInfo.pageHeight - 2 * createInfo.padding)
+        {
+            return std::nullopt;
+        }
+        checkDpi(key.dpi);
+
+        // Try the most recently used pages first to keep the hot texts close.
+        std::vector<size_t> order(m_pages.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+        {
+            return m_pages[a].lastUsedTick > m_pages[b].lastUsedTick;
+        });
+        Optional<math_utils::PackedRect> rect = {};
+        size_t pageIndex = 0;
+
+        for (auto index : order)
+        {
+            if ((rect = m_pages[index].packer.insert(width, height)))
+            {
+                pageIndex = index;
+                break;
+            }
+        }
+        if (!rect.has_value())
+        {
+            if (m_pages.size() < createInfo.maxPageCount)
+            {
+                pageIndex = m_pages.size();
+                auto& page = m_pages.emplace_back();
+
+                page.packer = math_utils::ShelfPacker(
+                    createInfo.pageWidth, createInfo.pageHeight, createInfo.padding);
+
+                page.generation = ++m_generation;
+
+                onCreatePage(pageIndex);
+            }
+            else pageIndex = recycleLeastRecentlyUsedPage();
+
+            rect = m_pages[pageIndex].packer.insert(width, height);
+            if (!rect.has_value()) return std::nullopt;
+        }
+        auto& slot = m_slots[key];
+
+        slot.pageIndex = pageIndex;
+        slot.pageGeneration = m_pages[pageIndex].generation;
+        slot.rect = rect.value();
+
+        touch(slot);
+        return slot;
+    }
+
+    bool TextAtlasCache::isValid(const Slot& slot) const
+    {
+        return slot.pageIndex < m_pages.size() &&
+            slot.pageGeneration == m_pages[slot.pageIndex].generation;
+    }
+
+    void TextAtlasCache::touch(const Slot& slot)
+    {
+        if (isValid(slot))
+        {
+            m_pages[slot.pageIndex].lastUsedTick = ++m_usedTick;
+        }
+    }
+
+    void TextAtlasCache::invalidate()
+    {
+        for (auto& page : m_pages)
+        {
+            page.packer.clear();
+            page.generation = ++m_generation;
+        }
+        m_slots.clear();
+    }
+
+    void TextAtlasCache::checkDpi(float dpi)
+    {
+        if (m_dpi != dpi)
+        {
+            m_dpi = dpi;
+
+            // The bitmap DPI is decided when created.
+            m_pages.clear();
+            m_slots.clear();
+
+            onClearPages();
+        }
+    }
+
+    size_t TextAtlasCache::pageCount() const
+    {
+        return m_pages.size();
+    }
+
+    TextAtlasCache::Rect TextAtlasCache::slotRect(const Slot& slot) const
+    {
+        auto factor = 96.0f / m_dpi;
+        return
+        {
+            slot.rect.x * factor,
+            slot.rect.y * factor,
+            (slot.rect.x + slot.rect.width) * factor,
+            (slot.rect.y + slot.rect.height) * factor
+        };
+    }
+
+    size_t TextAtlasCache::recycleLeastRecentlyUsedPage()
+    {
+        auto target = std::min_element(m_pages.begin(), m_pages.end(),
+        [](const Page& a, const Page& b)
+        {
+            return a.lastUsedTick < b.lastUsedTick;
+        });
+        auto pageIndex = (size_t)std::distance(m_pages.begin(), target);
+
+        std::erase_if(m_slots, [&](auto& pair)
+        {
+            return pair.second.pageIndex == pageIndex;
+        });
+        target->packer.clear();
+        target->generation = ++m_generation;
+
+        ++statistics.recycledPageCount;
+        return pageIndex;
+    }
+}
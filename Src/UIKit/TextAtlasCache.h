@@ -0,0 +1,144 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include "Common/CppLangUtils/NonCopyable.h"
+#include "Common/MathUtils/Packing.h"
+
+namespace d14engine::uikit
+{
+    // The bookkeeping of TextAtlas (key lookup, region packing per page and
+    // recycling the least recently used page), which only uses the standard
+    // library so it can be tested without creating any Direct2D resource.
+    // The cached regions are identified by the text content and all the
+    // properties that affect the rasterization result.
+
+    struct TextAtlasCache : cpp_lang_utils::NonCopyable
+    {
+        struct CreateInfo
+        {
+            // in pixels
+            int pageWidth = 1024;
+            int pageHeight = 1024;
+
+            // The least recently used page is recycled when all are full.
+            size_t maxPageCount = 4;
+
+            int padding = 1;
+        };
+
+        // Not a default argument since GCC rejects the default member
+        // initializers of a nested struct before the enclosing one ends.
+        TextAtlasCache();
+
+        explicit TextAtlasCache(const CreateInfo& info);
+
+        virtual ~TextAtlasCache() = default;
+
+        // This field stores the original create-info passed in the ctor.
+        const CreateInfo createInfo = {};
+
+        struct Key
+        {
+            Wstring text = {};
+
+            Wstring fontFamilyName = {};
+            Wstring localeName = {};
+
+            float fontSize = 0.0f;
+            int fontWeight = 0, fontStyle = 0, fontStretch = 0;
+
+            float maxWidth = 0.0f, maxHeight = 0.0f;
+            float incrementalTabStop = 0.0f;
+
+            int textAlignment = 0, paragraphAlignment = 0, wordWrapping = 0;
+            int drawTextOptions = 0;
+
+            std::array<float, 4> color = {}; // RGBA
+
+            float dpi = 96.0f;
+
+            bool operator==(const Key& rhs) const = default;
+        };
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const;
+        };
+
+        struct Slot
+        {
+            size_t pageIndex = 0;
+            size_t pageGeneration = 0;
+
+            math_utils::PackedRect rect = {}; // in pixels
+        };
+
+        struct Rect { float left = 0.0f, top = 0.0f, right = 0.0f, bottom = 0.0f; };
+
+    protected:
+        struct Page
+        {
+            math_utils::ShelfPacker packer = {};
+
+            // Changed when the page is recycled to invalidate the slots that
+            // are still held by the users, which is unique among all pages
+            // ever created (including those dropped by checkDpi).
+            size_t generation = 0;
+
+            size_t lastUsedTick = 0;
+        };
+        std::vector<Page> m_pages = {};
+
+        size_t m_generation = 0;
+
+        std::unordered_map<Key, Slot, KeyHash> m_slots = {};
+
+        // Increased every time a slot is used, which works as the LRU clock.
+        size_t m_usedTick = 0;
+
+        float m_dpi = 96.0f;
+
+        // The subclass creates the resources of the page here (e.g. the
+        // page bitmap of TextAtlas), where the page index is always equal
+        // to the previous page count.
+        virtual void onCreatePage(size_t pageIndex) { }
+
+        // Called after all the pages are dropped.
+        virtual void onClearPages() { }
+
+    public:
+        // Returns std::nullopt if the key has not been rasterized yet.
+        Optional<Slot> find(const Key& key);
+
+        // Reserves a region for the key, and the caller should rasterize
+        // the text into the region before drawing it.  Returns std::nullopt
+        // if the region is larger than a single page.
+        Optional<Slot> allocate(const Key& key, int width, int height);
+
+        bool isValid(const Slot& slot) const;
+
+        void touch(const Slot& slot);
+
+        // Drops all the cached regions (e.g. after changing theme or DPI).
+        void invalidate();
+
+        // The pages are recreated if the DPI differs from the last one.
+        void checkDpi(float dpi);
+
+        size_t pageCount() const;
+
+        struct Statistics
+        {
+            size_t hitCount = 0;
+            size_t missCount = 0;
+            size_t recycledPageCount = 0;
+        }
+        statistics = {};
+
+        // The region in DIPs (relative to the page) to draw the cached text.
+        Rect slotRect(const Slot& slot) const;
+
+    protected:
+        size_t recycleLeastRecentlyUsedPage();
+    };
+}
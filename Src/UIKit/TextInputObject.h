@@ -2,6 +2,8 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
+
 namespace d14engine::uikit
 {
     struct TextInputObject
@@ -22,7 +24,7 @@ namespace d14engine::uikit
             if (f_onInputString) f_onInputString(this, str);
         }
 
-        Function<void(TextInputObject*, WstrParam)> f_onInputString = {};
+        cpp_lang_utils::LazyFunction<void(TextInputObject*, WstrParam)> f_onInputString = {};
 
         void onTextChange(WstrParam text)
         {
@@ -31,7 +33,7 @@ namespace d14engine::uikit
             if (f_onTextChange) f_onTextChange(this, text);
         }
 
-        Function<void(TextInputObject*, WstrParam)> f_onTextChange = {};
+        cpp_lang_utils::LazyFunction<void(TextInputObject*, WstrParam)> f_onTextChange = {};
 
     protected:
         virtual void onInputStringHelper(WstrParam str) { }
@@ -0,0 +1,67 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::uikit
+{
+    // Switching the theme only increases the generation, and each object
+    // compares it with the generation it has applied before being drawn, so
+    // a switch costs O(subscribers) instead of O(all objects), and the
+    // following frames O(visible objects).
+    //
+    // The subscribers are the objects that must be up to date even when not
+    // drawn, which are notified immediately.  They are held weakly, and the
+    // expired ones are dropped in each switch.
+    //
+    // Only the standard library is used so that the costs can be measured
+    // without Win32.
+    template<typename Subscriber>
+    struct ThemeGeneration
+    {
+    protected:
+        uint64_t m_value = 0;
+
+        using SubscriberSet = std::set<WeakPtr<Subscriber>, std::owner_less<WeakPtr<Subscriber>>>;
+
+        SubscriberSet m_subscribers = {};
+
+    public:
+        uint64_t value() const
+        {
+            return m_value;
+        }
+
+        // Returns the subscribers to notify, which are locked in a separate
+        // list since they may unsubscribe themselves in the callbacks.
+        std::vector<SharedPtr<Subscriber>> advance()
+        {
+            ++m_value;
+
+            std::erase_if(m_subscribers, [](auto& subscriber) { return subscriber.expired(); });
+
+            std::vector<SharedPtr<Subscriber>> subscribers = {};
+            subscribers.reserve(m_subscribers.size());
+
+            for (auto& subscriber : m_subscribers)
+            {
+                subscribers.push_back(subscriber.lock());
+            }
+            return subscribers;
+        }
+
+        void subscribe(ShrdPtrParam<Subscriber> subscriber)
+        {
+            m_subscribers.insert(subscriber);
+        }
+
+        void unsubscribe(ShrdPtrParam<Subscriber> subscriber)
+        {
+            m_subscribers.erase(subscriber);
+        }
+
+        size_t subscriberCount() const
+        {
+            return m_subscribers.size();
+        }
+    };
+}
@@ -0,0 +1,199 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/TileLoader.h"
+
+#include <cstring>
+
+namespace d14engine::uikit
+{
+    MemoryTileSource::MemoryTileSource(const image_utils::ImageView& image)
+        : m_image(image) { }
+
+    int MemoryTileSource::width() const
+    {
+        return (int)m_image.width;
+    }
+
+    int MemoryTileSource::height() const
+    {
+        return (int)m_image.height;
+    }
+
+    bool MemoryTileSource::readTile(const TilePyramid& pyramid, const TilePyramid::Key& key, std::vector<uint8_t>& pixels)
+    {
+        auto rect = pyramid.tileRect(key);
+
+        int left = (int)rect.left, top = (int)rect.top;
+        int width = (int)rect.right - left, height = (int)rect.bottom - top;
+
+        pixels.resize((size_t)width * height * 4);
+
+        if (key.level == 0)
+        {
+            for (int y = 0; y < height; ++y)
+            {
+                auto src = m_image.data + (size_t)(top + y) * m_image.rowPitch + (size_t)left * 4;
+                memcpy(pixels.data() + (size_t)y * width * 4, src, (size_t)width * 4);
+            }
+            return true;
+        }
+        // The level-0 pixels covered by a pixel of the level.
+        auto span = [&](int64_t index, int64_t size)
+        {
+            return std::pair{ index << key.level, std::min((index + 1) << key.level, size) };
+        };
+        for (int y = 0; y < height; ++y)
+        {
+            auto [y0, y1] = span(top + y, m_image.height);
+
+            for (int x = 0; x < width; ++x)
+            {
+                auto [x0, x1] = span(left + x, m_image.width);
+
+                uint64_t sums[4] = {};
+                for (int64_t sy = y0; sy < y1; ++sy)
+                {
+                    auto src = m_image.data + sy * m_image.rowPitch;
+                    for (int64_t sx = x0; sx < x1; ++sx)
+                    {
+                        for (int c = 0; c < 4; ++c) sums[c] += src[sx * 4 + c];
+                    }
+                }
+                auto count = (uint64_t)((y1 - y0) * (x1 - x0));
+
+                auto dst = pixels.data() + ((size_t)y * width + x) * 4;
+                for (int c = 0; c < 4; ++c)
+                {
+                    dst[c] = (uint8_t)((sums[c] + count / 2) / count);
+                }
+            }
+        }
+        return true;
+    }
+
+    TileLoader::TileLoader(ShrdPtrParam<TileSource> source, const TilePyramid& pyramid, size_t threadCount)
+        :
+        m_source(source),
+        m_pyramid(pyramid)
+    {
+        threadCount = std::max(threadCount, (size_t)1);
+
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            m_workers.emplace_back([this] { work(); });
+        }
+    }
+
+    TileLoader::~TileLoader()
+    {
+        {
+            std::unique_lock lock(m_mutex);
+            m_stopping = true;
+        }
+        m_keyQueued.notify_all();
+
+        for (auto& worker : m_workers) worker.join();
+    }
+
+    void TileLoader::work()
+    {
+        while (true)
+        {
+            Key key = {};
+            {
+                std::unique_lock lock(m_mutex);
+                m_keyQueued.wait(lock, [this] { return !m_queuedKeys.empty() || m_stopping; });
+
+                if (m_stopping) break;
+
+                key = m_queuedKeys.front();
+                m_queuedKeys.pop_front();
+            }
+            auto rect = m_pyramid.tileRect(key);
+
+            Tile tile = {};
+            tile.key = key;
+            tile.width = (int)(rect.right - rect.left);
+            tile.height = (int)(rect.bottom - rect.top);
+
+            // A failed tile is never requested again, and an exception is
+            // treated the same since it is thrown on a worker thread.
+            bool succeeded = false;
+            try
+            {
+                if (m_source->isConcurrent())
+                {
+                    succeeded = m_source->readTile(m_pyramid, key, tile.pixels);
+                }
+                else // serialized
+                {
+                    std::unique_lock sourceLock(m_sourceMutex);
+                    succeeded = m_source->readTile(m_pyramid, key, tile.pixels);
+                }
+            }
+            catch (...) { succeeded = false; }
+
+            succeeded = succeeded && tile.pixels.size() == (size_t)tile.width * tile.height * 4;
+            {
+                std::unique_lock lock(m_mutex);
+                if (succeeded)
+                {
+                    m_loadedTiles.push_back(std::move(tile));
+                }
+                else // failed
+                {
+                    m_loadingKeys.erase(key);
+                    m_failedKeys.insert(key);
+                }
+            }
+        }
+    }
+
+    const TilePyramid& TileLoader::pyramid() const
+    {
+        return m_pyramid;
+    }
+
+    void TileLoader::request(const std::vector<Key>& keys)
+    {
+        {
+            std::unique_lock lock(m_mutex);
+
+            for (auto& key : m_queuedKeys) m_loadingKeys.erase(key);
+            m_queuedKeys.clear();
+
+            for (auto& key : keys)
+            {
+                if (!m_pyramid.isValid(key) || m_failedKeys.contains(key)) continue;
+
+                // Also skips the duplicate keys in the request.
+                if (m_loadingKeys.insert(key).second) m_queuedKeys.push_back(key);
+            }
+        }
+        m_keyQueued.notify_all();
+    }
+
+    std::vector<TileLoader::Tile> TileLoader::takeLoaded()
+    {
+        std::unique_lock lock(m_mutex);
+
+        std::vector<Tile> tiles = std::move(m_loadedTiles);
+        m_loadedTiles.clear();
+
+        for (auto& tile : tiles) m_loadingKeys.erase(tile.key);
+
+        return tiles;
+    }
+
+    bool TileLoader::idle() const
+    {
+        std::unique_lock lock(m_mutex);
+        return m_loadingKeys.empty();
+    }
+
+    size_t TileLoader::failedCount() const
+    {
+        std::unique_lock lock(m_mutex);
+        return m_failedKeys.size();
+    }
+}
@@ -0,0 +1,114 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include "Common/CppLangUtils/NonCopyable.h"
+#include "Common/ImageUtils/ImageEncoder.h"
+
+#include "UIKit/TiledImageModel.h"
+
+#include <condition_variable>
+#include <mutex>
+
+namespace d14engine::uikit
+{
+    // Provides the pixels of the tiles, which is called on the loader
+    // threads (one call at a time unless the source says otherwise).
+    struct TileSource
+    {
+        virtual ~TileSource() = default;
+
+        // The size of level 0.
+        virtual int width() const = 0;
+        virtual int height() const = 0;
+
+        // Whether readTile can be called on multiple threads at the same time.
+        virtual bool isConcurrent() const { return false; }
+
+        // Writes the RGBA8 pixels (premultiplied alpha, 4 * width bytes per
+        // row) of pyramid.tileRect(key), and returns false if failed.
+        virtual bool readTile(const TilePyramid& pyramid, const TilePyramid::Key& key, std::vector<uint8_t>& pixels) = 0;
+    };
+
+    // Reads the tiles from an image in memory (which must outlive the
+    // source), where each pixel of a coarser level is the box average of
+    // the level-0 pixels it covers.
+    struct MemoryTileSource : TileSource
+    {
+        explicit MemoryTileSource(const image_utils::ImageView& image);
+
+    protected:
+        image_utils::ImageView m_image = {};
+
+    public:
+        int width() const override;
+        int height() const override;
+
+        bool isConcurrent() const override { return true; }
+
+        bool readTile(const TilePyramid& pyramid, const TilePyramid::Key& key, std::vector<uint8_t>& pixels) override;
+    };
+
+    // Reads the tiles on the worker threads.  Requesting replaces the tiles
+    // that have not started loading yet, so the tiles scrolled/zoomed out of
+    // the viewport are never loaded, and the loaded tiles are taken by the
+    // UI thread (e.g. when updating the UI objects).
+    struct TileLoader : cpp_lang_utils::NonCopyable
+    {
+        using Key = TilePyramid::Key;
+
+        TileLoader(ShrdPtrParam<TileSource> source, const TilePyramid& pyramid, size_t threadCount = 1);
+
+        virtual ~TileLoader();
+
+        struct Tile
+        {
+            Key key = {};
+
+            int width = 0, height = 0;
+
+            std::vector<uint8_t> pixels = {};
+        };
+
+    protected:
+        SharedPtr<TileSource> m_source = {};
+
+        TilePyramid m_pyramid;
+
+        std::deque<Key> m_queuedKeys = {};
+
+        // The tiles being loaded, loaded but not taken, or failed, which
+        // are skipped when requested again.
+        std::unordered_set<Key, TilePyramid::KeyHash> m_loadingKeys = {};
+        std::unordered_set<Key, TilePyramid::KeyHash> m_failedKeys = {};
+
+        std::vector<Tile> m_loadedTiles = {};
+
+        bool m_stopping = false;
+
+        // Serializes readTile if the source is not concurrent.
+        std::mutex m_sourceMutex = {};
+
+        // Guards all the members above except the source.
+        mutable std::mutex m_mutex = {};
+
+        std::condition_variable m_keyQueued = {};
+
+        std::vector<std::thread> m_workers = {};
+
+        void work();
+
+    public:
+        const TilePyramid& pyramid() const;
+
+        // The keys are loaded in the given order.
+        void request(const std::vector<Key>& keys);
+
+        std::vector<Tile> takeLoaded();
+
+        // Whether nothing is queued, being loaded or waiting to be taken.
+        bool idle() const;
+
+        size_t failedCount() const;
+    };
+}
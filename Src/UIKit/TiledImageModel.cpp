@@ -0,0 +1,332 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/TiledImageModel.h"
+
+#include <cmath>
+
+namespace d14engine::uikit
+{
+    size_t TilePyramid::KeyHash::operator()(const Key& key) const
+    {
+        // The levels are less than 32 and the tile indices less than 2^24.
+        auto value = ((uint64_t)key.level << 48) ^ ((uint64_t)(uint32_t)key.x << 24) ^ (uint64_t)(uint32_t)key.y;
+        return std::hash<uint64_t>{}(value);
+    }
+
+    TilePyramid::TilePyramid(int width, int height, int tileSize)
+        :
+        m_width(std::max(width, 1)),
+        m_height(std::max(height, 1)),
+        m_tileSize(std::max(tileSize, 1))
+    {
+        int levelWidth = m_width, levelHeight = m_height;
+        while (true)
+        {
+            Level level = {};
+            level.width = levelWidth;
+            level.height = levelHeight;
+            level.tileCountX = (levelWidth + m_tileSize - 1) / m_tileSize;
+            level.tileCountY = (levelHeight + m_tileSize - 1) / m_tileSize;
+
+            m_levels.push_back(level);
+
+            if (level.tileCountX == 1 && level.tileCountY == 1) break;
+
+            levelWidth = (levelWidth + 1) / 2;
+            levelHeight = (levelHeight + 1) / 2;
+        }
+    }
+
+    int TilePyramid::width() const
+    {
+        return m_width;
+    }
+
+    int TilePyramid::height() const
+    {
+        return m_height;
+    }
+
+    int TilePyramid::tileSize() const
+    {
+        return m_tileSize;
+    }
+
+    int TilePyramid::levelCount() const
+    {
+        return (int)m_levels.size();
+    }
+
+    int TilePyramid::levelWidth(int level) const
+    {
+        return m_levels[level].width;
+    }
+
+    int TilePyramid::levelHeight(int level) const
+    {
+        return m_levels[level].height;
+    }
+
+    int TilePyramid::tileCountX(int level) const
+    {
+        return m_levels[level].tileCountX;
+    }
+
+    int TilePyramid::tileCountY(int level) const
+    {
+        return m_levels[level].tileCountY;
+    }
+
+    bool TilePyramid::isValid(const Key& key) const
+    {
+        if (key.level < 0 || key.level >= levelCount()) return false;
+
+        auto& level = m_levels[key.level];
+
+        return key.x >= 0 && key.x < level.tileCountX && key.y >= 0 && key.y < level.tileCountY;
+    }
+
+    TilePyramid::Rect TilePyramid::tileRect(const Key& key) const
+    {
+        auto& level = m_levels[key.level];
+
+        int left = key.x * m_tileSize, top = key.y * m_tileSize;
+
+        return
+        {
+            (double)left, (double)top,
+            (double)std::min(left + m_tileSize, level.width),
+            (double)std::min(top + m_tileSize, level.height)
+        };
+    }
+
+    TilePyramid::Rect TilePyramid::tileRegion(const Key& key) const
+    {
+        double scale = std::ldexp(1.0, key.level);
+
+        auto rect = tileRect(key);
+        return
+        {
+            rect.left * scale, rect.top * scale,
+            std::min(rect.right * scale, (double)m_width),
+            std::min(rect.bottom * scale, (double)m_height)
+        };
+    }
+
+    Optional<TilePyramid::Key> TilePyramid::parent(const Key& key) const
+    {
+        if (key.level + 1 >= levelCount()) return std::nullopt;
+
+        return Key{ key.level + 1, key.x / 2, key.y / 2 };
+    }
+
+    int TilePyramid::levelForScale(double scale) const
+    {
+        for (int i = levelCount() - 1; i > 0; --i)
+        {
+            if (std::ldexp(1.0, -i) >= scale) return i;
+        }
+        return 0;
+    }
+
+    std::vector<TilePyramid::Key> TilePyramid::tilesInRegion(int level, const Rect& region) const
+    {
+        auto& info = m_levels[level];
+
+        // The level-0 pixels of a tile.
+        double tileExtent = std::ldexp((double)m_tileSize, level);
+
+        // The tiles that only touch the region are excluded.
+        auto firstTile = [&](double value, int count)
+        {
+            return (int)std::clamp(std::floor(value / tileExtent), 0.0, (double)count);
+        };
+        auto lastTile = [&](double value, int count)
+        {
+            return (int)std::clamp(std::ceil(value / tileExtent), 0.0, (double)count);
+        };
+        int left = firstTile(region.left, info.tileCountX);
+        int top = firstTile(region.top, info.tileCountY);
+        int right = lastTile(region.right, info.tileCountX);
+        int bottom = lastTile(region.bottom, info.tileCountY);
+
+        std::vector<Key> keys = {};
+        for (int y = top; y < bottom; ++y)
+        {
+            for (int x = left; x < right; ++x)
+            {
+                keys.push_back({ level, x, y });
+            }
+        }
+        return keys;
+    }
+
+    TileCache::TileCache(size_t budget)
+        : m_budget(budget) { }
+
+    std::vector<TileCache::Key> TileCache::evict()
+    {
+        std::vector<Key> keys = {};
+
+        // The tiles used in this frame are at the front.
+        while (m_usedBytes > m_budget && !m_entries.empty())
+        {
+            auto& entry = m_entries.back();
+            if (entry.frameIndex == m_frameIndex) break;
+
+            keys.push_back(entry.key);
+            m_usedBytes -= entry.byteSize;
+
+            m_entryMap.erase(entry.key);
+            m_entries.pop_back();
+        }
+        return keys;
+    }
+
+    size_t TileCache::budget() const
+    {
+        return m_budget;
+    }
+
+    std::vector<TileCache::Key> TileCache::setBudget(size_t value)
+    {
+        m_budget = value;
+
+        return evict();
+    }
+
+    size_t TileCache::usedBytes() const
+    {
+        return m_usedBytes;
+    }
+
+    size_t TileCache::count() const
+    {
+        return m_entries.size();
+    }
+
+    bool TileCache::contains(const Key& key) const
+    {
+        return m_entryMap.contains(key);
+    }
+
+    void TileCache::beginFrame()
+    {
+        ++m_frameIndex;
+    }
+
+    bool TileCache::touch(const Key& key)
+    {
+        auto entryItor = m_entryMap.find(key);
+        if (entryItor == m_entryMap.end()) return false;
+
+        auto itor = entryItor->second;
+        itor->frameIndex = m_frameIndex;
+
+        m_entries.splice(m_entries.begin(), m_entries, itor);
+
+        return true;
+    }
+
+    std::vector<TileCache::Key> TileCache::insert(const Key& key, size_t byteSize)
+    {
+        erase(key);
+
+        m_entries.push_front({ key, byteSize, m_frameIndex });
+        m_entryMap[key] = m_entries.begin();
+
+        m_usedBytes += byteSize;
+
+        return evict();
+    }
+
+    void TileCache::erase(const Key& key)
+    {
+        auto entryItor = m_entryMap.find(key);
+        if (entryItor == m_entryMap.end()) return;
+
+        m_usedBytes -= entryItor->second->byteSize;
+
+        m_entries.erase(entryItor->second);
+        m_entryMap.erase(entryItor);
+    }
+
+    void TileCache::clear()
+    {
+        m_entries.clear();
+        m_entryMap.clear();
+
+        m_usedBytes = 0;
+    }
+
+    TilePlan planTiles(const TilePyramid& pyramid, TileCache& cache, const TilePyramid::Rect& region, double scale)
+    {
+        using Key = TilePlan::Key;
+        using Rect = TilePlan::Rect;
+
+        TilePlan plan = {};
+        plan.level = pyramid.levelForScale(scale);
+
+        auto sourceOf = [&](const Key& key, const Rect& destination) -> Rect
+        {
+            double levelScale = std::ldexp(1.0, -key.level);
+
+            auto rect = pyramid.tileRect(key);
+            return
+            {
+                destination.left * levelScale - rect.left,
+                destination.top * levelScale - rect.top,
+                destination.right * levelScale - rect.left,
+                destination.bottom * levelScale - rect.top
+            };
+        };
+        std::vector<Key> missingKeys = {};
+
+        for (auto& key : pyramid.tilesInRegion(plan.level, region))
+        {
+            auto destination = pyramid.tileRegion(key);
+
+            if (cache.touch(key))
+            {
+                plan.draws.push_back({ key, sourceOf(key, destination), destination });
+                continue;
+            }
+            missingKeys.push_back(key);
+
+            for (auto ancestor = pyramid.parent(key); ancestor.has_value(); ancestor = pyramid.parent(ancestor.value()))
+            {
+                if (cache.touch(ancestor.value()))
+                {
+                    plan.draws.push_back({ ancestor.value(), sourceOf(ancestor.value(), destination), destination });
+                    break;
+                }
+            }
+        }
+        int coarsestLevel = pyramid.levelCount() - 1;
+        if (plan.level != coarsestLevel)
+        {
+            for (auto& key : pyramid.tilesInRegion(coarsestLevel, region))
+            {
+                if (!cache.contains(key)) plan.requests.push_back(key);
+            }
+        }
+        double centerX = (region.left + region.right) * 0.5;
+        double centerY = (region.top + region.bottom) * 0.5;
+
+        auto distance = [&](const Key& key)
+        {
+            auto rect = pyramid.tileRegion(key);
+
+            double dx = (rect.left + rect.right) * 0.5 - centerX;
+            double dy = (rect.top + rect.bottom) * 0.5 - centerY;
+
+            return dx * dx + dy * dy;
+        };
+        std::stable_sort(missingKeys.begin(), missingKeys.end(),
+            [&](const Key& lhs, const Key& rhs) { return distance(lhs) < distance(rhs); });
+
+        plan.requests.insert(plan.requests.end(), missingKeys.begin(), missingKeys.end());
+
+        return plan;
+    }
+}
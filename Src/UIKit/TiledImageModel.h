@@ -0,0 +1,184 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+namespace d14engine::uikit
+{
+    // The tiles of a mip pyramid of a (possibly huge) image, which only uses
+    // the standard library so it can be tested without creating any UI
+    // object (see TiledImageView for the UI part).
+    //
+    // Level 0 is the full resolution, and each level halves the previous
+    // one (rounded up) until the whole level fits in a single tile, so a
+    // pixel of level n covers exactly 2^n x 2^n level-0 pixels (clipped at
+    // the right/bottom edges of the image) and a tile covers exactly the
+    // 2x2 tiles of the finer level.
+    struct TilePyramid
+    {
+        struct Key
+        {
+            int level = 0, x = 0, y = 0;
+
+            bool operator==(const Key&) const = default;
+        };
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const;
+        };
+
+        // In the pixels of a level, or in the level-0 pixels for a region.
+        struct Rect
+        {
+            double left = 0.0, top = 0.0, right = 0.0, bottom = 0.0;
+
+            bool operator==(const Rect&) const = default;
+        };
+
+        TilePyramid(int width, int height, int tileSize = 256);
+
+    protected:
+        int m_width = 0, m_height = 0;
+
+        int m_tileSize = 0;
+
+        struct Level
+        {
+            int width = 0, height = 0;
+
+            int tileCountX = 0, tileCountY = 0;
+        };
+        std::vector<Level> m_levels = {};
+
+    public:
+        int width() const;
+        int height() const;
+
+        int tileSize() const;
+
+        int levelCount() const;
+
+        int levelWidth(int level) const;
+        int levelHeight(int level) const;
+
+        int tileCountX(int level) const;
+        int tileCountY(int level) const;
+
+        bool isValid(const Key& key) const;
+
+        // In the pixels of the level, where the tiles at the right/bottom
+        // edges are smaller than tileSize.
+        Rect tileRect(const Key& key) const;
+
+        // In the level-0 pixels, clipped at the edges of the image.
+        Rect tileRegion(const Key& key) const;
+
+        // Returns std::nullopt for the tiles at the coarsest level.
+        Optional<Key> parent(const Key& key) const;
+
+        // The coarsest level that still has at least one pixel for each
+        // device pixel, where scale is the device pixels per level-0 pixel
+        // (e.g. 0.3 if the image is shown at 30%).
+        int levelForScale(double scale) const;
+
+        // The tiles of the level that intersect the region (in the level-0
+        // pixels), in the row-major order.
+        std::vector<Key> tilesInRegion(int level, const Rect& region) const;
+    };
+
+    // Keeps the byte sizes of the loaded tiles in the LRU order, and evicts
+    // the least recently used ones beyond the budget.  Only the keys are
+    // kept here, so the owner drops its own payloads (e.g. the bitmaps) of
+    // the evicted keys.
+    //
+    // The tiles touched since the last beginFrame are never evicted, since
+    // they are being drawn, so the budget can be exceeded temporarily if the
+    // viewport needs more than that.
+    struct TileCache
+    {
+        using Key = TilePyramid::Key;
+
+        explicit TileCache(size_t budget = 256 * 1024 * 1024);
+
+    protected:
+        size_t m_budget = 0;
+        size_t m_usedBytes = 0;
+
+        size_t m_frameIndex = 0;
+
+        struct Entry
+        {
+            Key key = {};
+
+            size_t byteSize = 0;
+
+            size_t frameIndex = 0;
+        };
+        // The most recently used first.
+        std::list<Entry> m_entries = {};
+
+        std::unordered_map<Key, std::list<Entry>::iterator, TilePyramid::KeyHash> m_entryMap = {};
+
+        std::vector<Key> evict();
+
+    public:
+        size_t budget() const;
+
+        // Returns the evicted keys.
+        std::vector<Key> setBudget(size_t value);
+
+        size_t usedBytes() const;
+
+        size_t count() const;
+
+        bool contains(const Key& key) const;
+
+        void beginFrame();
+
+        // Marks the tile as used in this frame, and returns false if it is
+        // not in the cache.
+        bool touch(const Key& key);
+
+        // Inserts (or replaces) the tile as used in this frame, and returns
+        // the evicted keys, which never include this one.
+        std::vector<Key> insert(const Key& key, size_t byteSize);
+
+        void erase(const Key& key);
+
+        void clear();
+    };
+
+    // What to draw for a viewport with the tiles in the cache, and which
+    // tiles to load.
+    struct TilePlan
+    {
+        using Key = TilePyramid::Key;
+        using Rect = TilePyramid::Rect;
+
+        // The level picked for the scale.
+        int level = 0;
+
+        struct Draw
+        {
+            Key key = {};
+
+            // In the pixels of the tile (i.e. relative to the top-left of its
+            // tileRect), which is only part of the tile when a coarser tile
+            // stands in for a missing finer one.
+            Rect source = {};
+
+            // In the level-0 pixels.
+            Rect destination = {};
+        };
+        std::vector<Draw> draws = {};
+
+        // The missing tiles in the loading order: those of the coarsest level
+        // first (so something is shown as soon as possible), and then those
+        // of the target level from the center of the viewport.
+        std::vector<Key> requests = {};
+    };
+
+    // Draws the tiles of the level picked for the scale that are in the
+    // cache, and for each missing one, the part of its nearest ancestor in
+    // the cache instead (if any).  The drawn tiles are touched.
+    TilePlan planTiles(const TilePyramid& pyramid, TileCache& cache, const TilePyramid::Rect& region, double scale);
+}
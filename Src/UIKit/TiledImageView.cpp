@@ -0,0 +1,248 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/TiledImageView.h"
+
+#include "Common/DirectXError.h"
+#include "Common/MathUtils/2D.h"
+
+#include "Renderer/GraphUtils/Bitmap.h"
+#include "Renderer/Renderer.h"
+
+#include "UIKit/BitmapUtils.h"
+#include "UIKit/PlatformUtils.h"
+
+using namespace d14engine::renderer;
+
+namespace d14engine::uikit
+{
+    TiledImageView::TiledImageView(
+        ShrdPtrParam<TileSource> source,
+        const CreateInfo& info,
+        const D2D1_RECT_F& rect)
+        :
+        Panel(rect),
+        m_source(source),
+        m_pyramid(source->width(), source->height(), info.tileSize),
+        m_cache(info.cacheBudget)
+    {
+        m_loader = std::make_unique<TileLoader>(m_source, m_pyramid, info.loaderThreadCount);
+    }
+
+    void TiledImageView::uploadLoadedTiles()
+    {
+        for (auto& tile : m_loader->takeLoaded())
+        {
+            auto bitmap = bitmap_utils::loadBitmap(tile.width, tile.height, tile.pixels.data());
+
+            for (auto& key : m_cache.insert(tile.key, tile.pixels.size()))
+            {
+                m_tileBitmaps.erase(key);
+            }
+            m_tileBitmaps[tile.key] = bitmap;
+        }
+    }
+
+    const SharedPtr<TileSource>& TiledImageView::source() const
+    {
+        return m_source;
+    }
+
+    const TilePyramid& TiledImageView::pyramid() const
+    {
+        return m_pyramid;
+    }
+
+    const TileCache& TiledImageView::cache() const
+    {
+        return m_cache;
+    }
+
+    const TilePlan& TiledImageView::plan() const
+    {
+        return m_plan;
+    }
+
+    const D2D1_POINT_2F& TiledImageView::viewOffset() const
+    {
+        return m_viewOffset;
+    }
+
+    void TiledImageView::setViewOffset(const D2D1_POINT_2F& value)
+    {
+        m_viewOffset = value;
+    }
+
+    float TiledImageView::viewScale() const
+    {
+        return m_viewScale;
+    }
+
+    void TiledImageView::setViewScale(float value)
+    {
+        m_viewScale = std::max(value, FLT_EPSILON);
+    }
+
+    void TiledImageView::zoomAbout(const D2D1_POINT_2F& point, float factor)
+    {
+        // The image pixel under the point before and after scaling.
+        float imageX = m_viewOffset.x + point.x / m_viewScale;
+        float imageY = m_viewOffset.y + point.y / m_viewScale;
+
+        setViewScale(m_viewScale * factor);
+
+        m_viewOffset.x = imageX - point.x / m_viewScale;
+        m_viewOffset.y = imageY - point.y / m_viewScale;
+    }
+
+    void TiledImageView::fitToView()
+    {
+        auto imageWidth = (float)m_pyramid.width();
+        auto imageHeight = (float)m_pyramid.height();
+
+        setViewScale(std::min(width() / imageWidth, height() / imageHeight));
+
+        m_viewOffset.x = (imageWidth - width() / m_viewScale) * 0.5f;
+        m_viewOffset.y = (imageHeight - height() / m_viewScale) * 0.5f;
+    }
+
+    void TiledImageView::onRendererUpdateObject2DHelper(Renderer* rndr)
+    {
+        Panel::onRendererUpdateObject2DHelper(rndr);
+
+        // Upload before beginFrame, so the tiles drawn in the last frame
+        // are not evicted by the new ones.
+        uploadLoadedTiles();
+
+        m_cache.beginFrame();
+
+        TilePyramid::Rect region =
+        {
+            m_viewOffset.x, m_viewOffset.y,
+            m_viewOffset.x + width() / m_viewScale,
+            m_viewOffset.y + height() / m_viewScale
+        };
+        double scale = m_viewScale * platform_utils::dpi() / 96.0;
+
+        m_plan = planTiles(m_pyramid, m_cache, region, scale);
+
+        m_loader->request(m_plan.requests);
+
+        // Keep rendering to show the tiles as soon as they are loaded.
+        if (m_loader->idle()) decreaseAnimationCount();
+        else increaseAnimationCount();
+    }
+
+    void TiledImageView::onRendererDrawD2d1ObjectHelper(Renderer* rndr)
+    {
+        Panel::onRendererDrawD2d1ObjectHelper(rndr);
+
+        auto context = rndr->d2d1DeviceContext();
+
+        context->PushAxisAlignedClip(m_absoluteRect, D2D1_ANTIALIAS_MODE_ALIASED);
+
+        for (auto& draw : m_plan.draws)
+        {
+            auto bitmapItor = m_tileBitmaps.find(draw.key);
+            if (bitmapItor == m_tileBitmaps.end()) continue;
+
+            auto& dst = draw.destination;
+            D2D1_RECT_F destination =
+            {
+                m_absoluteRect.left + (float)((dst.left - m_viewOffset.x) * m_viewScale),
+                m_absoluteRect.top + (float)((dst.top - m_viewOffset.y) * m_viewScale),
+                m_absoluteRect.left + (float)((dst.right - m_viewOffset.x) * m_viewScale),
+                m_absoluteRect.top + (float)((dst.bottom - m_viewOffset.y) * m_viewScale)
+            };
+            auto& src = draw.source;
+            D2D1_RECT_F source =
+            {
+                (float)src.left, (float)src.top, (float)src.right, (float)src.bottom
+            };
+            // Round the edges (instead of the sizes) so that the adjacent
+            // tiles never leave any seam between them.
+            context->DrawBitmap(
+                bitmapItor->second.Get(), math_utils::roundf(destination),
+                tileOpacity, interpolationMode, &source);
+        }
+        context->PopAxisAlignedClip();
+    }
+
+    WicTileSource::WicTileSource(WstrParam imagePath)
+    {
+        auto factory = graph_utils::bitmap::factory();
+
+        ComPtr<IWICBitmapDecoder> decoder;
+        THROW_IF_FAILED(factory->CreateDecoderFromFilename(
+            imagePath.c_str(),
+            nullptr,
+            GENERIC_READ,
+            WICDecodeMetadataCacheOnDemand,
+            &decoder));
+
+        THROW_IF_FAILED(decoder->GetFrame(0, &m_frame));
+
+        THROW_IF_FAILED(m_frame->GetSize(&m_width, &m_height));
+    }
+
+    int WicTileSource::width() const
+    {
+        return (int)m_width;
+    }
+
+    int WicTileSource::height() const
+    {
+        return (int)m_height;
+    }
+
+    bool WicTileSource::readTile(const TilePyramid& pyramid, const TilePyramid::Key& key, std::vector<uint8_t>& pixels)
+    {
+        auto factory = graph_utils::bitmap::factory();
+
+        if (m_levels.size() < (size_t)pyramid.levelCount())
+        {
+            m_levels.resize(pyramid.levelCount());
+        }
+        auto& level = m_levels[key.level];
+        if (!level)
+        {
+            ComPtr<IWICBitmapSource> scaled = m_frame;
+            if (key.level > 0)
+            {
+                ComPtr<IWICBitmapScaler> scaler;
+                THROW_IF_FAILED(factory->CreateBitmapScaler(&scaler));
+
+                THROW_IF_FAILED(scaler->Initialize(
+                    m_frame.Get(),
+                    pyramid.levelWidth(key.level),
+                    pyramid.levelHeight(key.level),
+                    WICBitmapInterpolationModeFant));
+
+                scaled = scaler;
+            }
+            ComPtr<IWICFormatConverter> converter;
+            THROW_IF_FAILED(factory->CreateFormatConverter(&converter));
+
+            THROW_IF_FAILED(converter->Initialize(
+                scaled.Get(),
+                GUID_WICPixelFormat32bppPRGBA,
+                WICBitmapDitherTypeNone,
+                nullptr,
+                0.0f,
+                WICBitmapPaletteTypeCustom));
+
+            level = converter;
+        }
+        auto rect = pyramid.tileRect(key);
+
+        WICRect wicRect = {};
+        wicRect.X = (INT)rect.left;
+        wicRect.Y = (INT)rect.top;
+        wicRect.Width = (INT)(rect.right - rect.left);
+        wicRect.Height = (INT)(rect.bottom - rect.top);
+
+        UINT stride = 4 * wicRect.Width;
+        pixels.resize((size_t)stride * wicRect.Height);
+
+        return SUCCEEDED(level->CopyPixels(&wicRect, stride, (UINT)pixels.size(), pixels.data()));
+    }
+}
@@ -0,0 +1,119 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include "UIKit/Panel.h"
+#include "UIKit/TileLoader.h"
+#include "UIKit/TiledImageModel.h"
+
+namespace d14engine::uikit
+{
+    // Shows a (possibly huge) image by the tiles of its mip pyramid, where
+    // only the tiles that intersect the viewport at the level picked for the
+    // current scale are loaded (asynchronously by TileLoader) and kept in a
+    // byte-budgeted LRU (TileCache).  The coarser tiles in the cache stand in
+    // for the finer ones being loaded, so zooming/panning only shows blurry
+    // areas instead of blank ones once the coarsest level is loaded.
+    //
+    // Unlike Panel::bitmap (drawn with BitmapObject::g_interpolationMode,
+    // e.g. HIGH_QUALITY_CUBIC), the tiles are drawn with linear sampling by
+    // default since the picked level is never more than 2x larger than the
+    // device pixels.
+    struct TiledImageView : Panel
+    {
+        struct CreateInfo
+        {
+            int tileSize = 256;
+
+            // The bytes of the tile bitmaps (4 bytes per pixel).
+            size_t cacheBudget = 256 * 1024 * 1024;
+
+            size_t loaderThreadCount = 1;
+        };
+
+        explicit TiledImageView(
+            ShrdPtrParam<TileSource> source,
+            const CreateInfo& info = {},
+            const D2D1_RECT_F& rect = {});
+
+    protected:
+        SharedPtr<TileSource> m_source = {};
+
+        TilePyramid m_pyramid;
+
+        TileCache m_cache;
+
+        UniquePtr<TileLoader> m_loader = {};
+
+        std::unordered_map<TilePyramid::Key, ComPtr<ID2D1Bitmap1>, TilePyramid::KeyHash> m_tileBitmaps = {};
+
+        // Planned when updating and drawn in the same frame.
+        TilePlan m_plan = {};
+
+        // Creates the bitmaps of the loaded tiles and drops the evicted ones.
+        void uploadLoadedTiles();
+
+    public:
+        const SharedPtr<TileSource>& source() const;
+
+        const TilePyramid& pyramid() const;
+
+        const TileCache& cache() const;
+
+        const TilePlan& plan() const;
+
+    protected:
+        // The image pixel at the top-left of the view.
+        D2D1_POINT_2F m_viewOffset = { 0.0f, 0.0f };
+
+        // The DIPs per image pixel.
+        float m_viewScale = 1.0f;
+
+    public:
+        const D2D1_POINT_2F& viewOffset() const;
+        void setViewOffset(const D2D1_POINT_2F& value);
+
+        float viewScale() const;
+        void setViewScale(float value);
+
+        // Scales the view by the factor while keeping the image pixel under
+        // the point (in the self coordinate) still, e.g. for wheel zooming.
+        void zoomAbout(const D2D1_POINT_2F& point, float factor);
+
+        // Shows the whole image at the center of the view.
+        void fitToView();
+
+        float tileOpacity = 1.0f;
+
+        D2D1_INTERPOLATION_MODE interpolationMode = D2D1_INTERPOLATION_MODE_LINEAR;
+
+    protected:
+        // Panel
+        void onRendererUpdateObject2DHelper(renderer::Renderer* rndr) override;
+
+        void onRendererDrawD2d1ObjectHelper(renderer::Renderer* rndr) override;
+    };
+
+    // Reads the tiles of an image file with WIC, where each level is scaled
+    // from the frame by IWICBitmapScaler, which decodes at the reduced size
+    // directly for the codecs supporting IWICBitmapSourceTransform (e.g.
+    // JPEG), so the coarse levels never decode the full resolution.
+    struct WicTileSource : TileSource
+    {
+        explicit WicTileSource(WstrParam imagePath);
+
+    protected:
+        ComPtr<IWICBitmapFrameDecode> m_frame = {};
+
+        UINT m_width = 0, m_height = 0;
+
+        // The scaled and converted (32bppPRGBA) frame of each level.
+        std::vector<ComPtr<IWICBitmapSource>> m_levels = {};
+
+    public:
+        int width() const override;
+        int height() const override;
+
+        bool readTile(const TilePyramid& pyramid, const TilePyramid::Key& key, std::vector<uint8_t>& pixels) override;
+    };
+}
@@ -23,7 +23,7 @@ namespace d14engine::uikit
                 {
                     for (auto& item : m_rootItems)
                     {
-                        if (cpp_lang_utils::isMostDerivedEqual(uiobj, item))
+                        if (isSameUIObject(uiobj, item))
                         {
                             removeRootItem(index);
                             return true;
@@ -36,7 +36,7 @@ namespace d14engine::uikit
                     auto itemobjParent = itemobj->parentItem().lock();
                     for (auto& item : itemobjParent->childrenItems())
                     {
-                        if (cpp_lang_utils::isMostDerivedEqual(uiobj, item.ptr))
+                        if (isSameUIObject(uiobj, item.ptr))
                         {
                             itemobjParent->removeItem(index);
                             return true;
@@ -170,6 +170,7 @@ namespace d14engine::uikit
                     (*itemIndex)->appEventReactability.hitTest = false;
                 }
             }
+            HitTestCache::invalidateAll();
         }
     }
 
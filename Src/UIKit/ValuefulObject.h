@@ -2,6 +2,8 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
+
 namespace d14engine::uikit
 {
     template<typename Value_T>
@@ -22,7 +24,7 @@ namespace d14engine::uikit
             if (f_onValueChange) f_onValueChange(this, value);
         }
 
-        Function<void(ValuefulObject*, Value_T)> f_onValueChange = {};
+        cpp_lang_utils::LazyFunction<void(ValuefulObject*, Value_T)> f_onValueChange = {};
 
     protected:
         virtual void onValueChangeHelper(Value_T value) { }
@@ -3,9 +3,10 @@
 #include "Common/Precompile.h"
 
 #include "Common/CppLangUtils/IndexIterator.h"
-#include "Common/CppLangUtils/PointerEquality.h"
+#include "Common/CppLangUtils/LazyFunction.h"
 
 #include "UIKit/ConstraintLayout.h"
+#include "UIKit/ItemExtentModel.h"
 #include "UIKit/ScrollView.h"
 #include "UIKit/ViewItem.h"
 
@@ -36,7 +37,7 @@ namespace d14engine::uikit
                 size_t index = 0;
                 for (auto& item : m_items)
                 {
-                    if (cpp_lang_utils::isMostDerivedEqual(uiobj, item))
+                    if (isSameUIObject(uiobj, item))
                         { removeItem(index); return true; } ++index;
                 }
                 return false;
@@ -66,7 +67,7 @@ namespace d14engine::uikit
 
             if (f_onSelectChange) f_onSelectChange(this, selected);
         }
-        Function<void(WaterfallView*, const ItemIndexSet&)> f_onSelectChange = {};
+        cpp_lang_utils::LazyFunction<void(WaterfallView*, const ItemIndexSet&)> f_onSelectChange = {};
 
     protected:
         virtual void onSelectChangeHelper(const ItemIndexSet& selected) { }
@@ -90,24 +91,31 @@ namespace d14engine::uikit
         {
             // "index == m_items.size()" ---> append
             index = std::clamp(index, 0ull, m_items.size());
-            
-            float height = 0.0f;
-            for (auto& item : items)
+
+            auto anchor = captureScrollAnchor();
+
+            if (m_itemExtents.estimatedExtent() > 0.0f)
             {
-                height += item->height();
+                m_itemExtents.insert(index, items.size());
             }
-            m_layout->resize(width(), m_layout->height() + height);
-
-            auto itemIndex = ItemIndex::begin(&m_items);
+            else // measured with the current heights
+            {
+                std::vector<float> heights = {};
+                heights.reserve(items.size());
 
-            float offset = 0.0f;
-            // Lower Items
-            for (; itemIndex < index; ++itemIndex)
+                for (auto& item : items)
+                {
+                    heights.push_back(item->height());
+                }
+                m_itemExtents.insert(index, heights);
+            }
+            if (anchor.has_value() && anchor->index >= index)
             {
-                offset += (*itemIndex)->height();
+                anchor->index += items.size();
             }
-            ItemIndex insertStartIndex = itemIndex;
-            // New Items
+            ItemIndex insertStartIndex = itemIndexAt(index);
+
+            size_t newItemIndex = index;
             for (auto& item : items)
             {
                 item->setVisible(false);
@@ -118,23 +126,12 @@ namespace d14engine::uikit
                 info.keepWidth = false;
                 info.Left.ToLeft = 0.0f;
                 info.Right.ToRight = 0.0f;
-                info.Top.ToTop = offset;
+                info.Top.ToTop = m_itemExtents.offset(newItemIndex++);
 
                 m_layout->addElement(item, info);
-
-                offset += item->height();
-            }
-            // Higher Items
-            for (; itemIndex < m_items.size(); ++itemIndex)
-            {
-                auto elemItor = m_layout->findElement(*itemIndex);
-                if (elemItor.has_value())
-                {
-                    elemItor.value()->second.Top.ToTop = offset;
-                    m_layout->updateElement(elemItor.value());
-                }
-                offset += (*itemIndex)->height();
             }
+            // The higher items are not moved here but when they become
+            // visible, see updateItemIndexRangeActivity.
             m_items.insert(insertStartIndex.iterator, items.begin(), items.end());
 
             ItemIndexSet updatedItemIndexSet = {};
@@ -167,6 +164,8 @@ do { \
 
 #undef UPDATE_ITEM_INDEX
 
+            updateContentHeight(anchor);
+
             updateItemIndexRangeActivity();
         }
 
@@ -177,39 +176,32 @@ do { \
                 count = std::min(count, m_items.size() - index);
                 size_t endIndex = index + count;
 
-                float height = 0.0f;
-                for (ItemIndex itemIndex = { &m_items, index }; itemIndex < endIndex; ++itemIndex)
-                {
-                    height += (*itemIndex)->height();
-                }
-                m_layout->resize(width(), m_layout->height() - height);
+                auto anchor = captureScrollAnchor();
 
-                auto itemIndex = ItemIndex::begin(&m_items);
+                m_itemExtents.erase(index, count);
 
-                float offset = 0.0f;
-                // Lower Items
-                for (; itemIndex < index; ++itemIndex)
+                if (anchor.has_value())
                 {
-                    offset += (*itemIndex)->height();
+                    if (anchor->index >= endIndex)
+                    {
+                        anchor->index -= count;
+                    }
+                    else if (anchor->index >= index) // anchor removed
+                    {
+                        anchor = ScrollAnchor{ index, 0.0f };
+                    }
                 }
+                auto itemIndex = itemIndexAt(index);
+
                 ItemIndex eraseStartIndex = itemIndex;
-                // Old Items
                 for (; itemIndex < endIndex; ++itemIndex)
                 {
                     m_layout->removeElement(*itemIndex);
                 }
                 ItemIndex eraseEndIndex = itemIndex;
-                // Higher Items
-                for (; itemIndex < m_items.size(); ++itemIndex)
-                {
-                    auto elemItor = m_layout->findElement(*itemIndex);
-                    if (elemItor.has_value())
-                    {
-                        elemItor.value()->second.Top.ToTop = offset;
-                        m_layout->updateElement(elemItor.value());
-                    }
-                    offset += (*itemIndex)->height();
-                }
+
+                // The higher items are not moved here but when they become
+                // visible, see updateItemIndexRangeActivity.
                 m_items.erase(eraseStartIndex.iterator, eraseEndIndex.iterator);
 
                 ItemIndexSet updatedItemIndexSet = {};
@@ -275,6 +267,8 @@ do { \
                         m_activeItemIndexRange.last = eraseEndIndex.getIndexPrev(count + 1);
                     }
                 }
+                updateContentHeight(anchor);
+
                 updateItemIndexRangeActivity();
             }
         }
@@ -285,6 +279,7 @@ do { \
             m_layout->resize(m_layout->width(), 0.0f);
 
             m_items.clear();
+            m_itemExtents.clear();
 
             m_extendedSelectItemIndexOrigin.invalidate();
             m_lastSelectedItemIndex.invalidate();
@@ -298,41 +293,148 @@ do { \
         SharedPtr<ConstraintLayout> m_layout = {};
 
     public:
+        // Keeps the first visible item at the same position in the viewport
+        // when the items above it are inserted, removed or resized (e.g. the
+        // estimated heights are refined), so the content does not jump.
+        // Disabled when the viewport is at the very top.
+        bool scrollAnchoring = true;
+
+    protected:
+        struct ScrollAnchor
+        {
+            size_t index = 0;
+
+            // The distance from the top of the item to the viewport.
+            float delta = 0.0f;
+        };
+
+        Optional<ScrollAnchor> captureScrollAnchor() const
+        {
+            if (!scrollAnchoring || m_viewportOffset.y <= 0.0f) return std::nullopt;
+
+            size_t index = m_itemExtents.indexAt(m_viewportOffset.y);
+            if (index >= m_itemExtents.count()) return std::nullopt;
+
+            return ScrollAnchor{ index, m_viewportOffset.y - m_itemExtents.offset(index) };
+        }
+
+        void restoreScrollAnchor(const Optional<ScrollAnchor>& anchor)
+        {
+            if (anchor.has_value() && anchor->index < m_itemExtents.count())
+            {
+                setViewportOffset(
+                {
+                    m_viewportOffset.x,
+                    m_itemExtents.offset(anchor->index) + anchor->delta
+                });
+            }
+        }
+
+    protected:
+        // The heights of the items, from which the item offsets and the
+        // content height are queried in O(log n).
+        ItemExtentModel m_itemExtents = {};
+
+        void updateContentHeight(const Optional<ScrollAnchor>& anchor)
+        {
+            m_layout->resize(width(), m_itemExtents.totalExtent());
+
+            restoreScrollAnchor(anchor);
+        }
+
+    public:
+        // If positive, the inserted items are considered unmeasured and take
+        // this height until they are displayed the first time, when their
+        // actual heights are read and the content height is refined, which
+        // allows inserting lots of items whose heights are not known yet.
+        float estimatedItemHeight() const
+        {
+            return m_itemExtents.estimatedExtent();
+        }
+        void setEstimatedItemHeight(float value)
+        {
+            auto anchor = captureScrollAnchor();
+
+            m_itemExtents.setEstimatedExtent(value);
+
+            updateContentHeight(anchor);
+
+            updateItemIndexRangeActivity();
+        }
+
+        // Call this after resizing any items.
         void updateItemConstraints()
         {
-            float offset = 0.0f;
-            for (auto& item : m_items)
+            updateItemConstraints(0, m_items.size());
+        }
+
+        // Only re-reads the heights of the specified items (if measured).
+        void updateItemConstraints(size_t index, size_t count)
+        {
+            auto anchor = captureScrollAnchor();
+
+            size_t endIndex = std::min(index + count, m_items.size());
+
+            for (auto itemIndex = itemIndexAt(index); itemIndex < endIndex; ++itemIndex)
             {
-                auto elemItor = m_layout->findElement(item);
-                if (elemItor.has_value())
+                auto height = (*itemIndex)->height();
+
+                if (m_itemExtents.isMeasured(itemIndex.index) &&
+                    m_itemExtents.extent(itemIndex.index) != height)
                 {
-                    elemItor.value()->second.Top.ToTop = offset;
-                    m_layout->updateElement(elemItor.value());
+                    m_itemExtents.setExtent(itemIndex.index, height);
                 }
-                offset += item->height();
             }
-            m_layout->resize(width(), offset);
+            updateContentHeight(anchor);
+
+            updateItemIndexRangeActivity();
         }
 
     protected:
         using ItemIndexParam = const ItemIndex&;
 
-        ItemIndex viewportOffsetToItemIndex(float offset) const
+        ItemIndex itemIndexAt(size_t index) const
         {
-            float itemHeight = 0.0f;
-            for (ItemIndex itemIndex = { (ItemList*)&m_items, 0}; itemIndex.valid(); ++itemIndex)
+            auto pList = (ItemList*)&m_items;
+
+            if (index >= m_items.size()) return ItemIndex::end(pList);
+
+            // Walk from the nearest known position, since the visible range
+            // usually moves only a few items at a time.
+            size_t fromEnd = m_items.size() - index;
+
+            auto& hint = m_activeItemIndexRange.first;
+            if (hint.valid())
             {
-                // Do not use "itemHeight < offset" since it might cause the
-                // unexpected capture failure when the cursor-point is right
-                // on the edge of an item.
-                if (itemHeight <= offset)
+                size_t distance = index > hint.index ? index - hint.index : hint.index - index;
+                if (distance < index && distance < fromEnd)
                 {
-                    itemHeight += (*itemIndex)->height();
-                    if (itemHeight > offset) return itemIndex;
+                    if (index > hint.index)
+                    {
+                        return hint.getNext(distance);
+                    }
+                    else return hint.getPrev(distance);
                 }
-                else break;
             }
-            return ItemIndex{};
+            if (index <= fromEnd)
+            {
+                return ItemIndex{ pList, index };
+            }
+            else return ItemIndex::end(pList).getPrev(fromEnd);
+        }
+
+        ItemIndex viewportOffsetToItemIndex(float offset) const
+        {
+            // The item on the edge belongs to the lower one, i.e. the range
+            // of each item is [top, bottom), and the zero-height items (e.g.
+            // the folded tree view items) are never captured.
+            size_t index = m_itemExtents.indexAt(offset);
+
+            if (index < m_items.size())
+            {
+                return itemIndexAt(index);
+            }
+            else return ItemIndex{};
         }
 
     public:
@@ -457,14 +559,75 @@ do { \
                     (*itemIndex)->setVisible(value);
                     (*itemIndex)->appEventReactability.hitTest = value;
                 }
+                HitTestCache::invalidateAll();
+            }
+        }
+
+        bool m_isUpdatingItemIndexRange = false;
+
+        // Reads the actual heights of the unmeasured items in the viewport,
+        // and returns whether any of them has been measured.  All of them are
+        // below the first visible item, so the anchor needs no adjustment.
+        bool measureVisibleItems()
+        {
+            size_t first = m_itemExtents.indexAt(m_viewportOffset.y);
+            size_t last = m_itemExtents.indexAt(m_viewportOffset.y + height());
+
+            if (first >= m_items.size()) return false;
+
+            last = std::min(last, m_items.size() - 1);
+
+            bool measured = false;
+            for (auto itemIndex = itemIndexAt(first); itemIndex <= last; ++itemIndex)
+            {
+                if (!m_itemExtents.isMeasured(itemIndex.index))
+                {
+                    m_itemExtents.setExtent(itemIndex.index, (*itemIndex)->height());
+                    measured = true;
+                }
+            }
+            return measured;
+        }
+
+        // Moves the items of the active range to where they should be, since
+        // the other items are not moved when inserting/removing/resizing.
+        void updateItemIndexRangePositions()
+        {
+            auto& range = m_activeItemIndexRange;
+
+            if (range.first.valid() && range.last.valid())
+            {
+                float offset = m_itemExtents.offset(range.first.index);
+
+                for (auto itemIndex = range.first; itemIndex <= range.last; ++itemIndex)
+                {
+                    auto elemItor = m_layout->findElement(*itemIndex);
+                    if (elemItor.has_value() && elemItor.value()->second.Top.ToTop != offset)
+                    {
+                        elemItor.value()->second.Top.ToTop = offset;
+                        m_layout->updateElement(elemItor.value());
+                    }
+                    offset += m_itemExtents.extent(itemIndex.index);
+                }
             }
         }
 
     public:
         void updateItemIndexRangeActivity()
         {
+            // Resizing the layout below triggers this again.
+            if (m_isUpdatingItemIndexRange) return;
+
+            m_isUpdatingItemIndexRange = true;
+
             setItemIndexRangeActive(false);
 
+            // Measuring may change the visible range, so repeat until it is
+            // stable, which usually takes only 1 or 2 passes.
+            for (int pass = 0; pass < 4 && measureVisibleItems(); ++pass)
+            {
+                m_layout->resize(width(), m_itemExtents.totalExtent());
+            }
             m_activeItemIndexRange.first = viewportOffsetToItemIndex
             (
                 m_viewportOffset.y
@@ -477,7 +640,11 @@ do { \
             {
                 m_activeItemIndexRange.last = ItemIndex::last(&m_items);
             }
+            updateItemIndexRangePositions();
+
             setItemIndexRangeActive(true);
+
+            m_isUpdatingItemIndexRange = false;
         }
 
     protected:
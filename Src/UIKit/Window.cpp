@@ -414,7 +414,7 @@ namespace d14engine::uikit
                     auto caption = makeUIObject<TabCaption>(m_caption);
                     caption->promotable = true;
 
-                    tabGroup->insertTab({ caption, m_centerUIObject });
+                    tabGroup->insertTab({ caption, m_centerUIObject, tabLifecycle });
                     tabGroup->selectTab(0);
 
                     if (f_onTriggerTabDemoting) f_onTriggerTabDemoting(this, tabGroup.get());
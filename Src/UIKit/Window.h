@@ -2,6 +2,8 @@
 
 #include "Common/Precompile.h"
 
+#include "Common/CppLangUtils/LazyFunction.h"
+
 #include "UIKit/Appearances/Window.h"
 #include "UIKit/DraggablePanel.h"
 #include "UIKit/MaskStyle.h"
@@ -12,6 +14,7 @@ namespace d14engine::uikit
 {
     struct IconLabel;
     struct TabGroup;
+    struct TabLifecycle;
 
     struct Window : appearance::Window, DraggablePanel, ResizablePanel
     {
@@ -47,19 +50,19 @@ namespace d14engine::uikit
     public:
         void onMinimize();
 
-        Function<void(Window*)> f_onMinimize = {};
+        cpp_lang_utils::LazyFunction<void(Window*)> f_onMinimize = {};
 
         void onMaximize();
 
-        Function<void(Window*)> f_onMaximize = {};
+        cpp_lang_utils::LazyFunction<void(Window*)> f_onMaximize = {};
 
         void onRestore();
 
-        Function<void(Window*)> f_onRestore = {};
+        cpp_lang_utils::LazyFunction<void(Window*)> f_onRestore = {};
 
         void onClose();
 
-        Function<void(Window*)> f_onClose = {};
+        cpp_lang_utils::LazyFunction<void(Window*)> f_onClose = {};
 
     protected:
         virtual void onMinimizeHelper();
@@ -192,7 +195,7 @@ namespace d14engine::uikit
         void unregisterTabGroup(WeakPtrParam<TabGroup> tg);
 
     public:
-        Function<void(Window*, TabGroup*)> f_onTriggerTabDemoting = {};
+        cpp_lang_utils::LazyFunction<void(Window*, TabGroup*)> f_onTriggerTabDemoting = {};
 
         // When a window is being dragged, all of the tab-groups that have
         // been registered for the window will be associated with it, and if
@@ -202,6 +205,10 @@ namespace d14engine::uikit
 
         WeakPtr<TabGroup> associatedTabGroup = {};
 
+        // The lifecycle hooks of the tab that was promoted to this window,
+        // which are given back to the tab when the window is demoted.
+        SharedPtr<TabLifecycle> tabLifecycle = {};
+
     protected:
         void handleMouseMoveForRegisteredTabGroups(MouseMoveEvent& e);
         void handleMouseButtonForRegisteredTabGroups(MouseButtonEvent& e);
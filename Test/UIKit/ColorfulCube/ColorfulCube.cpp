@@ -247,7 +247,7 @@ D14_SET_APP_ENTRY(mainColorfulCube)
 
         auto wanderCoef = std::make_shared<XMFLOAT3>(XMFLOAT3{ 0.0f, 0.0f, 0.0f });
 
-        auto camera = std::make_shared<Camera>(device);
+        auto camera = std::make_shared<Camera>();
         {
             camera->eyePos = { -2.0f, +2.0f, -2.0f };
             camera->eyeDir = { +1.0f, -1.0f, +1.0f };
@@ -163,12 +163,22 @@ D14_SET_APP_ENTRY(mainImageViewer)
 #else
         Wstring assetsPath = L""; // same path with the executable
 #endif
-        std::vector<std::pair<Wstring, ComPtr<ID2D1Bitmap1>>> images;
+        struct ImageAsset
+        {
+            Wstring name = {};
+            ComPtr<ID2D1Bitmap1> bitmap = {};
+            // Shared by all the tabs of the image.
+            bitmap_utils::MipLevels mipLevels = {};
+        };
+        std::vector<ImageAsset> images;
         file_system_utils::foreachFileInDir(assetsPath, L"*.png", [&](WstrParam filePath)
         {
             auto fileName = file_system_utils::extractFileName(filePath);
             auto filePrefix = file_system_utils::extractFilePrefix(fileName);
-            images.push_back({ filePrefix, bitmap_utils::loadBitmap(filePath) });
+
+            ImageAsset image = { filePrefix };
+            image.bitmap = bitmap_utils::loadBitmap(filePath, image.mipLevels);
+            images.push_back(std::move(image));
             return false;
         });
         auto ui_insertButton = makeUIObject<FilledButton>(L"Create new image tab");
@@ -190,11 +200,12 @@ D14_SET_APP_ENTRY(mainImageViewer)
                     auto sh_tabGroup = wk_tabGroup.lock();
                     int index = rand() % (int)images.size();
 
-                    auto caption = makeUIObject<TabCaption>(images[index].first);
+                    auto caption = makeUIObject<TabCaption>(images[index].name);
                     caption->title()->label()->setTextFormat(D14_FONT(L"Default/Normal/12"));
 
-                    auto imageRect = math_utils::sizeOnlyRect(images[index].second->GetSize());
-                    auto content = makeUIObject<Panel>(imageRect, nullptr, images[index].second);
+                    auto imageRect = math_utils::sizeOnlyRect(images[index].bitmap->GetSize());
+                    auto content = makeUIObject<Panel>(imageRect, nullptr, images[index].bitmap);
+                    content->bitmapMipLevels = images[index].mipLevels;
                     auto wrapper = makeUIObject<ScrollView>(content);
 
                     size_t currTabIndex = sh_tabGroup->currActiveCardTabIndex().index;
@@ -0,0 +1,284 @@
+﻿#include "Common/Precompile.h"
+
+// The same layout as the one in d2d1.h (typedef of D3DCOLORVALUE), which is
+// all that the color utilities need from Direct2D.
+struct D2D1_COLOR_F { float r, g, b, a; };
+
+#include "UIKit/Appearances/Appearance.h"
+#include "UIKit/ColorUtils.h"
+
+#include "UnitTest.h"
+
+using namespace d14engine;
+using namespace d14engine::uikit;
+using namespace d14engine::uikit::appearance;
+using namespace d14engine::uikit::color_utils;
+
+namespace
+{
+    // The runtime implementation before the conversions became constexpr,
+    // i.e. ColorUtils.cpp and ColorGroup::generateTonedColors as they were.
+    namespace previous
+    {
+        iRGB convert(const D2D1_COLOR_F& rgb)
+        {
+            return
+            {
+                std::clamp((int)std::round(rgb.r * 255.0f), 0, 255),
+                std::clamp((int)std::round(rgb.g * 255.0f), 0, 255),
+                std::clamp((int)std::round(rgb.b * 255.0f), 0, 255)
+            };
+        }
+
+        D2D1_COLOR_F convert(const iRGB& rgb)
+        {
+            fRGB _rgb = {};
+            _rgb.R = std::clamp((float)rgb.R / 255.0f, 0.0f, 1.0f);
+            _rgb.G = std::clamp((float)rgb.G / 255.0f, 0.0f, 1.0f);
+            _rgb.B = std::clamp((float)rgb.B / 255.0f, 0.0f, 1.0f);
+
+            return { _rgb.R, _rgb.G, _rgb.B, 1.0f };
+        }
+
+        iHSB rgb2hsb(const iRGB& rgb)
+        {
+            iHSB hsb = {};
+
+            fRGB _rgb = {};
+            fHSB _hsb = {};
+
+            _rgb.R = std::clamp((float)rgb.R, 0.0f, 255.0f);
+            _rgb.G = std::clamp((float)rgb.G, 0.0f, 255.0f);
+            _rgb.B = std::clamp((float)rgb.B, 0.0f, 255.0f);
+
+            auto minmax = std::minmax({ _rgb.R, _rgb.G, _rgb.B });
+            auto& min = minmax.first;
+            auto& max = minmax.second;
+
+            if (min == max) _hsb.H = 0.0f;
+            else if (max == _rgb.R)
+            {
+                if (_rgb.G >= _rgb.B)
+                {
+                    _hsb.H = 60.0f * (_rgb.G - _rgb.B) / (max - min);
+                }
+                else _hsb.H = 60.0f * (_rgb.G - _rgb.B) / (max - min) + 360.0f;
+            }
+            else if (max == _rgb.G)
+            {
+                _hsb.H = 60.0f * (_rgb.B - _rgb.R) / (max - min) + 120.0f;
+            }
+            else if (max == _rgb.B)
+            {
+                _hsb.H = 60.0f * (_rgb.R - _rgb.G) / (max - min) + 240.0f;
+            }
+            hsb.H = std::clamp((int)std::round(_hsb.H), 0, 360);
+
+            if (max == 0.0f) _hsb.S = 0.0f;
+            else _hsb.S = 100.0f * (max - min) / max;
+
+            hsb.S = std::clamp((int)std::round(_hsb.S), 0, 100);
+
+            hsb.B = std::clamp((int)std::round(100.0f * max / 255.0f), 0, 100);
+
+            return hsb;
+        }
+
+        iRGB hsb2rgb(const iHSB& hsb)
+        {
+            iRGB rgb = {};
+
+            fRGB _rgb = {};
+            fHSB _hsb = {};
+
+            _hsb.H = std::clamp((float)hsb.H, 0.0f, 360.0f);
+            _hsb.S = std::clamp((float)hsb.S / 100.0f, 0.0f, 1.0f);
+            _hsb.B = std::clamp((float)hsb.B / 100.0f, 0.0f, 1.0f);
+
+            auto N = _hsb.H / 60.0f;
+            auto I = (int)N % 6;
+            auto F = (N - I);
+            auto P = _hsb.B * (1.0f - _hsb.S);
+            auto Q = _hsb.B * (1.0f - F * _hsb.S);
+            auto T = _hsb.B * (1.0f - (1.0f - F) * _hsb.S);
+
+            switch (I)
+            {
+            case 0: _rgb = { _hsb.B, T, P }; break;
+            case 1: _rgb = { Q, _hsb.B, P }; break;
+            case 2: _rgb = { P, _hsb.B, T }; break;
+            case 3: _rgb = { P, Q, _hsb.B }; break;
+            case 4: _rgb = { T, P, _hsb.B }; break;
+            case 5: _rgb = { _hsb.B, P, Q }; break;
+            default: break;
+            }
+            rgb.R = std::clamp((int)std::round(_rgb.R * 255.0f), 0, 255);
+            rgb.G = std::clamp((int)std::round(_rgb.G * 255.0f), 0, 255);
+            rgb.B = std::clamp((int)std::round(_rgb.B * 255.0f), 0, 255);
+
+            return rgb;
+        }
+
+        ColorGroup generateTonedColors(const D2D1_COLOR_F& accent, bool light)
+        {
+            iHSB hsb = previous::rgb2hsb(previous::convert(accent));
+            iHSB primary = hsb, secondary = hsb, tertiary = hsb;
+
+            if (light)
+            {
+                primary.S = 100;
+                secondary.S = 85;
+                tertiary.S = 70;
+                primary.B = 70;
+                secondary.B = 75;
+                tertiary.B = 80;
+            }
+            else // dark
+            {
+                primary.S = 50;
+                secondary.S = 50;
+                tertiary.S = 50;
+                primary.B = 90;
+                secondary.B = 85;
+                tertiary.B = 80;
+            }
+            return
+            {
+                previous::convert(previous::hsb2rgb(primary)),
+                previous::convert(previous::hsb2rgb(secondary)),
+                previous::convert(previous::hsb2rgb(tertiary))
+            };
+        }
+    }
+
+    bool isSame(const iRGB& lhs, const iRGB& rhs)
+    {
+        return lhs.R == rhs.R && lhs.G == rhs.G && lhs.B == rhs.B;
+    }
+
+    bool isSame(const iHSB& lhs, const iHSB& rhs)
+    {
+        return lhs.H == rhs.H && lhs.S == rhs.S && lhs.B == rhs.B;
+    }
+
+    bool isSame(const D2D1_COLOR_F& lhs, const D2D1_COLOR_F& rhs)
+    {
+        return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b && lhs.a == rhs.a;
+    }
+
+    bool isSame(const ColorGroup& lhs, const ColorGroup& rhs)
+    {
+        return isSame(lhs.primary, rhs.primary) &&
+            isSame(lhs.secondary, rhs.secondary) && isSame(lhs.tertiary, rhs.tertiary);
+    }
+
+    // What Application reads from the system (see systemThemeStyle).
+    constexpr D2D1_COLOR_F accentColor(uint32_t rgb)
+    {
+        return { ((rgb >> 16) & 0xff) / 255.0f, ((rgb >> 8) & 0xff) / 255.0f, (rgb & 0xff) / 255.0f, 1.0f };
+    }
+
+    void testConversions()
+    {
+        // Every RGB triple.
+        bool isSameRgb2Hsb = true, isSameConvert = true;
+        for (uint32_t rgb = 0; rgb < (1u << 24); ++rgb)
+        {
+            iRGB color = { (int)(rgb >> 16), (int)((rgb >> 8) & 0xff), (int)(rgb & 0xff) };
+
+            isSameRgb2Hsb = isSameRgb2Hsb && isSame(rgb2hsb(color), previous::rgb2hsb(color));
+
+            auto accent = accentColor(rgb);
+            isSameConvert = isSameConvert &&
+                isSame(convert(accent), previous::convert(accent)) &&
+                isSame(convert(color), previous::convert(color));
+        }
+        D14_CHECK(isSameRgb2Hsb);
+        D14_CHECK(isSameConvert);
+
+        // Every HSB triple, and some out of the range to be clamped.
+        bool isSameHsb2Rgb = true;
+        for (int h = -1; h <= 361; ++h)
+        {
+            for (int s = -1; s <= 101; ++s)
+            {
+                for (int b = -1; b <= 101; ++b)
+                {
+                    isSameHsb2Rgb = isSameHsb2Rgb && isSame(hsb2rgb({ h, s, b }), previous::hsb2rgb({ h, s, b }));
+                }
+            }
+        }
+        D14_CHECK(isSameHsb2Rgb);
+
+        // The float colors between the bytes, where the rounding differs
+        // most easily.
+        bool isSameRounding = true;
+        for (int i = -1000; i <= 256 * 1000; ++i)
+        {
+            float value = i / (255.0f * 1000.0f);
+
+            D2D1_COLOR_F color = { value, value, value, 1.0f };
+            isSameRounding = isSameRounding && isSame(convert(color), previous::convert(color));
+        }
+        D14_CHECK(isSameRounding);
+    }
+
+    // The toned colors of an accent of every hue, generated at compile time.
+    template<ThemeID Theme>
+    constexpr std::array<ColorGroup, 361> g_tonedColorTable = []
+    {
+        std::array<ColorGroup, 361> table = {};
+        for (int h = 0; h <= 360; ++h)
+        {
+            table[h] = ColorGroup::generate(convert(hsb2rgb({ h, 100, 100 })), Theme);
+        }
+        return table;
+    }();
+
+    void testTonedColors()
+    {
+        for (auto theme : { ThemeID::Light, ThemeID::Dark })
+        {
+            auto& table = theme == ThemeID::Light ?
+                g_tonedColorTable<ThemeID::Light> : g_tonedColorTable<ThemeID::Dark>;
+
+            bool isLight = theme == ThemeID::Light;
+
+            // The compile-time table against the previous runtime code.
+            bool isSameTable = true;
+            for (int h = 0; h <= 360; ++h)
+            {
+                auto accent = previous::convert(previous::hsb2rgb({ h, 100, 100 }));
+
+                isSameTable = isSameTable && isSame(table[h], previous::generateTonedColors(accent, isLight));
+            }
+            D14_CHECK(isSameTable);
+
+            // Every accent the system can report, where generate runs at
+            // runtime as in generateTonedColors.
+            bool isSameAccent = true;
+            for (uint32_t rgb = 0; rgb < (1u << 24); ++rgb)
+            {
+                auto accent = accentColor(rgb);
+
+                isSameAccent = isSameAccent &&
+                    isSame(ColorGroup::generate(accent, theme), previous::generateTonedColors(accent, isLight));
+            }
+            D14_CHECK(isSameAccent);
+        }
+        // The default Windows accent (0, 120, 215) at compile time.
+        constexpr auto light = ColorGroup::generate(accentColor(0x0078d7), ThemeID::Light);
+        constexpr auto dark = ColorGroup::generate(accentColor(0x0078d7), ThemeID::Dark);
+
+        D14_CHECK(isSame(light, previous::generateTonedColors(accentColor(0x0078d7), true)));
+        D14_CHECK(isSame(dark, previous::generateTonedColors(accentColor(0x0078d7), false)));
+    }
+}
+
+int main()
+{
+    testConversions();
+    testTonedColors();
+
+    return unit_test::report("ColorUtils");
+}
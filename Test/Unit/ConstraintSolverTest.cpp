@@ -0,0 +1,226 @@
+﻿#include "Common/Precompile.h"
+
+#include "Common/MathUtils/ConstraintSolver.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::math_utils;
+
+namespace
+{
+    using Solver = ConstraintSolver;
+    using Relation = Solver::Relation;
+    using Strength = Solver::Strength;
+
+    void testRequired()
+    {
+        Solver solver = {};
+        auto x = solver.addVariable();
+
+        D14_CHECK(solver.addConstraint({ { { x, 1.0 } }, -10.0 }, Relation::Equal).has_value());
+        D14_CHECK(solver.addConstraint({ { { x, 1.0 } }, -20.0 }, Relation::GreaterEqual, Strength::Weak).has_value());
+
+        solver.updateVariables();
+        D14_CHECK_NEAR(solver.value(x), 10.0, 1.0e-6);
+
+        // The unsatisfiable required ones are rejected and change nothing.
+        D14_CHECK(!solver.addConstraint({ { { x, 1.0 } }, -20.0 }, Relation::Equal).has_value());
+        D14_CHECK(!solver.addConstraint({ { { x, 1.0 } }, -5.0 }, Relation::LessEqual).has_value());
+
+        solver.updateVariables();
+        D14_CHECK_NEAR(solver.value(x), 10.0, 1.0e-6);
+    }
+
+    // Two panels in a row: a (preferred 100, at least 20), a gap of 10 and b
+    // (at least 30) that ends at the container width.
+    void testSplitter()
+    {
+        Solver solver = {};
+
+        auto aLeft = solver.addVariable(), aRight = solver.addVariable();
+        auto bLeft = solver.addVariable(), bRight = solver.addVariable();
+        auto width = solver.addVariable();
+
+        solver.addConstraint({ { { aLeft, 1.0 } }, 0.0 }, Relation::Equal);
+        solver.addConstraint({ { { aRight, 1.0 }, { aLeft, -1.0 } }, -100.0 }, Relation::Equal, Strength::Weak);
+        solver.addConstraint({ { { aRight, 1.0 }, { aLeft, -1.0 } }, -20.0 }, Relation::GreaterEqual);
+        solver.addConstraint({ { { bLeft, 1.0 }, { aRight, -1.0 } }, -10.0 }, Relation::Equal);
+        solver.addConstraint({ { { bRight, 1.0 }, { width, -1.0 } }, 0.0 }, Relation::Equal);
+        solver.addConstraint({ { { bRight, 1.0 }, { bLeft, -1.0 } }, -30.0 }, Relation::GreaterEqual);
+
+        solver.addEditVariable(width, Strength::make(999.0, 0.0, 0.0));
+
+        solver.suggestValue(width, 500.0);
+        solver.updateVariables();
+        D14_CHECK_NEAR(solver.value(aRight), 100.0, 1.0e-6);
+        D14_CHECK_NEAR(solver.value(bLeft), 110.0, 1.0e-6);
+        D14_CHECK_NEAR(solver.value(bRight), 500.0, 1.0e-6);
+
+        // b needs 30 and the gap 10, so a shrinks to 60.
+        solver.suggestValue(width, 100.0);
+        solver.updateVariables();
+        D14_CHECK_NEAR(solver.value(bRight), 100.0, 1.0e-6);
+        D14_CHECK_NEAR(solver.value(aRight), 60.0, 1.0e-6);
+
+        // 20 + 10 + 30 does not fit in 40, so the width edit loses.
+        solver.suggestValue(width, 40.0);
+        solver.updateVariables();
+        D14_CHECK_NEAR(solver.value(aRight), 20.0, 1.0e-6);
+        D14_CHECK_NEAR(solver.value(bRight), 60.0, 1.0e-6);
+
+        // Dragging the splitter between a and b.
+        solver.suggestValue(width, 500.0);
+        solver.addEditVariable(aRight, Strength::Strong);
+
+        solver.suggestValue(aRight, 250.0);
+        solver.updateVariables();
+        D14_CHECK_NEAR(solver.value(aRight), 250.0, 1.0e-6);
+        D14_CHECK_NEAR(solver.value(bLeft), 260.0, 1.0e-6);
+
+        // Stopped by the minimal width of b.
+        solver.suggestValue(aRight, 480.0);
+        solver.updateVariables();
+        D14_CHECK_NEAR(solver.value(aRight), 460.0, 1.0e-6);
+
+        // Back to the preferred width after releasing.
+        solver.removeEditVariable(aRight);
+        solver.updateVariables();
+        D14_CHECK_NEAR(solver.value(aRight), 100.0, 1.0e-6);
+    }
+
+    // Random systems, where the accepted required constraints must hold
+    // after every re-solve.
+    void testRandomized()
+    {
+        std::mt19937 random(7);
+        std::uniform_real_distribution<double> value(-100.0, 100.0);
+
+        for (int trial = 0; trial < 300; ++trial)
+        {
+            Solver solver = {};
+
+            std::vector<Solver::Variable> variables = {};
+            for (int i = 0; i < 6; ++i) variables.push_back(solver.addVariable());
+
+            struct Required { Solver::Expression expression; Relation relation; };
+            std::vector<Required> requireds = {};
+
+            for (int i = 0; i < 8; ++i)
+            {
+                size_t a = random() % variables.size(), b = random() % variables.size();
+                if (a == b) continue;
+
+                Solver::Expression expression = {};
+                expression.terms =
+                {
+                    { variables[a], 1.0 },
+                    { variables[b], -(double)(random() % 2 + 1) }
+                };
+                expression.constant = value(random);
+
+                auto relation = (Relation)(random() % 3);
+                if (solver.addConstraint(expression, relation).has_value())
+                {
+                    requireds.push_back({ expression, relation });
+                }
+            }
+            for (auto& variable : variables)
+            {
+                solver.addConstraint({ { { variable, 1.0 } }, -value(random) }, Relation::Equal, Strength::Weak);
+            }
+            solver.addEditVariable(variables[0], Strength::Strong);
+            solver.addEditVariable(variables[1], Strength::Medium);
+
+            for (int step = 0; step < 20; ++step)
+            {
+                solver.suggestValue(variables[random() % 2], value(random));
+                solver.updateVariables();
+
+                for (auto& required : requireds)
+                {
+                    double result = required.expression.constant;
+                    for (auto& term : required.expression.terms)
+                    {
+                        result += term.coefficient * solver.value(term.variable);
+                    }
+                    bool isSatisfied = {};
+                    switch (required.relation)
+                    {
+                    case Relation::Equal: isSatisfied = std::abs(result) < 1.0e-5; break;
+                    case Relation::LessEqual: isSatisfied = result < 1.0e-5; break;
+                    default: isSatisfied = result > -1.0e-5; break;
+                    }
+                    if (!D14_CHECK(isSatisfied)) return;
+                }
+            }
+        }
+    }
+
+    // N panels in a row filling the container: dragging the splitter in the
+    // middle re-solves incrementally from the last solution.
+    void benchmark()
+    {
+        for (int count : { 100, 500 })
+        {
+            Solver solver = {};
+
+            auto width = solver.addVariable();
+            std::vector<Solver::Variable> lefts = {}, rights = {};
+
+            double buildTime = unit_test::measure([&]
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    lefts.push_back(solver.addVariable());
+                    rights.push_back(solver.addVariable());
+
+                    if (i == 0)
+                    {
+                        solver.addConstraint({ { { lefts[0], 1.0 } }, 0.0 }, Relation::Equal);
+                    }
+                    else solver.addConstraint({ { { lefts[i], 1.0 }, { rights[i - 1], -1.0 } }, -4.0 }, Relation::Equal);
+
+                    solver.addConstraint({ { { rights[i], 1.0 }, { lefts[i], -1.0 } }, -20.0 }, Relation::GreaterEqual);
+                    solver.addConstraint({ { { rights[i], 1.0 }, { lefts[i], -1.0 } }, -100.0 }, Relation::Equal, Strength::Weak);
+                }
+                solver.addConstraint({ { { rights.back(), 1.0 }, { width, -1.0 } }, 0.0 }, Relation::Equal);
+
+                solver.addEditVariable(width, Strength::make(999.0, 0.0, 0.0));
+                solver.suggestValue(width, count * 104.0);
+                solver.updateVariables();
+            },
+            1);
+            auto splitter = rights[count / 2];
+            solver.addEditVariable(splitter, Strength::Strong);
+
+            const int frameCount = 200;
+            size_t pivotCount = solver.pivotCount(), changedCount = 0;
+
+            int frame = 0;
+            double dragTime = unit_test::measure([&]
+            {
+                solver.suggestValue(splitter, (count / 2) * 104.0 + 100.0 + (frame++ % 50));
+                changedCount += solver.updateVariables().size();
+            },
+            frameCount);
+            pivotCount = solver.pivotCount() - pivotCount;
+
+            std::printf("benchmark %d panels: build %.1f ms, splitter drag %.3f ms per frame "
+                "(%.1f pivots, %zu changed variables)\n",
+                count, buildTime, dragTime, (double)pivotCount / frameCount, changedCount / frameCount);
+        }
+    }
+}
+
+int main()
+{
+    testRequired();
+    testSplitter();
+    testRandomized();
+    benchmark();
+
+    return unit_test::report("ConstraintSolver");
+}
@@ -0,0 +1,155 @@
+﻿#include "Common/Precompile.h"
+
+#include "Common/MathUtils/Culling.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::math_utils;
+
+namespace
+{
+    // The identity view-projection keeps x, y in [-1, 1] and z in [0, 1].
+    const float g_identity[4][4] =
+    {
+        { 1.0f, 0.0f, 0.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f, 0.0f },
+        { 0.0f, 0.0f, 1.0f, 0.0f },
+        { 0.0f, 0.0f, 0.0f, 1.0f }
+    };
+
+    bool insideIdentity(const AABB& box)
+    {
+        return box.maxX >= -1.0f && box.minX <= 1.0f &&
+               box.maxY >= -1.0f && box.minY <= 1.0f &&
+               box.maxZ >= 0.0f && box.minZ <= 1.0f;
+    }
+
+    AABBArray randomBoxes(size_t count, float range, float size, unsigned seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> position(-range, range);
+
+        AABBArray boxes = {};
+        boxes.reserve(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            float x = position(random), y = position(random), z = position(random);
+            boxes.push({ x, y, z, x + size, y + size, z + size });
+        }
+        return boxes;
+    }
+
+    AABB boxAt(const AABBArray& boxes, size_t i)
+    {
+        return
+        {
+            boxes.minX[i], boxes.minY[i], boxes.minZ[i],
+            boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i]
+        };
+    }
+
+    void testIdentityFrustum()
+    {
+        auto frustum = Frustum::fromViewProj(g_identity);
+
+        // The odd count exercises the scalar tail after the SIMD steps.
+        auto boxes = randomBoxes(100003, 3.0f, 0.2f, 5);
+
+        std::vector<uint8_t> results(boxes.size());
+        cullAABBs(frustum, boxes, 0, boxes.size(), results.data());
+
+        size_t visibleCount = 0;
+        for (size_t i = 0; i < boxes.size(); ++i)
+        {
+            auto box = boxAt(boxes, i);
+
+            // The boxes are axis-aligned in clip space, so the test is exact.
+            D14_CHECK(intersects(frustum, box) == insideIdentity(box));
+            D14_CHECK((bool)results[i] == insideIdentity(box));
+
+            visibleCount += results[i];
+        }
+        D14_CHECK(visibleCount > 0 && visibleCount < boxes.size());
+
+        // The chunks give the same results as the whole range.
+        std::vector<uint8_t> chunkResults(boxes.size(), 2);
+        for (size_t offset = 0; offset < boxes.size(); offset += 777)
+        {
+            auto count = std::min<size_t>(777, boxes.size() - offset);
+            cullAABBs(frustum, boxes, offset, count, chunkResults.data());
+        }
+        D14_CHECK(chunkResults == results);
+    }
+
+    void testPerspectiveFrustum()
+    {
+        // A DirectX left-handed perspective (row vectors), 90 degrees FOV,
+        // aspect 1, near 1 and far 100, looking along +z.
+        const float n = 1.0f, f = 100.0f;
+        const float viewProj[4][4] =
+        {
+            { 1.0f, 0.0f, 0.0f, 0.0f },
+            { 0.0f, 1.0f, 0.0f, 0.0f },
+            { 0.0f, 0.0f, f / (f - n), 1.0f },
+            { 0.0f, 0.0f, -n * f / (f - n), 0.0f }
+        };
+        auto frustum = Frustum::fromViewProj(viewProj);
+
+        auto point = [](float x, float y, float z) { return AABB{ x, y, z, x, y, z }; };
+
+        D14_CHECK(intersects(frustum, point(0.0f, 0.0f, 50.0f)));
+        D14_CHECK(intersects(frustum, point(9.0f, -9.0f, 10.0f)));
+
+        D14_CHECK(!intersects(frustum, point(0.0f, 0.0f, 0.5f))); // before near
+        D14_CHECK(!intersects(frustum, point(0.0f, 0.0f, 101.0f))); // after far
+        D14_CHECK(!intersects(frustum, point(11.0f, 0.0f, 10.0f))); // right
+        D14_CHECK(!intersects(frustum, point(0.0f, -11.0f, 10.0f))); // bottom
+        D14_CHECK(!intersects(frustum, point(0.0f, 0.0f, -10.0f))); // behind
+
+        // A box straddling the side plane is kept.
+        D14_CHECK(intersects(frustum, AABB{ 9.0f, -1.0f, 10.0f, 20.0f, 1.0f, 11.0f }));
+
+        // The SIMD path agrees with the scalar one.
+        auto boxes = randomBoxes(50001, 60.0f, 2.0f, 9);
+
+        std::vector<uint8_t> results(boxes.size());
+        cullAABBs(frustum, boxes, 0, boxes.size(), results.data());
+
+        for (size_t i = 0; i < boxes.size(); ++i)
+        {
+            D14_CHECK((bool)results[i] == intersects(frustum, boxAt(boxes, i)));
+        }
+    }
+
+    void benchmark()
+    {
+        auto frustum = Frustum::fromViewProj(g_identity);
+
+        for (size_t count : { 1024, 16384, 262144 })
+        {
+            auto boxes = randomBoxes(count, 3.0f, 0.2f, 11);
+
+            std::vector<uint8_t> results(count);
+            double time = unit_test::measure([&]
+            {
+                cullAABBs(frustum, boxes, 0, count, results.data());
+            },
+            100);
+            std::printf("benchmark cullAABBs (%zu boxes): %.1f us, %.2f ns per box\n",
+                count, time * 1000.0, time * 1.0e6 / count);
+        }
+    }
+}
+
+int main()
+{
+    testIdentityFrustum();
+    testPerspectiveFrustum();
+    benchmark();
+
+    return unit_test::report("Culling");
+}
@@ -0,0 +1,228 @@
+﻿#include "Common/Precompile.h"
+
+#include "Renderer/DeferredReleaseQueue.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::renderer;
+
+namespace
+{
+    // Stands in for ID3D12Fence, where the "GPU" completes the signaled
+    // values whenever the test says so.
+    struct FakeFence
+    {
+        uint64_t signaledValue = 0;
+        uint64_t completedValue = 0;
+
+        uint64_t signal() { return ++signaledValue; }
+    };
+
+    // Records the releases, and fails if released while the GPU may still
+    // use it, i.e. before the fence completes the value of its last frame.
+    struct Resource
+    {
+        static inline const FakeFence* g_fence = nullptr;
+
+        static inline int g_aliveCount = 0;
+        static inline int g_earlyReleaseCount = 0;
+
+        uint64_t lastUsedFenceValue = 0;
+
+        bool isOwner = true;
+
+        explicit Resource(uint64_t lastUsedFenceValue)
+            : lastUsedFenceValue(lastUsedFenceValue) { ++g_aliveCount; }
+
+        Resource(Resource&& other) noexcept
+            : lastUsedFenceValue(other.lastUsedFenceValue)
+        {
+            other.isOwner = false;
+        }
+        Resource& operator=(Resource&& other) noexcept
+        {
+            if (isOwner) release();
+
+            lastUsedFenceValue = other.lastUsedFenceValue;
+            isOwner = other.isOwner;
+            other.isOwner = false;
+
+            return *this;
+        }
+        ~Resource() { if (isOwner) release(); }
+
+        void release()
+        {
+            --g_aliveCount;
+            if (g_fence && lastUsedFenceValue > g_fence->completedValue) ++g_earlyReleaseCount;
+        }
+    };
+
+    void testRetire()
+    {
+        FakeFence fence = {};
+        Resource::g_fence = &fence;
+        {
+            DeferredReleaseQueue<Resource> queue = {};
+
+            queue.push(Resource(fence.signaledValue + 1));
+            queue.push(Resource(fence.signaledValue + 1));
+            queue.finishFrame(fence.signal());
+
+            // Nothing before the fence passes the value of the frame.
+            D14_CHECK(queue.retire(fence.completedValue) == 0);
+            D14_CHECK(queue.pendingObjectCount() == 2 && Resource::g_aliveCount == 2);
+
+            fence.completedValue = 1;
+            D14_CHECK(queue.retire(fence.completedValue) == 2);
+            D14_CHECK(queue.pendingObjectCount() == 0 && Resource::g_aliveCount == 0);
+
+            // The untagged ones are never retired.
+            queue.push(Resource(fence.signaledValue + 1));
+            D14_CHECK(queue.retire(UINT64_MAX) == 0 && queue.pendingObjectCount() == 1);
+
+            // The same fence value merges into one frame.
+            queue.finishFrame(fence.signal());
+            queue.push(Resource(fence.signaledValue));
+            queue.finishFrame(fence.signaledValue);
+
+            D14_CHECK(queue.pendingFrameCount() == 1 && queue.pendingObjectCount() == 2);
+
+            fence.completedValue = fence.signaledValue;
+            D14_CHECK(queue.retire(fence.completedValue) == 2);
+        }
+        D14_CHECK(Resource::g_aliveCount == 0 && Resource::g_earlyReleaseCount == 0);
+    }
+
+    void testReleaseAll()
+    {
+        FakeFence fence = {};
+        Resource::g_fence = nullptr; // the GPU is idle
+
+        DeferredReleaseQueue<Resource> queue = {};
+
+        for (int frame = 0; frame < 5; ++frame)
+        {
+            queue.push(Resource(fence.signaledValue + 1));
+            queue.push(Resource(fence.signaledValue + 1));
+            queue.finishFrame(fence.signal());
+        }
+        queue.push(Resource(fence.signaledValue + 1)); // untagged
+
+        D14_CHECK(queue.pendingObjectCount() == 11 && queue.pendingFrameCount() == 5);
+
+        queue.releaseAll();
+        D14_CHECK(queue.pendingObjectCount() == 0 && queue.pendingFrameCount() == 0);
+        D14_CHECK(Resource::g_aliveCount == 0);
+    }
+
+    // e.g. a bitmap whose release drops the last reference to its atlas,
+    // which is deferred in turn.
+    struct Chained
+    {
+        static inline DeferredReleaseQueue<Chained>* g_queue = nullptr;
+        static inline int g_releaseCount = 0;
+
+        int depth = 0;
+
+        bool isOwner = true;
+
+        explicit Chained(int depth) : depth(depth) { }
+
+        Chained(Chained&& other) noexcept : depth(other.depth) { other.isOwner = false; }
+
+        Chained& operator=(Chained&& other) noexcept
+        {
+            depth = other.depth;
+            isOwner = other.isOwner;
+            other.isOwner = false;
+
+            return *this;
+        }
+        ~Chained()
+        {
+            if (!isOwner) return;
+
+            ++g_releaseCount;
+            if (depth > 0) g_queue->push(Chained(depth - 1));
+        }
+    };
+
+    void testPushDuringRelease()
+    {
+        DeferredReleaseQueue<Chained> queue = {};
+        Chained::g_queue = &queue;
+
+        queue.push(Chained(2));
+        queue.push(Chained(0));
+        queue.finishFrame(1);
+
+        // The pushed one waits for the next frame.
+        D14_CHECK(queue.retire(1) == 2);
+        D14_CHECK(Chained::g_releaseCount == 2);
+        D14_CHECK(queue.pendingObjectCount() == 1 && queue.pendingFrameCount() == 0);
+
+        queue.finishFrame(2);
+        D14_CHECK(queue.retire(2) == 1);
+        D14_CHECK(Chained::g_releaseCount == 3 && queue.pendingObjectCount() == 1);
+
+        // And the same for releaseAll, where the pushed one is kept.
+        queue.releaseAll();
+        D14_CHECK(Chained::g_releaseCount == 4 && queue.pendingObjectCount() == 0);
+
+        queue.releaseAll();
+        D14_CHECK(Chained::g_releaseCount == 4);
+    }
+
+    // Up to 3 frames in flight with the GPU completing at random, where no
+    // resource may be released early and all are released in the end.
+    void testRandomized()
+    {
+        FakeFence fence = {};
+        Resource::g_fence = &fence;
+
+        std::mt19937 random(7);
+        {
+            DeferredReleaseQueue<Resource> queue = {};
+
+            for (int frame = 0; frame < 100000; ++frame)
+            {
+                uint64_t minCompletedValue = fence.signaledValue >= 3 ? fence.signaledValue - 3 : 0;
+                fence.completedValue = std::max(fence.completedValue,
+                    std::min<uint64_t>(fence.signaledValue, minCompletedValue + random() % 4));
+
+                queue.retire(fence.completedValue);
+
+                for (uint32_t i = random() % 3; i > 0; --i)
+                {
+                    queue.push(Resource(fence.signaledValue + 1));
+                }
+                queue.finishFrame(fence.signal());
+
+                if (random() % 50 == 0) // waits for the GPU
+                {
+                    fence.completedValue = fence.signaledValue;
+                    queue.retire(fence.completedValue);
+
+                    if (!D14_CHECK(queue.pendingObjectCount() == 0)) return;
+                }
+            }
+            fence.completedValue = fence.signaledValue;
+            queue.retire(fence.completedValue);
+        }
+        D14_CHECK(Resource::g_aliveCount == 0 && Resource::g_earlyReleaseCount == 0);
+    }
+}
+
+int main()
+{
+    testRetire();
+    testReleaseAll();
+    testPushDuringRelease();
+    testRandomized();
+
+    return unit_test::report("DeferredReleaseQueue");
+}
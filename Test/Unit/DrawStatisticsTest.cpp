@@ -0,0 +1,134 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/DrawStatistics.h"
+
+#include "UnitTest.h"
+
+using namespace d14engine;
+using namespace d14engine::uikit;
+
+namespace
+{
+    void testFrame()
+    {
+        DrawStatistics statistics = {};
+        statistics.collectRects = true;
+
+        // Discarded outside of a frame.
+        statistics.enterObject("Stray", { 0.0f, 0.0f, 1.0f, 1.0f }, 0.0);
+        D14_CHECK(!statistics.isInFrame());
+
+        statistics.beginFrame(100.0f, 100.0f);
+        D14_CHECK(statistics.isInFrame());
+
+        statistics.enterLayer("Window", 0.0);
+        statistics.leave(1.0);
+
+        statistics.enterObject("Window", { -50.0f, 0.0f, 100.0f, 100.0f }, 10.0); // clipped
+        {
+            statistics.enterObject("Button", { 10.0f, 10.0f, 30.0f, 20.0f }, 11.0);
+            statistics.addTextLayout();
+            statistics.leave(13.0);
+
+            statistics.enterObject("Button", { 200.0f, 200.0f, 300.0f, 300.0f }, 13.0); // offscreen
+            statistics.leave(14.0);
+
+            statistics.addMaskPass();
+            statistics.addShadowPass();
+        }
+        statistics.leave(20.0);
+        statistics.endFrame();
+
+        auto& frame = statistics.lastFrame();
+        D14_CHECK(frame.index == 1);
+        D14_CHECK(frame.objectCount == 3 && frame.layerCount == 1);
+        D14_CHECK(frame.maskPassCount == 1 && frame.shadowPassCount == 1 && frame.textLayoutCount == 1);
+
+        D14_CHECK(frame.coveredArea == 100.0 * 100.0 + 20.0 * 10.0);
+        D14_CHECK_NEAR(frame.overdraw(), 1.02, 1.0e-9);
+
+        // The time of the nested buttons is excluded from the window.
+        D14_CHECK(frame.classes.at("Window").selfSecs == 1.0 + 10.0 - 3.0);
+        D14_CHECK(frame.classes.at("Window").layerCount == 1);
+        D14_CHECK(frame.classes.at("Button").selfSecs == 3.0);
+        D14_CHECK(frame.classes.at("Button").objectCount == 2);
+
+        // The offscreen one covers nothing.
+        D14_CHECK(frame.rects.size() == 2);
+
+        auto json = statistics.dump();
+        D14_CHECK(json.find("\"frame\":1") != std::string::npos);
+        D14_CHECK(json.find("\"overdraw\":1.02") != std::string::npos);
+        D14_CHECK(json.find("{\"name\":\"Button\",\"objects\":2") != std::string::npos);
+    }
+
+    void testUnbalanced()
+    {
+        DrawStatistics statistics = {};
+
+        statistics.beginFrame(10.0f, 10.0f);
+        statistics.enterObject("A\"b", { 0.0f, 0.0f, 5.0f, 5.0f }, 0.0);
+        statistics.endFrame(); // not left
+
+        auto& frame = statistics.lastFrame();
+        D14_CHECK(frame.objectCount == 1 && frame.coveredArea == 25.0);
+        D14_CHECK(frame.rects.empty()); // not collected by default
+
+        // The class names are escaped.
+        D14_CHECK(statistics.dump().find("\"name\":\"A\\\"b\"") != std::string::npos);
+
+        // The next frame starts clean.
+        statistics.beginFrame(10.0f, 10.0f);
+        statistics.leave(1.0); // nothing to leave
+        statistics.endFrame();
+        D14_CHECK(statistics.lastFrame().index == 2 && statistics.lastFrame().objectCount == 0);
+    }
+
+    // What the statistics add to each drawn object: a frame of 10k objects
+    // (100 panels of 100 children) across 8 classes.
+    void benchmark()
+    {
+        const char* classNames[] =
+        {
+            "Panel", "Label", "Button", "IconLabel", "ScrollView", "ListViewItem", "Window", "TabGroup"
+        };
+        for (bool collectRects : { false, true })
+        {
+            DrawStatistics statistics = {};
+            statistics.collectRects = collectRects;
+
+            double time = unit_test::measure([&]
+            {
+                statistics.beginFrame(1920.0f, 1080.0f);
+
+                double nowSecs = 0.0;
+                for (int i = 0; i < 100; ++i)
+                {
+                    DrawStatistics::Rect rect = { (float)i, 0.0f, (float)i + 500.0f, 500.0f };
+                    statistics.enterObject(classNames[i % 8], rect, nowSecs += 1.0e-6);
+
+                    for (int j = 0; j < 100; ++j)
+                    {
+                        statistics.enterObject(classNames[j % 8], rect, nowSecs += 1.0e-6);
+                        statistics.addTextLayout();
+                        statistics.leave(nowSecs += 1.0e-6);
+                    }
+                    statistics.leave(nowSecs += 1.0e-6);
+                }
+                statistics.endFrame();
+            },
+            200);
+            std::printf("benchmark frame (10100 objects, %s): %.1f us, %.1f ns per object\n",
+                collectRects ? "with rects" : "without rects", time * 1000.0, time * 1.0e6 / 10100);
+        }
+    }
+}
+
+int main()
+{
+    testFrame();
+    testUnbalanced();
+    benchmark();
+
+    return unit_test::report("DrawStatistics");
+}
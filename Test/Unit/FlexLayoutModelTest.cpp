@@ -0,0 +1,234 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/FlexLayoutModel.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::uikit;
+
+namespace
+{
+    using Model = FlexLayoutModel;
+
+    void testGrowAndShrink()
+    {
+        Model model = {};
+
+        Model::Settings settings = {};
+        settings.mainGap = 10.0f;
+
+        model.setSettings(settings);
+        model.resize(310.0f, 50.0f);
+
+        Model::Item a = {};
+        a.width = 100.0f;
+        a.height = 20.0f;
+        a.grow = 1.0f;
+
+        Model::Item b = a;
+        b.grow = 2.0f;
+
+        model.insert(0, a);
+        model.insert(1, b);
+        model.update();
+
+        // 300 available, 200 of bases, so 100 free in 1:2.
+        D14_CHECK_NEAR(model.rect(0).right, 133.333f, 1.0e-2f);
+        D14_CHECK_NEAR(model.rect(1).left, 143.333f, 1.0e-2f);
+        D14_CHECK_NEAR(model.rect(1).right, 310.0f, 1.0e-2f);
+
+        // Stretched on the cross axis.
+        D14_CHECK_NEAR(model.rect(0).bottom, 50.0f, 1.0e-2f);
+
+        // The frozen one gives the rest to the other.
+        b.maxWidth = 150.0f;
+        model.setItem(1, b);
+        model.update();
+
+        D14_CHECK_NEAR(model.rect(1).right - model.rect(1).left, 150.0f, 1.0e-2f);
+        D14_CHECK_NEAR(model.rect(0).right, 150.0f, 1.0e-2f);
+
+        // 100 available, 200 of bases, so both shrink by 50.
+        model.resize(110.0f, 50.0f);
+        model.update();
+
+        D14_CHECK_NEAR(model.rect(0).right, 50.0f, 1.0e-2f);
+        D14_CHECK_NEAR(model.rect(1).right, 110.0f, 1.0e-2f);
+    }
+
+    void testWrapAndJustify()
+    {
+        Model model = {};
+
+        Model::Settings settings = {};
+        settings.wrap = true;
+        settings.justifyContent = Model::Justify::SpaceBetween;
+        settings.alignItems = Model::Align::Start;
+        settings.crossGap = 5.0f;
+
+        model.setSettings(settings);
+        model.resize(100.0f, 200.0f);
+
+        Model::Item item = {};
+        item.width = 40.0f;
+        item.height = 10.0f;
+
+        for (size_t i = 0; i < 5; ++i) model.insert(i, item);
+        model.update();
+
+        // 2 items per line.
+        D14_CHECK(model.lineCount() == 3);
+        D14_CHECK(model.rect(0).left == 0.0f && model.rect(1).right == 100.0f);
+        D14_CHECK(model.rect(2).top == 15.0f && model.rect(4).top == 30.0f);
+        D14_CHECK(model.rect(4).left == 0.0f);
+    }
+
+    // The incremental updates must always give the same rects as laying out
+    // the same items from scratch.
+    void testIncrementalEqualsFresh()
+    {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> extent(10.0f, 80.0f);
+
+        for (int trial = 0; trial < 200; ++trial)
+        {
+            Model::Settings settings = {};
+            settings.direction = random() % 2 ? Model::Direction::Row : Model::Direction::Column;
+            settings.wrap = random() % 2;
+            settings.justifyContent = (Model::Justify)(random() % 6);
+            settings.alignItems = (Model::Align)(random() % 4);
+            settings.mainGap = 3.0f;
+            settings.crossGap = 2.0f;
+            settings.padding = { 1.0f, 2.0f, 3.0f, 4.0f };
+
+            auto randomItem = [&]
+            {
+                Model::Item item = {};
+                item.width = extent(random);
+                item.height = extent(random);
+                item.grow = (float)(random() % 3);
+                item.shrink = (float)(random() % 2);
+                item.minWidth = 5.0f;
+                item.maxHeight = 70.0f;
+                return item;
+            };
+            float width = 300.0f, height = 300.0f;
+
+            Model incremental = {};
+            incremental.setSettings(settings);
+            incremental.resize(width, height);
+
+            std::vector<Model::Item> items = {};
+            for (size_t i = 0; i < 60; ++i)
+            {
+                items.push_back(randomItem());
+                incremental.insert(i, items.back());
+            }
+            incremental.update();
+
+            for (int step = 0; step < 30; ++step)
+            {
+                size_t index = random() % items.size();
+                switch (random() % 3)
+                {
+                case 0:
+                {
+                    items[index] = randomItem();
+                    incremental.setItem(index, items[index]);
+                    break;
+                }
+                case 1:
+                {
+                    width = 200.0f + extent(random) * 2.0f;
+                    height = 200.0f + extent(random) * 2.0f;
+                    incremental.resize(width, height);
+                    break;
+                }
+                default:
+                {
+                    incremental.erase(index);
+                    items.erase(items.begin() + index);
+
+                    items.insert(items.begin() + index, randomItem());
+                    incremental.insert(index, items[index]);
+                    break;
+                }
+                }
+                incremental.update();
+
+                Model fresh = {};
+                fresh.setSettings(settings);
+                fresh.resize(width, height);
+
+                for (size_t i = 0; i < items.size(); ++i) fresh.insert(i, items[i]);
+                fresh.update();
+
+                bool isSame = true;
+                for (size_t i = 0; i < items.size(); ++i)
+                {
+                    isSame = isSame && incremental.rect(i) == fresh.rect(i);
+                }
+                if (!D14_CHECK(isSame)) return;
+            }
+        }
+    }
+
+    // 10k children, where resizing one of them should only resolve its own
+    // line (if wrapped) and report the items that actually moved.
+    void benchmark()
+    {
+        for (bool wrap : { false, true })
+        {
+            Model model = {};
+
+            Model::Settings settings = {};
+            settings.wrap = wrap;
+            settings.mainGap = 4.0f;
+
+            model.setSettings(settings);
+            model.resize(wrap ? 1000.0f : 400000.0f, wrap ? 100000.0f : 40.0f);
+
+            for (size_t i = 0; i < 10000; ++i)
+            {
+                Model::Item item = {};
+                item.width = 30.0f + (float)(i % 7);
+                item.height = 20.0f + (float)(i % 5);
+                model.insert(i, item);
+            }
+            double fullTime = unit_test::measure([&] { model.update(); }, 1);
+
+            int step = 0;
+            size_t changedCount = 0;
+            double itemTime = unit_test::measure([&]
+            {
+                auto item = model.item(5000);
+                item.width = 33.0f + (float)(++step % 2);
+                model.setItem(5000, item);
+
+                changedCount = model.update().size();
+            },
+            100);
+            size_t resolvedCount = model.resolvedItemCount();
+
+            std::printf("benchmark 10k children (%s, %zu lines): full %.3f ms, "
+                "one item %.3f ms (resolved %zu, changed %zu)\n",
+                wrap ? "wrap" : "no wrap", model.lineCount(), fullTime,
+                itemTime, resolvedCount, changedCount);
+
+            if (wrap) D14_CHECK(resolvedCount < 100 && changedCount < 100);
+        }
+    }
+}
+
+int main()
+{
+    testGrowAndShrink();
+    testWrapAndJustify();
+    testIncrementalEqualsFresh();
+    benchmark();
+
+    return unit_test::report("FlexLayoutModel");
+}
@@ -0,0 +1,279 @@
+﻿#include "Common/Precompile.h"
+
+#include "Renderer/FrameWriter.h"
+#include "Renderer/ReadbackSlotRing.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::renderer;
+
+namespace
+{
+    std::filesystem::path testDirectory()
+    {
+        auto directory = std::filesystem::temp_directory_path() / "D14EngineFrameWriterTest";
+
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+
+        return directory;
+    }
+
+    std::string readHead(const std::filesystem::path& path, size_t byteCount)
+    {
+        std::ifstream file(path, std::ios::binary);
+
+        std::string head(byteCount, '\0');
+        file.read(head.data(), (std::streamsize)byteCount);
+
+        return head;
+    }
+
+    void testSlotRing()
+    {
+        ReadbackSlotRing ring(2);
+        D14_CHECK(ring.slotCount() == 2 && ring.freeSlotCount() == 2);
+
+        auto a = ring.acquire();
+        ring.finishFrame(1);
+        auto b = ring.acquire();
+        ring.finishFrame(2);
+
+        D14_CHECK(a.has_value() && b.has_value() && a != b);
+        D14_CHECK(!ring.acquire().has_value()); // all waiting for the GPU
+
+        // Nothing before the fence completes.
+        D14_CHECK(!ring.popCompleted(0).has_value());
+
+        // In the acquiring order.
+        D14_CHECK(ring.popCompleted(2) == a);
+        D14_CHECK(ring.popCompleted(2) == b);
+        D14_CHECK(!ring.popCompleted(2).has_value());
+
+        // Not free until released.
+        D14_CHECK(ring.freeSlotCount() == 0);
+        ring.release(a.value());
+        D14_CHECK(ring.freeSlotCount() == 1 && ring.acquire() == a);
+    }
+
+    // A render loop where the "GPU" fills the slot of frame N a random
+    // 1 to 3 frames later, which is read back without waiting and written
+    // to the disk on the worker.
+    void testSimulatedRecording()
+    {
+        const uint32_t width = 64, height = 32;
+        const size_t rowPitch = 256; // aligned like a readback buffer
+
+        auto directory = testDirectory();
+
+        FrameWriter::Settings settings = {};
+        settings.directory = directory.wstring();
+        settings.prefix = L"f";
+        settings.format = FrameWriter::Format::BmpSequence;
+        settings.maxQueuedBytes = width * height * 4 * 8;
+
+        ReadbackSlotRing ring(3);
+
+        std::vector<std::vector<uint8_t>> slotMemory(3, std::vector<uint8_t>(rowPitch * height));
+        std::vector<uint32_t> slotFrames(3);
+
+        // fence value -> slot to fill
+        std::deque<std::pair<uint64_t, size_t>> gpuQueue = {};
+
+        uint64_t signaledFenceValue = 0, completedFenceValue = 0;
+        std::mt19937 random(3);
+
+        size_t readCount = 0, ringDroppedCount = 0;
+        Optional<uint32_t> lastReadFrame = {};
+        {
+            FrameWriter writer(settings);
+
+            for (uint32_t frame = 0; frame < 2000; ++frame)
+            {
+                uint64_t target = std::max<uint64_t>(
+                    completedFenceValue, signaledFenceValue > 2 ? signaledFenceValue - 2 : 0) + random() % 2;
+
+                target = std::min(target, signaledFenceValue);
+
+                while (!gpuQueue.empty() && gpuQueue.front().first <= target)
+                {
+                    auto slot = gpuQueue.front().second;
+                    for (uint32_t y = 0; y < height; ++y)
+                    {
+                        for (uint32_t x = 0; x < width; ++x)
+                        {
+                            auto pixel = &slotMemory[slot][y * rowPitch + x * 4];
+
+                            pixel[0] = (uint8_t)slotFrames[slot];
+                            pixel[1] = (uint8_t)x;
+                            pixel[2] = (uint8_t)y;
+                            pixel[3] = 255;
+                        }
+                    }
+                    gpuQueue.pop_front();
+                }
+                completedFenceValue = target;
+
+                while (auto slot = ring.popCompleted(completedFenceValue))
+                {
+                    auto& memory = slotMemory[slot.value()];
+
+                    // Filled by the GPU, and in the frame order.
+                    D14_CHECK(memory[0] == (uint8_t)slotFrames[slot.value()]);
+                    D14_CHECK(!lastReadFrame.has_value() || slotFrames[slot.value()] > lastReadFrame.value());
+
+                    lastReadFrame = slotFrames[slot.value()];
+                    ++readCount;
+
+                    writer.push(width, height, memory.data(), rowPitch);
+                    ring.release(slot.value());
+                }
+                if (auto slot = ring.acquire())
+                {
+                    slotFrames[slot.value()] = frame;
+                    gpuQueue.push_back({ signaledFenceValue + 1, slot.value() });
+                }
+                else ++ringDroppedCount;
+
+                ring.finishFrame(++signaledFenceValue);
+            }
+            writer.finish();
+
+            D14_CHECK(!writer.failed());
+            D14_CHECK(writer.writtenFrameCount() + writer.droppedFrameCount() == readCount);
+            D14_CHECK(writer.writtenFrameCount() > 0);
+
+            size_t fileCount = 0;
+            for (auto& entry : std::filesystem::directory_iterator(directory))
+            {
+                ++fileCount;
+                D14_CHECK(std::filesystem::file_size(entry) == 54 + width * height * 4);
+            }
+            D14_CHECK(fileCount == writer.writtenFrameCount());
+
+            D14_CHECK(readHead(directory / "f000000.bmp", 2) == "BM");
+
+            std::printf("recording: %zu read back, %zu dropped by the ring, %zu written, %zu dropped by the writer\n",
+                readCount, ringDroppedCount, writer.writtenFrameCount(), writer.droppedFrameCount());
+        }
+        std::filesystem::remove_all(directory);
+    }
+
+    void testBoundedQueue()
+    {
+        auto directory = testDirectory();
+
+        FrameWriter::Settings settings = {};
+        settings.directory = directory.wstring();
+        settings.prefix = L"f";
+        settings.format = FrameWriter::Format::RawStream;
+        settings.maxQueuedBytes = 1; // at most one frame in flight
+
+        const uint32_t width = 1920, height = 1080;
+        std::vector<uint8_t> pixels(width * height * 4, 7);
+        {
+            FrameWriter writer(settings);
+
+            size_t pushedCount = 0, maxQueuedBytes = 0;
+            for (int i = 0; i < 50; ++i)
+            {
+                pushedCount += writer.push(width, height, pixels.data(), width * 4);
+                maxQueuedBytes = std::max(maxQueuedBytes, writer.queuedBytes());
+            }
+            writer.finish();
+
+            D14_CHECK(maxQueuedBytes <= pixels.size());
+            D14_CHECK(writer.writtenFrameCount() == pushedCount);
+            D14_CHECK(writer.writtenFrameCount() + writer.droppedFrameCount() == 50);
+
+            auto rawSize = std::filesystem::file_size(directory / "f.raw");
+            D14_CHECK(rawSize == writer.writtenFrameCount() * (12 + pixels.size()));
+
+            // Pushing after finishing is refused.
+            D14_CHECK(!writer.push(width, height, pixels.data(), width * 4));
+        }
+        settings.blockWhenFull = true;
+        settings.prefix = L"g";
+        {
+            FrameWriter writer(settings);
+
+            for (int i = 0; i < 20; ++i) writer.push(width, height, pixels.data(), width * 4);
+            writer.finish();
+
+            D14_CHECK(writer.writtenFrameCount() == 20 && writer.droppedFrameCount() == 0);
+        }
+        std::filesystem::remove_all(directory);
+    }
+
+    // The cost of each format for 1080p frames with some structure, which
+    // is what the worker has to keep up with.
+    void benchmark()
+    {
+        const uint32_t width = 1920, height = 1080;
+
+        std::vector<uint8_t> pixels(width * height * 4);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                auto pixel = &pixels[(y * width + x) * 4];
+
+                pixel[0] = (uint8_t)(x / 8);
+                pixel[1] = (uint8_t)(y / 8);
+                pixel[2] = (uint8_t)((x / 64 + y / 64) % 2 * 200);
+                pixel[3] = 255;
+            }
+        }
+        struct Case { const char* name; FrameWriter::Format format; const char* extension; };
+
+        for (auto& c : std::initializer_list<Case>
+        {
+            { "bmp", FrameWriter::Format::BmpSequence, ".bmp" },
+            { "qoi", FrameWriter::Format::QoiSequence, ".qoi" },
+            { "png", FrameWriter::Format::PngSequence, ".png" }
+        })
+        {
+            auto directory = testDirectory();
+
+            FrameWriter::Settings settings = {};
+            settings.directory = directory.wstring();
+            settings.format = c.format;
+            settings.blockWhenFull = true;
+
+            const int frameCount = 10;
+            size_t writtenCount = 0;
+
+            double time = unit_test::measure([&]
+            {
+                FrameWriter writer(settings);
+
+                for (int i = 0; i < frameCount; ++i) writer.push(width, height, pixels.data(), width * 4);
+                writer.finish();
+
+                writtenCount = writer.writtenFrameCount();
+            },
+            1);
+            auto fileSize = std::filesystem::file_size(directory / (std::string("frame000000") + c.extension));
+
+            D14_CHECK(writtenCount == frameCount);
+
+            std::printf("benchmark %s (1080p): %.1f ms per frame, %.2f MB per frame\n",
+                c.name, time / frameCount, fileSize / 1048576.0);
+
+            std::filesystem::remove_all(directory);
+        }
+    }
+}
+
+int main()
+{
+    testSlotRing();
+    testSimulatedRecording();
+    testBoundedQueue();
+    benchmark();
+
+    return unit_test::report("FrameWriter");
+}
@@ -0,0 +1,190 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/HitTestCache.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::uikit;
+
+namespace
+{
+    using Point = HitTestCache::Point;
+    using Rect = HitTestCache::Rect;
+
+    // The objects include or exclude the edges differently, which the cache
+    // must not depend on.
+    struct Sibling
+    {
+        Rect bounds = {};
+
+        enum class Edges { Closed, Open, HalfOpen } edges = Edges::Closed;
+
+        bool isHit(const Point& p) const
+        {
+            auto& r = bounds;
+            switch (edges)
+            {
+            case Edges::Closed: return p.x >= r.left && p.x <= r.right && p.y >= r.top && p.y <= r.bottom;
+            case Edges::Open: return p.x > r.left && p.x < r.right && p.y > r.top && p.y < r.bottom;
+            default: return p.x >= r.left && p.x <= r.right && p.y >= r.top && p.y < r.bottom;
+            }
+        }
+    };
+
+    std::vector<bool> hitTestAll(const std::vector<Sibling>& siblings, const Point& p)
+    {
+        std::vector<bool> results = {};
+        for (auto& sibling : siblings) results.push_back(sibling.isHit(p));
+        return results;
+    }
+
+    void testInvalidation()
+    {
+        HitTestCache cache = {};
+        D14_CHECK(!cache.isValid({ 5.0f, 5.0f }));
+
+        cache.begin({ 5.0f, 5.0f });
+        cache.update({ 5.0f, 5.0f }, Rect{ 0.0f, 0.0f, 10.0f, 10.0f }, true);
+        D14_CHECK(cache.isValid({ 6.0f, 6.0f }));
+
+        // The edges are excluded.
+        D14_CHECK(!cache.isValid({ 10.0f, 6.0f }));
+
+        HitTestCache::invalidateAll();
+        D14_CHECK(!cache.isValid({ 6.0f, 6.0f }));
+
+        // The unknown bounds (e.g. a custom f_isHit) disable the cache.
+        cache.begin({ 5.0f, 5.0f });
+        cache.update({ 5.0f, 5.0f }, std::nullopt, false);
+        D14_CHECK(!cache.isValid({ 5.0f, 5.0f }));
+
+        // Inside the bounds but not hit, so the result is unpredictable.
+        cache.begin({ 5.0f, 5.0f });
+        cache.update({ 5.0f, 5.0f }, Rect{ 0.0f, 0.0f, 10.0f, 10.0f }, false);
+        D14_CHECK(!cache.isValid({ 5.0f, 5.0f }));
+
+        // A missed sibling to the right cuts off that side.
+        cache.begin({ 5.0f, 5.0f });
+        cache.update({ 5.0f, 5.0f }, Rect{ 8.0f, 0.0f, 20.0f, 10.0f }, false);
+        D14_CHECK(cache.isValid({ 7.0f, 5.0f }) && !cache.isValid({ 9.0f, 5.0f }));
+        D14_CHECK(cache.stabilityRect().right == 8.0f);
+
+        cache.invalidate();
+        D14_CHECK(!cache.isValid({ 5.0f, 5.0f }));
+    }
+
+    // Whenever the cache claims to be valid, hit-testing all the siblings
+    // again must give the same results.
+    void testRandomized()
+    {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> coord(0.0f, 1000.0f);
+
+        size_t checkCount = 0, reusedCount = 0;
+
+        for (int scene = 0; scene < 2000; ++scene)
+        {
+            std::vector<Sibling> siblings(1 + random() % 50);
+            for (auto& sibling : siblings)
+            {
+                float x = std::round(coord(random)), y = std::round(coord(random));
+
+                sibling.bounds =
+                {
+                    x, y, x + std::round(coord(random) / 4.0f), y + std::round(coord(random) / 4.0f)
+                };
+                sibling.edges = (Sibling::Edges)(random() % 3);
+            }
+            Point p = { std::round(coord(random)), std::round(coord(random)) };
+
+            HitTestCache cache = {};
+            cache.begin(p);
+
+            std::vector<bool> results = {};
+            for (auto& sibling : siblings)
+            {
+                bool isHit = sibling.isHit(p);
+                results.push_back(isHit);
+
+                cache.update(p, sibling.bounds, isHit);
+            }
+            for (int i = 0; i < 200; ++i)
+            {
+                Point q =
+                {
+                    p.x + std::round((coord(random) - 500.0f) / 25.0f),
+                    p.y + std::round((coord(random) - 500.0f) / 25.0f)
+                };
+                ++checkCount;
+
+                if (cache.isValid(q))
+                {
+                    ++reusedCount;
+                    if (!D14_CHECK(hitTestAll(siblings, q) == results)) return;
+                }
+            }
+        }
+        // The jitters around the point are mostly reused.
+        D14_CHECK(reusedCount > checkCount / 4);
+
+        std::printf("reused %zu of %zu jittered points\n", reusedCount, checkCount);
+    }
+
+    // 2000 siblings in a 20 px grid and the cursor jittering by a few pixels,
+    // which is what a re-synthesized mouse-move looks like.
+    void benchmark()
+    {
+        std::vector<Sibling> siblings(2000);
+        for (size_t i = 0; i < siblings.size(); ++i)
+        {
+            float x = (float)(i % 50) * 20.0f, y = (float)(i / 50) * 20.0f;
+
+            siblings[i].bounds = { x, y, x + 20.0f, y + 20.0f };
+            siblings[i].edges = Sibling::Edges::HalfOpen;
+        }
+        const Point p = { 505.0f, 305.0f };
+
+        int jitter = 0, hitCount = 0;
+        double fullTime = unit_test::measure([&]
+        {
+            Point q = { p.x + (float)(jitter % 5), p.y + (float)(jitter % 3) };
+            ++jitter;
+
+            for (auto& sibling : siblings) hitCount += sibling.isHit(q);
+        },
+        20000);
+
+        HitTestCache cache = {};
+        double cachedTime = unit_test::measure([&]
+        {
+            Point q = { p.x + (float)(jitter % 5), p.y + (float)(jitter % 3) };
+            ++jitter;
+
+            if (cache.isValid(q)) return;
+
+            cache.begin(q);
+            for (auto& sibling : siblings)
+            {
+                bool isHit = sibling.isHit(q);
+                hitCount += isHit;
+
+                cache.update(q, sibling.bounds, isHit);
+            }
+        },
+        20000);
+        std::printf("benchmark mouse-move (%zu siblings): %.2f us full, %.3f us cached (%d hits)\n",
+            siblings.size(), fullTime * 1000.0, cachedTime * 1000.0, hitCount);
+    }
+}
+
+int main()
+{
+    testInvalidation();
+    testRandomized();
+    benchmark();
+
+    return unit_test::report("HitTestCache");
+}
@@ -0,0 +1,395 @@
+﻿#include "Common/Precompile.h"
+
+#include "Common/ImageUtils/ImageEncoder.h"
+
+#include "UnitTest.h"
+
+#include <cstring>
+#include <random>
+
+#include <zlib.h>
+
+using namespace d14engine;
+using namespace d14engine::image_utils;
+
+namespace
+{
+    uint32_t readBigEndian(const uint8_t* bytes)
+    {
+        return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3];
+    }
+
+    struct DecodedImage
+    {
+        uint32_t width = 0, height = 0;
+
+        int channelCount = 0;
+
+        std::vector<uint8_t> pixels = {};
+    };
+
+    int paethPredictor(int a, int b, int c)
+    {
+        int p = a + b - c;
+        int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+
+        if (pa <= pb && pa <= pc) return a;
+        return pb <= pc ? b : c;
+    }
+
+    // Checks the CRC of every chunk, inflates the IDATs with zlib and then
+    // reverses the filters, so this is independent of the encoder.
+    Optional<DecodedImage> decodePng(const std::vector<uint8_t>& file)
+    {
+        static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+        if (file.size() < 8 || std::memcmp(file.data(), signature, 8) != 0) return std::nullopt;
+
+        DecodedImage image = {};
+        std::vector<uint8_t> compressed = {};
+
+        bool hasEnd = false;
+        for (size_t offset = 8; offset + 12 <= file.size();)
+        {
+            uint32_t length = readBigEndian(&file[offset]);
+            if (offset + 12 + length > file.size()) return std::nullopt;
+
+            auto type = std::string((const char*)&file[offset + 4], 4);
+            auto data = &file[offset + 8];
+
+            if (crc32(0, &file[offset + 4], length + 4) != readBigEndian(data + length)) return std::nullopt;
+
+            if (type == "IHDR")
+            {
+                image.width = readBigEndian(data);
+                image.height = readBigEndian(data + 4);
+                image.channelCount = data[9] == 6 ? 4 : 3;
+            }
+            else if (type == "IDAT") compressed.insert(compressed.end(), data, data + length);
+            else if (type == "IEND") hasEnd = true;
+
+            offset += 12 + length;
+        }
+        if (!hasEnd) return std::nullopt;
+
+        size_t rowSize = (size_t)image.width * image.channelCount;
+
+        // One more byte to find the trailing garbage.
+        std::vector<uint8_t> filtered((rowSize + 1) * image.height + 1);
+        uLongf filteredSize = (uLongf)filtered.size();
+
+        if (uncompress(filtered.data(), &filteredSize, compressed.data(), (uLong)compressed.size()) != Z_OK ||
+            filteredSize != (rowSize + 1) * image.height) return std::nullopt;
+
+        image.pixels.resize(rowSize * image.height);
+
+        for (uint32_t y = 0; y < image.height; ++y)
+        {
+            int filter = filtered[y * (rowSize + 1)];
+            if (filter > 4) return std::nullopt;
+
+            auto src = &filtered[y * (rowSize + 1) + 1];
+            auto dst = &image.pixels[y * rowSize];
+            auto up = y > 0 ? &image.pixels[(y - 1) * rowSize] : nullptr;
+
+            int bpp = image.channelCount;
+            for (size_t i = 0; i < rowSize; ++i)
+            {
+                int a = i >= (size_t)bpp ? dst[i - bpp] : 0;
+                int b = up ? up[i] : 0;
+                int c = up && i >= (size_t)bpp ? up[i - bpp] : 0;
+
+                int predictor = 0;
+                switch (filter)
+                {
+                case 1: predictor = a; break;
+                case 2: predictor = b; break;
+                case 3: predictor = (a + b) / 2; break;
+                case 4: predictor = paethPredictor(a, b, c); break;
+                default: break;
+                }
+                dst[i] = (uint8_t)(src[i] + predictor);
+            }
+        }
+        return image;
+    }
+
+    // Always decodes to RGBA, as the reference decoder does.
+    Optional<DecodedImage> decodeQoi(const std::vector<uint8_t>& file)
+    {
+        if (file.size() < 22 || std::memcmp(file.data(), "qoif", 4) != 0) return std::nullopt;
+
+        DecodedImage image = {};
+        image.width = readBigEndian(&file[4]);
+        image.height = readBigEndian(&file[8]);
+        image.channelCount = file[12];
+
+        size_t pixelCount = (size_t)image.width * image.height;
+        image.pixels.resize(pixelCount * 4);
+
+        uint8_t index[64][4] = {};
+        uint8_t pixel[4] = { 0, 0, 0, 255 };
+
+        size_t offset = 14;
+        int run = 0;
+
+        for (size_t i = 0; i < pixelCount; ++i)
+        {
+            if (run > 0) --run;
+            else
+            {
+                if (offset + 8 >= file.size()) return std::nullopt;
+
+                int tag = file[offset++];
+                if (tag == 0xfe) // RGB
+                {
+                    for (int k = 0; k < 3; ++k) pixel[k] = file[offset++];
+                }
+                else if (tag == 0xff) // RGBA
+                {
+                    for (int k = 0; k < 4; ++k) pixel[k] = file[offset++];
+                }
+                else if ((tag >> 6) == 0) // INDEX
+                {
+                    std::memcpy(pixel, index[tag], 4);
+                }
+                else if ((tag >> 6) == 1) // DIFF
+                {
+                    pixel[0] += ((tag >> 4) & 3) - 2;
+                    pixel[1] += ((tag >> 2) & 3) - 2;
+                    pixel[2] += (tag & 3) - 2;
+                }
+                else if ((tag >> 6) == 2) // LUMA
+                {
+                    int dg = (tag & 63) - 32;
+                    int next = file[offset++];
+
+                    pixel[0] += dg - 8 + ((next >> 4) & 15);
+                    pixel[1] += dg;
+                    pixel[2] += dg - 8 + (next & 15);
+                }
+                else run = tag & 63; // RUN
+
+                std::memcpy(index[(pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64], pixel, 4);
+            }
+            std::memcpy(&image.pixels[i * 4], pixel, 4);
+        }
+        static const uint8_t end[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+        if (offset + 8 != file.size() || std::memcmp(&file[offset], end, 8) != 0) return std::nullopt;
+
+        return image;
+    }
+
+    enum class Content { Noise, Gradient, Blocks };
+
+    // The padding bytes of each row are filled with 0xcd, which must never
+    // reach the output.
+    std::vector<uint8_t> makePixels(uint32_t width, uint32_t height, size_t rowPitch, Content content)
+    {
+        std::vector<uint8_t> pixels(rowPitch * height, 0xcd);
+        std::mt19937 random(7);
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                auto pixel = &pixels[y * rowPitch + x * 4];
+                switch (content)
+                {
+                case Content::Noise:
+                {
+                    for (int k = 0; k < 4; ++k) pixel[k] = (uint8_t)random();
+                    break;
+                }
+                case Content::Gradient:
+                {
+                    pixel[0] = (uint8_t)(x * 255 / width);
+                    pixel[1] = (uint8_t)(y * 255 / height);
+                    pixel[2] = (uint8_t)((x / 32 + y / 32) % 2 * 200);
+                    pixel[3] = 255;
+
+                    if (random() % 40 == 0) pixel[0] ^= (uint8_t)random();
+                    break;
+                }
+                default:
+                {
+                    pixel[0] = (x / 50) % 2 ? 30 : 220;
+                    pixel[1] = 90;
+                    pixel[2] = (uint8_t)((y / 40) % 3 * 60);
+                    pixel[3] = (uint8_t)((x + y) % 255);
+                    break;
+                }
+                }
+            }
+        }
+        return pixels;
+    }
+
+    bool isSamePixels(const ImageView& source, const DecodedImage& decoded, bool alpha)
+    {
+        // QOI always decodes to RGBA, with the opaque alpha for RGB.
+        size_t pixelSize = decoded.pixels.size() / ((size_t)source.width * source.height);
+
+        for (uint32_t y = 0; y < source.height; ++y)
+        {
+            for (uint32_t x = 0; x < source.width; ++x)
+            {
+                auto expected = source.data + y * source.rowPitch + x * 4;
+                auto actual = &decoded.pixels[((size_t)y * source.width + x) * pixelSize];
+
+                for (int k = 0; k < 3; ++k)
+                {
+                    if (actual[k] != expected[k]) return false;
+                }
+                if (pixelSize == 4 && actual[3] != (alpha ? expected[3] : 255)) return false;
+            }
+        }
+        return true;
+    }
+
+    // Every level, thread count and channel count on the sizes around the
+    // stripe boundaries, with the padded rows like a readback buffer.
+    void testRoundTrip()
+    {
+        std::pair<uint32_t, uint32_t> sizes[] = { { 1, 1 }, { 3, 2 }, { 17, 300 }, { 640, 480 }, { 1000, 777 } };
+
+        for (auto& size : sizes)
+        {
+            uint32_t width = size.first, height = size.second;
+            size_t rowPitch = width * 4 + (width % 3) * 4;
+
+            for (auto content : { Content::Noise, Content::Gradient, Content::Blocks })
+            {
+                auto pixels = makePixels(width, height, rowPitch, content);
+                ImageView view = { pixels.data(), width, height, rowPitch };
+
+                for (bool alpha : { false, true })
+                {
+                    for (int level : { 0, 1, 4, 6, 9 })
+                    {
+                        for (size_t threadCount : { 1, 3, 8 })
+                        {
+                            PngSettings settings = {};
+                            settings.level = level;
+                            settings.alpha = alpha;
+                            settings.threadCount = threadCount;
+                            settings.minStripeSize = 4096; // many stripes
+
+                            auto decoded = decodePng(encodePng(view, settings));
+
+                            bool isSame = D14_CHECK(decoded.has_value()) &&
+                                D14_CHECK(decoded->width == width && decoded->height == height) &&
+                                D14_CHECK(decoded->channelCount == (alpha ? 4 : 3)) &&
+                                D14_CHECK(isSamePixels(view, decoded.value(), alpha));
+
+                            if (!isSame)
+                            {
+                                std::printf("png %ux%u, content %d, alpha %d, level %d, %zu threads\n",
+                                    width, height, (int)content, (int)alpha, level, threadCount);
+                                return;
+                            }
+                        }
+                    }
+                    auto decoded = decodeQoi(encodeQoi(view, alpha));
+
+                    bool isSame = D14_CHECK(decoded.has_value()) &&
+                        D14_CHECK(decoded->width == width && decoded->height == height) &&
+                        D14_CHECK(decoded->channelCount == (alpha ? 4 : 3)) &&
+                        D14_CHECK(isSamePixels(view, decoded.value(), alpha));
+
+                    if (!isSame)
+                    {
+                        std::printf("qoi %ux%u, content %d, alpha %d\n", width, height, (int)content, (int)alpha);
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+    size_t idatCount(const std::vector<uint8_t>& file)
+    {
+        size_t count = 0;
+        for (size_t offset = 8; offset + 12 <= file.size(); offset += 12 + readBigEndian(&file[offset]))
+        {
+            if (std::memcmp(&file[offset + 4], "IDAT", 4) == 0) ++count;
+        }
+        return count;
+    }
+
+    // One stripe per thread at most, and none smaller than minStripeSize.
+    // Each stripe takes an IDAT, and so does the zlib trailer.
+    void testStripes()
+    {
+        uint32_t width = 800, height = 600;
+        auto pixels = makePixels(width, height, width * 4, Content::Gradient);
+
+        ImageView view = { pixels.data(), width, height, width * 4 };
+
+        PngSettings settings = {};
+        settings.minStripeSize = 16 * 1024;
+
+        settings.threadCount = 1;
+        D14_CHECK(idatCount(encodePng(view, settings)) == 1 + 1);
+
+        settings.threadCount = 8;
+        D14_CHECK(idatCount(encodePng(view, settings)) == 8 + 1);
+
+        // 1.9 MB of the filtered data
+        settings.minStripeSize = 1024 * 1024;
+        D14_CHECK(idatCount(encodePng(view, settings)) == 1 + 1);
+    }
+
+    // A 4K frame like a screenshot, and zlib on the unfiltered pixels as the
+    // baseline of a single-threaded encoder.
+    void benchmark()
+    {
+        uint32_t width = 3840, height = 2160;
+        auto pixels = makePixels(width, height, width * 4, Content::Gradient);
+
+        ImageView view = { pixels.data(), width, height, width * 4 };
+
+        for (int level : { 0, 1, 6 })
+        {
+            for (size_t threadCount : { 1, 0 })
+            {
+                PngSettings settings = {};
+                settings.level = level;
+                settings.threadCount = threadCount;
+
+                size_t fileSize = 0;
+                double time = unit_test::measure([&] { fileSize = encodePng(view, settings).size(); }, 3);
+
+                std::printf("benchmark png (4K, level %d, %s): %.1f ms, %.2f MB\n", level,
+                    threadCount == 1 ? "1 thread" : "all threads", time, fileSize / 1048576.0);
+            }
+        }
+        size_t fileSize = 0;
+        double time = unit_test::measure([&] { fileSize = encodeQoi(view).size(); }, 3);
+
+        std::printf("benchmark qoi (4K): %.1f ms, %.2f MB\n", time, fileSize / 1048576.0);
+
+        for (int level : { 1, 6 })
+        {
+            std::vector<uint8_t> compressed(compressBound((uLong)pixels.size()));
+            uLongf compressedSize = 0;
+
+            double time = unit_test::measure([&]
+            {
+                compressedSize = (uLongf)compressed.size();
+                compress2(compressed.data(), &compressedSize, pixels.data(), (uLong)pixels.size(), level);
+            },
+            1);
+            std::printf("benchmark zlib (4K, level %d, unfiltered): %.1f ms, %.2f MB\n",
+                level, time, compressedSize / 1048576.0);
+        }
+    }
+}
+
+int main()
+{
+    testRoundTrip();
+    testStripes();
+    benchmark();
+
+    return unit_test::report("ImageEncoder");
+}
@@ -0,0 +1,198 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/InputCoalescer.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::uikit;
+
+namespace
+{
+    struct Point { float x = 0.0f, y = 0.0f; };
+
+    using Coalescer = InputCoalescer<Point>;
+    using Kind = Coalescer::Entry::Kind;
+
+    void testMerging()
+    {
+        Coalescer input = {};
+        D14_CHECK(input.empty());
+
+        for (int i = 0; i < 20; ++i) input.pushMove({ (float)i, 0.0f }, 0);
+
+        // The consecutive moves with the same state become one entry.
+        D14_CHECK(input.entries().size() == 1);
+        D14_CHECK(input.entries()[0].point.x == 19.0f);
+
+        auto history = input.history(input.entries()[0]);
+        D14_CHECK(history.size() == 20);
+        D14_CHECK(history.front().x == 0.0f && history.back().x == 19.0f);
+
+        input.pushMove({ 20.0f, 0.0f }, 1); // state changed
+
+        input.pushWheel({ 20.0f, 0.0f }, 1, 120);
+        input.pushWheel({ 20.0f, 0.0f }, 1, -40);
+        input.pushWheel({ 21.0f, 0.0f }, 1, 120); // point changed
+
+        input.pushMove({ 22.0f, 0.0f }, 1);
+        input.pushMove({ 23.0f, 0.0f }, 1);
+
+        auto& entries = input.entries();
+        D14_CHECK(entries.size() == 5);
+
+        D14_CHECK(entries[1].kind == Kind::Move && entries[1].historyCount == 1);
+        D14_CHECK(entries[2].kind == Kind::Wheel && entries[2].wheelDelta == 80);
+        D14_CHECK(entries[3].kind == Kind::Wheel && entries[3].wheelDelta == 120);
+
+        history = input.history(entries[4]);
+        D14_CHECK(history.size() == 2 && history[0].x == 22.0f && history[1].x == 23.0f);
+
+        input.clear();
+        D14_CHECK(input.empty());
+    }
+
+    // Replaying the entries must give the same final point, the same wheel
+    // total and the same ordered move points as the raw messages.
+    void testRandomizedReplay()
+    {
+        std::mt19937 random(3);
+        Coalescer input = {};
+
+        for (int frame = 0; frame < 2000; ++frame)
+        {
+            std::vector<Point> rawMoves = {};
+            int rawWheel = 0;
+            Point lastPoint = {};
+
+            int messageCount = random() % 64;
+            for (int i = 0; i < messageCount; ++i)
+            {
+                Point point = { (float)(random() % 4), (float)(random() % 4) };
+                uint32_t state = random() % 2;
+
+                if (random() % 4 == 0)
+                {
+                    int delta = 120 * ((int)(random() % 3) - 1);
+                    input.pushWheel(point, state, delta);
+                    rawWheel += delta;
+                }
+                else
+                {
+                    input.pushMove(point, state);
+                    rawMoves.push_back(point);
+                }
+                lastPoint = point;
+            }
+            D14_CHECK(input.entries().size() <= (size_t)messageCount);
+
+            std::vector<Point> replayedMoves = {};
+            int replayedWheel = 0;
+
+            for (auto& entry : input.entries())
+            {
+                if (entry.kind == Kind::Move)
+                {
+                    auto history = input.history(entry);
+                    D14_CHECK(history.back().x == entry.point.x && history.back().y == entry.point.y);
+
+                    replayedMoves.insert(replayedMoves.end(), history.begin(), history.end());
+                }
+                else replayedWheel += entry.wheelDelta;
+            }
+            D14_CHECK(replayedWheel == rawWheel);
+            D14_CHECK(replayedMoves.size() == rawMoves.size());
+
+            for (size_t i = 0; i < std::min(replayedMoves.size(), rawMoves.size()); ++i)
+            {
+                D14_CHECK(replayedMoves[i].x == rawMoves[i].x && replayedMoves[i].y == rawMoves[i].y);
+            }
+            if (!input.empty())
+            {
+                auto& point = input.entries().back().point;
+                D14_CHECK(point.x == lastPoint.x && point.y == lastPoint.y);
+            }
+            input.clear();
+        }
+    }
+
+    // Like Application::flushCoalescedInput, where a handler pushes new
+    // input and flushes again while the entries are being dispatched.
+    struct Dispatcher
+    {
+        Coalescer input = {};
+
+        std::vector<float> dispatched = {};
+
+        void flush()
+        {
+            if (input.empty()) return;
+
+            Coalescer dispatching = {};
+            dispatching.swap(input);
+
+            for (auto& entry : dispatching.entries())
+            {
+                dispatched.push_back(entry.point.x);
+
+                // e.g. a handler that moves the cursor with SendMessage
+                if (entry.point.x == 1.0f)
+                {
+                    input.pushMove({ 100.0f, 0.0f }, 1);
+                    input.pushWheel({ 101.0f, 0.0f }, 0, 120);
+                    flush();
+                }
+                else if (entry.point.x == 101.0f)
+                {
+                    input.pushMove({ 200.0f, 0.0f }, 0);
+                }
+            }
+            if (input.empty())
+            {
+                dispatching.clear();
+                input.swap(dispatching);
+            }
+        }
+    };
+
+    void testReentrantFlush()
+    {
+        Dispatcher dispatcher = {};
+
+        dispatcher.input.pushMove({ 0.0f, 0.0f }, 0);
+        dispatcher.input.pushWheel({ 1.0f, 0.0f }, 0, 120);
+        dispatcher.input.pushMove({ 2.0f, 0.0f }, 0);
+
+        dispatcher.flush();
+
+        // The nested flush dispatches the new entries in place, and the
+        // entry pushed by it waits for the next flush.
+        std::vector<float> expected = { 0.0f, 1.0f, 100.0f, 101.0f, 2.0f };
+        D14_CHECK(dispatcher.dispatched == expected);
+        D14_CHECK(dispatcher.input.entries().size() == 1);
+        D14_CHECK(dispatcher.input.entries()[0].point.x == 200.0f);
+
+        dispatcher.flush();
+        D14_CHECK(dispatcher.dispatched.back() == 200.0f && dispatcher.input.empty());
+
+        // The storage goes back to the coalescer when nothing is waiting.
+        for (int i = 0; i < 64; ++i) dispatcher.input.pushMove({ 0.0f, (float)i }, (uint32_t)i);
+
+        auto data = dispatcher.input.entries().data();
+        dispatcher.flush();
+
+        dispatcher.input.pushMove({ 0.0f, 0.0f }, 0);
+        D14_CHECK(dispatcher.input.entries().data() == data);
+    }
+}
+
+int main()
+{
+    testMerging();
+    testRandomizedReplay();
+    testReentrantFlush();
+
+    return unit_test::report("InputCoalescer");
+}
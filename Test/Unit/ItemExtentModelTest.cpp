@@ -0,0 +1,242 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/ItemExtentModel.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::uikit;
+
+namespace
+{
+    // The naive O(n) model that ItemExtentModel is checked against.
+    struct ReferenceModel
+    {
+        float estimatedExtent = 0.0f;
+
+        std::vector<float> extents = {};
+        std::vector<bool> measured = {};
+
+        float extent(size_t index) const
+        {
+            return measured[index] ? extents[index] : estimatedExtent;
+        }
+
+        double offset(size_t index) const
+        {
+            double sum = 0.0;
+            for (size_t i = 0; i < index; ++i) sum += extent(i);
+            return sum;
+        }
+
+        size_t indexAt(float offset) const
+        {
+            if (offset < 0.0f) return extents.size();
+
+            double sum = 0.0;
+            for (size_t i = 0; i < extents.size(); ++i)
+            {
+                sum += extent(i);
+                if (sum > offset) return i;
+            }
+            return extents.size();
+        }
+    };
+
+    void testBasics()
+    {
+        ItemExtentModel model = {};
+        model.setEstimatedExtent(20.0f);
+
+        D14_CHECK(model.count() == 0);
+        D14_CHECK(model.totalExtent() == 0.0f);
+        D14_CHECK(model.indexAt(0.0f) == 0);
+
+        model.insert(0, 3); // unmeasured
+        D14_CHECK(model.totalExtent() == 60.0f);
+        D14_CHECK(!model.isMeasured(1));
+
+        model.setExtent(1, 50.0f);
+        D14_CHECK(model.isMeasured(1));
+        D14_CHECK(model.offset(2) == 70.0f);
+        D14_CHECK(model.totalExtent() == 90.0f);
+
+        // Only the unmeasured ones follow the estimate.
+        model.setEstimatedExtent(10.0f);
+        D14_CHECK(model.totalExtent() == 70.0f);
+
+        D14_CHECK(model.indexAt(9.9f) == 0);
+        D14_CHECK(model.indexAt(10.0f) == 1);
+        D14_CHECK(model.indexAt(59.9f) == 1);
+        D14_CHECK(model.indexAt(60.0f) == 2);
+        D14_CHECK(model.indexAt(70.0f) == 3);
+        D14_CHECK(model.indexAt(-1.0f) == 3);
+
+        // The zero-extent items are never hit.
+        model.setExtent(0, 0.0f);
+        D14_CHECK(model.indexAt(0.0f) == 1);
+
+        // Negative extents are clamped to keep the offsets monotonic.
+        model.setExtent(2, -5.0f);
+        D14_CHECK(model.extent(2) == 0.0f);
+
+        model.erase(0, 10);
+        D14_CHECK(model.count() == 0);
+        D14_CHECK(model.totalExtent() == 0.0f);
+    }
+
+    void testAgainstReference()
+    {
+        std::mt19937 random(7);
+
+        ItemExtentModel model = {};
+        ReferenceModel reference = {};
+
+        auto setEstimate = [&](float value)
+        {
+            model.setEstimatedExtent(value);
+            reference.estimatedExtent = value;
+        };
+        setEstimate(20.0f);
+
+        for (int step = 0; step < 20000; ++step)
+        {
+            auto& extents = reference.extents;
+            auto& measured = reference.measured;
+
+            // Append at the end often, which takes the O(log n) path.
+            auto pickIndex = [&](size_t size)
+            {
+                return random() % 3 == 0 ? size : random() % (size + 1);
+            };
+            switch (random() % 7)
+            {
+            case 0: // insert unmeasured
+            {
+                size_t index = pickIndex(extents.size());
+                size_t count = random() % 4;
+
+                model.insert(index, count);
+                extents.insert(extents.begin() + index, count, 0.0f);
+                measured.insert(measured.begin() + index, count, false);
+                break;
+            }
+            case 1: // insert measured
+            {
+                size_t index = pickIndex(extents.size());
+
+                std::vector<float> values(random() % 4);
+                for (auto& value : values) value = (float)(random() % 50);
+
+                model.insert(index, values);
+                extents.insert(extents.begin() + index, values.begin(), values.end());
+                measured.insert(measured.begin() + index, values.size(), true);
+                break;
+            }
+            case 2: // erase
+            {
+                if (extents.empty()) break;
+
+                size_t index = pickIndex(extents.size() - 1);
+                size_t count = 1 + random() % 3;
+
+                model.erase(index, count);
+
+                count = std::min(count, extents.size() - index);
+                extents.erase(extents.begin() + index, extents.begin() + index + count);
+                measured.erase(measured.begin() + index, measured.begin() + index + count);
+                break;
+            }
+            case 3:
+            case 4: // measure
+            {
+                if (extents.empty()) break;
+
+                size_t index = random() % extents.size();
+                float value = (float)(random() % 60);
+
+                model.setExtent(index, value);
+                extents[index] = value;
+                measured[index] = true;
+                break;
+            }
+            case 5: setEstimate((float)(random() % 30)); break;
+            default: break;
+            }
+            if (!D14_CHECK(model.count() == extents.size())) return;
+
+            // Checking every item makes the loop O(n^2), so sample them.
+            for (int i = 0; i < 4 && !extents.empty(); ++i)
+            {
+                size_t index = random() % extents.size();
+
+                D14_CHECK(model.isMeasured(index) == measured[index]);
+                D14_CHECK(model.extent(index) == reference.extent(index));
+                D14_CHECK_NEAR(model.offset(index), reference.offset(index), 1.0e-3);
+            }
+            double total = reference.offset(extents.size());
+            D14_CHECK_NEAR(model.totalExtent(), total, 1.0e-3);
+
+            for (int i = 0; i < 4; ++i)
+            {
+                // The integer offsets hit the boundaries exactly.
+                float offset = (float)(random() % ((int)total + 20)) - 5.0f;
+
+                D14_CHECK(model.indexAt(offset) == reference.indexAt(offset));
+            }
+        }
+    }
+
+    void benchmark()
+    {
+        const size_t itemCount = 1'000'000;
+
+        ItemExtentModel model = {};
+        model.setEstimatedExtent(48.0f);
+
+        double appendTime = unit_test::measure([&]
+        {
+            for (size_t i = 0; i < itemCount; ++i) model.insert(model.count(), 1);
+        });
+        double measureTime = unit_test::measure([&]
+        {
+            for (size_t i = 0; i < itemCount; i += 7) model.setExtent(i, 30.0f + (float)(i % 13));
+        });
+        std::mt19937 random(42);
+        float total = model.totalExtent();
+
+        const int queryCount = 100000;
+        size_t checksum = 0;
+
+        double queryTime = unit_test::measure([&]
+        {
+            for (int i = 0; i < queryCount; ++i)
+            {
+                size_t index = model.indexAt(total * (float)(random() % 10000) / 10000.0f);
+                checksum += (size_t)model.offset(index);
+            }
+        });
+        double totalTime = unit_test::measure([&] { checksum += (size_t)model.totalExtent(); }, queryCount);
+
+        std::printf(
+            "benchmark (%zu items): append %.1f ns, measure %.1f ns, "
+            "indexAt+offset %.1f ns, totalExtent %.1f ns (checksum %zu)\n",
+            itemCount,
+            appendTime * 1.0e6 / itemCount,
+            measureTime * 1.0e6 / (itemCount / 7),
+            queryTime * 1.0e6 / queryCount,
+            totalTime * 1.0e6,
+            checksum);
+    }
+}
+
+int main()
+{
+    testBasics();
+    testAgainstReference();
+    benchmark();
+
+    return unit_test::report("ItemExtentModel");
+}
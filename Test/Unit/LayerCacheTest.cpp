@@ -0,0 +1,108 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/LayerCache.h"
+
+#include "UnitTest.h"
+
+using namespace d14engine;
+using namespace d14engine::uikit;
+
+namespace
+{
+    struct Node
+    {
+        Node* parent = nullptr;
+
+        LayerCacheState* cache = nullptr;
+    };
+
+    Node* parentOf(Node* node) { return node->parent; }
+
+    LayerCacheState* cacheOf(Node* node) { return node->cache; }
+
+    // What Panel does in the layer pass: the nested caches are rendered
+    // before the outer one.
+    void drawFrame(LayerCacheState& outer, LayerCacheState& inner)
+    {
+        if (outer.beginFrame())
+        {
+            if (inner.beginFrame()) inner.markRendered();
+
+            outer.markRendered();
+        }
+    }
+
+    void testRenderAndReuse()
+    {
+        LayerCacheState root = {}, middle = {};
+
+        Node rootNode = { nullptr, &root };
+        Node middleNode = { &rootNode, &middle };
+        Node leafNode = { &middleNode, nullptr };
+        Node plainNode = { &leafNode, nullptr };
+
+        D14_CHECK(!root.isValid());
+
+        // A static subtree is rendered once and then reused.
+        for (int i = 0; i < 100; ++i) drawFrame(root, middle);
+
+        D14_CHECK(root.renderCount() == 1 && root.reuseCount() == 99);
+        D14_CHECK(middle.renderCount() == 1 && middle.reuseCount() == 0);
+
+        // A change deep inside reaches every caching ancestor.
+        invalidateLayerCaches(&plainNode, true, parentOf, cacheOf);
+        D14_CHECK(!root.isValid() && !middle.isValid());
+
+        drawFrame(root, middle);
+        D14_CHECK(root.renderCount() == 2 && middle.renderCount() == 2);
+
+        // Moving the middle one only touches its ancestors, since its own
+        // bitmap is in the self coordinate.
+        invalidateLayerCaches(&middleNode, false, parentOf, cacheOf);
+        D14_CHECK(!root.isValid() && middle.isValid());
+
+        drawFrame(root, middle);
+        D14_CHECK(root.renderCount() == 3 && middle.reuseCount() == 1);
+
+        // An invalid cache under a valid one (e.g. hidden and not rendered)
+        // does not stop the walk.
+        middle.invalidate();
+        invalidateLayerCaches(&leafNode, true, parentOf, cacheOf);
+        D14_CHECK(!root.isValid());
+
+        // Nothing to do for the root.
+        drawFrame(root, middle);
+        invalidateLayerCaches(&rootNode, false, parentOf, cacheOf);
+        D14_CHECK(root.isValid());
+    }
+
+    // The walk runs on every change inside a cached subtree, so it must stay
+    // cheap for the deep trees.
+    void benchmark()
+    {
+        for (size_t depth : { 8, 32, 128 })
+        {
+            std::vector<Node> nodes(depth);
+            std::vector<LayerCacheState> caches(depth / 8);
+
+            for (size_t i = 1; i < depth; ++i) nodes[i].parent = &nodes[i - 1];
+            for (size_t i = 0; i < caches.size(); ++i) nodes[i * 8].cache = &caches[i];
+
+            double time = unit_test::measure([&]
+            {
+                invalidateLayerCaches(&nodes.back(), true, parentOf, cacheOf);
+            },
+            100000);
+            std::printf("benchmark invalidateLayerCaches (depth %zu, %zu caches): %.1f ns\n",
+                depth, caches.size(), time * 1.0e6);
+        }
+    }
+}
+
+int main()
+{
+    testRenderAndReuse();
+    benchmark();
+
+    return unit_test::report("LayerCache");
+}
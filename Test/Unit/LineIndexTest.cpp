@@ -0,0 +1,221 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/LineIndex.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::uikit;
+
+namespace
+{
+    using Position = LineIndex::Position;
+
+    std::vector<size_t> naiveLineStarts(WstrViewParam text)
+    {
+        std::vector<size_t> starts = { 0 };
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            if (text[i] == L'\n') starts.push_back(i + 1);
+        }
+        return starts;
+    }
+
+    // Compares every line and every offset with rescanning the text.
+    bool isSameAsNaive(const LineIndex& index, WstrViewParam text)
+    {
+        auto starts = naiveLineStarts(text);
+
+        if (index.lineCount() != starts.size() || index.textLength() != text.size()) return false;
+
+        for (size_t line = 0; line < starts.size(); ++line)
+        {
+            size_t end = line + 1 < starts.size() ? starts[line + 1] - 1 : text.size();
+
+            if (index.lineStart(line) != starts[line]) return false;
+            if (index.lineLength(line) != end - starts[line]) return false;
+
+            // The columns are clamped to the line.
+            if (index.offsetOf({ line, 0 }) != starts[line]) return false;
+            if (index.offsetOf({ line, SIZE_MAX }) != end) return false;
+        }
+        for (size_t offset = 0; offset <= text.size() + 1; ++offset)
+        {
+            size_t clamped = std::min(offset, text.size());
+            size_t line = std::upper_bound(starts.begin(), starts.end(), clamped) - starts.begin() - 1;
+
+            auto position = index.positionOf(offset);
+            if (position != Position{ line, clamped - starts[line] }) return false;
+
+            if (index.offsetOf(position) != clamped) return false;
+        }
+        // The lines are clamped to the last one.
+        return index.offsetOf({ SIZE_MAX, 0 }) == starts.back();
+    }
+
+    void testFixed()
+    {
+        LineIndex empty;
+        D14_CHECK(empty.lineCount() == 1 && empty.lineLength(0) == 0);
+        D14_CHECK(isSameAsNaive(empty, L""));
+
+        Wstring text = L"ab\ncd\n";
+        LineIndex index(text);
+
+        D14_CHECK(index.lineCount() == 3);
+        D14_CHECK((index.positionOf(2) == Position{ 0, 2 }));
+        D14_CHECK((index.positionOf(3) == Position{ 1, 0 }));
+        D14_CHECK(isSameAsNaive(index, text));
+
+        // Joining the lines.
+        index.erase(2, 1);
+        text.erase(2, 1);
+        D14_CHECK(index.lineCount() == 2 && isSameAsNaive(index, text));
+
+        // The offset is clamped to the text length.
+        index.insert(6, L"x\n\ny");
+        text.insert(5, L"x\n\ny");
+        D14_CHECK(index.lineCount() == 4 && isSameAsNaive(index, text));
+
+        // A '\r' is an ordinary character of the line.
+        index.assign(L"a\r\nb");
+        D14_CHECK(index.lineCount() == 2 && index.lineLength(0) == 2);
+    }
+
+    // Random inserts, erases and assigns (with many '\n' and '\r') against
+    // rescanning the text after every edit.
+    void testRandomized()
+    {
+        std::mt19937 random(1);
+
+        auto randomText = [&](size_t length)
+        {
+            Wstring text = {};
+            for (size_t i = 0; i < length; ++i)
+            {
+                auto kind = random() % 6;
+                if (kind == 0) text += L'\n';
+                else if (kind == 1) text += L'\r';
+                else text += (wchar_t)(L'a' + random() % 26);
+            }
+            return text;
+        };
+        for (int trial = 0; trial < 200; ++trial)
+        {
+            auto text = randomText(random() % 40);
+            LineIndex index(text);
+
+            if (!D14_CHECK(isSameAsNaive(index, text))) return;
+
+            for (int step = 0; step < 60; ++step)
+            {
+                auto kind = random() % 10;
+                if (kind < 5)
+                {
+                    auto inserted = randomText(random() % (kind == 0 ? 30 : 4));
+                    size_t offset = random() % (text.size() + 1);
+
+                    index.insert(offset, inserted);
+                    text.insert(offset, inserted);
+                }
+                else if (kind < 9)
+                {
+                    size_t offset = random() % (text.size() + 2);
+                    size_t count = random() % (kind == 5 ? 40 : 4);
+
+                    index.erase(offset, count);
+                    if (offset < text.size()) text.erase(offset, count);
+                }
+                else
+                {
+                    text = randomText(random() % 50);
+                    index.assign(text);
+                }
+                if (!D14_CHECK(isSameAsNaive(index, text))) return;
+            }
+        }
+    }
+
+    // A text of 1M lines, where the lookups and edits should take a few
+    // microseconds compared with the milliseconds of rescanning the text.
+    void benchmark()
+    {
+        std::mt19937 random(1);
+
+        Wstring text = {};
+        for (int i = 0; i < 1000000; ++i)
+        {
+            text.append(20 + random() % 60, L'x');
+            text += L'\n';
+        }
+        LineIndex index;
+
+        double buildTime = unit_test::measure([&] { index.assign(text); }, 1);
+
+        std::printf("benchmark build (%zu lines, %zu characters): %.1f ms\n",
+            index.lineCount(), index.textLength(), buildTime);
+
+        const int lookupCount = 200000;
+        size_t sum = 0;
+
+        double positionTime = unit_test::measure([&]
+        {
+            sum += index.positionOf(random() % index.textLength()).line;
+        },
+        lookupCount);
+        double lineStartTime = unit_test::measure([&]
+        {
+            sum += index.lineStart(random() % index.lineCount());
+        },
+        lookupCount);
+        std::printf("benchmark positionOf: %.0f ns, lineStart: %.0f ns\n",
+            positionTime * 1.0e6, lineStartTime * 1.0e6);
+
+        int step = 0;
+        double typingTime = unit_test::measure([&]
+        {
+            size_t offset = random() % index.textLength();
+            switch (step++ % 4)
+            {
+            case 0: case 1: index.insert(offset, L"a"); break;
+            case 2: index.insert(offset, L"\n"); break;
+            default: index.erase(offset, 1); break;
+            }
+        },
+        lookupCount);
+
+        Wstring pasted = {};
+        for (int i = 0; i < 100; ++i)
+        {
+            pasted.append(random() % 10, L'y');
+            pasted += L'\n';
+        }
+        double pasteTime = unit_test::measure([&]
+        {
+            size_t offset = random() % index.textLength();
+            if (step++ % 2) index.insert(offset, pasted);
+            else index.erase(offset, pasted.size());
+        },
+        20000);
+        double rescanTime = unit_test::measure([&]
+        {
+            sum += std::count(text.begin(), text.end(), L'\n');
+        },
+        10);
+        std::printf("benchmark typing: %.0f ns, pasting/deleting 100 lines: %.0f ns, "
+            "rescanning the text: %.1f ms\n", typingTime * 1.0e6, pasteTime * 1.0e6, rescanTime);
+
+        D14_CHECK(sum > 0);
+    }
+}
+
+int main()
+{
+    testFixed();
+    testRandomized();
+    benchmark();
+
+    return unit_test::report("LineIndex");
+}
@@ -0,0 +1,269 @@
+﻿#include "Common/Precompile.h"
+
+#include "Common/ImageUtils/MipChain.h"
+
+#include "UnitTest.h"
+
+#include <numbers>
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::image_utils;
+
+namespace
+{
+    enum class Alpha { Random, Cutout, Opaque };
+
+    // Premultiplied pixels, where the padding bytes of each row are filled
+    // with 0xcd, which must never reach the output.
+    std::vector<uint8_t> makePixels(uint32_t width, uint32_t height, size_t rowPitch, Alpha alphaMode, std::mt19937& random)
+    {
+        std::vector<uint8_t> pixels(rowPitch * height, 0xcd);
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                auto pixel = &pixels[y * rowPitch + x * 4];
+
+                uint8_t alpha = 255;
+                if (alphaMode == Alpha::Random) alpha = (uint8_t)random();
+                else if (alphaMode == Alpha::Cutout) alpha = (x / 3 + y / 5) % 2 * 255;
+
+                for (int k = 0; k < 3; ++k) pixel[k] = (uint8_t)(random() % (alpha + 1));
+                pixel[3] = alpha;
+            }
+        }
+        return pixels;
+    }
+
+    Image referenceBox(const ImageView& image)
+    {
+        Image result = {};
+        result.width = (image.width + 1) / 2;
+        result.height = (image.height + 1) / 2;
+        result.pixels.resize(result.width * result.height * 4);
+
+        for (uint32_t y = 0; y < result.height; ++y)
+        {
+            for (uint32_t x = 0; x < result.width; ++x)
+            {
+                for (int k = 0; k < 4; ++k)
+                {
+                    int sum = 0;
+                    for (uint32_t dy = 0; dy < 2; ++dy)
+                    {
+                        for (uint32_t dx = 0; dx < 2; ++dx)
+                        {
+                            auto sx = std::min(x * 2 + dx, image.width - 1);
+                            auto sy = std::min(y * 2 + dy, image.height - 1);
+
+                            sum += image.data[sy * image.rowPitch + sx * 4 + k];
+                        }
+                    }
+                    result.pixels[(y * result.width + x) * 4 + k] = (uint8_t)((sum + 2) / 4);
+                }
+            }
+        }
+        return result;
+    }
+
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 40; ++k)
+        {
+            term *= (x / (2 * k)) * (x / (2 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    // The 8x8 Kaiser-windowed sinc (beta 4) in double, which is computed
+    // without the fixed-point weights of the kernels.
+    Image referenceKaiser(const ImageView& image)
+    {
+        double weights[8] = {}, weightSum = 0.0;
+        for (int k = 0; k < 8; ++k)
+        {
+            double d = k - 3.5, t = d / 4.0, u = std::numbers::pi * d / 2.0;
+
+            weights[k] = std::sin(u) / u * besselI0(4.0 * std::sqrt(1.0 - t * t)) / besselI0(4.0);
+            weightSum += weights[k];
+        }
+        for (auto& weight : weights) weight /= weightSum;
+
+        Image result = {};
+        result.width = (image.width + 1) / 2;
+        result.height = (image.height + 1) / 2;
+        result.pixels.resize(result.width * result.height * 4);
+
+        for (uint32_t y = 0; y < result.height; ++y)
+        {
+            for (uint32_t x = 0; x < result.width; ++x)
+            {
+                double sums[4] = {};
+                for (int ky = 0; ky < 8; ++ky)
+                {
+                    for (int kx = 0; kx < 8; ++kx)
+                    {
+                        auto sy = std::clamp<int64_t>((int64_t)y * 2 - 3 + ky, 0, image.height - 1);
+                        auto sx = std::clamp<int64_t>((int64_t)x * 2 - 3 + kx, 0, image.width - 1);
+
+                        for (int k = 0; k < 4; ++k)
+                        {
+                            sums[k] += weights[ky] * weights[kx] * image.data[sy * image.rowPitch + sx * 4 + k];
+                        }
+                    }
+                }
+                auto pixel = &result.pixels[(y * result.width + x) * 4];
+
+                double alpha = std::clamp(sums[3], 0.0, 255.0);
+                for (int k = 0; k < 3; ++k)
+                {
+                    pixel[k] = (uint8_t)std::lrint(std::min(std::clamp(sums[k], 0.0, 255.0), alpha));
+                }
+                pixel[3] = (uint8_t)std::lrint(alpha);
+            }
+        }
+        return result;
+    }
+
+    bool isPremultiplied(const Image& image)
+    {
+        for (size_t i = 0; i < image.pixels.size(); i += 4)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                if (image.pixels[i + k] > image.pixels[i + 3]) return false;
+            }
+        }
+        return true;
+    }
+
+    // Every SIMD level against the references, on the sizes around the
+    // vector widths, with and without the padded rows.
+    void testDownsample()
+    {
+        std::mt19937 random(7);
+
+        for (uint32_t width : { 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 64, 65, 127 })
+        {
+            for (uint32_t height : { 1, 2, 3, 7, 8, 13 })
+            {
+                for (auto alphaMode : { Alpha::Random, Alpha::Cutout, Alpha::Opaque })
+                {
+                    for (size_t padding : { 0, 12 })
+                    {
+                        size_t rowPitch = width * 4 + padding;
+
+                        auto pixels = makePixels(width, height, rowPitch, alphaMode, random);
+                        ImageView view = { pixels.data(), width, height, rowPitch };
+
+                        auto box = referenceBox(view);
+                        auto kaiser = referenceKaiser(view);
+
+                        Image scalarKaiser = {};
+                        for (auto simd : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 })
+                        {
+                            auto result = downsample(view, MipFilter::Box, simd);
+
+                            bool isSame = D14_CHECK(result.width == box.width && result.height == box.height) &&
+                                D14_CHECK(result.pixels == box.pixels);
+
+                            result = downsample(view, MipFilter::Kaiser, simd);
+
+                            // The same results at all levels.
+                            if (simd == SimdLevel::Scalar) scalarKaiser = result;
+                            isSame = isSame && D14_CHECK(result.pixels == scalarKaiser.pixels);
+
+                            int maxDifference = 0;
+                            for (size_t i = 0; i < result.pixels.size(); ++i)
+                            {
+                                maxDifference = std::max(maxDifference, std::abs(result.pixels[i] - kaiser.pixels[i]));
+                            }
+                            isSame = isSame && D14_CHECK(maxDifference <= 1) && D14_CHECK(isPremultiplied(result));
+
+                            if (!isSame)
+                            {
+                                std::printf("%ux%u, alpha %d, padding %zu, simd %d\n",
+                                    width, height, (int)alphaMode, padding, (int)simd);
+                                return;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        // A constant image stays constant, since the weights sum to 1.
+        std::vector<uint8_t> pixels(40 * 30 * 4);
+        for (size_t i = 0; i < pixels.size(); i += 4)
+        {
+            pixels[i] = 10; pixels[i + 1] = 100; pixels[i + 2] = 200; pixels[i + 3] = 220;
+        }
+        auto result = downsample({ pixels.data(), 40, 30, 160 }, MipFilter::Kaiser);
+
+        bool isConstant = true;
+        for (size_t i = 0; i < result.pixels.size(); i += 4)
+        {
+            isConstant = isConstant && result.pixels[i] == 10 &&
+                result.pixels[i + 1] == 100 && result.pixels[i + 2] == 200 && result.pixels[i + 3] == 220;
+        }
+        D14_CHECK(isConstant);
+    }
+
+    void testChain()
+    {
+        std::vector<uint8_t> pixels(1000 * 3 * 4);
+        ImageView view = { pixels.data(), 1000, 3, 4000 };
+
+        // 500x2, 250x1 ... 1x1
+        auto chain = generateMipChain(view);
+        D14_CHECK(chain.size() == 10);
+        D14_CHECK(chain[0].width == 500 && chain[0].height == 2);
+        D14_CHECK(chain.back().width == 1 && chain.back().height == 1);
+
+        // Stops at 63, which is not greater than 64.
+        chain = generateMipChain(view, MipFilter::Box, 64);
+        D14_CHECK(chain.size() == 4 && chain.back().width == 63);
+
+        D14_CHECK(generateMipChain({ pixels.data(), 1, 1, 4 }).empty());
+    }
+
+    // A 4K bitmap at load time, which is what the mip chain adds to it.
+    void benchmark()
+    {
+        std::printf("benchmark supported SIMD level: %d\n", (int)supportedSimdLevel());
+
+        std::mt19937 random(7);
+
+        uint32_t width = 3840, height = 2160;
+        auto pixels = makePixels(width, height, width * 4, Alpha::Random, random);
+
+        ImageView view = { pixels.data(), width, height, width * 4 };
+
+        for (auto filter : { MipFilter::Box, MipFilter::Kaiser })
+        {
+            for (auto simd : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 })
+            {
+                double time = unit_test::measure([&] { downsample(view, filter, simd); }, 3);
+
+                std::printf("benchmark downsample (4K, %s, simd %d): %.2f ms\n",
+                    filter == MipFilter::Box ? "box" : "kaiser", (int)simd, time);
+            }
+        }
+        size_t levelCount = 0;
+        double time = unit_test::measure([&] { levelCount = generateMipChain(view).size(); }, 3);
+
+        std::printf("benchmark generateMipChain (4K, box): %zu levels in %.2f ms\n", levelCount, time);
+    }
+}
+
+int main()
+{
+    testDownsample();
+    testChain();
+    benchmark();
+
+    return unit_test::report("MipChain");
+}
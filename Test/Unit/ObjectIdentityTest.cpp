@@ -0,0 +1,188 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/ObjectIdentity.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::uikit;
+
+namespace
+{
+    // A mock hierarchy shaped like the real one: Panel with several
+    // polymorphic bases, RawTextInput (appearance, LabelArea, Label and
+    // TextInputObject on top of Panel) and FilledButton (which derives from
+    // Panel virtually through ClickablePanel).
+
+    struct TextInputObject
+    {
+        virtual ~TextInputObject() = default;
+
+        virtual int compositionFontSize() const { return 0; }
+    };
+
+    struct DrawObject { virtual ~DrawObject() = default; virtual void draw() { } };
+    struct Sortable { virtual ~Sortable() = default; int priority = 0; };
+
+    struct Panel : DrawObject, std::enable_shared_from_this<Panel>, Sortable
+    {
+        ObjectIdentity<TextInputObject> identity = {};
+
+        // Like Panel::identity/textInputObject, including the fallback used
+        // while constructing.
+        const void* mostDerived() const
+        {
+            if (!identity.isValid()) return dynamic_cast<const void*>(this);
+
+            return identity.mostDerived;
+        }
+        TextInputObject* textInputObject() const
+        {
+            if (!identity.isValid()) return dynamic_cast<TextInputObject*>(const_cast<Panel*>(this));
+
+            return identity.interfaceObject;
+        }
+    };
+
+    struct LabelAppearance { virtual ~LabelAppearance() = default; float color[4] = {}; };
+    struct LabelAreaAppearance { virtual ~LabelAreaAppearance() = default; float color[4] = {}; };
+    struct RawTextInputAppearance { virtual ~RawTextInputAppearance() = default; float color[4] = {}; };
+
+    struct Label : LabelAppearance, Panel { };
+    struct LabelArea : LabelAreaAppearance, Label { };
+    struct RawTextInput : RawTextInputAppearance, LabelArea, TextInputObject { };
+
+    struct ClickablePanel : virtual Panel { };
+    struct Button : ClickablePanel { };
+    struct FilledButton : LabelAppearance, Button { };
+
+    // Like makeUIObject.
+    template<typename T>
+    SharedPtr<T> makeObject()
+    {
+        auto object = std::make_shared<T>();
+        object->identity = ObjectIdentity<TextInputObject>::make(object.get());
+        return object;
+    }
+
+    // Like cpp_lang_utils::isMostDerivedEqual and isSameUIObject.
+    bool isMostDerivedEqual(ShrdPtrParam<Panel> lhs, ShrdPtrParam<Panel> rhs)
+    {
+        return std::dynamic_pointer_cast<const void>(lhs) == std::dynamic_pointer_cast<const void>(rhs);
+    }
+
+    bool isSameObject(const Panel* lhs, const Panel* rhs)
+    {
+        if (lhs == nullptr || rhs == nullptr) return lhs == rhs;
+
+        return lhs->mostDerived() == rhs->mostDerived();
+    }
+
+    void testIdentity()
+    {
+        auto input = makeObject<RawTextInput>();
+        auto button = makeObject<FilledButton>();
+
+        SharedPtr<Panel> inputPanel = input, buttonPanel = button;
+
+        // The same as the dynamic casts.
+        D14_CHECK(inputPanel->mostDerived() == dynamic_cast<const void*>(inputPanel.get()));
+        D14_CHECK(buttonPanel->mostDerived() == dynamic_cast<const void*>(buttonPanel.get()));
+
+        D14_CHECK(inputPanel->textInputObject() == static_cast<TextInputObject*>(input.get()));
+        D14_CHECK(buttonPanel->textInputObject() == nullptr);
+
+        // Different bases of the same object are the same object.
+        SharedPtr<Panel> anotherInputPanel = std::static_pointer_cast<Label>(input);
+
+        D14_CHECK(isSameObject(inputPanel.get(), anotherInputPanel.get()));
+        D14_CHECK(!isSameObject(inputPanel.get(), buttonPanel.get()));
+        D14_CHECK(isSameObject(nullptr, nullptr) && !isSameObject(inputPanel.get(), nullptr));
+
+        // Not cached yet, so falls back to the dynamic casts.
+        RawTextInput constructing = {};
+        Panel* constructingPanel = &constructing;
+
+        D14_CHECK(!constructing.identity.isValid());
+        D14_CHECK(constructingPanel->mostDerived() == &constructing);
+        D14_CHECK(constructingPanel->textInputObject() == static_cast<TextInputObject*>(&constructing));
+    }
+
+    // The enter/leave comparison runs for every mouse-move, and querying the
+    // text input interface for every focus change, so both are measured over
+    // a mix of objects (to keep the branches and caches honest).
+    void benchmark()
+    {
+        std::vector<SharedPtr<Panel>> objects = {};
+        for (int i = 0; i < 1024; ++i)
+        {
+            switch (i % 3)
+            {
+            case 0: objects.push_back(makeObject<RawTextInput>()); break;
+            case 1: objects.push_back(makeObject<FilledButton>()); break;
+            default: objects.push_back(makeObject<Label>()); break;
+            }
+        }
+        std::mt19937 random(1);
+
+        std::vector<std::pair<size_t, size_t>> pairs(4096);
+        for (auto& pair : pairs) pair = { random() % objects.size(), random() % objects.size() };
+
+        const int repeatCount = 200;
+        size_t equalCount = 0, expectedEqualCount = 0;
+
+        double castTime = unit_test::measure([&]
+        {
+            for (auto& pair : pairs)
+            {
+                expectedEqualCount += isMostDerivedEqual(objects[pair.first], objects[pair.second]);
+            }
+        },
+        repeatCount);
+        double cachedTime = unit_test::measure([&]
+        {
+            for (auto& pair : pairs)
+            {
+                equalCount += isSameObject(objects[pair.first].get(), objects[pair.second].get());
+            }
+        },
+        repeatCount);
+        D14_CHECK(equalCount == expectedEqualCount);
+
+        std::printf("benchmark identity comparison: dynamic_pointer_cast %.1f ns, cached %.1f ns\n",
+            castTime * 1.0e6 / pairs.size(), cachedTime * 1.0e6 / pairs.size());
+
+        size_t textInputCount = 0, expectedTextInputCount = 0;
+
+        castTime = unit_test::measure([&]
+        {
+            for (auto& object : objects)
+            {
+                expectedTextInputCount += std::dynamic_pointer_cast<TextInputObject>(object) != nullptr;
+            }
+        },
+        repeatCount);
+        cachedTime = unit_test::measure([&]
+        {
+            for (auto& object : objects)
+            {
+                textInputCount += object->textInputObject() != nullptr;
+            }
+        },
+        repeatCount);
+        D14_CHECK(textInputCount == expectedTextInputCount);
+
+        std::printf("benchmark TextInputObject lookup: dynamic_pointer_cast %.1f ns, cached %.1f ns\n",
+            castTime * 1.0e6 / objects.size(), cachedTime * 1.0e6 / objects.size());
+    }
+}
+
+int main()
+{
+    testIdentity();
+    benchmark();
+
+    return unit_test::report("ObjectIdentity");
+}
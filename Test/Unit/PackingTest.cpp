@@ -0,0 +1,172 @@
+﻿#include "Common/Precompile.h"
+
+#include "Common/MathUtils/Packing.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::math_utils;
+
+namespace
+{
+    struct Size { int width = 0, height = 0; };
+
+    std::vector<Size> randomSizes(size_t count, int minSize, int maxSize, unsigned seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<int> distribution(minSize, maxSize);
+
+        std::vector<Size> sizes(count);
+        for (auto& size : sizes)
+        {
+            size = { distribution(random), distribution(random) };
+        }
+        return sizes;
+    }
+
+    std::vector<Optional<PackedRect>> pack(RectPacker& packer, const std::vector<Size>& sizes)
+    {
+        std::vector<Optional<PackedRect>> results = {};
+        for (auto& size : sizes)
+        {
+            results.push_back(packer.insert(size.width, size.height));
+        }
+        return results;
+    }
+
+    // In the bin, padded from the border and from each other, and matching
+    // the requested sizes (with the rotation taken into account).
+    void checkPlacements(
+        const RectPacker& packer,
+        const std::vector<Size>& sizes,
+        const std::vector<Optional<PackedRect>>& results)
+    {
+        int padding = packer.padding();
+
+        std::vector<PackedRect> placed = {};
+        long long area = 0;
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            if (!results[i].has_value()) continue;
+
+            auto& rect = results[i].value();
+            auto& size = sizes[i];
+
+            if (rect.rotated)
+            {
+                D14_CHECK(packer.allowRotation());
+                D14_CHECK(rect.width == size.height && rect.height == size.width);
+            }
+            else D14_CHECK(rect.width == size.width && rect.height == size.height);
+
+            D14_CHECK(rect.x >= padding && rect.y >= padding);
+            D14_CHECK(rect.x + rect.width + padding <= packer.binWidth());
+            D14_CHECK(rect.y + rect.height + padding <= packer.binHeight());
+
+            placed.push_back(rect);
+            area += (long long)rect.width * rect.height;
+        }
+        for (size_t i = 0; i < placed.size(); ++i)
+        {
+            auto& a = placed[i];
+            for (size_t j = i + 1; j < placed.size(); ++j)
+            {
+                auto& b = placed[j];
+
+                bool apart =
+                    a.x + a.width + padding <= b.x || b.x + b.width + padding <= a.x ||
+                    a.y + a.height + padding <= b.y || b.y + b.height + padding <= a.y;
+
+                if (!D14_CHECK(apart)) return;
+            }
+        }
+        double binArea = (double)packer.binWidth() * packer.binHeight();
+        D14_CHECK_NEAR(packer.occupancy(), area / binArea, 1.0e-4);
+    }
+
+    bool samePlacements(
+        const std::vector<Optional<PackedRect>>& lhs,
+        const std::vector<Optional<PackedRect>>& rhs)
+    {
+        if (lhs.size() != rhs.size()) return false;
+
+        for (size_t i = 0; i < lhs.size(); ++i)
+        {
+            if (lhs[i].has_value() != rhs[i].has_value()) return false;
+            if (!lhs[i].has_value()) continue;
+
+            auto& a = lhs[i].value();
+            auto& b = rhs[i].value();
+
+            if (a.x != b.x || a.y != b.y || a.width != b.width ||
+                a.height != b.height || a.rotated != b.rotated) return false;
+        }
+        return true;
+    }
+
+    template<typename Packer>
+    void testPacker(const char* name, Packer first, Packer second, float minOccupancy)
+    {
+        auto sizes = randomSizes(3000, 4, 64, 1);
+
+        auto results = pack(first, sizes);
+        checkPlacements(first, sizes, results);
+
+        // Filling the bin until nothing fits, so the occupancy is comparable.
+        D14_CHECK(first.occupancy() >= minOccupancy);
+
+        // Deterministic, also after clearing.
+        D14_CHECK(samePlacements(results, pack(second, sizes)));
+
+        first.clear();
+        D14_CHECK(first.occupancy() == 0.0f);
+        D14_CHECK(samePlacements(results, pack(first, sizes)));
+
+        // Too large for the bin.
+        D14_CHECK(!first.insert(first.binWidth() + 1, 1).has_value());
+
+        std::printf("%s: occupancy %.3f\n", name, first.occupancy());
+    }
+
+    template<typename Packer>
+    void benchmarkPacker(const char* name, int binSize, int count)
+    {
+        auto sizes = randomSizes(count, 8, 48, 2);
+
+        size_t placedCount = 0;
+        double time = unit_test::measure([&]
+        {
+            Packer packer(binSize, binSize, 1);
+            for (auto& size : sizes)
+            {
+                if (packer.insert(size.width, size.height).has_value()) ++placedCount;
+            }
+        });
+        std::printf("benchmark %s: %d inserts into %dx%d in %.2f ms (%.2f us each, %zu placed)\n",
+            name, count, binSize, binSize, time, time * 1000.0 / count, placedCount);
+    }
+}
+
+int main()
+{
+    testPacker("ShelfPacker",
+        ShelfPacker(1024, 1024, 1), ShelfPacker(1024, 1024, 1), 0.55f);
+
+    testPacker("SkylinePacker",
+        SkylinePacker(1024, 1024, 1, true), SkylinePacker(1024, 1024, 1, true), 0.80f);
+
+    testPacker("MaxRectsPacker",
+        MaxRectsPacker(1024, 1024, 1, true), MaxRectsPacker(1024, 1024, 1, true), 0.85f);
+
+    testPacker("MaxRectsPacker (no rotation, no padding)",
+        MaxRectsPacker(512, 512, 0, false), MaxRectsPacker(512, 512, 0, false), 0.85f);
+
+    benchmarkPacker<ShelfPacker>("ShelfPacker", 4096, 8000);
+    benchmarkPacker<SkylinePacker>("SkylinePacker", 4096, 8000);
+    benchmarkPacker<MaxRectsPacker>("MaxRectsPacker", 1024, 1000);
+
+    return unit_test::report("Packing");
+}
@@ -0,0 +1,154 @@
+﻿#include "Common/Precompile.h"
+
+#include "Renderer/RingAllocator.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::renderer;
+
+namespace
+{
+    void testBasics()
+    {
+        RingAllocator ring(4096);
+
+        D14_CHECK(ring.allocate(10) == 0u);
+        D14_CHECK(ring.allocate(10) == 256u); // aligned
+        D14_CHECK(ring.allocate(10, 4) == 268u);
+
+        D14_CHECK(!ring.allocate(0).has_value());
+        D14_CHECK(!ring.allocate(4097).has_value());
+
+        ring.finishFrame(1);
+        D14_CHECK(ring.pendingFrameCount() == 1);
+
+        // Not enough space before the frame is retired.
+        D14_CHECK(!ring.allocate(4096).has_value());
+
+        ring.retire(0);
+        D14_CHECK(ring.usedSize() > 0);
+
+        ring.retire(1);
+        D14_CHECK(ring.usedSize() == 0);
+        D14_CHECK(ring.pendingFrameCount() == 0);
+
+        // Restarts from 0 when empty, so the whole capacity is available.
+        D14_CHECK(ring.allocate(4096) == 0u);
+
+        // An empty frame is not recorded.
+        ring.finishFrame(2);
+        ring.retire(2);
+        ring.finishFrame(3);
+        D14_CHECK(ring.pendingFrameCount() == 0);
+    }
+
+    void testWrapping()
+    {
+        RingAllocator ring(1024);
+
+        D14_CHECK(ring.allocate(512) == 0u);
+        ring.finishFrame(1);
+        D14_CHECK(ring.allocate(256) == 512u);
+        ring.finishFrame(2);
+
+        ring.retire(1); // [0, 512) is free
+
+        // The 256 bytes at the end are too small, so they are skipped.
+        D14_CHECK(ring.allocate(384) == 0u);
+        D14_CHECK(ring.usedSize() == 256 + 256 + 384);
+
+        ring.finishFrame(3);
+        ring.retire(3);
+        D14_CHECK(ring.usedSize() == 0);
+    }
+
+    // Random chunks under up to 3 frames of GPU lag, where the live chunks
+    // must never overlap and must stay aligned and in bounds.
+    void testRandomized()
+    {
+        const uint64_t capacity = 4096;
+
+        RingAllocator ring(capacity);
+        std::mt19937 random(1);
+
+        struct Chunk { uint64_t offset = 0, size = 0, fenceValue = 0; };
+        std::vector<Chunk> liveChunks = {};
+
+        uint64_t fenceValue = 1, completedFenceValue = 1;
+        size_t allocationCount = 0, failureCount = 0;
+
+        for (int frame = 0; frame < 100000; ++frame)
+        {
+            int count = random() % 8;
+            for (int i = 0; i < count; ++i)
+            {
+                uint64_t size = 1 + random() % 700;
+
+                auto offset = ring.allocate(size);
+                ++allocationCount;
+
+                if (!offset.has_value())
+                {
+                    ++failureCount;
+                    continue;
+                }
+                D14_CHECK(offset.value() % RingAllocator::g_defaultAlignment == 0);
+                D14_CHECK(offset.value() + size <= capacity);
+
+                for (auto& chunk : liveChunks)
+                {
+                    D14_CHECK(offset.value() + size <= chunk.offset || chunk.offset + chunk.size <= offset.value());
+                }
+                liveChunks.push_back({ offset.value(), size, fenceValue + 1 });
+            }
+            ring.finishFrame(++fenceValue);
+
+            if (fenceValue > 3)
+            {
+                completedFenceValue = std::max(completedFenceValue, fenceValue - random() % 3);
+            }
+            ring.retire(completedFenceValue);
+
+            std::erase_if(liveChunks, [&](const Chunk& chunk)
+            {
+                return chunk.fenceValue <= completedFenceValue;
+            });
+            D14_CHECK(ring.pendingFrameCount() <= 4);
+        }
+        // Some requests must fail since the ring is small, but not most.
+        D14_CHECK(failureCount > 0 && failureCount < allocationCount / 4);
+    }
+
+    void benchmark()
+    {
+        RingAllocator ring(4 * 1024 * 1024);
+
+        const int frameCount = 10000;
+        const int chunkCount = 256;
+
+        uint64_t fenceValue = 0;
+        double time = unit_test::measure([&]
+        {
+            for (int i = 0; i < chunkCount; ++i) ring.allocate(64 + (i % 7) * 96);
+
+            ring.finishFrame(++fenceValue);
+            if (fenceValue > 2) ring.retire(fenceValue - 2);
+        },
+        frameCount);
+        std::printf("benchmark (%d chunks per frame): %.1f ns per allocation\n",
+            chunkCount, time * 1.0e6 / chunkCount);
+    }
+}
+
+int main()
+{
+    testBasics();
+    testWrapping();
+    testRandomized();
+    benchmark();
+
+    return unit_test::report("RingAllocator");
+}
@@ -0,0 +1,161 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/AnimationUtils/ScrollIntegrator.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::uikit::animation_utils;
+
+namespace
+{
+    // 3 wheel notches of 90 pixels, 50 ms apart, advanced at the frame rate
+    // until the motion stops.
+    std::vector<float> scrollThreeNotches(float fps, float& elapsedSecs)
+    {
+        ScrollIntegrator scroll = {};
+        scroll.setRange(0.0f, 1000.0f);
+        scroll.reset(100.0f);
+
+        std::vector<float> trace = {};
+
+        int notchCount = 0;
+        elapsedSecs = 0.0f;
+
+        while (trace.size() < 10000)
+        {
+            if (notchCount < 3 && elapsedSecs >= notchCount * 0.05f)
+            {
+                scroll.scrollBy(90.0f);
+                ++notchCount;
+            }
+            bool isMoving = scroll.advance(1.0f / fps);
+            elapsedSecs += 1.0f / fps;
+
+            trace.push_back(scroll.position());
+
+            if (!isMoving && notchCount == 3) break;
+        }
+        return trace;
+    }
+
+    void testScrolling()
+    {
+        float elapsed60 = 0.0f, elapsed144 = 0.0f, elapsedAgain = 0.0f;
+
+        auto trace60 = scrollThreeNotches(60.0f, elapsed60);
+        auto trace144 = scrollThreeNotches(144.0f, elapsed144);
+
+        // The notches accumulate into one motion that settles on the target.
+        D14_CHECK(trace60.back() == 370.0f && trace144.back() == 370.0f);
+        D14_CHECK_NEAR(elapsed60, elapsed144, 0.05f);
+        D14_CHECK(elapsed60 < 0.5f);
+
+        // The spring is critically damped, so it never overshoots.
+        D14_CHECK(*std::max_element(trace60.begin(), trace60.end()) <= 370.0f);
+
+        // The same inputs give the same motion.
+        D14_CHECK(scrollThreeNotches(60.0f, elapsedAgain) == trace60);
+
+        // The target is clamped to the range.
+        ScrollIntegrator scroll = {};
+        scroll.setRange(0.0f, 500.0f);
+        scroll.reset(0.0f);
+        scroll.scrollBy(10000.0f);
+
+        float maxPosition = 0.0f;
+        while (scroll.advance(1.0f / 60.0f)) maxPosition = std::max(maxPosition, scroll.position());
+
+        D14_CHECK(scroll.position() == 500.0f && maxPosition <= 500.0f);
+    }
+
+    void testFlinging()
+    {
+        ScrollIntegrator fling = {};
+        fling.setRange(0.0f, 100000.0f);
+        fling.reset(0.0f);
+        fling.fling(3000.0f);
+
+        float elapsedSecs = 0.0f;
+        while (fling.advance(1.0f / 60.0f)) elapsedSecs += 1.0f / 60.0f;
+
+        // v / friction is the distance of an exponential decay.
+        D14_CHECK_NEAR(fling.position(), 3000.0f / fling.friction, 15.0f);
+        D14_CHECK(elapsedSecs < 2.0f && !fling.isMoving());
+
+        // Stops at the edge of the range.
+        fling.reset(50.0f);
+        fling.fling(-3000.0f);
+        while (fling.advance(1.0f / 60.0f));
+
+        D14_CHECK(fling.position() == 0.0f);
+
+        // The velocity is limited.
+        fling.reset(0.0f);
+        fling.fling(1.0e6f);
+        D14_CHECK(fling.velocity() <= fling.maxVelocity);
+
+        fling.stop();
+        D14_CHECK(!fling.isMoving() && !fling.advance(1.0f / 60.0f));
+    }
+
+    // Random inputs at random frame times, where the position must stay in
+    // the range, and the motion must stop once the inputs stop.
+    void testRandomized()
+    {
+        std::mt19937 random(5);
+        std::uniform_real_distribution<float> frameSecs(0.001f, 0.12f);
+
+        ScrollIntegrator scroll = {};
+        scroll.setRange(0.0f, 2000.0f);
+        scroll.reset(0.0f);
+
+        for (int i = 0; i < 20000; ++i)
+        {
+            switch (random() % 8)
+            {
+            case 0: scroll.scrollBy((float)((int)(random() % 1200) - 600)); break;
+            case 1: scroll.fling((float)((int)(random() % 12000) - 6000)); break;
+            case 2: scroll.translate((float)((int)(random() % 100) - 50)); break;
+            case 3: scroll.setRange(0.0f, (float)(random() % 3000)); break;
+            default: break;
+            }
+            scroll.advance(frameSecs(random));
+
+            auto position = scroll.position();
+            if (!D14_CHECK(position >= 0.0f && position <= 3000.0f)) break;
+        }
+        int frameCount = 0;
+        while (scroll.advance(1.0f / 60.0f) && frameCount < 600) ++frameCount;
+
+        D14_CHECK(frameCount < 600);
+    }
+
+    void benchmark()
+    {
+        ScrollIntegrator scroll = {};
+        scroll.setRange(0.0f, 1.0e6f);
+        scroll.reset(0.0f);
+
+        int frame = 0;
+        double time = unit_test::measure([&]
+        {
+            if (frame++ % 30 == 0) scroll.scrollBy(120.0f);
+            scroll.advance(1.0f / 60.0f);
+        },
+        100000);
+        std::printf("benchmark advance (60 fps, 4 steps per frame): %.1f ns\n", time * 1.0e6);
+    }
+}
+
+int main()
+{
+    testScrolling();
+    testFlinging();
+    testRandomized();
+    benchmark();
+
+    return unit_test::report("ScrollIntegrator");
+}
@@ -0,0 +1,162 @@
+﻿#include "Common/Precompile.h"
+
+#include "Pipeline/2D/SpriteBatch.h"
+
+#include "UnitTest.h"
+
+#include <cmath>
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::pipeline;
+
+namespace
+{
+    SpriteList randomSprites(size_t count, float extent, uint16_t layerCount, uint16_t textureCount, unsigned seed)
+    {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> position(-64.0f, extent + 64.0f);
+
+        SpriteList sprites = {};
+        sprites.reserve(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            SpriteList::Desc desc = {};
+
+            desc.x = position(random);
+            desc.y = position(random);
+            desc.scaleX = desc.scaleY = 16.0f + (float)(random() % 32);
+            desc.rotation = (float)(random() % 628) / 100.0f;
+            desc.tint = (uint32_t)i; // identifies the sprite in the instances
+            desc.layer = (uint16_t)(random() % layerCount);
+            desc.texture = (uint16_t)(random() % textureCount);
+
+            sprites.push(desc);
+        }
+        return sprites;
+    }
+
+    void testList()
+    {
+        SpriteList sprites = {};
+
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            SpriteList::Desc desc = {};
+            desc.tint = i;
+            D14_CHECK(sprites.push(desc) == i);
+        }
+        // Swap-and-pop keeps the other indices.
+        sprites.erase(1);
+        D14_CHECK(sprites.size() == 3);
+        D14_CHECK(sprites.tint[0] == 0 && sprites.tint[1] == 3 && sprites.tint[2] == 2);
+
+        sprites.erase(5); // out of range
+        D14_CHECK(sprites.size() == 3);
+
+        sprites.clear();
+        D14_CHECK(sprites.size() == 0);
+    }
+
+    void testBatching()
+    {
+        auto sprites = randomSprites(20000, 1024.0f, 4, 8, 3);
+
+        SpriteBatcher batcher = {};
+        batcher.viewRect = SpriteBatcher::ViewRect{ 0.0f, 0.0f, 800.0f, 600.0f };
+
+        size_t visibleCount = batcher.prepare(sprites);
+        D14_CHECK(visibleCount == batcher.visibleCount());
+
+        std::vector<SpriteInstance> instances(visibleCount);
+        batcher.pack(sprites, instances.data());
+
+        // The expected visible set with the same bounding-circle rule.
+        std::vector<bool> expected(sprites.size());
+        size_t expectedCount = 0;
+        for (size_t i = 0; i < sprites.size(); ++i)
+        {
+            float radius = 0.5f * std::sqrt(
+                sprites.scaleX[i] * sprites.scaleX[i] +
+                sprites.scaleY[i] * sprites.scaleY[i]);
+
+            float x = sprites.positionX[i], y = sprites.positionY[i];
+
+            expected[i] = x + radius >= 0.0f && x - radius <= 800.0f && y + radius >= 0.0f && y - radius <= 600.0f;
+            expectedCount += expected[i];
+        }
+        D14_CHECK(visibleCount == expectedCount);
+
+        std::vector<bool> packed(sprites.size());
+
+        uint32_t nextOffset = 0;
+        uint32_t lastKey = 0;
+        uint32_t lastIndex = 0;
+
+        for (auto& batch : batcher.batches())
+        {
+            // Contiguous, non-empty, and strictly ordered by (layer, texture).
+            D14_CHECK(batch.instanceOffset == nextOffset);
+            D14_CHECK(batch.instanceCount > 0);
+
+            uint32_t key = (uint32_t)batch.layer << 16 | batch.texture;
+            if (nextOffset > 0) D14_CHECK(key > lastKey);
+            lastKey = key;
+
+            for (uint32_t i = 0; i < batch.instanceCount; ++i)
+            {
+                auto& instance = instances[batch.instanceOffset + i];
+                uint32_t index = instance.tint;
+
+                D14_CHECK(expected[index] && !packed[index]);
+                packed[index] = true;
+
+                D14_CHECK(sprites.layer[index] == batch.layer);
+                D14_CHECK(sprites.texture[index] == batch.texture);
+                D14_CHECK(instance.position[0] == sprites.positionX[index]);
+                D14_CHECK(instance.rotation == sprites.rotation[index]);
+
+                // Stable, i.e. the pushed order in each batch.
+                if (i > 0) D14_CHECK(index > lastIndex);
+                lastIndex = index;
+            }
+            nextOffset += batch.instanceCount;
+        }
+        D14_CHECK(nextOffset == visibleCount);
+
+        // Without a view rect nothing is culled.
+        batcher.viewRect.reset();
+        D14_CHECK(batcher.prepare(sprites) == sprites.size());
+    }
+
+    void benchmark()
+    {
+        const size_t spriteCount = 100000;
+        const int frameCount = 50;
+
+        auto sprites = randomSprites(spriteCount, 2048.0f, 4, 16, 5);
+
+        SpriteBatcher batcher = {};
+        batcher.viewRect = SpriteBatcher::ViewRect{ 0.0f, 0.0f, 1920.0f, 1080.0f };
+
+        std::vector<SpriteInstance> instances(spriteCount);
+
+        size_t visibleCount = 0;
+        double prepareTime = unit_test::measure([&] { visibleCount = batcher.prepare(sprites); }, frameCount);
+        double packTime = unit_test::measure([&] { batcher.pack(sprites, instances.data()); }, frameCount);
+
+        std::printf(
+            "benchmark (%zu sprites, %zu visible, %zu batches): cull+sort %.2f ms, pack %.2f ms per frame\n",
+            spriteCount, visibleCount, batcher.batches().size(), prepareTime, packTime);
+    }
+}
+
+int main()
+{
+    testList();
+    testBatching();
+    benchmark();
+
+    return unit_test::report("SpriteBatch");
+}
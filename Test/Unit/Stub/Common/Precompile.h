@@ -0,0 +1,75 @@
+﻿#pragma once
+
+// The standard library part of Src/Common/Precompile.h, which hides the real
+// one (see CMakeLists.txt) so that the cores only using the standard library
+// are built without the Windows & DirectX SDK.  Nothing else should be added
+// here, otherwise the missing includes of the cores would go unnoticed.
+
+// Standard Library
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <span>
+#include <sstream>
+#include <string_view>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+namespace d14engine
+{
+    template<typename T>
+    using Function = std::function<T>;
+    template<typename T>
+    using FuncParam = const Function<T>&;
+
+    template<typename T>
+    using Optional = std::optional<T>;
+    template<typename T>
+    using OptParam = const Optional<T>&;
+
+    template<typename T>
+    using SharedPtr = std::shared_ptr<T>;
+    template<typename T>
+    using ShrdPtrParam = const SharedPtr<T>&;
+
+    using String = std::string;
+    using StrParam = const String&;
+
+    using StringView = std::string_view;
+    using StrViewParam = const StringView&;
+
+    template<typename T>
+    using UniquePtr = std::unique_ptr<T>;
+    template<typename T>
+    using UniqPtrParam = const UniquePtr<T>&;
+
+    template<typename... Types>
+    using Variant = std::variant<Types...>;
+    template<typename... Types>
+    using VarParam = const Variant<Types...>&;
+
+    template<typename T>
+    using WeakPtr = std::weak_ptr<T>;
+    template<typename T>
+    using WeakPtrParam = const WeakPtr<T>&;
+
+    using Wstring = std::wstring;
+    using WstrParam = const Wstring&;
+
+    using WstringView = std::wstring_view;
+    using WstrViewParam = const WstringView&;
+}
@@ -0,0 +1,176 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/TabLifecyclePolicy.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::uikit;
+
+namespace
+{
+    using State = TabLifecyclePolicy::State;
+
+    void testOrder()
+    {
+        TabLifecyclePolicy policy = {};
+        policy.memoryBudget = 250;
+
+        policy.insert(1, 100, true, true);
+        policy.insert(2, 100, true, true);
+        policy.insert(3, 100, false, false); // never trimmed
+        policy.insert(4, 100, true, true);
+        D14_CHECK(policy.count() == 4 && policy.totalMemory() == 400);
+
+        policy.activate(1);
+        policy.activate(2);
+        policy.activate(4);
+        D14_CHECK(policy.state(4) == State::Active && policy.state(2) == State::Loaded);
+
+        // The least recently used one is suspended first: 1 (3 is pinned).
+        auto action = policy.nextAction();
+        D14_CHECK(action.has_value() && action->key == 1 && action->target == State::Suspended);
+
+        policy.update(1, State::Suspended, 10);
+        action = policy.nextAction();
+        D14_CHECK(action.has_value() && action->key == 2 && action->target == State::Suspended);
+
+        policy.update(2, State::Suspended, 10);
+        D14_CHECK(policy.totalMemory() == 220 && !policy.nextAction().has_value());
+
+        // Then the suspended ones are unloaded, the older first.
+        policy.memoryBudget = 215;
+        action = policy.nextAction();
+        D14_CHECK(action.has_value() && action->key == 1 && action->target == State::Unloaded);
+
+        policy.update(1, State::Unloaded, 1);
+        D14_CHECK(!policy.nextAction().has_value());
+
+        // Nothing more can be trimmed.
+        policy.memoryBudget = 0;
+        policy.update(2, State::Unloaded, 1);
+        D14_CHECK(!policy.nextAction().has_value());
+
+        D14_CHECK(policy.count(State::Unloaded) == 2);
+        D14_CHECK(policy.count(State::Active) == 1);
+
+        policy.erase(4);
+        D14_CHECK(policy.count() == 3 && policy.totalMemory() == 102);
+        D14_CHECK(!policy.contains(4));
+    }
+
+    // The content of a tab in each state: a loaded one holds its text
+    // layouts and bitmaps, a suspended one only the UI objects, and an
+    // unloaded one only the snapshot.
+    constexpr size_t g_loadedMemory = 4 * 1024 * 1024;
+    constexpr size_t g_suspendedMemory = 512 * 1024;
+    constexpr size_t g_unloadedMemory = 16 * 1024;
+
+    size_t memoryOf(State state)
+    {
+        switch (state)
+        {
+        case State::Suspended: return g_suspendedMemory;
+        case State::Unloaded: return g_unloadedMemory;
+        default: return g_loadedMemory;
+        }
+    }
+
+    // The same loop as TabGroup::trimInactiveTabs.
+    size_t trim(TabLifecyclePolicy& policy)
+    {
+        size_t actionCount = 0;
+        while (auto action = policy.nextAction())
+        {
+            policy.update(action->key, action->target, memoryOf(action->target));
+            ++actionCount;
+        }
+        return actionCount;
+    }
+
+    void select(TabLifecyclePolicy& policy, TabLifecyclePolicy::Key key)
+    {
+        policy.update(key, State::Loaded, g_loadedMemory); // like TabGroup::loadTab
+        policy.activate(key);
+        trim(policy);
+    }
+
+    // 200 tabs switched at random, mostly among a few recent ones like a
+    // user does, where the budget must hold after every switch.
+    void testTwoHundredTabs()
+    {
+        const size_t tabCount = 200;
+        const size_t budget = 64 * 1024 * 1024;
+
+        TabLifecyclePolicy policy = {};
+        policy.memoryBudget = budget;
+
+        for (size_t key = 1; key <= tabCount; ++key)
+        {
+            policy.insert(key, g_loadedMemory, true, true);
+            trim(policy);
+        }
+        D14_CHECK(policy.totalMemory() <= budget);
+
+        std::mt19937 random(7);
+        std::vector<TabLifecyclePolicy::Key> recent = { 1 };
+
+        for (int i = 0; i < 5000; ++i)
+        {
+            TabLifecyclePolicy::Key key = {};
+            if (random() % 4 != 0)
+            {
+                key = recent[random() % recent.size()];
+            }
+            else key = 1 + random() % tabCount;
+
+            select(policy, key);
+            if (!D14_CHECK(policy.totalMemory() <= budget)) break;
+
+            D14_CHECK(policy.state(key) == State::Active);
+
+            recent.push_back(key);
+            if (recent.size() > 8) recent.erase(recent.begin());
+        }
+        D14_CHECK(policy.count(State::Active) == 1);
+
+        std::printf("%zu tabs: %.1f MB all loaded, %.1f MB with the policy "
+            "(%zu loaded, %zu suspended, %zu unloaded, budget %.0f MB)\n",
+            tabCount, tabCount * g_loadedMemory / 1048576.0, policy.totalMemory() / 1048576.0,
+            policy.count(State::Loaded) + policy.count(State::Active),
+            policy.count(State::Suspended), policy.count(State::Unloaded), budget / 1048576.0);
+    }
+
+    void benchmark()
+    {
+        const size_t tabCount = 200;
+
+        TabLifecyclePolicy policy = {};
+        policy.memoryBudget = 64 * 1024 * 1024;
+
+        for (size_t key = 1; key <= tabCount; ++key)
+        {
+            policy.insert(key, g_loadedMemory, true, true);
+        }
+        trim(policy);
+
+        std::mt19937 random(11);
+        double time = unit_test::measure([&]
+        {
+            select(policy, 1 + random() % tabCount);
+        },
+        10000);
+        std::printf("benchmark select + trim (%zu tabs): %.2f us\n", tabCount, time * 1000.0);
+    }
+}
+
+int main()
+{
+    testOrder();
+    testTwoHundredTabs();
+    benchmark();
+
+    return unit_test::report("TabLifecyclePolicy");
+}
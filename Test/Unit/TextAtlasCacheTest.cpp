@@ -0,0 +1,233 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/TextAtlasCache.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::uikit;
+
+namespace
+{
+    using Key = TextAtlasCache::Key;
+    using Slot = TextAtlasCache::Slot;
+
+    // Records the page resources like TextAtlas does with the bitmaps.
+    struct RecordingCache : TextAtlasCache
+    {
+        using TextAtlasCache::TextAtlasCache;
+
+        size_t createdPageCount = 0;
+        size_t clearCount = 0;
+
+        size_t liveResourceCount = 0;
+
+    protected:
+        void onCreatePage(size_t pageIndex) override
+        {
+            D14_CHECK(pageIndex == liveResourceCount);
+
+            ++createdPageCount;
+            ++liveResourceCount;
+        }
+        void onClearPages() override
+        {
+            ++clearCount;
+            liveResourceCount = 0;
+        }
+    };
+
+    Key makeKey(WstrParam text, float dpi = 96.0f)
+    {
+        Key key = {};
+        key.text = text;
+        key.fontFamilyName = L"Segoe UI";
+        key.fontSize = 14.0f;
+        key.fontWeight = 400;
+        key.color = { 0.0f, 0.0f, 0.0f, 1.0f };
+        key.dpi = dpi;
+        return key;
+    }
+
+    bool isOverlapped(const math_utils::PackedRect& a, const math_utils::PackedRect& b)
+    {
+        return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+    }
+
+    void testFindAndAllocate()
+    {
+        RecordingCache cache({ 256, 256, 2, 1 });
+
+        auto key = makeKey(L"OK");
+        D14_CHECK(!cache.find(key).has_value());
+
+        auto slot = cache.allocate(key, 30, 20);
+        D14_CHECK(slot.has_value() && cache.isValid(slot.value()));
+        D14_CHECK(cache.pageCount() == 1 && cache.createdPageCount == 1);
+
+        auto found = cache.find(key);
+        D14_CHECK(found.has_value() && found->rect.x == slot->rect.x && found->rect.y == slot->rect.y);
+        D14_CHECK(cache.statistics.hitCount == 1 && cache.statistics.missCount == 1);
+
+        // Any property that affects the rasterization is a different key.
+        auto colored = key;
+        colored.color[0] = 1.0f;
+        D14_CHECK(!cache.find(colored).has_value());
+
+        auto bold = key;
+        bold.fontWeight = 700;
+        D14_CHECK(!cache.find(bold).has_value());
+
+        // Larger than a page (with the padding).
+        D14_CHECK(!cache.allocate(makeKey(L"long"), 255, 20).has_value());
+        D14_CHECK(cache.allocate(makeKey(L"long"), 252, 20).has_value());
+
+        // Within a page, the regions never overlap.
+        std::vector<Slot> slots = {};
+        for (int i = 0; i < 40; ++i)
+        {
+            auto other = cache.allocate(makeKey(std::to_wstring(i)), 10 + i % 7 * 5, 12 + i % 3);
+            if (other.has_value()) slots.push_back(other.value());
+        }
+        bool isDisjoint = true;
+        for (size_t i = 0; i < slots.size(); ++i)
+        {
+            for (size_t j = i + 1; j < slots.size(); ++j)
+            {
+                if (slots[i].pageIndex == slots[j].pageIndex && cache.isValid(slots[i]) &&
+                    cache.isValid(slots[j]) && isOverlapped(slots[i].rect, slots[j].rect))
+                {
+                    isDisjoint = false;
+                }
+            }
+        }
+        D14_CHECK(isDisjoint);
+    }
+
+    void testRecycle()
+    {
+        // A page only holds 4 rows of 20 pixels.
+        RecordingCache cache({ 64, 84, 2, 0 });
+
+        auto a = cache.allocate(makeKey(L"a"), 64, 20);
+        auto b = cache.allocate(makeKey(L"b"), 64, 20);
+        cache.allocate(makeKey(L"c"), 64, 20);
+        cache.allocate(makeKey(L"d"), 64, 20);
+        cache.allocate(makeKey(L"e"), 64, 20);
+
+        D14_CHECK(cache.pageCount() == 2 && cache.createdPageCount == 2);
+        D14_CHECK(a->pageIndex == 0 && b->pageIndex == 0);
+
+        // Page 1 becomes the least recently used one after touching page 0.
+        cache.allocate(makeKey(L"f"), 64, 20);
+        cache.allocate(makeKey(L"g"), 64, 20);
+        cache.allocate(makeKey(L"h"), 64, 20);
+        cache.touch(a.value());
+
+        auto i = cache.allocate(makeKey(L"i"), 64, 20);
+        D14_CHECK(i.has_value() && i->pageIndex == 1);
+        D14_CHECK(cache.statistics.recycledPageCount == 1 && cache.createdPageCount == 2);
+
+        // The slots of the recycled page are invalidated.
+        D14_CHECK(!cache.find(makeKey(L"e")).has_value());
+        D14_CHECK(cache.find(makeKey(L"a")).has_value() && cache.isValid(a.value()));
+
+        // Dropping all keeps the pages but invalidates every slot.
+        cache.invalidate();
+        D14_CHECK(!cache.isValid(a.value()) && !cache.find(makeKey(L"a")).has_value());
+        D14_CHECK(cache.pageCount() == 2 && cache.clearCount == 0);
+    }
+
+    void testDpi()
+    {
+        RecordingCache cache({ 256, 256, 2, 1 });
+
+        auto slot = cache.allocate(makeKey(L"OK"), 30, 20);
+        D14_CHECK(cache.slotRect(slot.value()).right == 31.0f);
+
+        // The pages are dropped together with their resources.
+        auto scaled = cache.allocate(makeKey(L"OK", 192.0f), 60, 40);
+        D14_CHECK(cache.clearCount == 1 && cache.createdPageCount == 2 && cache.liveResourceCount == 1);
+
+        // The old slot must not alias the recreated page of the same index.
+        D14_CHECK(scaled->pageIndex == slot->pageIndex && !cache.isValid(slot.value()));
+        D14_CHECK(cache.isValid(scaled.value()));
+
+        auto rect = cache.slotRect(scaled.value());
+        D14_CHECK(rect.left == 0.5f && rect.right == 30.5f && rect.bottom == 20.5f);
+    }
+
+    // A screen full of labels, e.g. a settings page with 400 captions and
+    // buttons, where each frame looks up every label (the hit path).  Then
+    // scrolling through a list of 20000 items, where the new items keep
+    // allocating and the pages are recycled.
+    void benchmark()
+    {
+        std::mt19937 random(1);
+
+        TextAtlasCache cache;
+
+        std::vector<Key> labels = {};
+        for (int i = 0; i < 400; ++i)
+        {
+            labels.push_back(makeKey(L"Setting caption number " + std::to_wstring(i)));
+        }
+        for (auto& label : labels)
+        {
+            cache.allocate(label, 80 + (int)(random() % 120), 18 + (int)(random() % 4));
+        }
+        size_t hitCount = 0;
+
+        double frameTime = unit_test::measure([&]
+        {
+            for (auto& label : labels) hitCount += cache.find(label).has_value();
+        },
+        500);
+        D14_CHECK(hitCount == labels.size() * 500);
+
+        std::printf("benchmark screen of %zu labels: %.1f us per frame (%.0f ns per label), %zu pages\n",
+            labels.size(), frameTime * 1.0e3, frameTime * 1.0e6 / labels.size(), cache.pageCount());
+
+        // 40 rows visible, scrolling by 3 rows per frame.
+        const int itemCount = 20000, visibleCount = 40, step = 3;
+
+        std::vector<Key> items = {};
+        for (int i = 0; i < itemCount; ++i)
+        {
+            items.push_back(makeKey(L"List item " + std::to_wstring(i)));
+        }
+        cache.invalidate();
+        cache.statistics = {};
+
+        int first = 0;
+        double scrollTime = unit_test::measure([&]
+        {
+            for (int i = first; i < first + visibleCount; ++i)
+            {
+                auto& key = items[i % itemCount];
+                if (!cache.find(key).has_value())
+                {
+                    cache.allocate(key, 60 + (int)(key.text.size() * 7), 20);
+                }
+            }
+            first += step;
+        },
+        itemCount / step);
+
+        std::printf("benchmark scrolling %d items: %.1f us per frame, %zu hits, %zu misses, %zu recycled pages\n",
+            itemCount, scrollTime * 1.0e3, cache.statistics.hitCount,
+            cache.statistics.missCount, cache.statistics.recycledPageCount);
+    }
+}
+
+int main()
+{
+    testFindAndAllocate();
+    testRecycle();
+    testDpi();
+    benchmark();
+
+    return unit_test::report("TextAtlasCache");
+}
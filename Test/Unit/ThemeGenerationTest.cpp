@@ -0,0 +1,146 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/ThemeGeneration.h"
+
+#include "UnitTest.h"
+
+using namespace d14engine;
+using namespace d14engine::uikit;
+
+namespace
+{
+    // A stand-in of Panel that keeps the applied generation and copies a few
+    // colors in onChangeTheme like the appearances do.
+    struct Widget
+    {
+        virtual ~Widget() = default;
+
+        uint64_t appliedGeneration = 0;
+
+        std::array<float, 4> background = {}, foreground = {}, stroke = {};
+
+        virtual void onChangeTheme(bool dark)
+        {
+            float value = dark ? 0.1f : 0.9f;
+
+            background = { value, value, value, 1.0f };
+            foreground = { 1.0f - value, 1.0f - value, 1.0f - value, 1.0f };
+            stroke = { 0.5f, 0.5f, 0.5f, value };
+        }
+    };
+
+    using Generation = ThemeGeneration<Widget>;
+
+    void applyPendingTheme(Widget& widget, const Generation& generation, bool dark)
+    {
+        if (widget.appliedGeneration == generation.value()) return;
+
+        widget.appliedGeneration = generation.value();
+        widget.onChangeTheme(dark);
+    }
+
+    void testSubscribers()
+    {
+        Generation generation = {};
+        D14_CHECK(generation.value() == 0);
+
+        auto a = std::make_shared<Widget>();
+        auto b = std::make_shared<Widget>();
+
+        generation.subscribe(a);
+        generation.subscribe(b);
+        generation.subscribe(a); // once only
+        D14_CHECK(generation.subscriberCount() == 2);
+
+        auto subscribers = generation.advance();
+        D14_CHECK(generation.value() == 1 && subscribers.size() == 2);
+
+        // Unsubscribing while notifying does not touch the returned list.
+        for (auto& subscriber : subscribers) generation.unsubscribe(subscriber);
+        D14_CHECK(generation.subscriberCount() == 0);
+
+        // The expired ones are dropped in the next switch.
+        generation.subscribe(a);
+        generation.subscribe(b);
+        subscribers.clear();
+        b.reset();
+
+        subscribers = generation.advance();
+        D14_CHECK(generation.value() == 2);
+        D14_CHECK(subscribers.size() == 1 && subscribers[0] == a);
+        D14_CHECK(generation.subscriberCount() == 1);
+    }
+
+    void testCatchUp()
+    {
+        Generation generation = {};
+        std::vector<Widget> widgets(100);
+
+        generation.advance();
+        for (size_t i = 0; i < 10; ++i) applyPendingTheme(widgets[i], generation, true);
+
+        D14_CHECK(widgets[0].appliedGeneration == 1 && widgets[0].background[0] == 0.1f);
+        D14_CHECK(widgets[10].appliedGeneration == 0 && widgets[10].background[0] == 0.0f);
+
+        // A hidden widget applies the latest theme once shown, however many
+        // switches it missed.
+        generation.advance();
+        generation.advance();
+        applyPendingTheme(widgets[50], generation, false);
+        D14_CHECK(widgets[50].appliedGeneration == 3 && widgets[50].background[0] == 0.9f);
+    }
+
+    // What a theme toggle costs against the widget count: the old eager walk
+    // that applies the theme to every widget, and the generation with the
+    // catch-up of the 200 widgets that are visible in the next frame.
+    void benchmark()
+    {
+        const size_t visibleCount = 200;
+
+        for (size_t count : { 1000, 10000, 100000 })
+        {
+            std::vector<UniquePtr<Widget>> widgets = {};
+            widgets.reserve(count);
+            for (size_t i = 0; i < count; ++i) widgets.push_back(std::make_unique<Widget>());
+
+            bool dark = false;
+            double eagerTime = unit_test::measure([&]
+            {
+                dark = !dark;
+                for (auto& widget : widgets) widget->onChangeTheme(dark);
+            },
+            20);
+
+            Generation generation = {};
+            double toggleTime = unit_test::measure([&]
+            {
+                dark = !dark;
+                generation.advance();
+            },
+            20);
+
+            double catchUpTime = unit_test::measure([&]
+            {
+                dark = !dark;
+                generation.advance();
+                for (size_t i = 0; i < visibleCount; ++i)
+                {
+                    applyPendingTheme(*widgets[i], generation, dark);
+                }
+            },
+            20);
+            std::printf("benchmark (%zu widgets): eager %.1f us, toggle %.3f us, "
+                "toggle + first frame (%zu visible) %.1f us\n",
+                count, eagerTime * 1000.0, toggleTime * 1000.0, visibleCount, catchUpTime * 1000.0);
+        }
+    }
+}
+
+int main()
+{
+    testSubscribers();
+    testCatchUp();
+    benchmark();
+
+    return unit_test::report("ThemeGeneration");
+}
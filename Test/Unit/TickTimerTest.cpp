@@ -0,0 +1,198 @@
+﻿#include "Common/Precompile.h"
+
+#include "Renderer/Clocks.h"
+#include "Renderer/TickTimer.h"
+
+#include "UnitTest.h"
+
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::renderer;
+
+namespace
+{
+    // A frame sequence like animation_utils::Sequence, which advances one
+    // frame per 70 ms of the update time.
+    struct FrameSequence
+    {
+        size_t index = SIZE_MAX;
+        size_t count = 12;
+
+        float elapsedSecs = 0.0f;
+        float frameSecs = 0.07f;
+
+        uint64_t advanceCount = 0;
+
+        void update(double deltaSecs)
+        {
+            elapsedSecs += (float)deltaSecs;
+            while (elapsedSecs >= frameSecs)
+            {
+                index = (index + 1) % count;
+                elapsedSecs -= frameSecs;
+                ++advanceCount;
+            }
+        }
+    };
+
+    struct RunResult
+    {
+        uint64_t updateCount = 0;
+
+        size_t index = 0;
+        uint64_t advanceCount = 0;
+    };
+
+    // 10 minutes at the frame rate in the fixed-step mode, optionally with
+    // the frame times jittering by +/- 50%.
+    RunResult runFixedStep(double fps, bool jitter)
+    {
+        auto clock = std::make_shared<ManualClock>(5.0);
+
+        TickTimer timer(clock);
+        timer.setFixedStepMode({ true, 1.0 / 60.0, 8 });
+        timer.start();
+
+        std::mt19937 random(1);
+        std::uniform_real_distribution<double> scale(0.5, 1.5);
+
+        FrameSequence sequence = {};
+        RunResult result = {};
+
+        while (true)
+        {
+            for (uint32_t i = 0; i < timer.stepCount(); ++i)
+            {
+                sequence.update(timer.deltaSecs());
+                ++result.updateCount;
+            }
+            auto alpha = timer.interpolationAlpha();
+            D14_CHECK(alpha >= 0.0 && alpha < 1.0);
+
+            if (timer.elapsedSecs() >= 600.0) break;
+
+            clock->advance(jitter ? scale(random) / fps : 1.0 / fps);
+            timer.tick();
+        }
+        result.index = sequence.index;
+        result.advanceCount = sequence.advanceCount;
+
+        return result;
+    }
+
+    void testFixedStep()
+    {
+        auto expected = runFixedStep(60.0, false);
+        D14_CHECK(expected.updateCount == 36000 || expected.updateCount == 36001);
+
+        // The animations end at the same frame whatever the frame rate is.
+        for (double fps : { 30.0, 75.0, 144.0, 240.0 })
+        {
+            for (bool jitter : { false, true })
+            {
+                auto result = runFixedStep(fps, jitter);
+
+                D14_CHECK(result.index == expected.index);
+                D14_CHECK(result.advanceCount == expected.advanceCount);
+                D14_CHECK(result.updateCount >= 36000 && result.updateCount <= 36002);
+            }
+        }
+        // A 1 second hitch only runs the capped steps, and drops the rest.
+        auto clock = std::make_shared<ManualClock>();
+
+        TickTimer timer(clock);
+        timer.setFixedStepMode({ true, 1.0 / 60.0, 8 });
+        timer.start();
+
+        clock->advance(1.0);
+        timer.tick();
+
+        D14_CHECK(timer.stepCount() == 8);
+        D14_CHECK(timer.interpolationAlpha() >= 0.0 && timer.interpolationAlpha() < 1.0);
+
+        // So the next frame is a normal one.
+        clock->advance(1.0 / 60.0);
+        timer.tick();
+        D14_CHECK(timer.stepCount() <= 2);
+    }
+
+    void testClocks()
+    {
+        auto manual = std::make_shared<ManualClock>();
+        auto scaled = std::make_shared<ScaledClock>(manual, 2.0);
+
+        manual->advance(1.0);
+        D14_CHECK_NEAR(scaled->nowSecs(), 2.0, 1.0e-9);
+
+        // Changing the scale does not make the time jump.
+        scaled->setScale(0.5);
+        manual->advance(2.0);
+        D14_CHECK_NEAR(scaled->nowSecs(), 3.0, 1.0e-9);
+
+        scaled->setScale(0.0);
+        manual->advance(10.0);
+        D14_CHECK_NEAR(scaled->nowSecs(), 3.0, 1.0e-9);
+
+        // The pause is not counted, and a new clock continues the time.
+        TickTimer timer(manual);
+        timer.start();
+
+        manual->advance(1.0);
+        timer.tick();
+        timer.stop();
+
+        manual->advance(5.0);
+        timer.resume();
+        manual->advance(1.0);
+        timer.tick();
+
+        auto another = std::make_shared<ManualClock>(100.0);
+        timer.setClock(another);
+
+        another->advance(1.0);
+        timer.tick();
+
+        D14_CHECK_NEAR(timer.elapsedSecs(), 3.0, 1.0e-9);
+        D14_CHECK_NEAR(timer.deltaSecs(), 1.0, 1.0e-9);
+
+        // Not in the fixed-step mode, so one update per frame.
+        D14_CHECK(timer.stepCount() == 1 && timer.interpolationAlpha() == 0.0);
+    }
+
+    // With the fixed-step clock, 10 minutes of the animations at 60 fps run
+    // as fast as the updates themselves.
+    void benchmark()
+    {
+        TickTimer timer(std::make_shared<FixedStepClock>(1.0 / 60.0));
+        timer.start();
+
+        FrameSequence sequence = {};
+        uint64_t frameCount = 0;
+
+        double time = unit_test::measure([&]
+        {
+            while (timer.elapsedSecs() < 600.0 - 1.0e-9)
+            {
+                sequence.update(timer.deltaSecs());
+                timer.tick();
+                ++frameCount;
+            }
+        },
+        1);
+        D14_CHECK(frameCount == 36000);
+        D14_CHECK_NEAR(timer.elapsedSecs(), 600.0, 1.0e-6);
+
+        std::printf("benchmark fixed-step clock: %llu frames (10 minutes at 60 fps) in %.3f ms\n",
+            (unsigned long long)frameCount, time);
+    }
+}
+
+int main()
+{
+    testFixedStep();
+    testClocks();
+    benchmark();
+
+    return unit_test::report("TickTimer");
+}
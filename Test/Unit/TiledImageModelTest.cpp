@@ -0,0 +1,309 @@
+﻿#include "Common/Precompile.h"
+
+#include "UIKit/TileLoader.h"
+#include "UIKit/TiledImageModel.h"
+
+#include "UnitTest.h"
+
+#include <cstring>
+#include <random>
+
+using namespace d14engine;
+using namespace d14engine::uikit;
+
+namespace
+{
+    using Key = TilePyramid::Key;
+    using Rect = TilePyramid::Rect;
+
+    void testPyramid()
+    {
+        TilePyramid pyramid(10000, 3000, 256);
+
+        // 10000 -> 5000 -> 2500 -> 1250 -> 625 -> 313 -> 157 (fits in 256)
+        D14_CHECK(pyramid.levelCount() == 7);
+        D14_CHECK(pyramid.levelWidth(6) == 157 && pyramid.levelHeight(6) == 47);
+        D14_CHECK(pyramid.tileCountX(0) == 40 && pyramid.tileCountY(0) == 12);
+
+        D14_CHECK((pyramid.tileRect({ 0, 39, 11 }) == Rect{ 9984.0, 2816.0, 10000.0, 3000.0 }));
+
+        D14_CHECK(pyramid.levelForScale(2.0) == 0);
+        D14_CHECK(pyramid.levelForScale(1.0) == 0);
+        D14_CHECK(pyramid.levelForScale(0.5) == 1);
+        D14_CHECK(pyramid.levelForScale(0.26) == 1);
+        D14_CHECK(pyramid.levelForScale(0.25) == 2);
+        D14_CHECK(pyramid.levelForScale(0.0001) == 6);
+
+        Rect whole = { 0.0, 0.0, 10000.0, 3000.0 };
+
+        for (int level = 0; level < pyramid.levelCount(); ++level)
+        {
+            // The tiles of every level cover the whole image exactly.
+            double area = 0.0;
+            for (auto& key : pyramid.tilesInRegion(level, whole))
+            {
+                auto region = pyramid.tileRegion(key);
+                area += (region.right - region.left) * (region.bottom - region.top);
+            }
+            D14_CHECK_NEAR(area, 3.0e7, 1.0e-3);
+
+            // And the parent covers the child.
+            if (level + 1 == pyramid.levelCount()) continue;
+
+            bool isCovered = true;
+            for (auto& key : pyramid.tilesInRegion(level, whole))
+            {
+                auto child = pyramid.tileRegion(key);
+                auto parent = pyramid.tileRegion(pyramid.parent(key).value());
+
+                isCovered = isCovered &&
+                    parent.left <= child.left && parent.top <= child.top &&
+                    parent.right >= child.right && parent.bottom >= child.bottom;
+            }
+            D14_CHECK(isCovered);
+        }
+        D14_CHECK(!pyramid.parent({ 6, 0, 0 }).has_value());
+
+        D14_CHECK(pyramid.tilesInRegion(0, { 256.0, 0.0, 512.0, 256.0 }).size() == 1);
+        D14_CHECK(pyramid.tilesInRegion(0, { -100.0, -100.0, -1.0, -1.0 }).empty());
+    }
+
+    void testCache()
+    {
+        TileCache cache(1000);
+
+        cache.beginFrame();
+        cache.insert({ 0, 0, 0 }, 400);
+        cache.insert({ 0, 1, 0 }, 400);
+
+        // The least recently used one is evicted.
+        cache.beginFrame();
+        cache.touch({ 0, 0, 0 });
+
+        auto evicted = cache.insert({ 0, 2, 0 }, 400);
+        D14_CHECK((evicted.size() == 1 && evicted[0] == Key{ 0, 1, 0 }));
+        D14_CHECK(cache.usedBytes() == 800);
+
+        // Those being drawn are kept even beyond the budget.
+        cache.beginFrame();
+        cache.touch({ 0, 0, 0 });
+        cache.touch({ 0, 2, 0 });
+
+        D14_CHECK(cache.insert({ 0, 3, 0 }, 400).empty());
+        D14_CHECK(cache.usedBytes() == 1200);
+
+        cache.beginFrame();
+        cache.touch({ 0, 3, 0 });
+
+        D14_CHECK(cache.setBudget(500).size() == 2);
+        D14_CHECK(cache.count() == 1 && cache.usedBytes() == 400);
+
+        // Replacing updates the size.
+        cache.insert({ 0, 3, 0 }, 100);
+        D14_CHECK(cache.count() == 1 && cache.usedBytes() == 100);
+    }
+
+    void testPlan()
+    {
+        TilePyramid pyramid(10000, 3000, 256);
+        TileCache cache(SIZE_MAX);
+
+        Rect viewport = { 0.0, 0.0, 1000.0, 1000.0 };
+
+        // Nothing to draw, so the coarsest tile is loaded first.
+        auto plan = planTiles(pyramid, cache, viewport, 1.0);
+
+        D14_CHECK(plan.level == 0 && plan.draws.empty());
+        D14_CHECK(plan.requests.size() == 1 + 16 && plan.requests[0].level == 6);
+
+        // The coarsest tile stands in for all the missing ones.
+        cache.insert({ 6, 0, 0 }, 1);
+        plan = planTiles(pyramid, cache, viewport, 1.0);
+
+        D14_CHECK(plan.draws.size() == 16 && plan.requests.size() == 16);
+
+        auto& draw = plan.draws[5];
+        D14_CHECK(draw.key.level == 6 && draw.destination == pyramid.tileRegion({ 0, 1, 1 }));
+        D14_CHECK_NEAR(draw.source.left, 256.0 / 64.0, 1.0e-9);
+        D14_CHECK_NEAR(draw.source.right, 512.0 / 64.0, 1.0e-9);
+
+        // The requests of the target level start from the center.
+        double lastDistance = -1.0;
+        for (size_t i = 1; i < plan.requests.size(); ++i)
+        {
+            auto region = pyramid.tileRegion(plan.requests[i]);
+
+            double dx = (region.left + region.right) / 2.0 - 500.0;
+            double dy = (region.top + region.bottom) / 2.0 - 500.0;
+
+            D14_CHECK(dx * dx + dy * dy >= lastDistance);
+            lastDistance = dx * dx + dy * dy;
+        }
+        cache.insert({ 0, 1, 1 }, 1);
+        plan = planTiles(pyramid, cache, viewport, 1.0);
+
+        D14_CHECK(plan.draws.size() == 16 && plan.requests.size() == 15);
+    }
+
+    std::vector<Key> allKeys(const TilePyramid& pyramid)
+    {
+        std::vector<Key> keys = {};
+
+        Rect whole = { 0.0, 0.0, (double)pyramid.width(), (double)pyramid.height() };
+        for (int level = 0; level < pyramid.levelCount(); ++level)
+        {
+            for (auto& key : pyramid.tilesInRegion(level, whole)) keys.push_back(key);
+        }
+        return keys;
+    }
+
+    // Compares the loaded tiles with the image, where a pixel of level 1 is
+    // the rounded average of the 2x2 pixels it covers.
+    void testLoader()
+    {
+        const uint32_t width = 1500, height = 900;
+
+        std::vector<uint8_t> pixels(width * height * 4);
+        std::mt19937 random(3);
+        for (auto& byte : pixels) byte = (uint8_t)random();
+
+        auto source = std::make_shared<MemoryTileSource>(image_utils::ImageView{ pixels.data(), width, height, width * 4 });
+
+        TilePyramid pyramid(width, height, 256);
+        auto keys = allKeys(pyramid);
+        {
+            TileLoader loader(source, pyramid, 3);
+
+            // The duplicated requests are skipped.
+            loader.request(keys);
+            loader.request(keys);
+
+            std::unordered_set<Key, TilePyramid::KeyHash> loadedKeys = {};
+
+            bool isSame = true;
+            auto checkTile = [&](const TileLoader::Tile& tile)
+            {
+                D14_CHECK(loadedKeys.insert(tile.key).second);
+
+                if (tile.key.level == 0)
+                {
+                    for (int y = 0; y < tile.height; ++y)
+                    {
+                        auto expected = &pixels[((tile.key.y * 256 + y) * width + tile.key.x * 256) * 4];
+                        isSame = isSame && std::memcmp(&tile.pixels[y * tile.width * 4], expected, tile.width * 4) == 0;
+                    }
+                }
+                else if (tile.key.level == 1)
+                {
+                    // The bottom-right pixel, which is clipped at the edges.
+                    int x = tile.width - 1, y = tile.height - 1;
+                    int px = tile.key.x * 256 + x, py = tile.key.y * 256 + y;
+
+                    int sum = 0, count = 0;
+                    for (int sy = py * 2; sy < std::min(py * 2 + 2, (int)height); ++sy)
+                    {
+                        for (int sx = px * 2; sx < std::min(px * 2 + 2, (int)width); ++sx)
+                        {
+                            sum += pixels[(sy * width + sx) * 4];
+                            ++count;
+                        }
+                    }
+                    isSame = isSame && tile.pixels[(y * tile.width + x) * 4] == (sum + count / 2) / count;
+                }
+            };
+            while (!loader.idle())
+            {
+                for (auto& tile : loader.takeLoaded()) checkTile(tile);
+
+                std::this_thread::yield();
+            }
+            for (auto& tile : loader.takeLoaded()) checkTile(tile);
+
+            D14_CHECK(isSame);
+            D14_CHECK(loadedKeys.size() == keys.size());
+            D14_CHECK(loader.failedCount() == 0);
+        }
+        // A new request drops the queued tiles.
+        TileLoader loader(source, pyramid, 1);
+
+        loader.request(keys);
+        loader.request({});
+
+        size_t loadedCount = 0;
+        while (!loader.idle())
+        {
+            loadedCount += loader.takeLoaded().size();
+
+            std::this_thread::yield();
+        }
+        D14_CHECK(loadedCount < keys.size());
+    }
+
+    // Panning a 4K viewport over a gigapixel image, which runs every frame,
+    // and loading all the tiles of an 8k x 8k image.
+    void benchmark()
+    {
+        TilePyramid pyramid(40000, 30000, 256);
+        TileCache cache(512 * 1024 * 1024);
+
+        // As if everything of the coarser half were loaded.
+        for (int level = pyramid.levelCount() / 2; level < pyramid.levelCount(); ++level)
+        {
+            for (auto& key : pyramid.tilesInRegion(level, { 0.0, 0.0, 40000.0, 30000.0 })) cache.insert(key, 256 * 256 * 4);
+        }
+        int frame = 0;
+        size_t drawCount = 0, requestCount = 0;
+
+        double planTime = unit_test::measure([&]
+        {
+            cache.beginFrame();
+
+            double offset = (frame++ % 100) * 37.0;
+            auto plan = planTiles(pyramid, cache, { offset, offset, offset + 3840.0, offset + 2160.0 }, 1.0);
+
+            drawCount = plan.draws.size();
+            requestCount = plan.requests.size();
+        },
+        1000);
+        std::printf("benchmark planTiles (4K viewport, 40000x30000): %.1f us per frame (%zu draws, %zu requests)\n",
+            planTime * 1000.0, drawCount, requestCount);
+
+        const uint32_t width = 8192, height = 8192;
+        std::vector<uint8_t> pixels((size_t)width * height * 4, 0x80);
+
+        auto source = std::make_shared<MemoryTileSource>(image_utils::ImageView{ pixels.data(), width, height, width * 4 });
+
+        TilePyramid sourcePyramid(width, height, 256);
+        auto keys = allKeys(sourcePyramid);
+
+        for (size_t threadCount : { 1, 4 })
+        {
+            TileLoader loader(source, sourcePyramid, threadCount);
+
+            double loadTime = unit_test::measure([&]
+            {
+                loader.request(keys);
+                while (!loader.idle())
+                {
+                    loader.takeLoaded();
+
+                    std::this_thread::yield();
+                }
+            },
+            1);
+            std::printf("benchmark TileLoader (8k x 8k, %zu tiles, %zu threads): %.1f ms\n",
+                keys.size(), threadCount, loadTime);
+        }
+    }
+}
+
+int main()
+{
+    testPyramid();
+    testCache();
+    testPlan();
+    testLoader();
+    benchmark();
+
+    return unit_test::report("TiledImageModel");
+}
@@ -0,0 +1,57 @@
+﻿#pragma once
+
+#include "Common/Precompile.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace d14engine::unit_test
+{
+    // A minimal harness for the unit tests, where each test is an executable
+    // that runs the checks (and benchmarks) in main and returns report().
+
+    inline int g_checkCount = 0;
+    inline int g_failureCount = 0;
+
+    inline bool check(bool condition, const char* expression, const char* file, int line)
+    {
+        ++g_checkCount;
+        if (!condition)
+        {
+            // Only print the first failures, since a broken invariant in a
+            // randomized loop would otherwise flood the output.
+            if (g_failureCount++ < 20)
+            {
+                std::printf("%s(%d): check failed: %s\n", file, line, expression);
+            }
+        }
+        return condition;
+    }
+
+    inline int report(const char* name)
+    {
+        std::printf("%s: %d checks, %d failures\n", name, g_checkCount, g_failureCount);
+
+        return g_failureCount == 0 ? 0 : 1;
+    }
+
+    // Returns the average milliseconds of calling func repeatCount times.
+    template<typename Func>
+    double measure(Func&& func, int repeatCount = 1)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < repeatCount; ++i) func();
+
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        return elapsed.count() / repeatCount;
+    }
+}
+
+#define D14_CHECK(Expression) \
+    ::d14engine::unit_test::check((Expression), #Expression, __FILE__, __LINE__)
+
+#define D14_CHECK_NEAR(Value, Expected, Tolerance) \
+    D14_CHECK(std::abs((double)(Value) - (double)(Expected)) <= (Tolerance))
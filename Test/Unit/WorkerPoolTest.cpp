@@ -0,0 +1,83 @@
+﻿#include "Common/Precompile.h"
+
+#include "Renderer/WorkerPool.h"
+
+#include "UnitTest.h"
+
+#include <atomic>
+
+using namespace d14engine;
+using namespace d14engine::renderer;
+
+namespace
+{
+    void testRunsEachTaskOnce(size_t workerCount)
+    {
+        WorkerPool pool(workerCount);
+        D14_CHECK(pool.workerCount() == workerCount);
+
+        // Many short runs in a row, which is how a frame loop uses the pool.
+        for (size_t run = 0; run < 2000; ++run)
+        {
+            size_t taskCount = run % 17;
+
+            std::vector<std::atomic<int>> calls(taskCount);
+            for (auto& call : calls) call = 0;
+
+            pool.run(taskCount, [&](size_t index) { ++calls[index]; });
+
+            // run returns only after all the tasks have returned.
+            bool once = true;
+            for (auto& call : calls) once = once && call == 1;
+
+            if (!D14_CHECK(once)) return;
+        }
+    }
+
+    void testUsesTheWorkers()
+    {
+        WorkerPool pool(3);
+
+        std::mutex mutex = {};
+        std::set<std::thread::id> threads = {};
+
+        // Long enough that the workers wake before the caller takes all.
+        pool.run(64, [&](size_t)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            std::unique_lock lock(mutex);
+            threads.insert(std::this_thread::get_id());
+        });
+        D14_CHECK(threads.size() > 1);
+    }
+
+    void benchmark()
+    {
+        // The fixed cost of a run, which is what DrawList's threshold of the
+        // parallel culling has to amortize.
+        for (size_t workerCount : { 0, 1, 3 })
+        {
+            WorkerPool pool(workerCount);
+
+            std::atomic<size_t> sum = 0;
+            double time = unit_test::measure([&]
+            {
+                pool.run(workerCount + 1, [&](size_t index) { sum += index; });
+            },
+            2000);
+            std::printf("benchmark run (%zu workers, empty tasks): %.2f us\n", workerCount, time * 1000.0);
+        }
+    }
+}
+
+int main()
+{
+    testRunsEachTaskOnce(0);
+    testRunsEachTaskOnce(1);
+    testRunsEachTaskOnce(4);
+    testUsesTheWorkers();
+    benchmark();
+
+    return unit_test::report("WorkerPool");
+}